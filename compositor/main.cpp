@@ -42,6 +42,10 @@
 
 int main(int argc, char *argv[])
 {
+    // Each output renders with its own context, mirrored outputs
+    // sample the frames of another one so they must all be shared
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+
     // Application
     QGuiApplication app(argc, argv);
     app.setApplicationName("Green Island");
@@ -45,14 +45,18 @@
 #include <GreenIsland/QtWaylandCompositor/QWaylandXdgShell>
 
 #include <GreenIsland/Server/ApplicationManager>
+#include <GreenIsland/Server/BlurItem>
 #include <GreenIsland/Server/ClientWindow>
 #include <GreenIsland/Server/ClientWindowQuickItem>
+#include <GreenIsland/Server/ColorManager>
 #include <GreenIsland/Server/CompositorSettings>
 #include <GreenIsland/Server/OutputChangeset>
 #include <GreenIsland/Server/OutputManagement>
 #include <GreenIsland/Server/QuickOutput>
 #include <GreenIsland/Server/QuickOutputConfiguration>
 #include <GreenIsland/Server/GtkShell>
+#include <GreenIsland/Server/IdleInhibitManager>
+#include <GreenIsland/Server/IdleManager>
 #include <GreenIsland/Server/Keymap>
 #include <GreenIsland/Server/Screen>
 #include <GreenIsland/Server/Screencaster>
@@ -73,7 +77,9 @@ Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(QWaylandXdgShell)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(QWaylandTextInputManager)
 
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(ApplicationManager)
+Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(ColorManager)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(GtkShell)
+Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(IdleInhibitManager)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(OutputManagement)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(Screencaster)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(Screenshooter)
@@ -178,6 +184,16 @@ void GreenIslandPlugin::registerTypes(const char *uri)
     qmlRegisterUncreatableType<Screenshot>(uri, 1, 0, "Screenshot",
                                            QObject::tr("Cannot create instance of Screenshot"));
 
+    // Color manager
+    qmlRegisterType<ColorManagerQuickExtension>(uri, 1, 0, "ColorManager");
+
+    // Blur behind
+    qmlRegisterType<BlurItem>(uri, 1, 0, "BlurItem");
+
+    // Idle
+    qmlRegisterType<IdleManager>(uri, 1, 0, "IdleManager");
+    qmlRegisterType<IdleInhibitManagerQuickExtension>(uri, 1, 0, "IdleInhibitManager");
+
     // Key event filter
     qmlRegisterType<KeyEventFilter>(uri, 1, 0, "KeyEventFilter");
 
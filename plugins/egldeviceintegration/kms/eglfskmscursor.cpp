@@ -174,8 +174,19 @@ void EglFSKmsCursor::setPos(const QPoint &pos)
 {
     Q_FOREACH (QPlatformScreen *screen, m_screen->virtualSiblings()) {
         EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen);
-        QPoint origin = kmsScreen->geometry().topLeft();
-        QPoint localPos = pos - origin;
+        const QRect geometry = kmsScreen->geometry();
+        QPoint localPos = pos - geometry.topLeft();
+
+        // The cursor plane is positioned in scanout coordinates
+        if (kmsScreen->transform() != EglFSScreen::TransformNormal) {
+            const QPointF scanoutPos = kmsScreen->mapToScanout(
+                        QPointF(qreal(localPos.x()) / geometry.width(),
+                                qreal(localPos.y()) / geometry.height()));
+            const drmModeModeInfo &mode = kmsScreen->output().modes[kmsScreen->output().mode];
+            localPos = QPoint(qRound(scanoutPos.x() * mode.hdisplay),
+                              qRound(scanoutPos.y() * mode.vdisplay));
+        }
+
         QPoint adjustedPos = localPos - m_cursorImage.hotspot();
 
         int ret = drmModeMoveCursor(kmsScreen->device()->fd(), kmsScreen->output().crtc_id, adjustedPos.x(), adjustedPos.y());
@@ -33,11 +33,16 @@
 
 #include <QtCore/QLoggingCategory>
 #include <QtCore/private/qcore_unix_p.h>
+#include <QtGui/QScreen>
+#include <QtGui/QWindow>
 #include <QtGui/private/qguiapplication_p.h>
 
 #include <GreenIsland/Platform/EGLDeviceIntegration>
 #include <GreenIsland/Platform/EglFSIntegration>
 #include <GreenIsland/Platform/Logind>
+#include <GreenIsland/Platform/Udev>
+#include <GreenIsland/Platform/UdevDevice>
+#include <GreenIsland/Platform/UdevMonitor>
 
 #include "eglfskmsdevice.h"
 #include "eglfskmsscreen.h"
@@ -98,6 +103,8 @@ static const char * const connector_type_names[] = {
     "HDMI",
     "TV",
     "eDP",
+    "Virtual",
+    "DSI",
 };
 
 static QByteArray nameForConnector(const drmModeConnectorPtr connector)
@@ -308,9 +315,45 @@ EglFSKmsScreen *EglFSKmsDevice::screenForConnector(drmModeResPtr resources, drmM
         drmModeGetCrtc(m_dri_fd, crtc_id),
         modes,
         connectorProperty(connector, QByteArrayLiteral("DPMS")),
-        extractEdid(connector)
+        extractEdid(connector),
+        false,
+        crtcProperty(crtc_id, QByteArrayLiteral("VRR_ENABLED")),
+        0, 0, 0, 0, 0,
+        0, 0, 0
     };
 
+    uint64_t vrrCapable = 0;
+    if (connectorPropertyValue(connector, QByteArrayLiteral("vrr_capable"), &vrrCapable))
+        output.vrr_capable = vrrCapable != 0 && output.vrr_enabled_prop != 0;
+    qCDebug(lcKms) << "Adaptive sync for output" << connectorName
+                   << (output.vrr_capable ? "is supported" : "is not supported");
+
+    // Color management properties, older drivers only have the legacy gamma
+    uint64_t lutSize = 0;
+    output.gamma_lut_prop = crtcProperty(crtc_id, QByteArrayLiteral("GAMMA_LUT"));
+    if (crtcProperty(crtc_id, QByteArrayLiteral("GAMMA_LUT_SIZE"), &lutSize))
+        output.gamma_lut_size = int(lutSize);
+    lutSize = 0;
+    output.degamma_lut_prop = crtcProperty(crtc_id, QByteArrayLiteral("DEGAMMA_LUT"));
+    if (crtcProperty(crtc_id, QByteArrayLiteral("DEGAMMA_LUT_SIZE"), &lutSize))
+        output.degamma_lut_size = int(lutSize);
+    output.ctm_prop = crtcProperty(crtc_id, QByteArrayLiteral("CTM"));
+
+    // Rotations the primary plane can do while scanning out
+    output.primary_plane_id = primaryPlane(crtc);
+    if (output.primary_plane_id) {
+        drmModePropertyPtr rotation = Q_NULLPTR;
+        output.rotation_prop = objectProperty(output.primary_plane_id, DRM_MODE_OBJECT_PLANE,
+                                              QByteArrayLiteral("rotation"), Q_NULLPTR, &rotation);
+        if (rotation) {
+            for (int i = 0; i < rotation->count_enums; i++)
+                output.rotations |= 1 << rotation->enums[i].value;
+            drmModeFreeProperty(rotation);
+        }
+    }
+    qCDebug(lcKms) << "Rotations supported by output" << connectorName
+                   << ":" << hex << output.rotations;
+
     m_crtc_allocator |= (1 << output.crtc_id);
     m_connector_allocator |= (1 << output.connector_id);
 
@@ -333,6 +376,85 @@ drmModePropertyPtr EglFSKmsDevice::connectorProperty(drmModeConnectorPtr connect
     return Q_NULLPTR;
 }
 
+bool EglFSKmsDevice::connectorPropertyValue(drmModeConnectorPtr connector, const QByteArray &name, uint64_t *value)
+{
+    drmModePropertyPtr prop;
+
+    for (int i = 0; i < connector->count_props; i++) {
+        prop = drmModeGetProperty(m_dri_fd, connector->props[i]);
+        if (!prop)
+            continue;
+        bool found = strcmp(prop->name, name.constData()) == 0;
+        drmModeFreeProperty(prop);
+        if (found) {
+            *value = connector->prop_values[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint32_t EglFSKmsDevice::crtcProperty(uint32_t crtcId, const QByteArray &name, uint64_t *value)
+{
+    return objectProperty(crtcId, DRM_MODE_OBJECT_CRTC, name, value);
+}
+
+uint32_t EglFSKmsDevice::objectProperty(uint32_t objectId, uint32_t objectType, const QByteArray &name,
+                                        uint64_t *value, drmModePropertyPtr *property)
+{
+    drmModeObjectPropertiesPtr props =
+            drmModeObjectGetProperties(m_dri_fd, objectId, objectType);
+    if (!props)
+        return 0;
+
+    uint32_t propId = 0;
+    for (uint32_t i = 0; i < props->count_props && !propId; i++) {
+        drmModePropertyPtr prop = drmModeGetProperty(m_dri_fd, props->props[i]);
+        if (!prop)
+            continue;
+        if (strcmp(prop->name, name.constData()) == 0) {
+            propId = prop->prop_id;
+            if (value)
+                *value = props->prop_values[i];
+            if (property) {
+                // Ownership goes to the caller
+                *property = prop;
+                continue;
+            }
+        }
+        drmModeFreeProperty(prop);
+    }
+
+    drmModeFreeObjectProperties(props);
+    return propId;
+}
+
+uint32_t EglFSKmsDevice::primaryPlane(int crtcIndex)
+{
+    drmModePlaneResPtr planes = drmModeGetPlaneResources(m_dri_fd);
+    if (!planes)
+        return 0;
+
+    uint32_t planeId = 0;
+    for (uint32_t i = 0; i < planes->count_planes && !planeId; i++) {
+        drmModePlanePtr plane = drmModeGetPlane(m_dri_fd, planes->planes[i]);
+        if (!plane)
+            continue;
+
+        uint64_t type = 0;
+        if ((plane->possible_crtcs & (1 << crtcIndex)) &&
+                objectProperty(plane->plane_id, DRM_MODE_OBJECT_PLANE, QByteArrayLiteral("type"), &type) &&
+                type == DRM_PLANE_TYPE_PRIMARY)
+            planeId = plane->plane_id;
+
+        drmModeFreePlane(plane);
+    }
+
+    drmModeFreePlaneResources(planes);
+    return planeId;
+}
+
 drmModePropertyBlobPtr EglFSKmsDevice::extractEdid(drmModeConnectorPtr connector)
 {
     drmModePropertyPtr prop;
@@ -353,11 +475,9 @@ drmModePropertyBlobPtr EglFSKmsDevice::extractEdid(drmModeConnectorPtr connector
 void EglFSKmsDevice::pageFlipHandler(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec, void *user_data)
 {
     Q_UNUSED(fd);
-    Q_UNUSED(sequence);
-    Q_UNUSED(tv_sec);
-    Q_UNUSED(tv_usec);
 
     EglFSKmsScreen *screen = static_cast<EglFSKmsScreen *>(user_data);
+    screen->updatePresentation(sequence, tv_sec, tv_usec);
     screen->flipFinished();
 }
 
@@ -369,6 +489,9 @@ EglFSKmsDevice::EglFSKmsDevice(EglFSKmsIntegration *integration, const QString &
     , m_crtc_allocator(0)
     , m_connector_allocator(0)
     , m_globalCursor(Q_NULLPTR)
+    , m_globalCursorScreen(Q_NULLPTR)
+    , m_udev(Q_NULLPTR)
+    , m_udevMonitor(Q_NULLPTR)
 {
 }
 
@@ -399,6 +522,11 @@ bool EglFSKmsDevice::open()
 
     qCDebug(lcKms) << "Creating GBM device for file descriptor" << m_dri_fd
                    << "obtained from" << m_path;
+    // Primary planes are only listed with universal planes, we
+    // need them for rotation while mode setting is still legacy
+    if (drmSetClientCap(m_dri_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0)
+        qCDebug(lcKms) << "Universal planes are not supported by" << m_path;
+
     m_gbm_device = gbm_create_device(m_dri_fd);
     if (!m_gbm_device) {
         qErrnoWarning("Could not create GBM device");
@@ -412,6 +540,12 @@ bool EglFSKmsDevice::open()
 
 void EglFSKmsDevice::close()
 {
+    delete m_udevMonitor;
+    m_udevMonitor = Q_NULLPTR;
+
+    delete m_udev;
+    m_udev = Q_NULLPTR;
+
     if (m_gbm_device) {
         gbm_device_destroy(m_gbm_device);
         m_gbm_device = Q_NULLPTR;
@@ -426,6 +560,7 @@ void EglFSKmsDevice::close()
     if (m_globalCursor)
         m_globalCursor->deleteLater();
     m_globalCursor = Q_NULLPTR;
+    m_globalCursorScreen = Q_NULLPTR;
 }
 
 void EglFSKmsDevice::createScreens()
@@ -436,10 +571,7 @@ void EglFSKmsDevice::createScreens()
         return;
     }
 
-    EglFSKmsScreen *primaryScreen = Q_NULLPTR;
-    QList<QPlatformScreen *> siblings;
     QPoint pos(0, 0);
-    EglFSIntegration *integration = static_cast<EglFSIntegration *>(QGuiApplicationPrivate::platformIntegration());
 
     for (int i = 0; i < resources->count_connectors; i++) {
         drmModeConnectorPtr connector = drmModeGetConnector(m_dri_fd, resources->connectors[i]);
@@ -448,12 +580,92 @@ void EglFSKmsDevice::createScreens()
 
         EglFSKmsScreen *screen = screenForConnector(resources, connector, pos);
         if (screen) {
-            integration->addScreen(screen);
+            addScreen(screen);
             pos.rx() += screen->geometry().width();
-            siblings << screen;
+        }
+
+        drmModeFreeConnector(connector);
+    }
+
+    drmModeFreeResources(resources);
+
+    updateSiblings();
+
+    // Watch for connectors being plugged or unplugged
+    m_udev = new Udev;
+    m_udevMonitor = new UdevMonitor(m_udev);
+    if (!m_udevMonitor->isValid()) {
+        qCWarning(lcKms, "Output hotplug is not available");
+        return;
+    }
+    m_udevMonitor->filterSubSystemDevType(QStringLiteral("drm"), QStringLiteral("drm_minor"));
+    QObject::connect(m_udevMonitor, &UdevMonitor::deviceChanged, [this](UdevDevice *device) {
+        if (device->deviceNode() != m_path)
+            return;
+        if (device->deviceProperty(QStringLiteral("HOTPLUG")) != QLatin1String("1"))
+            return;
+
+        // Recent kernels tell us which connector has changed
+        qCDebug(lcKms) << "Hotplug event for" << m_path;
+        updateScreens(device->deviceProperty(QStringLiteral("CONNECTOR")).toUInt());
+    });
+}
+
+void EglFSKmsDevice::updateScreens(quint32 connectorId)
+{
+    drmModeResPtr resources = drmModeGetResources(m_dri_fd);
+    if (!resources) {
+        qCWarning(lcKms, "drmModeGetResources failed");
+        return;
+    }
+
+    // The kernel has already probed the connector that triggered the
+    // hotplug event, so here we read the cached state and do a full
+    // probe only for outputs that have just been connected
+    Q_FOREACH (EglFSKmsScreen *screen, m_screens) {
+        const uint32_t id = screen->output().connector_id;
+        if (connectorId != 0 && id != connectorId)
+            continue;
+
+        bool connected = false;
+        if (drmModeConnectorPtr connector = drmModeGetConnectorCurrent(m_dri_fd, id)) {
+            connected = connector->connection == DRM_MODE_CONNECTED;
+            drmModeFreeConnector(connector);
+        }
 
-            if (!primaryScreen)
-                primaryScreen = screen;
+        if (!connected)
+            removeScreen(screen);
+    }
+
+    // New outputs are placed at the right of the existing ones
+    QPoint pos(0, 0);
+    Q_FOREACH (EglFSKmsScreen *screen, m_screens)
+        pos.setX(qMax(pos.x(), screen->geometry().right() + 1));
+
+    for (int i = 0; i < resources->count_connectors; i++) {
+        const uint32_t id = resources->connectors[i];
+        if (connectorId != 0 && id != connectorId)
+            continue;
+        if (screenForConnectorId(id))
+            continue;
+
+        drmModeConnectorPtr connector = drmModeGetConnectorCurrent(m_dri_fd, id);
+        if (!connector)
+            continue;
+        const bool connected = connector->connection == DRM_MODE_CONNECTED;
+        drmModeFreeConnector(connector);
+        if (!connected)
+            continue;
+
+        connector = drmModeGetConnector(m_dri_fd, id);
+        if (!connector)
+            continue;
+
+        EglFSKmsScreen *screen = screenForConnector(resources, connector, pos);
+        if (screen) {
+            qCInfo(lcKms) << "Output" << screen->name() << "connected";
+            addScreen(screen);
+            pos.rx() += screen->geometry().width();
         }
 
         drmModeFreeConnector(connector);
@@ -461,12 +673,68 @@ void EglFSKmsDevice::createScreens()
 
     drmModeFreeResources(resources);
 
-    if (!m_integration->separateScreens()) {
-        Q_FOREACH (QPlatformScreen *screen, siblings)
-            static_cast<EglFSKmsScreen *>(screen)->setVirtualSiblings(siblings);
+    updateSiblings();
+}
+
+EglFSKmsScreen *EglFSKmsDevice::screenForConnectorId(uint32_t connectorId) const
+{
+    Q_FOREACH (EglFSKmsScreen *screen, m_screens) {
+        if (screen->output().connector_id == connectorId)
+            return screen;
+    }
+
+    return Q_NULLPTR;
+}
+
+void EglFSKmsDevice::addScreen(EglFSKmsScreen *screen)
+{
+    m_screens.append(screen);
+
+    EglFSIntegration *integration = static_cast<EglFSIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    integration->addScreen(screen);
+}
+
+void EglFSKmsDevice::removeScreen(EglFSKmsScreen *screen)
+{
+    qCInfo(lcKms) << "Output" << screen->name() << "disconnected";
+
+    // Destroy the windows on this screen first, which stops their
+    // render loops before the gbm surface goes away, the other
+    // outputs keep rendering undisturbed
+    Q_FOREACH (QWindow *window, QGuiApplication::topLevelWindows()) {
+        if (window->screen() && window->screen()->handle() == screen)
+            window->destroy();
+    }
+
+    m_crtc_allocator &= ~(1 << screen->output().crtc_id);
+    m_connector_allocator &= ~(1 << screen->output().connector_id);
+    m_screens.removeOne(screen);
+
+    if (m_globalCursorScreen == screen) {
+        m_globalCursor->deleteLater();
+        m_globalCursor = Q_NULLPTR;
+        m_globalCursorScreen = Q_NULLPTR;
+    }
+
+    // Also deletes the screen
+    EglFSIntegration *integration = static_cast<EglFSIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    integration->removeScreen(screen);
+}
+
+void EglFSKmsDevice::updateSiblings()
+{
+    if (m_integration->separateScreens())
+        return;
 
-        if (primaryScreen && qEnvironmentVariableIsSet("GREENISLAND_QPA_SHOW_CURSOR"))
-            m_globalCursor = new EglFSKmsCursor(primaryScreen);
+    QList<QPlatformScreen *> siblings;
+    Q_FOREACH (EglFSKmsScreen *screen, m_screens)
+        siblings << screen;
+    Q_FOREACH (EglFSKmsScreen *screen, m_screens)
+        screen->setVirtualSiblings(siblings);
+
+    if (!m_globalCursor && !m_screens.isEmpty() && qEnvironmentVariableIsSet("GREENISLAND_QPA_SHOW_CURSOR")) {
+        m_globalCursorScreen = m_screens.first();
+        m_globalCursor = new EglFSKmsCursor(m_globalCursorScreen);
     }
 }
 
@@ -485,6 +753,41 @@ QPlatformCursor *EglFSKmsDevice::globalCursor() const
     return m_globalCursor;
 }
 
+bool EglFSKmsDevice::isCrtcPossible(uint32_t crtcId, uint32_t connectorId) const
+{
+    drmModeResPtr resources = drmModeGetResources(m_dri_fd);
+    if (!resources)
+        return false;
+
+    int crtcIndex = -1;
+    for (int i = 0; i < resources->count_crtcs; i++) {
+        if (resources->crtcs[i] == crtcId) {
+            crtcIndex = i;
+            break;
+        }
+    }
+    drmModeFreeResources(resources);
+
+    if (crtcIndex < 0)
+        return false;
+
+    drmModeConnectorPtr connector = drmModeGetConnectorCurrent(m_dri_fd, connectorId);
+    if (!connector)
+        return false;
+
+    bool possible = false;
+    for (int i = 0; i < connector->count_encoders && !possible; i++) {
+        drmModeEncoderPtr encoder = drmModeGetEncoder(m_dri_fd, connector->encoders[i]);
+        if (!encoder)
+            continue;
+        possible = encoder->possible_crtcs & (1 << crtcIndex);
+        drmModeFreeEncoder(encoder);
+    }
+    drmModeFreeConnector(connector);
+
+    return possible;
+}
+
 void EglFSKmsDevice::handleDrmEvent()
 {
     drmEventContext drmEvent = {
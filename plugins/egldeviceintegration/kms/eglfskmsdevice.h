@@ -46,6 +46,8 @@ namespace GreenIsland {
 namespace Platform {
 
 class EglFSKmsScreen;
+class Udev;
+class UdevMonitor;
 
 class EglFSKmsDevice
 {
@@ -56,12 +58,15 @@ public:
     void close();
 
     void createScreens();
+    void updateScreens(quint32 connectorId = 0);
 
     gbm_device *device() const;
     int fd() const;
 
     QPlatformCursor *globalCursor() const;
 
+    bool isCrtcPossible(uint32_t crtcId, uint32_t connectorId) const;
+
     void handleDrmEvent();
 
 private:
@@ -76,10 +81,26 @@ private:
     quint32 m_connector_allocator;
 
     EglFSKmsCursor *m_globalCursor;
+    EglFSKmsScreen *m_globalCursorScreen;
+
+    QList<EglFSKmsScreen *> m_screens;
+
+    Udev *m_udev;
+    UdevMonitor *m_udevMonitor;
+
+    EglFSKmsScreen *screenForConnectorId(uint32_t connectorId) const;
+    void addScreen(EglFSKmsScreen *screen);
+    void removeScreen(EglFSKmsScreen *screen);
+    void updateSiblings();
 
     int crtcForConnector(drmModeResPtr resources, drmModeConnectorPtr connector);
     EglFSKmsScreen *screenForConnector(drmModeResPtr resources, drmModeConnectorPtr connector, QPoint pos);
     drmModePropertyPtr connectorProperty(drmModeConnectorPtr connector, const QByteArray &name);
+    bool connectorPropertyValue(drmModeConnectorPtr connector, const QByteArray &name, uint64_t *value);
+    uint32_t crtcProperty(uint32_t crtcId, const QByteArray &name, uint64_t *value = Q_NULLPTR);
+    uint32_t objectProperty(uint32_t objectId, uint32_t objectType, const QByteArray &name,
+                            uint64_t *value = Q_NULLPTR, drmModePropertyPtr *property = Q_NULLPTR);
+    uint32_t primaryPlane(int crtcIndex);
     drmModePropertyBlobPtr extractEdid(drmModeConnectorPtr connector);
 
     static void pageFlipHandler(int fd,
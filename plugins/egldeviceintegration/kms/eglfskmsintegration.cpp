@@ -42,8 +42,10 @@
 #include <QtGui/qpa/qplatformwindow.h>
 #include <QtGui/qpa/qplatformcursor.h>
 #include <QtGui/QScreen>
+#include <QtGui/QWindow>
 
 #include <GreenIsland/Platform/EglFSCursor>
+#include <GreenIsland/Platform/EglFSFunctions>
 #include <GreenIsland/Platform/EglFSWindow>
 #include <GreenIsland/Platform/Udev>
 #include <GreenIsland/Platform/UdevEnumerate>
@@ -65,6 +67,74 @@ namespace Platform {
 Q_LOGGING_CATEGORY(lcKms, "greenisland.qpa.kms")
 
 QMutex EglFSKmsScreen::m_waitForFlipMutex;
+QMutex EglFSKmsScreen::m_cloneMutex;
+
+static bool setScanoutClone(QScreen *screen, QScreen *source)
+{
+    if (!screen)
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+    EglFSKmsScreen *kmsSource = source ? static_cast<EglFSKmsScreen *>(source->handle()) : Q_NULLPTR;
+    return kmsScreen->setCloneSource(kmsSource);
+}
+
+static bool queryLastPresentation(QWindow *window, EglFSFunctions::Presentation *presentation)
+{
+    if (!window || !window->screen())
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(window->screen()->handle());
+    *presentation = kmsScreen->lastPresentation();
+    return presentation->ust != 0;
+}
+
+static bool setPresentationCallback(QScreen *screen, EglFSFunctions::PresentationCallback callback, void *data)
+{
+    if (!screen)
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+    kmsScreen->setPresentationCallback(callback, data);
+    return true;
+}
+
+static bool adaptiveSyncRange(QScreen *screen, qreal *minimumRate, qreal *maximumRate)
+{
+    if (!screen)
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+    return kmsScreen->adaptiveSyncRange(minimumRate, maximumRate);
+}
+
+static bool setAdaptiveSync(QScreen *screen, bool enabled)
+{
+    if (!screen)
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+    return kmsScreen->setAdaptiveSync(enabled);
+}
+
+static bool colorPipeline(QScreen *screen, EglFSFunctions::ColorPipeline *pipeline)
+{
+    if (!screen)
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+    *pipeline = kmsScreen->colorPipeline();
+    return pipeline->stages != 0;
+}
+
+static bool setColorCorrection(QScreen *screen, const EglFSFunctions::ColorCorrection &correction)
+{
+    if (!screen)
+        return false;
+
+    EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+    return kmsScreen->setColorCorrection(correction);
+}
 
 EglFSKmsIntegration::EglFSKmsIntegration()
     : m_device(Q_NULLPTR)
@@ -204,8 +274,9 @@ void EglFSKmsIntegration::saveConfiguration(const QString &fileName)
             output[QStringLiteral("mode")] = QStringLiteral("preferred");
         else
             output[QStringLiteral("mode")] = QStringLiteral("%1x%2")
-                    .arg(QString::number(kmsScreen->geometry().size().width()))
-                    .arg(QString::number(kmsScreen->geometry().size().height()));
+                    .arg(QString::number(kmsScreen->output().modes[kmsScreen->currentMode()].hdisplay))
+                    .arg(QString::number(kmsScreen->output().modes[kmsScreen->currentMode()].vdisplay));
+        output[QStringLiteral("transform")] = EglFSKmsScreen::transformName(kmsScreen->transform());
 
         outputs.append(QJsonValue::fromVariant(output));
     }
@@ -352,6 +423,26 @@ bool EglFSKmsIntegration::supportsPBuffers() const
     return m_pbuffers;
 }
 
+QFunctionPointer EglFSKmsIntegration::platformFunction(const QByteArray &function) const
+{
+    if (function == EglFSFunctions::setScanoutCloneIdentifier())
+        return QFunctionPointer(setScanoutClone);
+    if (function == EglFSFunctions::lastPresentationIdentifier())
+        return QFunctionPointer(queryLastPresentation);
+    if (function == EglFSFunctions::setPresentationCallbackIdentifier())
+        return QFunctionPointer(setPresentationCallback);
+    if (function == EglFSFunctions::adaptiveSyncRangeIdentifier())
+        return QFunctionPointer(adaptiveSyncRange);
+    if (function == EglFSFunctions::setAdaptiveSyncIdentifier())
+        return QFunctionPointer(setAdaptiveSync);
+    if (function == EglFSFunctions::colorPipelineIdentifier())
+        return QFunctionPointer(colorPipeline);
+    if (function == EglFSFunctions::setColorCorrectionIdentifier())
+        return QFunctionPointer(setColorCorrection);
+
+    return Q_NULLPTR;
+}
+
 bool EglFSKmsIntegration::hwCursor() const
 {
     return m_hwCursor;
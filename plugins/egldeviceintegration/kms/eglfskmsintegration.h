@@ -72,6 +72,7 @@ public:
     void resizeSurface(QPlatformSurface *surface) Q_DECL_OVERRIDE;
     void presentBuffer(QPlatformSurface *surface) Q_DECL_OVERRIDE;
     bool supportsPBuffers() const Q_DECL_OVERRIDE;
+    QFunctionPointer platformFunction(const QByteArray &function) const Q_DECL_OVERRIDE;
 
     bool hwCursor() const;
     bool separateScreens() const;
@@ -32,8 +32,12 @@
  ***************************************************************************/
 
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtGui/QScreen>
 #include <QtGui/private/qguiapplication_p.h>
 #include <QtGui/qpa/qplatformwindow.h>
+#include <QtGui/qpa/qwindowsysteminterface.h>
 
 #include <GreenIsland/Platform/EglFSIntegration>
 #include <GreenIsland/Platform/EglFSWindow>
@@ -45,12 +49,48 @@
 
 #include <math.h>
 
+#ifndef DRM_MODE_ROTATE_0
+#define DRM_MODE_ROTATE_0 (1 << 0)
+#define DRM_MODE_ROTATE_90 (1 << 1)
+#define DRM_MODE_ROTATE_180 (1 << 2)
+#define DRM_MODE_ROTATE_270 (1 << 3)
+#define DRM_MODE_REFLECT_X (1 << 4)
+#endif
+
 namespace GreenIsland {
 
 namespace Platform {
 
 Q_DECLARE_LOGGING_CATEGORY(lcKms)
 
+static uint32_t drmRotation(EglFSScreen::Transform transform)
+{
+    // Both wl_output and KMS rotate counter-clockwise
+    switch (transform) {
+    case EglFSScreen::Transform90:
+        return DRM_MODE_ROTATE_90;
+    case EglFSScreen::Transform180:
+        return DRM_MODE_ROTATE_180;
+    case EglFSScreen::Transform270:
+        return DRM_MODE_ROTATE_270;
+    case EglFSScreen::TransformFlipped:
+        return DRM_MODE_ROTATE_0 | DRM_MODE_REFLECT_X;
+    case EglFSScreen::TransformFlipped90:
+        return DRM_MODE_ROTATE_90 | DRM_MODE_REFLECT_X;
+    case EglFSScreen::TransformFlipped180:
+        return DRM_MODE_ROTATE_180 | DRM_MODE_REFLECT_X;
+    case EglFSScreen::TransformFlipped270:
+        return DRM_MODE_ROTATE_270 | DRM_MODE_REFLECT_X;
+    default:
+        return DRM_MODE_ROTATE_0;
+    }
+}
+
+static const char *transformNames[] = {
+    "normal", "90", "180", "270",
+    "flipped", "flipped-90", "flipped-180", "flipped-270"
+};
+
 class EglFSKmsInterruptHandler : public QObject
 {
 public:
@@ -149,10 +189,17 @@ EglFSKmsScreen::EglFSKmsScreen(EglFSKmsIntegration *integration,
     , m_gbm_bo_next(Q_NULLPTR)
     , m_suspend(false)
     , m_pendingMode(-1)
+    , m_pendingTransform(-1)
     , m_output(output)
     , m_pos(position)
     , m_cursor(Q_NULLPTR)
+    , m_cloneSource(Q_NULLPTR)
     , m_powerState(PowerStateOn)
+    , m_adaptiveSync(false)
+    , m_transform(TransformNormal)
+    , m_appliedTransform(-1)
+    , m_presentationCallback(Q_NULLPTR)
+    , m_presentationData(Q_NULLPTR)
     , m_interruptHandler(new EglFSKmsInterruptHandler(this))
 {
     m_siblings << this;
@@ -172,6 +219,17 @@ EglFSKmsScreen::EglFSKmsScreen(EglFSKmsIntegration *integration,
         qCWarning(lcKms) << "No EDID data for output" << name();
     }
 
+    // Portrait signage and the like
+    const QString transformName = m_integration->outputSettings().value(name())
+            .value(QStringLiteral("transform"), QStringLiteral("normal")).toString();
+    Transform transform = TransformNormal;
+    if (!parseTransform(transformName, &transform))
+        qCWarning(lcKms) << "Invalid transform" << transformName << "for output" << name();
+    else if (!supportsTransform(transform))
+        qCWarning(lcKms) << "Output" << name() << "cannot scan out with transform" << transformName;
+    else
+        m_transform = transform;
+
     qCDebug(lcKms, "Physical size for output \"%s\": %.2fx%.2f",
             name().toLatin1().constData(),
             m_output.physical_size.width(),
@@ -186,6 +244,10 @@ EglFSKmsScreen::EglFSKmsScreen(EglFSKmsIntegration *integration,
 
 EglFSKmsScreen::~EglFSKmsScreen()
 {
+    setCloneSource(Q_NULLPTR);
+    Q_FOREACH (EglFSKmsScreen *clone, m_clones)
+        clone->setCloneSource(Q_NULLPTR);
+
     if (m_output.dpms_prop) {
         drmModeFreeProperty(m_output.dpms_prop);
         m_output.dpms_prop = Q_NULLPTR;
@@ -205,9 +267,21 @@ EglFSKmsScreen::~EglFSKmsScreen()
 QRect EglFSKmsScreen::geometry() const
 {
     const int mode = m_output.mode;
-    return QRect(m_pos.x(), m_pos.y(),
-                 m_output.modes[mode].hdisplay,
-                 m_output.modes[mode].vdisplay);
+    QSize size(m_output.modes[mode].hdisplay, m_output.modes[mode].vdisplay);
+
+    // Contents are rendered in their native orientation
+    switch (m_transform) {
+    case Transform90:
+    case Transform270:
+    case TransformFlipped90:
+    case TransformFlipped270:
+        size.transpose();
+        break;
+    default:
+        break;
+    }
+
+    return QRect(m_pos, size);
 }
 
 int EglFSKmsScreen::depth() const
@@ -366,29 +440,61 @@ void EglFSKmsScreen::flip()
         return;
     }
 
+    QMutexLocker cloneLock(&m_cloneMutex);
+
+    // Our connector is driven by the source CRTC, nothing we
+    // render is shown so give the buffer back right away; our
+    // windows are not exposed meanwhile so we rarely get here
+    if (m_cloneSource) {
+        gbm_surface_release_buffer(m_gbm_surface, m_gbm_bo_next);
+        m_gbm_bo_next = Q_NULLPTR;
+        return;
+    }
+
     FrameBuffer *fb = framebufferForBufferObject(m_gbm_bo_next);
 
     if (!m_output.mode_set) {
+        // Clones are driven by our CRTC, they scan out the same buffers
+        QVector<uint32_t> connectors;
+        connectors.append(m_output.connector_id);
+        Q_FOREACH (EglFSKmsScreen *clone, m_clones)
+            connectors.append(clone->m_output.connector_id);
+
         qCDebug(lcKms, "Changing mode to %d: %dx%d @ %.2f Hz",
                 m_output.mode,
                 geometry().size().width(),
                 geometry().size().height(),
                 refreshRate());
 
+        // The CRTC checks the buffer size against the
+        // rotation, so it has to be set before
+        applyTransform(m_transform);
+
         int ret = drmModeSetCrtc(m_device->fd(),
                                  m_output.crtc_id,
                                  fb->fb,
                                  0, 0,
-                                 &m_output.connector_id, 1,
+                                 connectors.data(), connectors.size(),
                                  &m_output.modes[m_output.mode]);
 
         if (ret) {
             qErrnoWarning("Could not set DRM mode!");
         } else {
             m_output.mode_set = true;
-            setPowerState(PowerStateOn);
+            applyPowerState(PowerStateOn);
+            applyAdaptiveSync();
+
+            m_colorMutex.lock();
+            applyColorCorrection(m_colorCorrection);
+            m_colorMutex.unlock();
+
+            // The CRTCs of the clones are left without connectors
+            Q_FOREACH (EglFSKmsScreen *clone, m_clones)
+                drmModeSetCrtc(m_device->fd(), clone->m_output.crtc_id,
+                               0, 0, 0, Q_NULLPTR, 0, Q_NULLPTR);
         }
     }
+    cloneLock.unlock();
 
     int ret = drmModePageFlip(m_device->fd(),
                               m_output.crtc_id,
@@ -402,6 +508,337 @@ void EglFSKmsScreen::flip()
     }
 }
 
+static bool sameTimings(const drmModeModeInfo &a, const drmModeModeInfo &b)
+{
+    return a.clock == b.clock &&
+            a.hdisplay == b.hdisplay && a.hsync_start == b.hsync_start &&
+            a.hsync_end == b.hsync_end && a.htotal == b.htotal && a.hskew == b.hskew &&
+            a.vdisplay == b.vdisplay && a.vsync_start == b.vsync_start &&
+            a.vsync_end == b.vsync_end && a.vtotal == b.vtotal && a.vscan == b.vscan &&
+            a.flags == b.flags;
+}
+
+bool EglFSKmsScreen::setCloneSource(EglFSKmsScreen *source)
+{
+    QMutexLocker lock(&m_cloneMutex);
+
+    if (m_cloneSource == source)
+        return true;
+
+    if (source) {
+        // Only a CRTC of the same device with the very same timings
+        // can drive both connectors, and clones cannot be chained
+        if (source == this || source->m_device != m_device)
+            return false;
+        if (source->m_cloneSource || !m_clones.isEmpty())
+            return false;
+        if (!sameTimings(m_output.modes[m_output.mode], source->m_output.modes[source->m_output.mode]))
+            return false;
+        if (m_transform != source->m_transform)
+            return false;
+        if (!m_device->isCrtcPossible(source->m_output.crtc_id, m_output.connector_id))
+            return false;
+    }
+
+    if (m_cloneSource) {
+        m_cloneSource->m_clones.removeOne(this);
+        m_cloneSource->m_output.mode_set = false;
+    }
+
+    m_cloneSource = source;
+
+    if (m_cloneSource) {
+        m_cloneSource->m_clones.append(this);
+        m_cloneSource->m_output.mode_set = false;
+    }
+
+    // Take our connector back with the next flip
+    m_output.mode_set = false;
+
+    lock.unlock();
+    updateExposure();
+
+    return true;
+}
+
+void EglFSKmsScreen::updatePresentation(unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec)
+{
+    QMutexLocker lock(&m_presentationMutex);
+
+    // Page flip events are timestamped on CLOCK_MONOTONIC
+    m_presentation.ust = quint64(tv_sec) * 1000000 + tv_usec;
+    m_presentation.msc = sequence;
+    m_presentation.refreshNsec = quint32(1000000000 / refreshRate());
+
+    // Called under the lock so that it can be removed safely
+    if (m_presentationCallback)
+        m_presentationCallback(m_presentation, m_presentationData);
+}
+
+EglFSFunctions::Presentation EglFSKmsScreen::lastPresentation() const
+{
+    QMutexLocker lock(&m_presentationMutex);
+    return m_presentation;
+}
+
+void EglFSKmsScreen::setPresentationCallback(EglFSFunctions::PresentationCallback callback, void *data)
+{
+    QMutexLocker lock(&m_presentationMutex);
+    m_presentationCallback = callback;
+    m_presentationData = data;
+}
+
+bool EglFSKmsScreen::adaptiveSyncRange(qreal *minimumRate, qreal *maximumRate) const
+{
+    if (!m_output.vrr_capable)
+        return false;
+
+    // The range comes from the EDID, the current mode caps it
+    const qreal minimum = m_edid.minimumRefreshRate;
+    const qreal maximum = m_edid.maximumRefreshRate > 0
+            ? qMin(m_edid.maximumRefreshRate, refreshRate()) : refreshRate();
+    if (minimum <= 0 || maximum <= minimum)
+        return false;
+
+    *minimumRate = minimum;
+    *maximumRate = maximum;
+    return true;
+}
+
+bool EglFSKmsScreen::setAdaptiveSync(bool enabled)
+{
+    if (enabled && (!m_output.vrr_capable || m_cloneSource || !m_clones.isEmpty()))
+        return false;
+
+    if (m_adaptiveSync == enabled)
+        return true;
+
+    m_adaptiveSync = enabled;
+    if (m_output.mode_set)
+        applyAdaptiveSync();
+    return true;
+}
+
+void EglFSKmsScreen::applyAdaptiveSync()
+{
+    if (!m_output.vrr_enabled_prop)
+        return;
+
+    // The property lives in the CRTC state, a mode set keeps it
+    int ret = drmModeObjectSetProperty(m_device->fd(), m_output.crtc_id,
+                                       DRM_MODE_OBJECT_CRTC,
+                                       m_output.vrr_enabled_prop,
+                                       m_adaptiveSync ? 1 : 0);
+    if (ret)
+        qErrnoWarning("Could not %s adaptive sync for output %s",
+                      m_adaptiveSync ? "enable" : "disable",
+                      qPrintable(m_output.name));
+}
+
+EglFSScreen::Transform EglFSKmsScreen::transform() const
+{
+    return m_transform;
+}
+
+bool EglFSKmsScreen::setTransform(Transform transform)
+{
+    if (!supportsTransform(transform))
+        return false;
+
+    const int current = m_pendingTransform >= 0 ? m_pendingTransform : m_transform;
+    if (current == transform)
+        return true;
+
+    // Applied with the next frame, together with a pending mode
+    m_pendingTransform = m_transform == transform ? -1 : transform;
+    return true;
+}
+
+QString EglFSKmsScreen::transformName(Transform transform)
+{
+    return QLatin1String(transformNames[transform]);
+}
+
+bool EglFSKmsScreen::parseTransform(const QString &name, Transform *transform)
+{
+    for (int i = 0; i <= TransformFlipped270; i++) {
+        if (name == QLatin1String(transformNames[i])) {
+            *transform = static_cast<Transform>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool EglFSKmsScreen::supportsTransform(Transform transform) const
+{
+    if (transform == TransformNormal)
+        return true;
+
+    const uint32_t rotation = drmRotation(transform);
+    return m_output.rotation_prop && (m_output.rotations & rotation) == rotation;
+}
+
+void EglFSKmsScreen::applyTransform(Transform transform)
+{
+    if (!m_output.rotation_prop || m_appliedTransform == transform)
+        return;
+
+    // The plane is checked against the framebuffer it still scans
+    // out, which has the size of the old rotation: drivers that
+    // cannot scale the primary plane reject the new one unless
+    // the CRTC is disabled first. Callers set the mode right after.
+    drmModeSetCrtc(m_device->fd(), m_output.crtc_id,
+                   0, 0, 0, Q_NULLPTR, 0, Q_NULLPTR);
+
+    if (drmModeObjectSetProperty(m_device->fd(), m_output.primary_plane_id,
+                                 DRM_MODE_OBJECT_PLANE, m_output.rotation_prop,
+                                 drmRotation(transform)) != 0) {
+        qErrnoWarning("Could not set rotation for output %s", qPrintable(m_output.name));
+        return;
+    }
+
+    m_appliedTransform = transform;
+}
+
+EglFSFunctions::ColorPipeline EglFSKmsScreen::colorPipeline() const
+{
+    EglFSFunctions::ColorPipeline pipeline;
+
+    if (m_output.gamma_lut_prop && m_output.gamma_lut_size > 0) {
+        pipeline.stages |= EglFSFunctions::GammaStage;
+        pipeline.gammaSize = m_output.gamma_lut_size;
+    } else if (m_output.saved_crtc && m_output.saved_crtc->gamma_size > 0) {
+        pipeline.stages |= EglFSFunctions::GammaStage;
+        pipeline.gammaSize = m_output.saved_crtc->gamma_size;
+    }
+
+    if (m_output.degamma_lut_prop && m_output.degamma_lut_size > 0) {
+        pipeline.stages |= EglFSFunctions::DegammaStage;
+        pipeline.degammaSize = m_output.degamma_lut_size;
+    }
+
+    if (m_output.ctm_prop)
+        pipeline.stages |= EglFSFunctions::ColorTransformStage;
+
+    return pipeline;
+}
+
+bool EglFSKmsScreen::setColorCorrection(const EglFSFunctions::ColorCorrection &correction)
+{
+    const EglFSFunctions::ColorPipeline pipeline = colorPipeline();
+
+    if (!correction.degammaLut.isEmpty() &&
+            (!(pipeline.stages & EglFSFunctions::DegammaStage) ||
+             correction.degammaLut.size() != pipeline.degammaSize * 3))
+        return false;
+    if (!correction.colorTransform.isEmpty() &&
+            (!(pipeline.stages & EglFSFunctions::ColorTransformStage) ||
+             correction.colorTransform.size() != 9))
+        return false;
+    if (!correction.gammaLut.isEmpty() &&
+            (!(pipeline.stages & EglFSFunctions::GammaStage) ||
+             correction.gammaLut.size() != pipeline.gammaSize * 3))
+        return false;
+
+    // Also read by the render thread after a mode set, the
+    // lock is held while applying so it's never rolled back
+    QMutexLocker lock(&m_colorMutex);
+    m_colorCorrection = correction;
+    if (m_output.mode_set)
+        applyColorCorrection(m_colorCorrection);
+    return true;
+}
+
+void EglFSKmsScreen::applyColorCorrection(const EglFSFunctions::ColorCorrection &correction)
+{
+    if (m_output.degamma_lut_prop)
+        setColorLut(m_output.degamma_lut_prop, correction.degammaLut);
+
+    if (m_output.ctm_prop) {
+        uint32_t blobId = 0;
+
+        if (!correction.colorTransform.isEmpty()) {
+            // S31.32 sign-magnitude fixed point
+            drm_color_ctm ctm;
+            for (int i = 0; i < 9; i++) {
+                const qreal value = correction.colorTransform.at(i);
+                ctm.matrix[i] = quint64(qAbs(value) * (Q_UINT64_C(1) << 32));
+                if (value < 0)
+                    ctm.matrix[i] |= Q_UINT64_C(1) << 63;
+            }
+
+            if (drmModeCreatePropertyBlob(m_device->fd(), &ctm, sizeof(ctm), &blobId) != 0)
+                qErrnoWarning("Could not create the color transform matrix for output %s",
+                              qPrintable(m_output.name));
+        }
+
+        drmModeObjectSetProperty(m_device->fd(), m_output.crtc_id, DRM_MODE_OBJECT_CRTC,
+                                 m_output.ctm_prop, blobId);
+        if (blobId)
+            drmModeDestroyPropertyBlob(m_device->fd(), blobId);
+    }
+
+    if (m_output.gamma_lut_prop) {
+        setColorLut(m_output.gamma_lut_prop, correction.gammaLut);
+    } else if (m_output.saved_crtc && m_output.saved_crtc->gamma_size > 0) {
+        // Legacy gamma has no bypass, use a linear ramp instead
+        const int size = m_output.saved_crtc->gamma_size;
+        QVector<quint16> red(size), green(size), blue(size);
+        for (int i = 0; i < size; i++) {
+            if (correction.gammaLut.isEmpty()) {
+                red[i] = green[i] = blue[i] = quint16(i * 0xffff / qMax(size - 1, 1));
+            } else {
+                red[i] = correction.gammaLut.at(i * 3);
+                green[i] = correction.gammaLut.at(i * 3 + 1);
+                blue[i] = correction.gammaLut.at(i * 3 + 2);
+            }
+        }
+
+        if (drmModeCrtcSetGamma(m_device->fd(), m_output.crtc_id, size,
+                                red.data(), green.data(), blue.data()) != 0)
+            qErrnoWarning("Could not set gamma for output %s", qPrintable(m_output.name));
+    }
+}
+
+bool EglFSKmsScreen::setColorLut(uint32_t propId, const QVector<quint16> &lut)
+{
+    uint32_t blobId = 0;
+
+    if (!lut.isEmpty()) {
+        const int size = lut.size() / 3;
+        QVector<drm_color_lut> entries(size);
+        for (int i = 0; i < size; i++) {
+            entries[i].red = lut.at(i * 3);
+            entries[i].green = lut.at(i * 3 + 1);
+            entries[i].blue = lut.at(i * 3 + 2);
+            entries[i].reserved = 0;
+        }
+
+        if (drmModeCreatePropertyBlob(m_device->fd(), entries.constData(),
+                                      size * sizeof(drm_color_lut), &blobId) != 0) {
+            qErrnoWarning("Could not create a color LUT for output %s",
+                          qPrintable(m_output.name));
+            return false;
+        }
+    }
+
+    // A null blob bypasses the stage, the CRTC keeps a reference
+    // to the blob so it can be destroyed right away
+    int ret = drmModeObjectSetProperty(m_device->fd(), m_output.crtc_id,
+                                       DRM_MODE_OBJECT_CRTC, propId, blobId);
+    if (blobId)
+        drmModeDestroyPropertyBlob(m_device->fd(), blobId);
+
+    if (ret) {
+        qErrnoWarning("Could not set a color LUT for output %s", qPrintable(m_output.name));
+        return false;
+    }
+
+    return true;
+}
+
 void EglFSKmsScreen::flipFinished()
 {
     if (m_gbm_bo_current)
@@ -414,12 +851,57 @@ void EglFSKmsScreen::flipFinished()
 
 void EglFSKmsScreen::resizeSurface()
 {
-    m_output.mode = m_pendingMode;
+    const QSize oldSize = geometry().size();
+
+    if (m_pendingMode >= 0)
+        m_output.mode = m_pendingMode;
     m_pendingMode = -1;
+    if (m_pendingTransform >= 0)
+        m_transform = static_cast<Transform>(m_pendingTransform);
+    m_pendingTransform = -1;
     m_output.mode_set = false;
 
-    destroySurface();
-    createSurface();
+    // Clones must have the same timings and transform, otherwise
+    // each screen goes back to its own CRTC
+    QList<EglFSKmsScreen *> detached;
+    m_cloneMutex.lock();
+    const drmModeModeInfo &mode = m_output.modes[m_output.mode];
+    if (m_cloneSource && (m_transform != m_cloneSource->m_transform ||
+                          !sameTimings(mode, m_cloneSource->m_output.modes[m_cloneSource->m_output.mode]))) {
+        m_cloneSource->m_clones.removeOne(this);
+        m_cloneSource->m_output.mode_set = false;
+        m_cloneSource = Q_NULLPTR;
+        detached.append(this);
+    }
+    Q_FOREACH (EglFSKmsScreen *clone, m_clones) {
+        if (m_transform != clone->m_transform ||
+                !sameTimings(mode, clone->m_output.modes[clone->m_output.mode])) {
+            m_clones.removeOne(clone);
+            clone->m_cloneSource = Q_NULLPTR;
+            clone->m_output.mode_set = false;
+            detached.append(clone);
+        }
+    }
+    m_cloneMutex.unlock();
+
+    // We are called by the render thread, windows of the screens
+    // that are not clones anymore are exposed by the GUI thread
+    if (!detached.isEmpty()) {
+        QTimer::singleShot(0, QCoreApplication::instance(), [detached] {
+            Q_FOREACH (QScreen *screen, QGuiApplication::screens()) {
+                EglFSKmsScreen *kmsScreen = static_cast<EglFSKmsScreen *>(screen->handle());
+                if (detached.contains(kmsScreen))
+                    kmsScreen->updateExposure();
+            }
+        });
+    }
+
+    // A refresh rate only change can keep scanning out the same
+    // buffers, the next flip will program the new timings
+    if (geometry().size() != oldSize) {
+        destroySurface();
+        createSurface();
+    }
 
     QWindowSystemInterface::handleScreenGeometryChange(screen(), geometry(), availableGeometry());
     QWindowSystemInterface::handleScreenRefreshRateChange(screen(), refreshRate());
@@ -431,6 +913,15 @@ void EglFSKmsScreen::resizeSurface()
 void EglFSKmsScreen::restoreMode()
 {
     if (m_output.mode_set && m_output.saved_crtc) {
+        // Whoever takes over doesn't expect adaptive sync
+        // nor our color correction
+        if (m_adaptiveSync && m_output.vrr_enabled_prop)
+            drmModeObjectSetProperty(m_device->fd(), m_output.crtc_id,
+                                     DRM_MODE_OBJECT_CRTC,
+                                     m_output.vrr_enabled_prop, 0);
+        applyColorCorrection(EglFSFunctions::ColorCorrection());
+        applyTransform(TransformNormal);
+
         drmModeSetCrtc(m_device->fd(),
                        m_output.saved_crtc->crtc_id,
                        m_output.saved_crtc->buffer_id,
@@ -454,6 +945,15 @@ EglFSScreen::PowerState EglFSKmsScreen::powerState() const
 }
 
 void EglFSKmsScreen::setPowerState(EglFSScreen::PowerState state)
+{
+    if (!m_output.dpms_prop)
+        return;
+
+    applyPowerState(state);
+    updateExposure();
+}
+
+void EglFSKmsScreen::applyPowerState(EglFSScreen::PowerState state)
 {
     if (!m_output.dpms_prop)
         return;
@@ -463,6 +963,24 @@ void EglFSKmsScreen::setPowerState(EglFSScreen::PowerState state)
     m_powerState = state;
 }
 
+void EglFSKmsScreen::updateExposure()
+{
+    // Windows on a screen that is off or scanning out the buffers
+    // of another screen are not exposed, hence their render loops
+    // stop until they can be seen again
+    m_cloneMutex.lock();
+    const bool exposed = m_powerState == PowerStateOn && !m_cloneSource;
+    m_cloneMutex.unlock();
+
+    Q_FOREACH (QWindow *window, QGuiApplication::topLevelWindows()) {
+        if (window->screen() && window->screen()->handle() == this && window->isVisible()) {
+            QWindowSystemInterface::handleExposeEvent(window, exposed
+                                                      ? QRegion(QRect(QPoint(0, 0), window->geometry().size()))
+                                                      : QRegion());
+        }
+    }
+}
+
 QList<EglFSScreen::Mode> EglFSKmsScreen::modes() const
 {
     QList<EglFSScreen::Mode> list;
@@ -494,6 +1012,27 @@ void EglFSKmsScreen::setCurrentMode(int modeId)
     m_pendingMode = modeId;
 }
 
+bool EglFSKmsScreen::testMode(int modeId) const
+{
+    // Legacy KMS has no way to test a configuration without
+    // committing it, so we can only reject what we know will fail
+    if (modeId < 0 || modeId >= m_output.modes.size())
+        return false;
+    return m_pendingMode < 0;
+}
+
+void EglFSKmsScreen::setPosition(const QPoint &pos)
+{
+    if (m_pos == pos)
+        return;
+
+    // The CRTC scans out from the origin of its own buffer, moving
+    // the screen in the virtual desktop doesn't need a mode set
+    m_pos = pos;
+    QWindowSystemInterface::handleScreenGeometryChange(screen(), geometry(), availableGeometry());
+    resizeMaximizedWindows();
+}
+
 int EglFSKmsScreen::preferredMode() const
 {
     return m_output.preferred_mode;
@@ -574,6 +1113,12 @@ bool EglFSKmsScreen::parseEdid(EglFSKmsEdid &edid)
             edid.identifier = parseEdidString(&data[offset + 5]);
         else if (data[offset + 3] == EdidDescriptorDisplayProductSerialNumber)
             edid.serialNumber = parseEdidString(&data[offset + 5]);
+        else if (data[offset + 3] == EdidDescriptorDisplayRangeLimits) {
+            // Vertical rates in Hz, EDID 1.4 adds 255 when the
+            // offset flags are set
+            edid.minimumRefreshRate = data[offset + 5] + ((data[offset + 4] & 0x03) == 0x03 ? 255 : 0);
+            edid.maximumRefreshRate = data[offset + 6] + ((data[offset + 4] & 0x02) ? 255 : 0);
+        }
     }
 
     // PNP ID is the same as EISA ID
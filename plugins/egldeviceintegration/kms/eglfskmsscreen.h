@@ -37,6 +37,7 @@
 #include <QtCore/QList>
 #include <QtCore/QMutex>
 
+#include <GreenIsland/Platform/EglFSFunctions>
 #include <GreenIsland/Platform/EglFSScreen>
 
 #include "eglfskmsintegration.h"
@@ -66,6 +67,16 @@ struct EglFSKmsOutput
     QList<drmModeModeInfo> modes;
     drmModePropertyPtr dpms_prop;
     drmModePropertyBlobPtr edid_blob;
+    bool vrr_capable;
+    uint32_t vrr_enabled_prop;
+    uint32_t gamma_lut_prop;
+    int gamma_lut_size;
+    uint32_t degamma_lut_prop;
+    int degamma_lut_size;
+    uint32_t ctm_prop;
+    uint32_t primary_plane_id;
+    uint32_t rotation_prop;
+    uint32_t rotations;
 };
 
 struct EglFSKmsEdid
@@ -75,6 +86,8 @@ struct EglFSKmsEdid
     QString model;
     QString serialNumber;
     QSizeF physicalSize;
+    qreal minimumRefreshRate = 0;
+    qreal maximumRefreshRate = 0;
 };
 
 class EglFSKmsScreen : public EglFSScreen
@@ -119,19 +132,41 @@ public:
     void flip();
     void flipFinished();
 
-    bool isResizingSurface() const { return m_pendingMode >= 0; }
+    void updatePresentation(unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec);
+    EglFSFunctions::Presentation lastPresentation() const;
+    void setPresentationCallback(EglFSFunctions::PresentationCallback callback, void *data);
+
+    bool adaptiveSyncRange(qreal *minimumRate, qreal *maximumRate) const;
+    bool setAdaptiveSync(bool enabled);
+
+    EglFSFunctions::ColorPipeline colorPipeline() const;
+    bool setColorCorrection(const EglFSFunctions::ColorCorrection &correction);
+
+    Transform transform() const Q_DECL_OVERRIDE;
+    bool setTransform(Transform transform) Q_DECL_OVERRIDE;
+    bool supportsTransform(Transform transform) const;
+
+    static QString transformName(Transform transform);
+    static bool parseTransform(const QString &name, Transform *transform);
+
+    bool isResizingSurface() const { return m_pendingMode >= 0 || m_pendingTransform >= 0; }
     void resizeSurface();
 
     EglFSKmsOutput &output() { return m_output; }
+    bool setCloneSource(EglFSKmsScreen *source);
     void restoreMode();
 
     EglFSScreen::PowerState powerState() const Q_DECL_OVERRIDE;
     void setPowerState(EglFSScreen::PowerState state) Q_DECL_OVERRIDE;
+    void updateExposure();
 
     QList<EglFSScreen::Mode> modes() const Q_DECL_OVERRIDE;
 
     int currentMode() const Q_DECL_OVERRIDE;
     void setCurrentMode(int modeId) Q_DECL_OVERRIDE;
+    bool testMode(int modeId) const Q_DECL_OVERRIDE;
+
+    void setPosition(const QPoint &pos) Q_DECL_OVERRIDE;
 
     int preferredMode() const Q_DECL_OVERRIDE;
     void setPreferredMode(int modeId) Q_DECL_OVERRIDE;
@@ -152,6 +187,7 @@ private:
     bool m_suspend;
 
     int m_pendingMode;
+    int m_pendingTransform;
     EglFSKmsEdid m_edid;
     EglFSKmsOutput m_output;
     QPoint m_pos;
@@ -159,7 +195,29 @@ private:
 
     QList<QPlatformScreen *> m_siblings;
 
+    EglFSKmsScreen *m_cloneSource;
+    QList<EglFSKmsScreen *> m_clones;
+    static QMutex m_cloneMutex;
+
     PowerState m_powerState;
+    void applyPowerState(PowerState state);
+
+    bool m_adaptiveSync;
+    void applyAdaptiveSync();
+
+    Transform m_transform;
+    int m_appliedTransform;
+    void applyTransform(Transform transform);
+
+    EglFSFunctions::ColorCorrection m_colorCorrection;
+    QMutex m_colorMutex;
+    void applyColorCorrection(const EglFSFunctions::ColorCorrection &correction);
+    bool setColorLut(uint32_t propId, const QVector<quint16> &lut);
+
+    EglFSFunctions::Presentation m_presentation;
+    EglFSFunctions::PresentationCallback m_presentationCallback;
+    void *m_presentationData;
+    mutable QMutex m_presentationMutex;
 
     struct FrameBuffer {
         FrameBuffer() : fb(0) {}
@@ -174,6 +232,7 @@ private:
 
     enum EdidDescriptor {
         EdidDescriptorAlphanumericDataString = 0xfe,
+        EdidDescriptorDisplayRangeLimits = 0xfd,
         EdidDescriptorDisplayProductName = 0xfc,
         EdidDescriptorDisplayProductSerialNumber = 0xff
     };
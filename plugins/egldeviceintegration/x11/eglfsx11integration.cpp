@@ -27,12 +27,16 @@
  * $END_LICENSE$
  ***************************************************************************/
 
+#include <QtCore/QHash>
 #include <QtCore/QThread>
+#include <QtGui/QGuiApplication>
 
 #include "eglfsx11integration.h"
 
 #include <X11/Xlib.h>
 #include <X11/Xlib-xcb.h>
+#include <xcb/present.h>
+#include <xcb/xinput.h>
 
 /* Make no mistake: This is not a replacement for the xcb platform plugin.
    This here is barely an extremely useful tool for developing eglfs itself because
@@ -46,12 +50,29 @@ class EventReader : public QThread
 {
 public:
     EventReader(EglFSX11Integration *integration)
-        : m_integration(integration) { }
+        : m_integration(integration)
+        , m_pointerInside(false)
+        , m_rawMotion(false)
+    {
+    }
 
     void run();
 
 private:
     EglFSX11Integration *m_integration;
+    Qt::MouseButtons m_buttons;
+    QPointF m_pointerPos;
+    bool m_pointerInside;
+    bool m_rawMotion;
+    QHash<quint16, bool> m_relativeDevices;
+
+    QWindow *window() const;
+
+    void handlePresentEvent(xcb_ge_generic_event_t *event);
+    void handleXIEvent(xcb_ge_generic_event_t *event);
+    void handleXIRawMotion(xcb_input_raw_motion_event_t *event);
+    bool isRelativeDevice(quint16 deviceId);
+    void movePointer(const QPointF &pos, xcb_timestamp_t time);
 };
 
 QAtomicInt running;
@@ -103,10 +124,24 @@ static Qt::MouseButton translateMouseButton(xcb_button_t s)
     }
 }
 
-void EventReader::run()
+static inline qreal fixed1616ToReal(xcb_input_fp1616_t value)
 {
-    Qt::MouseButtons buttons;
+    return qreal(value) / 0x10000;
+}
 
+static inline qreal fixed3232ToReal(xcb_input_fp3232_t value)
+{
+    return value.integral + qreal(value.frac) / (qreal(1) + 0xffffffff);
+}
+
+QWindow *EventReader::window() const
+{
+    QPlatformWindow *platformWindow = m_integration->platformWindow();
+    return platformWindow ? platformWindow->window() : Q_NULLPTR;
+}
+
+void EventReader::run()
+{
     xcb_generic_event_t *event;
     while (running.load() && (event = xcb_wait_for_event(m_integration->connection()))) {
         uint response_type = event->response_type & ~0x80;
@@ -114,23 +149,23 @@ void EventReader::run()
         case XCB_BUTTON_PRESS: {
             xcb_button_press_event_t *press = (xcb_button_press_event_t *)event;
             QPoint p(press->event_x, press->event_y);
-            buttons = (buttons & ~0x7) | translateMouseButtons(press->state);
-            buttons |= translateMouseButton(press->detail);
-            QWindowSystemInterface::handleMouseEvent(0, press->time, p, p, buttons);
+            m_buttons = (m_buttons & ~0x7) | translateMouseButtons(press->state);
+            m_buttons |= translateMouseButton(press->detail);
+            QWindowSystemInterface::handleMouseEvent(0, press->time, p, p, m_buttons);
             break;
             }
         case XCB_BUTTON_RELEASE: {
             xcb_button_release_event_t *release = (xcb_button_release_event_t *)event;
             QPoint p(release->event_x, release->event_y);
-            buttons = (buttons & ~0x7) | translateMouseButtons(release->state);
-            buttons &= ~translateMouseButton(release->detail);
-            QWindowSystemInterface::handleMouseEvent(0, release->time, p, p, buttons);
+            m_buttons = (m_buttons & ~0x7) | translateMouseButtons(release->state);
+            m_buttons &= ~translateMouseButton(release->detail);
+            QWindowSystemInterface::handleMouseEvent(0, release->time, p, p, m_buttons);
             break;
             }
         case XCB_MOTION_NOTIFY: {
             xcb_motion_notify_event_t *motion = (xcb_motion_notify_event_t *)event;
             QPoint p(motion->event_x, motion->event_y);
-            QWindowSystemInterface::handleMouseEvent(0, motion->time, p, p, buttons);
+            QWindowSystemInterface::handleMouseEvent(0, motion->time, p, p, m_buttons);
             break;
             }
         case XCB_CLIENT_MESSAGE: {
@@ -139,18 +174,184 @@ void EventReader::run()
             if (client->format == 32
                 && client->type == atoms[Atoms::WM_PROTOCOLS]
                 && client->data.data32[0] == atoms[Atoms::WM_DELETE_WINDOW]) {
-                QWindow *window = m_integration->platformWindow() ? m_integration->platformWindow()->window() : 0;
-                if (window)
-                    QWindowSystemInterface::handleCloseEvent(window);
+                if (QWindow *w = window())
+                    QWindowSystemInterface::handleCloseEvent(w);
+            }
+            break;
             }
+        case XCB_GE_GENERIC: {
+            xcb_ge_generic_event_t *generic = (xcb_ge_generic_event_t *)event;
+            if (m_integration->presentOpcode() && generic->extension == m_integration->presentOpcode())
+                handlePresentEvent(generic);
+            else if (m_integration->xiOpcode() && generic->extension == m_integration->xiOpcode())
+                handleXIEvent(generic);
             break;
             }
         default:
             break;
         }
+
+        free(event);
     }
 }
 
+void EventReader::handlePresentEvent(xcb_ge_generic_event_t *event)
+{
+    if (event->event_type != XCB_PRESENT_COMPLETE_NOTIFY)
+        return;
+
+    xcb_present_complete_notify_event_t *complete = (xcb_present_complete_notify_event_t *)event;
+    if (complete->kind == XCB_PRESENT_COMPLETE_KIND_NOTIFY_MSC)
+        m_integration->presentCompleted(complete->serial, complete->ust, complete->msc);
+}
+
+void EventReader::handleXIEvent(xcb_ge_generic_event_t *event)
+{
+    switch (event->event_type) {
+    case XCB_INPUT_ENTER: {
+        xcb_input_enter_event_t *enter = (xcb_input_enter_event_t *)event;
+        m_pointerInside = true;
+        movePointer(QPointF(fixed1616ToReal(enter->event_x), fixed1616ToReal(enter->event_y)),
+                    enter->time);
+        break;
+        }
+    case XCB_INPUT_LEAVE:
+        m_pointerInside = false;
+        break;
+    case XCB_INPUT_MOTION: {
+        // Raw motion moves the pointer while it's inside the window,
+        // the accelerated position is only used for devices without it
+        xcb_input_motion_event_t *motion = (xcb_input_motion_event_t *)event;
+        if (!m_rawMotion || !isRelativeDevice(motion->sourceid))
+            movePointer(QPointF(fixed1616ToReal(motion->event_x), fixed1616ToReal(motion->event_y)),
+                        motion->time);
+        break;
+        }
+    case XCB_INPUT_BUTTON_PRESS:
+    case XCB_INPUT_BUTTON_RELEASE: {
+        xcb_input_button_press_event_t *button = (xcb_input_button_press_event_t *)event;
+        QWindow *w = window();
+        if (!w)
+            break;
+
+        // Buttons 4-7 are the wheel, only presses are meaningful
+        if (button->detail >= 4 && button->detail <= 7) {
+            if (event->event_type == XCB_INPUT_BUTTON_PRESS) {
+                const int delta = button->detail == 4 || button->detail == 6 ? 120 : -120;
+                const QPoint angleDelta = button->detail < 6 ? QPoint(0, delta) : QPoint(delta, 0);
+                QWindowSystemInterface::handleWheelEvent(w, button->time, m_pointerPos, m_pointerPos,
+                                                         QPoint(), angleDelta);
+            }
+            break;
+        }
+
+        const Qt::MouseButton qtButton = translateMouseButton(button->detail);
+        if (event->event_type == XCB_INPUT_BUTTON_PRESS)
+            m_buttons |= qtButton;
+        else
+            m_buttons &= ~qtButton;
+        QWindowSystemInterface::handleMouseEvent(w, button->time, m_pointerPos, m_pointerPos, m_buttons);
+        break;
+        }
+    case XCB_INPUT_RAW_MOTION:
+        handleXIRawMotion((xcb_input_raw_motion_event_t *)event);
+        break;
+    default:
+        break;
+    }
+}
+
+void EventReader::handleXIRawMotion(xcb_input_raw_motion_event_t *event)
+{
+    if (!m_pointerInside || !isRelativeDevice(event->sourceid))
+        return;
+
+    // Values are packed in the order of the bits set in the mask,
+    // the first two valuators of a pointer are the x and y axes
+    const uint32_t *mask = xcb_input_raw_button_press_valuator_mask((xcb_input_raw_button_press_event_t *)event);
+    const xcb_input_fp3232_t *values = xcb_input_raw_button_press_axisvalues_raw((xcb_input_raw_button_press_event_t *)event);
+    if (!event->valuators_len)
+        return;
+
+    QPointF delta;
+    int index = 0;
+    if (mask[0] & (1 << 0))
+        delta.setX(fixed3232ToReal(values[index++]));
+    if (mask[0] & (1 << 1))
+        delta.setY(fixed3232ToReal(values[index++]));
+    if (delta.isNull())
+        return;
+
+    m_rawMotion = true;
+    movePointer(m_pointerPos + delta, event->time);
+}
+
+bool EventReader::isRelativeDevice(quint16 deviceId)
+{
+    QHash<quint16, bool>::const_iterator it = m_relativeDevices.constFind(deviceId);
+    if (it != m_relativeDevices.constEnd())
+        return it.value();
+
+    // Absolute devices such as tablets report positions, not deltas
+    bool relative = false;
+    xcb_connection_t *connection = m_integration->connection();
+    xcb_input_xi_query_device_reply_t *reply =
+            xcb_input_xi_query_device_reply(connection, xcb_input_xi_query_device(connection, deviceId), Q_NULLPTR);
+    if (reply) {
+        xcb_input_xi_device_info_iterator_t info = xcb_input_xi_query_device_infos_iterator(reply);
+        if (info.rem) {
+            xcb_input_device_class_iterator_t it = xcb_input_xi_device_info_classes_iterator(info.data);
+            for (; it.rem; xcb_input_device_class_next(&it)) {
+                if (it.data->type != XCB_INPUT_DEVICE_CLASS_TYPE_VALUATOR)
+                    continue;
+                xcb_input_valuator_class_t *valuator = (xcb_input_valuator_class_t *)it.data;
+                if (valuator->number == 0)
+                    relative = valuator->mode == XCB_INPUT_VALUATOR_MODE_RELATIVE;
+            }
+        }
+        free(reply);
+    }
+
+    m_relativeDevices.insert(deviceId, relative);
+    return relative;
+}
+
+void EventReader::movePointer(const QPointF &pos, xcb_timestamp_t time)
+{
+    QWindow *w = window();
+    if (!w)
+        return;
+
+    const QSize size = m_integration->screenSize();
+    m_pointerPos = QPointF(qBound<qreal>(0, pos.x(), size.width() - 1),
+                           qBound<qreal>(0, pos.y(), size.height() - 1));
+    QWindowSystemInterface::handleMouseEvent(w, time, m_pointerPos, m_pointerPos, m_buttons);
+}
+
+static bool queryLastPresentation(QWindow *window, EglFSFunctions::Presentation *presentation)
+{
+    // There's only one native window
+    Q_UNUSED(window);
+
+    EglFSX11Integration *integration = static_cast<EglFSX11Integration *>(egl_device_integration());
+    *presentation = integration->lastPresentation();
+    return presentation->msc != 0;
+}
+
+EglFSX11Integration::EglFSX11Integration()
+    : m_display(0)
+    , m_connection(0)
+    , m_window(0)
+    , m_eventReader(0)
+    , m_connectionEventListener(0)
+    , m_platformWindow(0)
+    , m_presentOpcode(0)
+    , m_presentSerial(0)
+    , m_completedSerial(0)
+    , m_xiOpcode(0)
+{
+}
+
 void EglFSX11Integration::sendConnectionEvent(xcb_atom_t a)
 {
     xcb_client_message_event_t event;
@@ -187,6 +388,9 @@ void EglFSX11Integration::platformInit()
                       0, 0, 1, 1, 0, XCB_WINDOW_CLASS_INPUT_ONLY,
                       it.data->root_visual, 0, 0);
 
+    initializePresent();
+    initializeXInput2();
+
     m_eventReader = new EventReader(this);
     m_eventReader->start();
 }
@@ -221,6 +425,95 @@ bool EglFSX11Integration::handlesInput()
     return true;
 }
 
+void EglFSX11Integration::initializePresent()
+{
+    const xcb_query_extension_reply_t *extension =
+            xcb_get_extension_data(m_connection, &xcb_present_id);
+    if (!extension || !extension->present) {
+        qWarning("Present extension not available, frames will not be paced");
+        return;
+    }
+
+    xcb_present_query_version_reply_t *reply =
+            xcb_present_query_version_reply(m_connection,
+                                            xcb_present_query_version(m_connection,
+                                                                      XCB_PRESENT_MAJOR_VERSION,
+                                                                      XCB_PRESENT_MINOR_VERSION),
+                                            0);
+    if (!reply)
+        return;
+    free(reply);
+
+    m_presentOpcode = extension->major_opcode;
+}
+
+void EglFSX11Integration::initializeXInput2()
+{
+    const xcb_query_extension_reply_t *extension =
+            xcb_get_extension_data(m_connection, &xcb_input_id);
+    if (!extension || !extension->present)
+        return;
+
+    // Raw events are delivered without a grab since 2.1
+    xcb_input_xi_query_version_reply_t *reply =
+            xcb_input_xi_query_version_reply(m_connection,
+                                             xcb_input_xi_query_version(m_connection, 2, 2),
+                                             0);
+    if (!reply)
+        return;
+    if (reply->major_version > 2 || (reply->major_version == 2 && reply->minor_version >= 1))
+        m_xiOpcode = extension->major_opcode;
+    free(reply);
+}
+
+void EglFSX11Integration::selectInput()
+{
+    if (m_presentOpcode)
+        xcb_present_select_input(m_connection, xcb_generate_id(m_connection), m_window,
+                                 XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY);
+
+    if (!m_xiOpcode) {
+        const quint32 mask = XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE |
+                XCB_EVENT_MASK_POINTER_MOTION;
+        xcb_change_window_attributes(m_connection, m_window, XCB_CW_EVENT_MASK, &mask);
+        return;
+    }
+
+    struct {
+        xcb_input_event_mask_t header;
+        quint32 mask;
+    } mask;
+    mask.header.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+    mask.header.mask_len = 1;
+
+    mask.mask = XCB_INPUT_XI_EVENT_MASK_ENTER | XCB_INPUT_XI_EVENT_MASK_LEAVE |
+            XCB_INPUT_XI_EVENT_MASK_MOTION |
+            XCB_INPUT_XI_EVENT_MASK_BUTTON_PRESS | XCB_INPUT_XI_EVENT_MASK_BUTTON_RELEASE;
+    xcb_input_xi_select_events(m_connection, m_window, 1, &mask.header);
+
+    // Raw events are only delivered to the root window
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(m_connection));
+    mask.mask = XCB_INPUT_XI_EVENT_MASK_RAW_MOTION;
+    xcb_input_xi_select_events(m_connection, it.data->root, 1, &mask.header);
+
+    // The pointer follows unaccelerated motion and is painted by us,
+    // hide the host cursor that would drift away from it
+    xcb_pixmap_t pixmap = xcb_generate_id(m_connection);
+    xcb_create_pixmap(m_connection, 1, pixmap, m_window, 1, 1);
+    xcb_gcontext_t gc = xcb_generate_id(m_connection);
+    const quint32 foreground = 0;
+    xcb_create_gc(m_connection, gc, pixmap, XCB_GC_FOREGROUND, &foreground);
+    const xcb_rectangle_t rect = { 0, 0, 1, 1 };
+    xcb_poly_fill_rectangle(m_connection, pixmap, gc, 1, &rect);
+    xcb_free_gc(m_connection, gc);
+
+    xcb_cursor_t cursor = xcb_generate_id(m_connection);
+    xcb_create_cursor(m_connection, cursor, pixmap, pixmap, 0, 0, 0, 0, 0, 0, 0, 0);
+    xcb_change_window_attributes(m_connection, m_window, XCB_CW_CURSOR, &cursor);
+    xcb_free_cursor(m_connection, cursor);
+    xcb_free_pixmap(m_connection, pixmap);
+}
+
 QSize EglFSX11Integration::screenSize() const
 {
     if (m_screenSize.isEmpty()) {
@@ -280,6 +573,8 @@ EGLNativeWindowType EglFSX11Integration::createNativeWindow(QPlatformWindow *pla
     xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_window,
                         m_atoms[Atoms::_NET_WM_STATE], XCB_ATOM_ATOM, 32, 1, &m_atoms[Atoms::_NET_WM_STATE_FULLSCREEN]);
 
+    selectInput();
+
     xcb_map_window(m_connection, m_window);
 
     xcb_flush(m_connection);
@@ -298,6 +593,77 @@ bool EglFSX11Integration::hasCapability(QPlatformIntegration::Capability cap) co
     return false;
 }
 
+qreal EglFSX11Integration::refreshRate() const
+{
+    const EglFSFunctions::Presentation presentation = lastPresentation();
+    if (presentation.refreshNsec > 0)
+        return 1000000000.0 / presentation.refreshNsec;
+    return EGLDeviceIntegration::refreshRate();
+}
+
+void EglFSX11Integration::waitForVSync(QPlatformSurface *surface) const
+{
+    Q_UNUSED(surface);
+
+    if (!m_presentOpcode)
+        return;
+
+    // Wait for the vblank that followed the previous swap, but don't
+    // stall rendering if the server stops notifying us
+    QMutexLocker locker(&m_presentMutex);
+    while (m_completedSerial != m_presentSerial) {
+        if (!m_presentCondition.wait(&m_presentMutex, 100))
+            break;
+    }
+}
+
+void EglFSX11Integration::presentBuffer(QPlatformSurface *surface)
+{
+    Q_UNUSED(surface);
+
+    if (!m_presentOpcode)
+        return;
+
+    QMutexLocker locker(&m_presentMutex);
+    ++m_presentSerial;
+    xcb_present_notify_msc(m_connection, m_window, m_presentSerial, 0, 1, 0);
+    xcb_flush(m_connection);
+}
+
+void EglFSX11Integration::presentCompleted(quint32 serial, quint64 ust, quint64 msc)
+{
+    QMutexLocker locker(&m_presentMutex);
+
+    // Average out the jitter of the timestamps, skipped vblanks
+    // are accounted for by the counter
+    if (m_presentation.msc > 0 && msc > m_presentation.msc && ust > m_presentation.ust) {
+        const quint64 interval = (ust - m_presentation.ust) * 1000 / (msc - m_presentation.msc);
+        if (m_presentation.refreshNsec > 0)
+            m_presentation.refreshNsec = (m_presentation.refreshNsec * 7 + interval) / 8;
+        else
+            m_presentation.refreshNsec = interval;
+    }
+
+    m_presentation.ust = ust;
+    m_presentation.msc = msc;
+    m_completedSerial = serial;
+    m_presentCondition.wakeAll();
+}
+
+EglFSFunctions::Presentation EglFSX11Integration::lastPresentation() const
+{
+    QMutexLocker locker(&m_presentMutex);
+    return m_presentation;
+}
+
+QFunctionPointer EglFSX11Integration::platformFunction(const QByteArray &function) const
+{
+    if (m_presentOpcode && function == EglFSFunctions::lastPresentationIdentifier())
+        return QFunctionPointer(queryLastPresentation);
+
+    return Q_NULLPTR;
+}
+
 } // namespace Platform
 
 } // namespace GreenIsland
@@ -30,10 +30,13 @@
 #ifndef GREENISLAND_EGLFSX11INTEGRATION_H
 #define GREENISLAND_EGLFSX11INTEGRATION_H
 
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 #include <QtGui/qpa/qwindowsysteminterface.h>
 #include <QtGui/qpa/qplatformwindow.h>
 
 #include <GreenIsland/Platform/EGLDeviceIntegration>
+#include <GreenIsland/Platform/EglFSFunctions>
 
 #include <xcb/xcb.h>
 
@@ -59,7 +62,7 @@ class EventReader;
 class EglFSX11Integration : public EGLDeviceIntegration
 {
 public:
-    EglFSX11Integration() : m_connection(0), m_window(0), m_eventReader(0) {}
+    EglFSX11Integration();
 
     void platformInit() Q_DECL_OVERRIDE;
     void platformDestroy() Q_DECL_OVERRIDE;
@@ -69,18 +72,33 @@ public:
     bool handlesInput() Q_DECL_OVERRIDE;
 
     QSize screenSize() const Q_DECL_OVERRIDE;
+    qreal refreshRate() const Q_DECL_OVERRIDE;
     EGLNativeWindowType createNativeWindow(QPlatformWindow *window,
                                            const QSize &size,
                                            const QSurfaceFormat &format) Q_DECL_OVERRIDE;
     void destroyNativeWindow(EGLNativeWindowType window) Q_DECL_OVERRIDE;
     bool hasCapability(QPlatformIntegration::Capability cap) const Q_DECL_OVERRIDE;
 
+    void waitForVSync(QPlatformSurface *surface) const Q_DECL_OVERRIDE;
+    void presentBuffer(QPlatformSurface *surface) Q_DECL_OVERRIDE;
+
+    QFunctionPointer platformFunction(const QByteArray &function) const Q_DECL_OVERRIDE;
+
     xcb_connection_t *connection() { return m_connection; }
     const xcb_atom_t *atoms() const { return m_atoms; }
     QPlatformWindow *platformWindow() { return m_platformWindow; }
 
+    quint8 presentOpcode() const { return m_presentOpcode; }
+    quint8 xiOpcode() const { return m_xiOpcode; }
+
+    void presentCompleted(quint32 serial, quint64 ust, quint64 msc);
+    EglFSFunctions::Presentation lastPresentation() const;
+
 private:
     void sendConnectionEvent(xcb_atom_t a);
+    void initializePresent();
+    void initializeXInput2();
+    void selectInput();
 
     void *m_display;
     xcb_connection_t *m_connection;
@@ -90,6 +108,17 @@ private:
     xcb_window_t m_connectionEventListener;
     QPlatformWindow *m_platformWindow;
     mutable QSize m_screenSize;
+
+    // Present: a notification is requested for the vblank following
+    // each swap, the next frame waits for it
+    quint8 m_presentOpcode;
+    mutable QMutex m_presentMutex;
+    mutable QWaitCondition m_presentCondition;
+    quint32 m_presentSerial;
+    quint32 m_completedSerial;
+    EglFSFunctions::Presentation m_presentation;
+
+    quint8 m_xiOpcode;
 };
 
 } // namespace Platform
@@ -113,15 +113,12 @@ void PlasmaEffects::effects_set_blur_behind_region(Resource *resource,
         return;
     }
 
-    QtWayland::Region *r = QtWayland::Region::fromResource(regionResource);
-    r->region();
-
-    // TODO: Set blur behind region on views
-
-    /*
-     * TODO: Maybe add a property map to ShellWindow called "effects"
-     * with the "blur_behind" entry that contains the "region" property.
-     */
+    // A null region disables blur behind, BlurItem watches
+    // this property on the surfaces of its windows
+    QRegion region;
+    if (regionResource)
+        region = QtWayland::Region::fromResource(regionResource)->region();
+    surface->setProperty("blurBehindRegion", region);
 }
 
 void PlasmaEffects::effects_set_contrast_region(Resource *resource,
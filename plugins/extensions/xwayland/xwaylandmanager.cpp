@@ -49,11 +49,14 @@
  * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <QtCore/QAbstractEventDispatcher>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QSocketNotifier>
 #include <QtCore/QtMath>
 #include <GreenIsland/Compositor/QWaylandSurface>
 
 #include <GreenIsland/Server/ClientWindow>
+#include <waylandcompositor/compositor_api/qwaylandcompositor_p.h>
 
 #include "compositor.h"
 #include "xcbcursors.h"
@@ -62,6 +65,7 @@
 #include "xcbresources.h"
 #include "xwayland.h"
 #include "xwaylandmanager.h"
+#include "xwaylandselection.h"
 #include "xwaylandwindow.h"
 #include "xwaylandserver.h"
 #include "xwaylandsurface.h"
@@ -76,6 +80,7 @@ XWaylandManager::XWaylandManager(Compositor *compositor, XWaylandServer *server,
     : QObject(parent)
     , m_compositor(compositor)
     , m_server(server)
+    , m_selection(new XWaylandSelection(QWaylandCompositorPrivate::get(compositor)->dataDeviceManager(), this))
     , m_cursors(Q_NULLPTR)
     , m_lastCursor(CursorUnset)
     , m_wmWindow(Q_NULLPTR)
@@ -105,6 +110,11 @@ void XWaylandManager::start(int fd)
     QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
     connect(notifier, SIGNAL(activated(int)), this, SLOT(wmEvents()));
 
+    // Replies might have been read off the socket by a blocking call
+    // elsewhere, in which case the notifier won't fire for them
+    connect(QCoreApplication::eventDispatcher(), SIGNAL(aboutToBlock()),
+            this, SLOT(processPropertyReplies()));
+
     // Resources and atoms
     Xcb::resources();
 
@@ -175,6 +185,16 @@ XWaylandWindow *XWaylandManager::windowFromId(xcb_window_t id)
     return m_windowsMap.value(id, Q_NULLPTR);
 }
 
+void XWaylandManager::schedulePropertyFetch(XWaylandWindow *window)
+{
+    m_propertyWindows.insert(window);
+}
+
+void XWaylandManager::cancelPropertyFetch(XWaylandWindow *window)
+{
+    m_propertyWindows.remove(window);
+}
+
 void XWaylandManager::setupVisualAndColormap()
 {
     xcb_depth_iterator_t depthIterator =
@@ -204,31 +224,7 @@ void XWaylandManager::setupVisualAndColormap()
 
 void XWaylandManager::wmSelection()
 {
-    m_selRequest.requestor = XCB_NONE;
-
-    quint32 values[1];
-    values[0] = XCB_EVENT_MASK_PROPERTY_CHANGE;
-
-    m_selWindow = xcb_generate_id(Xcb::connection());
-    xcb_create_window(Xcb::connection(), XCB_COPY_FROM_PARENT,
-                      m_selWindow, Xcb::rootWindow(),
-                      0, 0, 10, 10, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
-                      Xcb::rootVisual(),
-                      XCB_CW_EVENT_MASK, values);
-    xcb_set_selection_owner(Xcb::connection(), m_selWindow,
-                            Xcb::resources()->atoms->clipboard_manager,
-                            XCB_TIME_CURRENT_TIME);
-
-    quint32 mask =
-            XCB_XFIXES_SELECTION_EVENT_MASK_SET_SELECTION_OWNER |
-            XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_WINDOW_DESTROY |
-            XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_CLIENT_CLOSE;
-    xcb_xfixes_select_selection_input(Xcb::connection(),
-                                      m_selWindow,
-                                      Xcb::resources()->atoms->clipboard,
-                                      mask);
-
-    //weston_wm_set_selection
+    m_selection->start();
 }
 
 void XWaylandManager::initializeDragAndDrop()
@@ -426,7 +422,7 @@ void XWaylandManager::handleMapRequest(xcb_map_request_event_t *event)
         return;
 
     XWaylandWindow *window = m_windowsMap[event->window];
-    window->readProperties();
+    window->waitForProperties();
 
     if (window->frameId() == XCB_WINDOW_NONE)
         createFrame(window);
@@ -585,12 +581,10 @@ void XWaylandManager::handlePropertyNotify(xcb_property_notify_event_t *event)
     XWaylandWindow *window = m_windowsMap[event->window];
     if (event->state == XCB_PROPERTY_DELETE)
         qCDebug(XWAYLAND_TRACE, "deleted");
-    else
-        window->readAndDumpProperty(event->atom);
 
-    if (event->atom == Xcb::resources()->atoms->net_wm_name ||
-            event->atom == XCB_ATOM_WM_NAME)
-        window->repaint();
+    // Fetched after the whole batch of events has been handled,
+    // the window repaints when a new title comes in
+    window->propertyChanged(event->atom, event->state == XCB_PROPERTY_DELETE);
 }
 
 void XWaylandManager::handleClientMessage(xcb_client_message_event_t *event)
@@ -624,42 +618,7 @@ void XWaylandManager::handleClientMessage(xcb_client_message_event_t *event)
 
 bool XWaylandManager::handleSelection(xcb_generic_event_t *event)
 {
-    switch (event->response_type & ~0x80) {
-    case XCB_SELECTION_NOTIFY:
-        handleSelectionNotify((xcb_selection_notify_event_t *)event);
-        return true;
-        /*
-    case XCB_PROPERTY_NOTIFY:
-        return handleSelectionPropertyNotify(event);
-    case XCB_SELECTION_REQUEST:
-        handleSelectionRequest(event);
-        return true;
-        */
-    default:
-        break;
-    }
-
-    /*
-    switch (event->response_type - xfixes->first_event) {
-    case XCB_XFIXES_SELECTION_NOTIFY:
-        return handleXFixesSelectionNotify(event);
-    }
-    */
-
-    return false;
-}
-
-void XWaylandManager::handleSelectionNotify(xcb_selection_notify_event_t *event)
-{
-    if (event->property == XCB_ATOM_NONE) {
-        /* convert selection failed */
-    } else if (event->target == Xcb::resources()->atoms->targets) {
-        /*
-              weston_wm_get_selection_targets(wm);
-      } else {
-              weston_wm_get_selection_data(wm);
-              */
-    }
+    return m_selection->handleEvent(event);
 }
 
 void XWaylandManager::handleMoveResize(XWaylandWindow *window, xcb_client_message_event_t *event)
@@ -797,7 +756,11 @@ void XWaylandManager::wmEvents()
     xcb_generic_event_t *event;
 
     while ((event = xcb_poll_for_event(Xcb::connection()))) {
-        //handle selection event
+        if (handleSelection(event)) {
+            free(event);
+            continue;
+        }
+
         //handle dnd event
 
         int type = event->response_type & ~0x80;
@@ -854,6 +817,24 @@ void XWaylandManager::wmEvents()
         free(event);
     }
 
+    processPropertyReplies();
+
+    xcb_flush(Xcb::connection());
+}
+
+void XWaylandManager::processPropertyReplies()
+{
+    if (m_propertyWindows.isEmpty())
+        return;
+
+    QSet<XWaylandWindow *>::iterator it = m_propertyWindows.begin();
+    while (it != m_propertyWindows.end()) {
+        if ((*it)->processPropertyReplies())
+            ++it;
+        else
+            it = m_propertyWindows.erase(it);
+    }
+
     xcb_flush(Xcb::connection());
 }
 
@@ -29,6 +29,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QMap>
+#include <QtCore/QSet>
 
 #include <xcb/xcb.h>
 
@@ -42,6 +43,7 @@ namespace GreenIsland {
 class Compositor;
 class XWayland;
 class XWaylandWindow;
+class XWaylandSelection;
 class XWaylandServer;
 
 class XWaylandManager : public QObject
@@ -72,14 +74,16 @@ public:
 
     XWaylandWindow *windowFromId(xcb_window_t id);
 
+    void schedulePropertyFetch(XWaylandWindow *window);
+    void cancelPropertyFetch(XWaylandWindow *window);
+
 private:
     Compositor *m_compositor;
     XWaylandServer *m_server;
     xcb_visualid_t m_visualId;
     xcb_colormap_t m_colorMap;
 
-    xcb_selection_request_event_t m_selRequest;
-    xcb_window_t m_selWindow;
+    XWaylandSelection *m_selection;
 
     xcb_cursor_t *m_cursors;
     int m_lastCursor;
@@ -89,6 +93,7 @@ private:
     QMap<xcb_window_t, XWaylandWindow *> m_windowsMap;
     QList<XWaylandWindow *> m_unpairedWindows;
     XWaylandWindow *m_focusWindow;
+    QSet<XWaylandWindow *> m_propertyWindows;
 
     void setupVisualAndColormap();
     void wmSelection();
@@ -115,7 +120,6 @@ private:
     void handleClientMessage(xcb_client_message_event_t *event);
 
     bool handleSelection(xcb_generic_event_t *event);
-    void handleSelectionNotify(xcb_selection_notify_event_t *event);
 
     void handleMoveResize(XWaylandWindow *window,
                           xcb_client_message_event_t *event);
@@ -128,6 +132,7 @@ private:
 
 private Q_SLOTS:
     void wmEvents();
+    void processPropertyReplies();
 };
 
 }
@@ -0,0 +1,759 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini
+ *
+ * $BEGIN_LICENSE:LGPL2.1+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include <waylandcompositor/wayland_wrapper/qwldatasource_p.h>
+
+#include "xcbatoms.h"
+#include "xcbresources.h"
+#include "xcbwrapper.h"
+#include "xwayland.h"
+#include "xwaylandselection.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace GreenIsland {
+
+// Upper bound for a single property, larger selections go through INCR
+static const int maxChunkSize = 1024 * 1024;
+
+// Give up an INCR transfer when the other side stops making progress
+static const int incrTimeout = 5000;
+
+static const QString utf8MimeType = QStringLiteral("text/plain;charset=utf-8");
+static const QString textMimeType = QStringLiteral("text/plain");
+
+static inline Xcb::Atoms *atoms()
+{
+    return Xcb::resources()->atoms;
+}
+
+XWaylandSelection::XWaylandSelection(QtWayland::DataDeviceManager *dataDeviceManager,
+                                     QObject *parent)
+    : QObject(parent)
+    , m_dataDeviceManager(dataDeviceManager)
+    , m_window(XCB_WINDOW_NONE)
+    , m_timestamp(XCB_TIME_CURRENT_TIME)
+    , m_ownerTimestamp(XCB_TIME_CURRENT_TIME)
+    , m_ownsClipboard(false)
+    , m_chunkSize(maxChunkSize)
+    , m_writeNotifier(Q_NULLPTR)
+    , m_incomingTimeout(new QTimer(this))
+    , m_readNotifier(Q_NULLPTR)
+    , m_outgoingTimeout(new QTimer(this))
+{
+    m_incomingTimeout->setSingleShot(true);
+    m_incomingTimeout->setInterval(incrTimeout);
+    connect(m_incomingTimeout, SIGNAL(timeout()),
+            this, SLOT(abortIncoming()));
+
+    m_outgoingTimeout->setSingleShot(true);
+    m_outgoingTimeout->setInterval(incrTimeout);
+    connect(m_outgoingTimeout, SIGNAL(timeout()),
+            this, SLOT(abortOutgoing()));
+
+    connect(m_dataDeviceManager, SIGNAL(selectionChanged()),
+            this, SLOT(selectionChanged()));
+}
+
+XWaylandSelection::~XWaylandSelection()
+{
+    // The X11 connection is gone by now, only release local resources
+    if (m_dataDeviceManager->selectionProvider() == this)
+        m_dataDeviceManager->setSelectionProvider(Q_NULLPTR);
+
+    for (int i = 0; i < m_pendingIncoming.size(); ++i)
+        ::close(m_pendingIncoming.at(i).second);
+    free(m_incoming.reply);
+    if (m_incoming.fd != -1)
+        ::close(m_incoming.fd);
+    if (m_outgoing.fd != -1)
+        ::close(m_outgoing.fd);
+}
+
+void XWaylandSelection::start()
+{
+    // Whatever fits in a single request skips INCR altogether
+    const qint64 maxRequest = qint64(xcb_get_maximum_request_length(Xcb::connection())) * 4;
+    m_chunkSize = int(qBound<qint64>(4096, maxRequest - 64, maxChunkSize));
+
+    quint32 values[1];
+    values[0] = XCB_EVENT_MASK_PROPERTY_CHANGE;
+
+    m_window = xcb_generate_id(Xcb::connection());
+    xcb_create_window(Xcb::connection(), XCB_COPY_FROM_PARENT,
+                      m_window, Xcb::rootWindow(),
+                      0, 0, 10, 10, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      Xcb::rootVisual(),
+                      XCB_CW_EVENT_MASK, values);
+    xcb_set_selection_owner(Xcb::connection(), m_window,
+                            atoms()->clipboard_manager,
+                            XCB_TIME_CURRENT_TIME);
+
+    quint32 mask =
+            XCB_XFIXES_SELECTION_EVENT_MASK_SET_SELECTION_OWNER |
+            XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_WINDOW_DESTROY |
+            XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_CLIENT_CLOSE;
+    xcb_xfixes_select_selection_input(Xcb::connection(), m_window,
+                                      atoms()->clipboard, mask);
+
+    // A Wayland client might already own the selection
+    selectionChanged();
+}
+
+bool XWaylandSelection::handleEvent(xcb_generic_event_t *event)
+{
+    switch (event->response_type & ~0x80) {
+    case XCB_SELECTION_NOTIFY:
+        handleSelectionNotify((xcb_selection_notify_event_t *)event);
+        return true;
+    case XCB_PROPERTY_NOTIFY:
+        return handleSelectionPropertyNotify((xcb_property_notify_event_t *)event);
+    case XCB_SELECTION_REQUEST:
+        handleSelectionRequest((xcb_selection_request_event_t *)event);
+        return true;
+    case XCB_SELECTION_CLEAR:
+        handleSelectionClear((xcb_selection_clear_event_t *)event);
+        return true;
+    default:
+        break;
+    }
+
+    const xcb_query_extension_reply_t *xfixes = Xcb::resources()->xfixes;
+    if (xfixes && xfixes->present &&
+            (event->response_type & ~0x80) == xfixes->first_event + XCB_XFIXES_SELECTION_NOTIFY) {
+        handleXFixesSelectionNotify((xcb_xfixes_selection_notify_event_t *)event);
+        return true;
+    }
+
+    return false;
+}
+
+QStringList XWaylandSelection::mimeTypes() const
+{
+    return m_mimeTypes;
+}
+
+void XWaylandSelection::send(const QString &mimeType, int fd)
+{
+    if (!m_sourceTargets.contains(mimeType)) {
+        ::close(fd);
+        return;
+    }
+
+    // Never block the compositor on a slow reader
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    // X11 only lets us convert one target at a time into our property
+    m_pendingIncoming.append(qMakePair(mimeType, fd));
+    if (m_incoming.fd == -1)
+        startIncoming();
+}
+
+void XWaylandSelection::handleXFixesSelectionNotify(xcb_xfixes_selection_notify_event_t *event)
+{
+    if (event->selection != atoms()->clipboard)
+        return;
+
+    if (event->owner == m_window) {
+        // Our own claim on behalf of a Wayland client
+        m_ownerTimestamp = event->selection_timestamp;
+        return;
+    }
+
+    // Whatever was requested from the previous owner is stale now
+    m_ownsClipboard = false;
+    clearIncoming();
+
+    if (event->owner == XCB_WINDOW_NONE) {
+        if (m_dataDeviceManager->selectionProvider() == this)
+            m_dataDeviceManager->setSelectionProvider(Q_NULLPTR);
+        return;
+    }
+
+    m_timestamp = event->timestamp;
+    xcb_convert_selection(Xcb::connection(), m_window,
+                          atoms()->clipboard, atoms()->targets,
+                          atoms()->wl_selection, m_timestamp);
+}
+
+void XWaylandSelection::handleSelectionNotify(xcb_selection_notify_event_t *event)
+{
+    if (event->requestor != m_window || event->selection != atoms()->clipboard)
+        return;
+
+    if (event->target == atoms()->targets) {
+        if (event->property == XCB_ATOM_NONE)
+            qCDebug(XWAYLAND) << "Failed to retrieve X11 selection targets";
+        else
+            readTargets();
+        return;
+    }
+
+    if (m_incoming.fd == -1 || event->target != m_incoming.target)
+        return;
+
+    if (event->property == XCB_ATOM_NONE)
+        finishIncoming();
+    else
+        readData();
+}
+
+bool XWaylandSelection::handleSelectionPropertyNotify(xcb_property_notify_event_t *event)
+{
+    if (event->window == m_window) {
+        // Owner wrote the next INCR chunk
+        if (event->atom == atoms()->wl_selection &&
+                event->state == XCB_PROPERTY_NEW_VALUE &&
+                m_incoming.fd != -1 && m_incoming.incr && !m_incoming.reply)
+            readData();
+        return true;
+    }
+
+    if (m_outgoing.fd != -1 && m_outgoing.incr &&
+            event->window == m_outgoing.request.requestor &&
+            event->atom == m_outgoing.request.property &&
+            event->state == XCB_PROPERTY_DELETE) {
+        // Requestor consumed the previous chunk
+        m_outgoing.waiting = true;
+        flushOutgoing();
+        return true;
+    }
+
+    return false;
+}
+
+void XWaylandSelection::handleSelectionRequest(xcb_selection_request_event_t *event)
+{
+    xcb_selection_request_event_t request = *event;
+
+    // Obsolete clients leave the property unset (ICCCM 2.2)
+    if (request.property == XCB_ATOM_NONE)
+        request.property = request.target;
+
+    if (request.selection != atoms()->clipboard || !m_ownsClipboard ||
+            !m_dataDeviceManager->currentSelectionSource()) {
+        sendNotify(&request, XCB_ATOM_NONE);
+        return;
+    }
+
+    if (request.target == atoms()->targets) {
+        sendTargets(&request);
+        return;
+    }
+
+    if (request.target == atoms()->timestamp) {
+        sendTimestamp(&request);
+        return;
+    }
+
+    // MULTIPLE is not supported, like any other unknown target
+    if (!m_clientTargets.contains(request.target)) {
+        sendNotify(&request, XCB_ATOM_NONE);
+        return;
+    }
+
+    m_pendingOutgoing.append(request);
+    if (m_outgoing.fd == -1)
+        startOutgoing();
+}
+
+void XWaylandSelection::handleSelectionClear(xcb_selection_clear_event_t *event)
+{
+    if (event->selection == atoms()->clipboard)
+        m_ownsClipboard = false;
+}
+
+void XWaylandSelection::readTargets()
+{
+    xcb_connection_t *c = Xcb::connection();
+
+    xcb_get_property_cookie_t cookie =
+            xcb_get_property(c, 1, m_window, atoms()->wl_selection,
+                             XCB_GET_PROPERTY_TYPE_ANY, 0, 4096);
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(c, cookie, Q_NULLPTR);
+    if (!reply)
+        return;
+    if (reply->type != XCB_ATOM_ATOM) {
+        free(reply);
+        return;
+    }
+
+    const xcb_atom_t *targets = static_cast<xcb_atom_t *>(xcb_get_property_value(reply));
+    const int count = reply->value_len;
+
+    // Resolve all the names with a single round trip
+    QVector<xcb_get_atom_name_cookie_t> cookies(count);
+    for (int i = 0; i < count; ++i)
+        cookies[i] = xcb_get_atom_name(c, targets[i]);
+
+    m_mimeTypes.clear();
+    m_sourceTargets.clear();
+
+    for (int i = 0; i < count; ++i) {
+        xcb_get_atom_name_reply_t *nameReply =
+                xcb_get_atom_name_reply(c, cookies.at(i), Q_NULLPTR);
+
+        QString mimeType;
+        if (targets[i] == atoms()->utf8_string) {
+            mimeType = utf8MimeType;
+        } else if (nameReply) {
+            const QString name =
+                    QString::fromLatin1(xcb_get_atom_name_name(nameReply),
+                                        xcb_get_atom_name_name_length(nameReply));
+            if (name.contains(QLatin1Char('/')))
+                mimeType = name;
+        }
+        free(nameReply);
+
+        if (!mimeType.isEmpty() && !m_sourceTargets.contains(mimeType)) {
+            m_mimeTypes.append(mimeType);
+            m_sourceTargets.insert(mimeType, targets[i]);
+        }
+    }
+
+    free(reply);
+
+    // Most Wayland clients ask for plain text without a charset
+    if (m_sourceTargets.contains(utf8MimeType) && !m_sourceTargets.contains(textMimeType)) {
+        m_mimeTypes.append(textMimeType);
+        m_sourceTargets.insert(textMimeType, atoms()->utf8_string);
+    }
+
+    m_dataDeviceManager->setSelectionProvider(this);
+}
+
+void XWaylandSelection::readData()
+{
+    xcb_connection_t *c = Xcb::connection();
+
+    // The property is deleted only once its contents have been written
+    // out, with INCR that's what makes the owner send the next chunk
+    xcb_get_property_cookie_t cookie =
+            xcb_get_property(c, 0, m_window, atoms()->wl_selection,
+                             XCB_GET_PROPERTY_TYPE_ANY, 0, 0x1fffffff);
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(c, cookie, Q_NULLPTR);
+    if (!reply) {
+        finishIncoming();
+        return;
+    }
+
+    // The owner is still there
+    m_incomingTimeout->start();
+
+    if (!m_incoming.incr && reply->type == atoms()->incr) {
+        free(reply);
+        m_incoming.incr = true;
+        xcb_delete_property(c, m_window, atoms()->wl_selection);
+        xcb_flush(c);
+        return;
+    }
+
+    m_incoming.reply = reply;
+    m_incoming.offset = 0;
+    writeIncoming();
+}
+
+void XWaylandSelection::writeIncoming()
+{
+    if (!m_incoming.reply)
+        return;
+
+    const char *data = static_cast<const char *>(xcb_get_property_value(m_incoming.reply));
+    const int length = xcb_get_property_value_length(m_incoming.reply);
+
+    while (m_incoming.offset < length) {
+        const ssize_t written = ::write(m_incoming.fd, data + m_incoming.offset,
+                                        length - m_incoming.offset);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN) {
+                if (!m_writeNotifier) {
+                    m_writeNotifier = new QSocketNotifier(m_incoming.fd, QSocketNotifier::Write, this);
+                    connect(m_writeNotifier, SIGNAL(activated(int)),
+                            this, SLOT(writeIncoming()));
+                }
+                m_writeNotifier->setEnabled(true);
+                return;
+            }
+
+            // Reader went away
+            finishIncoming();
+            return;
+        }
+
+        m_incoming.offset += written;
+        m_incomingTimeout->start();
+    }
+
+    if (m_writeNotifier)
+        m_writeNotifier->setEnabled(false);
+
+    free(m_incoming.reply);
+    m_incoming.reply = Q_NULLPTR;
+
+    xcb_delete_property(Xcb::connection(), m_window, atoms()->wl_selection);
+    xcb_flush(Xcb::connection());
+
+    // A zero-length chunk terminates INCR
+    if (!m_incoming.incr || length == 0)
+        finishIncoming();
+}
+
+void XWaylandSelection::startIncoming()
+{
+    while (!m_pendingIncoming.isEmpty()) {
+        const QPair<QString, int> next = m_pendingIncoming.takeFirst();
+
+        const xcb_atom_t target = m_sourceTargets.value(next.first, XCB_ATOM_NONE);
+        if (target == XCB_ATOM_NONE) {
+            ::close(next.second);
+            continue;
+        }
+
+        m_incoming.fd = next.second;
+        m_incoming.target = target;
+
+        xcb_convert_selection(Xcb::connection(), m_window,
+                              atoms()->clipboard, target,
+                              atoms()->wl_selection, m_timestamp);
+        xcb_flush(Xcb::connection());
+        m_incomingTimeout->start();
+        return;
+    }
+}
+
+void XWaylandSelection::finishIncoming()
+{
+    m_incomingTimeout->stop();
+
+    if (m_writeNotifier) {
+        m_writeNotifier->setEnabled(false);
+        m_writeNotifier->deleteLater();
+        m_writeNotifier = Q_NULLPTR;
+    }
+
+    free(m_incoming.reply);
+    if (m_incoming.fd != -1)
+        ::close(m_incoming.fd);
+    m_incoming = Incoming();
+
+    startIncoming();
+}
+
+void XWaylandSelection::clearIncoming()
+{
+    for (int i = 0; i < m_pendingIncoming.size(); ++i)
+        ::close(m_pendingIncoming.at(i).second);
+    m_pendingIncoming.clear();
+
+    if (m_incoming.fd != -1)
+        finishIncoming();
+}
+
+void XWaylandSelection::claimClipboard()
+{
+    xcb_connection_t *c = Xcb::connection();
+    QtWayland::DataSource *source = m_dataDeviceManager->currentSelectionSource();
+    const QList<QString> mimeTypes = source->mimeTypes();
+
+    // Intern all the targets with a single round trip
+    QVector<xcb_intern_atom_cookie_t> cookies(mimeTypes.size());
+    for (int i = 0; i < mimeTypes.size(); ++i) {
+        const QByteArray name = mimeTypes.at(i).toLatin1();
+        cookies[i] = xcb_intern_atom(c, 0, name.size(), name.constData());
+    }
+
+    m_clientTargets.clear();
+    for (int i = 0; i < mimeTypes.size(); ++i) {
+        xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(c, cookies.at(i), Q_NULLPTR);
+        if (reply) {
+            m_clientTargets.insert(reply->atom, mimeTypes.at(i));
+            free(reply);
+        }
+    }
+
+    if (mimeTypes.contains(utf8MimeType))
+        m_clientTargets.insert(atoms()->utf8_string, utf8MimeType);
+
+    xcb_set_selection_owner(c, m_window, atoms()->clipboard, XCB_TIME_CURRENT_TIME);
+    m_ownsClipboard = true;
+    xcb_flush(c);
+}
+
+void XWaylandSelection::sendTargets(xcb_selection_request_event_t *request)
+{
+    QVector<xcb_atom_t> targets;
+    targets.reserve(m_clientTargets.size() + 2);
+    targets.append(atoms()->targets);
+    targets.append(atoms()->timestamp);
+    for (QHash<xcb_atom_t, QString>::const_iterator it = m_clientTargets.constBegin();
+         it != m_clientTargets.constEnd(); ++it)
+        targets.append(it.key());
+
+    xcb_change_property(Xcb::connection(), XCB_PROP_MODE_REPLACE,
+                        request->requestor, request->property,
+                        XCB_ATOM_ATOM, 32, targets.size(), targets.constData());
+    sendNotify(request, request->property);
+}
+
+void XWaylandSelection::sendTimestamp(xcb_selection_request_event_t *request)
+{
+    xcb_change_property(Xcb::connection(), XCB_PROP_MODE_REPLACE,
+                        request->requestor, request->property,
+                        XCB_ATOM_INTEGER, 32, 1, &m_ownerTimestamp);
+    sendNotify(request, request->property);
+}
+
+void XWaylandSelection::sendNotify(xcb_selection_request_event_t *request, xcb_atom_t property)
+{
+    xcb_selection_notify_event_t notify;
+    memset(&notify, 0, sizeof(notify));
+    notify.response_type = XCB_SELECTION_NOTIFY;
+    notify.time = request->time;
+    notify.requestor = request->requestor;
+    notify.selection = request->selection;
+    notify.target = request->target;
+    notify.property = property;
+
+    xcb_send_event(Xcb::connection(), 0, request->requestor,
+                   XCB_EVENT_MASK_NO_EVENT, (const char *)&notify);
+    xcb_flush(Xcb::connection());
+}
+
+void XWaylandSelection::startOutgoing()
+{
+    while (!m_pendingOutgoing.isEmpty()) {
+        xcb_selection_request_event_t request = m_pendingOutgoing.takeFirst();
+
+        QtWayland::DataSource *source = m_dataDeviceManager->currentSelectionSource();
+        const QString mimeType = m_clientTargets.value(request.target);
+
+        int fds[2];
+        if (!source || mimeType.isEmpty() || pipe2(fds, O_CLOEXEC | O_NONBLOCK) == -1) {
+            sendNotify(&request, XCB_ATOM_NONE);
+            continue;
+        }
+
+        // Takes ownership of the write end
+        source->send(mimeType, fds[1]);
+
+        m_outgoing.fd = fds[0];
+        m_outgoing.request = request;
+        m_outgoing.chunk.reserve(m_chunkSize);
+
+        m_readNotifier = new QSocketNotifier(m_outgoing.fd, QSocketNotifier::Read, this);
+        connect(m_readNotifier, SIGNAL(activated(int)),
+                this, SLOT(readOutgoing()));
+        return;
+    }
+}
+
+void XWaylandSelection::readOutgoing()
+{
+    // Buffer at most one chunk, the rest stays in the pipe until
+    // the requestor is ready for it
+    QByteArray &chunk = m_outgoing.chunk;
+    while (chunk.size() < m_chunkSize) {
+        const int offset = chunk.size();
+        chunk.resize(m_chunkSize);
+
+        const ssize_t count = ::read(m_outgoing.fd, chunk.data() + offset, m_chunkSize - offset);
+        if (count < 0) {
+            chunk.resize(offset);
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN)
+                return;
+            abortOutgoing();
+            return;
+        }
+
+        chunk.resize(offset + count);
+        if (count == 0) {
+            m_outgoing.eof = true;
+            break;
+        }
+    }
+
+    m_readNotifier->setEnabled(false);
+    flushOutgoing();
+}
+
+void XWaylandSelection::flushOutgoing()
+{
+    xcb_connection_t *c = Xcb::connection();
+    xcb_selection_request_event_t *request = &m_outgoing.request;
+    QByteArray &chunk = m_outgoing.chunk;
+
+    if (!m_outgoing.incr) {
+        if (m_outgoing.eof) {
+            xcb_change_property(c, XCB_PROP_MODE_REPLACE,
+                                request->requestor, request->property,
+                                request->target, 8, chunk.size(), chunk.constData());
+            sendNotify(request, request->property);
+            finishOutgoing();
+            return;
+        }
+
+        // Doesn't fit in a single request, switch to INCR and wait
+        // for the requestor to delete the property; the window manager
+        // shares our connection and might have selected events on the
+        // requestor already, add to its mask rather than replacing it
+        xcb_get_window_attributes_reply_t *attributes =
+                xcb_get_window_attributes_reply(c, xcb_get_window_attributes(c, request->requestor), Q_NULLPTR);
+        if (attributes && !(attributes->your_event_mask & XCB_EVENT_MASK_PROPERTY_CHANGE)) {
+            quint32 mask = attributes->your_event_mask | XCB_EVENT_MASK_PROPERTY_CHANGE;
+            xcb_change_window_attributes(c, request->requestor, XCB_CW_EVENT_MASK, &mask);
+            m_outgoing.selectedPropertyChange = true;
+        }
+        free(attributes);
+
+        quint32 size = m_chunkSize;
+        xcb_change_property(c, XCB_PROP_MODE_REPLACE,
+                            request->requestor, request->property,
+                            atoms()->incr, 32, 1, &size);
+        sendNotify(request, request->property);
+
+        m_outgoing.incr = true;
+        m_outgoingTimeout->start();
+        return;
+    }
+
+    if (!m_outgoing.waiting)
+        return;
+
+    if (chunk.isEmpty() && !m_outgoing.eof) {
+        m_readNotifier->setEnabled(true);
+        return;
+    }
+
+    // A zero-length chunk terminates INCR
+    const bool last = chunk.isEmpty();
+    xcb_change_property(c, XCB_PROP_MODE_REPLACE,
+                        request->requestor, request->property,
+                        request->target, 8, chunk.size(), chunk.constData());
+    xcb_flush(c);
+
+    m_outgoing.waiting = false;
+    m_outgoingTimeout->start();
+
+    if (last) {
+        finishOutgoing();
+        return;
+    }
+
+    chunk.resize(0);
+    if (!m_outgoing.eof)
+        m_readNotifier->setEnabled(true);
+}
+
+void XWaylandSelection::finishOutgoing()
+{
+    m_outgoingTimeout->stop();
+
+    // Take back only what we added, the mask might have changed meanwhile
+    if (m_outgoing.selectedPropertyChange) {
+        xcb_connection_t *c = Xcb::connection();
+        xcb_get_window_attributes_reply_t *attributes =
+                xcb_get_window_attributes_reply(c, xcb_get_window_attributes(c, m_outgoing.request.requestor), Q_NULLPTR);
+        if (attributes) {
+            quint32 mask = attributes->your_event_mask & ~XCB_EVENT_MASK_PROPERTY_CHANGE;
+            xcb_change_window_attributes(c, m_outgoing.request.requestor,
+                                         XCB_CW_EVENT_MASK, &mask);
+            xcb_flush(c);
+            free(attributes);
+        }
+    }
+
+    if (m_readNotifier) {
+        m_readNotifier->setEnabled(false);
+        m_readNotifier->deleteLater();
+        m_readNotifier = Q_NULLPTR;
+    }
+
+    ::close(m_outgoing.fd);
+    m_outgoing = Outgoing();
+
+    startOutgoing();
+}
+
+void XWaylandSelection::selectionChanged()
+{
+    if (m_window == XCB_WINDOW_NONE)
+        return;
+
+    // Selection bridged from X11 to begin with
+    if (m_dataDeviceManager->selectionProvider() == this)
+        return;
+
+    if (m_dataDeviceManager->currentSelectionSource()) {
+        claimClipboard();
+    } else if (m_ownsClipboard) {
+        xcb_set_selection_owner(Xcb::connection(), XCB_WINDOW_NONE,
+                                atoms()->clipboard, XCB_TIME_CURRENT_TIME);
+        m_ownsClipboard = false;
+        xcb_flush(Xcb::connection());
+    }
+}
+
+void XWaylandSelection::abortIncoming()
+{
+    if (m_incoming.fd == -1)
+        return;
+
+    qCDebug(XWAYLAND) << "Aborting selection transfer from X11, target"
+                      << m_incoming.target;
+
+    // Moves on to the next request
+    finishIncoming();
+}
+
+void XWaylandSelection::abortOutgoing()
+{
+    if (m_outgoing.fd == -1)
+        return;
+
+    qCDebug(XWAYLAND) << "Aborting selection transfer to X11 window"
+                      << m_outgoing.request.requestor;
+
+    // Requestor is still waiting for an answer
+    if (!m_outgoing.incr)
+        sendNotify(&m_outgoing.request, XCB_ATOM_NONE);
+
+    finishOutgoing();
+}
+
+}
+
+#include "moc_xwaylandselection.cpp"
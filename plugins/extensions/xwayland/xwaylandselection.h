@@ -0,0 +1,147 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini
+ *
+ * $BEGIN_LICENSE:LGPL2.1+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef XWAYLANDSELECTION_H
+#define XWAYLANDSELECTION_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+#include <waylandcompositor/wayland_wrapper/qwldatadevicemanager_p.h>
+
+#include <xcb/xcb.h>
+#include <xcb/xfixes.h>
+
+class QSocketNotifier;
+class QTimer;
+
+namespace GreenIsland {
+
+/*
+ * Bridges CLIPBOARD between X11 clients and Wayland clients.
+ *
+ * Data is never loaded in memory as a whole: X11 selections are read
+ * one property at a time and written to the Wayland client before the
+ * next INCR chunk is requested, Wayland selections are read one chunk
+ * at a time and handed over to X11 with the INCR protocol when they
+ * don't fit in a single request.
+ */
+class XWaylandSelection : public QObject, public QtWayland::SelectionProvider
+{
+    Q_OBJECT
+public:
+    XWaylandSelection(QtWayland::DataDeviceManager *dataDeviceManager,
+                      QObject *parent = 0);
+    ~XWaylandSelection();
+
+    void start();
+
+    bool handleEvent(xcb_generic_event_t *event);
+
+    QStringList mimeTypes() const Q_DECL_OVERRIDE;
+    void send(const QString &mimeType, int fd) Q_DECL_OVERRIDE;
+
+private:
+    // X11 selection requested by a Wayland client
+    struct Incoming {
+        Incoming() : fd(-1), target(XCB_ATOM_NONE), incr(false), reply(0), offset(0) {}
+
+        int fd;
+        xcb_atom_t target;
+        bool incr;
+        xcb_get_property_reply_t *reply;
+        int offset;
+    };
+
+    // Wayland selection requested by an X11 client
+    struct Outgoing {
+        Outgoing() : fd(-1), incr(false), eof(false), waiting(false), selectedPropertyChange(false) {}
+
+        int fd;
+        xcb_selection_request_event_t request;
+        bool incr;
+        bool eof;
+        bool waiting;
+        bool selectedPropertyChange;
+        QByteArray chunk;
+    };
+
+    QtWayland::DataDeviceManager *m_dataDeviceManager;
+
+    xcb_window_t m_window;
+    xcb_timestamp_t m_timestamp;
+    xcb_timestamp_t m_ownerTimestamp;
+    bool m_ownsClipboard;
+    int m_chunkSize;
+
+    QStringList m_mimeTypes;
+    QHash<QString, xcb_atom_t> m_sourceTargets;
+    QHash<xcb_atom_t, QString> m_clientTargets;
+
+    QList<QPair<QString, int> > m_pendingIncoming;
+    Incoming m_incoming;
+    QSocketNotifier *m_writeNotifier;
+    QTimer *m_incomingTimeout;
+
+    QList<xcb_selection_request_event_t> m_pendingOutgoing;
+    Outgoing m_outgoing;
+    QSocketNotifier *m_readNotifier;
+    QTimer *m_outgoingTimeout;
+
+    void handleXFixesSelectionNotify(xcb_xfixes_selection_notify_event_t *event);
+    void handleSelectionNotify(xcb_selection_notify_event_t *event);
+    bool handleSelectionPropertyNotify(xcb_property_notify_event_t *event);
+    void handleSelectionRequest(xcb_selection_request_event_t *event);
+    void handleSelectionClear(xcb_selection_clear_event_t *event);
+
+    void readTargets();
+    void readData();
+    void startIncoming();
+    void finishIncoming();
+    void clearIncoming();
+
+    void claimClipboard();
+    void sendTargets(xcb_selection_request_event_t *request);
+    void sendTimestamp(xcb_selection_request_event_t *request);
+    void sendNotify(xcb_selection_request_event_t *request, xcb_atom_t property);
+    void startOutgoing();
+    void flushOutgoing();
+    void finishOutgoing();
+
+private Q_SLOTS:
+    void selectionChanged();
+    void writeIncoming();
+    void abortIncoming();
+    void readOutgoing();
+    void abortOutgoing();
+};
+
+}
+
+#endif // XWAYLANDSELECTION_H
@@ -69,13 +69,47 @@
 
 namespace GreenIsland {
 
+// Decoding type of each property we keep track of, none for the others
+static xcb_atom_t propertyType(xcb_atom_t atom)
+{
+    Xcb::Atoms *atoms = Xcb::resources()->atoms;
+
+    switch (atom) {
+    case XCB_ATOM_WM_CLASS:
+    case XCB_ATOM_WM_NAME:
+        return XCB_ATOM_STRING;
+    case XCB_ATOM_WM_TRANSIENT_FOR:
+        return XCB_ATOM_WINDOW;
+    default:
+        break;
+    }
+
+    if (atom == atoms->wm_protocols)
+        return TYPE_WM_PROTOCOLS;
+    if (atom == atoms->wm_normal_hints)
+        return TYPE_WM_NORMAL_HINTS;
+    if (atom == atoms->net_wm_state)
+        return TYPE_NET_WM_STATE;
+    if (atom == atoms->net_wm_window_type)
+        return XCB_ATOM_ATOM;
+    if (atom == atoms->net_wm_name)
+        return XCB_ATOM_STRING;
+    if (atom == atoms->net_wm_pid)
+        return XCB_ATOM_CARDINAL;
+    if (atom == atoms->motif_wm_hints)
+        return TYPE_MOTIF_WM_HINTS;
+    if (atom == atoms->wm_client_machine)
+        return XCB_ATOM_WM_CLIENT_MACHINE;
+
+    return XCB_ATOM_NONE;
+}
+
 XWaylandWindow::XWaylandWindow(xcb_window_t window, const QRect &geometry,
                                bool overrideRedirect, XWaylandManager *parent)
     : QObject(parent)
     , m_wm(parent)
     , m_window(window)
     , m_geometry(geometry)
-    , m_propsDirty(true)
     , m_overrideRedirect(overrideRedirect)
     , m_decorated(false)
     , m_transientFor(Q_NULLPTR)
@@ -100,6 +134,21 @@ XWaylandWindow::XWaylandWindow(xcb_window_t window, const QRect &geometry,
     xcb_change_window_attributes(Xcb::connection(), window,
                                  XCB_CW_EVENT_MASK, values);
 
+    // Fill the property cache, replies are collected later
+    // without blocking
+    Xcb::Atoms *atoms = Xcb::resources()->atoms;
+    const xcb_atom_t properties[] = {
+        XCB_ATOM_WM_CLASS, XCB_ATOM_WM_NAME, XCB_ATOM_WM_TRANSIENT_FOR,
+        atoms->wm_protocols, atoms->wm_normal_hints, atoms->net_wm_state,
+        atoms->net_wm_window_type, atoms->net_wm_name, atoms->net_wm_pid,
+        atoms->motif_wm_hints, atoms->wm_client_machine
+    };
+    for (uint i = 0; i < sizeof(properties) / sizeof(properties[0]); ++i)
+        fetchProperty(properties[i]);
+    m_decorated = !m_overrideRedirect;
+    m_sizeHints.flags = 0;
+    m_motifHints.flags = 0;
+
     xcb_get_geometry_reply_t *reply =
             xcb_get_geometry_reply(Xcb::connection(), cookie, Q_NULLPTR);
     if (reply)
@@ -109,6 +158,7 @@ XWaylandWindow::XWaylandWindow(xcb_window_t window, const QRect &geometry,
     free(reply);
 
     m_wm->addWindow(window, this);
+    m_wm->schedulePropertyFetch(this);
 }
 
 XWaylandWindow::~XWaylandWindow()
@@ -125,6 +175,11 @@ XWaylandWindow::~XWaylandWindow()
 
     setSurface(Q_NULLPTR);
 
+    QHash<xcb_atom_t, xcb_get_property_cookie_t>::const_iterator it;
+    for (it = m_pendingProperties.constBegin(); it != m_pendingProperties.constEnd(); ++it)
+        xcb_discard_reply(Xcb::connection(), it.value().sequence);
+    m_wm->cancelPropertyFetch(this);
+
     m_wm->removeWindow(m_window);
 }
 
@@ -162,9 +217,8 @@ void XWaylandWindow::setSurface(QWaylandSurface *surface)
         m_surfaceInterface->deleteLater();
     m_surfaceInterface = new XWaylandSurface(this);
 
-    // Read and set properties
-    readProperties();
-    setProperties();
+    // Set properties, from the cache unless still in flight
+    waitForProperties();
 
     // Move the window
     m_surfaceInterface->clientWindow()->setPosition(m_properties.pos);
@@ -227,74 +281,162 @@ void XWaylandWindow::setWorkspace(int workspace)
     }
 }
 
-void XWaylandWindow::readProperties()
+/*
+ * Property values are cached on the window: all of them are requested
+ * when the window is created, afterwards only those that change are
+ * fetched again.  Replies are collected from the event loop without
+ * blocking, see processPropertyReplies().
+ */
+void XWaylandWindow::propertyChanged(xcb_atom_t atom, bool deleted)
 {
-    if (!m_propsDirty)
+    if (propertyType(atom) == XCB_ATOM_NONE) {
+        if (!deleted)
+            readAndDumpProperty(atom);
         return;
-    m_propsDirty = false;
-
-    QMap<xcb_atom_t, xcb_atom_t> props;
-    props[XCB_ATOM_WM_CLASS] = XCB_ATOM_STRING;
-    props[XCB_ATOM_WM_NAME] = XCB_ATOM_STRING;
-    props[XCB_ATOM_WM_TRANSIENT_FOR] = XCB_ATOM_WINDOW;
-    props[Xcb::resources()->atoms->wm_protocols] = TYPE_WM_PROTOCOLS;
-    props[Xcb::resources()->atoms->wm_normal_hints] = TYPE_WM_NORMAL_HINTS;
-    props[Xcb::resources()->atoms->net_wm_state] = TYPE_NET_WM_STATE;
-    props[Xcb::resources()->atoms->net_wm_window_type] = XCB_ATOM_ATOM;
-    props[Xcb::resources()->atoms->net_wm_name] = XCB_ATOM_STRING;
-    props[Xcb::resources()->atoms->net_wm_pid] = XCB_ATOM_CARDINAL;
-    props[Xcb::resources()->atoms->motif_wm_hints] = TYPE_MOTIF_WM_HINTS;
-    props[Xcb::resources()->atoms->wm_client_machine] = XCB_ATOM_WM_CLIENT_MACHINE;
-
-    QMap<xcb_atom_t, xcb_get_property_cookie_t> cookies;
-    Q_FOREACH (xcb_atom_t atom, props.keys()) {
-        xcb_get_property_cookie_t cookie = xcb_get_property(
-                    Xcb::connection(), 0, m_window, atom, XCB_ATOM_ANY, 0, 2048);
-        cookies[atom] = cookie;
     }
 
-    m_decorated = !m_overrideRedirect;
-    m_sizeHints.flags = 0;
-    m_motifHints.flags = 0;
-    m_properties.deleteWindow = 0;
+    m_dirtyProperties.remove(atom);
 
-    Q_FOREACH (xcb_atom_t atom, props.keys()) {
-        xcb_get_property_reply_t *reply =
-                xcb_get_property_reply(Xcb::connection(), cookies[atom], Q_NULLPTR);
-        if (!reply)
-            // Bad window, usually
-            continue;
-        if (reply->type == XCB_ATOM_NONE) {
-            // No such property
-            free(reply);
-            continue;
+    if (deleted) {
+        // Whatever is in flight is out of date already
+        if (m_pendingProperties.contains(atom))
+            xcb_discard_reply(Xcb::connection(), m_pendingProperties.take(atom).sequence);
+
+        if (updateProperty(atom, Q_NULLPTR)) {
+            setProperties();
+            repaint();
         }
+        return;
+    }
 
-        void *p = decodeProperty(props[atom], reply);
-        dumpProperty(atom, reply);
+    // Fetched once per event batch, no matter how many times it changed
+    m_dirtyProperties.insert(atom);
+    m_wm->schedulePropertyFetch(this);
+}
+
+bool XWaylandWindow::processPropertyReplies()
+{
+    fetchDirtyProperties();
+
+    bool surfaceChanged = false;
 
-        switch (atom) {
-        case XCB_ATOM_WM_CLASS:
-            m_properties.appId = QString::fromUtf8((char *)p);
-            free(p);
-            break;
-        case XCB_ATOM_WM_NAME:
-            m_properties.title = QString::fromUtf8((char *)p);
-            free(p);
-            break;
-        case XCB_ATOM_WM_TRANSIENT_FOR:
-            m_transientFor = (XWaylandWindow *)p;
-            break;
-        default:
-            break;
+    QHash<xcb_atom_t, xcb_get_property_cookie_t>::iterator it = m_pendingProperties.begin();
+    while (it != m_pendingProperties.end()) {
+        void *reply = Q_NULLPTR;
+        xcb_generic_error_t *error = Q_NULLPTR;
+        if (!xcb_poll_for_reply(Xcb::connection(), it.value().sequence, &reply, &error)) {
+            ++it;
+            continue;
         }
 
+        const xcb_atom_t atom = it.key();
+        it = m_pendingProperties.erase(it);
+
+        // Errors usually mean the window is gone already
+        free(error);
+        if (updateProperty(atom, (xcb_get_property_reply_t *)reply))
+            surfaceChanged = true;
+        free(reply);
+    }
+
+    if (surfaceChanged) {
+        setProperties();
+        repaint();
+    }
+
+    return !m_pendingProperties.isEmpty();
+}
+
+void XWaylandWindow::waitForProperties()
+{
+    // Usually all the replies are in by the time the window is mapped
+    fetchDirtyProperties();
+
+    QHash<xcb_atom_t, xcb_get_property_cookie_t>::const_iterator it;
+    for (it = m_pendingProperties.constBegin(); it != m_pendingProperties.constEnd(); ++it) {
+        xcb_get_property_reply_t *reply =
+                xcb_get_property_reply(Xcb::connection(), it.value(), Q_NULLPTR);
+        updateProperty(it.key(), reply);
         free(reply);
     }
+    m_pendingProperties.clear();
 
     setProperties();
 }
 
+void XWaylandWindow::fetchProperty(xcb_atom_t atom)
+{
+    // A fetch in flight is superseded by the new one
+    if (m_pendingProperties.contains(atom))
+        xcb_discard_reply(Xcb::connection(), m_pendingProperties.value(atom).sequence);
+
+    xcb_get_property_cookie_t cookie = xcb_get_property(
+                Xcb::connection(), 0, m_window, atom, XCB_ATOM_ANY, 0, 2048);
+    m_pendingProperties.insert(atom, cookie);
+}
+
+void XWaylandWindow::fetchDirtyProperties()
+{
+    Q_FOREACH (xcb_atom_t atom, m_dirtyProperties)
+        fetchProperty(atom);
+    m_dirtyProperties.clear();
+}
+
+bool XWaylandWindow::updateProperty(xcb_atom_t atom, xcb_get_property_reply_t *reply)
+{
+    Xcb::Atoms *atoms = Xcb::resources()->atoms;
+
+    // Reset what the property contributes, a missing
+    // reply or value means it was deleted
+    if (atom == XCB_ATOM_WM_TRANSIENT_FOR) {
+        m_transientFor = Q_NULLPTR;
+    } else if (atom == atoms->wm_protocols) {
+        m_properties.deleteWindow = 0;
+    } else if (atom == atoms->wm_normal_hints) {
+        m_sizeHints.flags = 0;
+    } else if (atom == atoms->net_wm_state) {
+        m_properties.fullscreen = 0;
+        m_properties.maximizedHorizontally = 0;
+        m_properties.maximizedVertically = 0;
+    } else if (atom == atoms->motif_wm_hints) {
+        m_motifHints.flags = 0;
+        m_decorated = !m_overrideRedirect;
+    }
+
+    const bool hasValue = reply && reply->type != XCB_ATOM_NONE;
+    const xcb_atom_t type = propertyType(atom);
+    void *p = Q_NULLPTR;
+    if (hasValue) {
+        p = decodeProperty(type, reply);
+        dumpProperty(atom, reply);
+    }
+
+    bool surfaceChanged = false;
+
+    if (atom == XCB_ATOM_WM_CLASS) {
+        m_properties.appId = QString::fromUtf8((char *)p);
+        surfaceChanged = true;
+    } else if (atom == XCB_ATOM_WM_NAME) {
+        m_properties.wmName = QString::fromUtf8((char *)p);
+        surfaceChanged = true;
+    } else if (atom == atoms->net_wm_name) {
+        m_properties.netWmName = QString::fromUtf8((char *)p);
+        surfaceChanged = true;
+    } else if (atom == XCB_ATOM_WM_TRANSIENT_FOR) {
+        m_transientFor = (XWaylandWindow *)p;
+    }
+
+    if (type == XCB_ATOM_STRING || type == XCB_ATOM_WM_CLIENT_MACHINE)
+        free(p);
+
+    // _NET_WM_NAME is UTF-8 and takes precedence over WM_NAME
+    if (surfaceChanged)
+        m_properties.title = m_properties.netWmName.isEmpty()
+                ? m_properties.wmName : m_properties.netWmName;
+
+    return surfaceChanged;
+}
+
 void XWaylandWindow::setProperties()
 {
     if (!m_surfaceInterface)
@@ -306,6 +448,10 @@ void XWaylandWindow::setProperties()
 
 void XWaylandWindow::readAndDumpProperty(xcb_atom_t atom)
 {
+    // Round trip only worth it when tracing
+    if (!XWAYLAND_TRACE().isDebugEnabled())
+        return;
+
     xcb_get_property_cookie_t cookie =
             xcb_get_property(Xcb::connection(), 0, m_window,
                              atom, XCB_ATOM_ANY, 0, 2048);
@@ -381,6 +527,10 @@ xcb_window_t XWaylandWindow::window() const
 
 void XWaylandWindow::dumpProperty(xcb_atom_t property, xcb_get_property_reply_t *reply)
 {
+    // Resolving atom names costs a round trip each
+    if (!XWAYLAND_TRACE().isDebugEnabled())
+        return;
+
     QString buffer = QString("\tProperty %1 (window %2): ")
             .arg(Xcb::Atom::nameFromAtom(property))
             .arg(m_window);
@@ -453,16 +603,15 @@ void *XWaylandWindow::decodeProperty(xcb_atom_t type, xcb_get_property_reply_t *
                sizeof m_sizeHints);
         break;
     case TYPE_NET_WM_STATE: {
-        m_properties.fullscreen = 0;
         xcb_atom_t *value = (xcb_atom_t *)xcb_get_property_value(reply);
-        uint32_t i;
-        for (i = 0; i < reply->value_len; i++)
+        for (uint32_t i = 0; i < reply->value_len; i++) {
             if (value[i] == Xcb::resources()->atoms->net_wm_state_fullscreen)
                 m_properties.fullscreen = 1;
-        if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_horz)
-            m_properties.maximizedHorizontally = 1;
-        if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_vert)
-            m_properties.maximizedVertically = 1;
+            else if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_horz)
+                m_properties.maximizedHorizontally = 1;
+            else if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_vert)
+                m_properties.maximizedVertically = 1;
+        }
         break;
     }
     case TYPE_MOTIF_WM_HINTS:
@@ -27,8 +27,10 @@
 #ifndef XWAYLANDWINDOW_H
 #define XWAYLANDWINDOW_H
 
+#include <QtCore/QHash>
 #include <QtCore/QRect>
 #include <QtCore/QPointer>
+#include <QtCore/QSet>
 #include <GreenIsland/Compositor/QWaylandSurface>
 
 #include <xcb/xcb.h>
@@ -102,7 +104,9 @@ public:
 
     void setWorkspace(int workspace);
 
-    void readProperties();
+    void propertyChanged(xcb_atom_t atom, bool deleted);
+    bool processPropertyReplies();
+    void waitForProperties();
     void setProperties();
 
     void readAndDumpProperty(xcb_atom_t atom);
@@ -122,7 +126,6 @@ private:
     XWaylandManager *m_wm;
     xcb_window_t m_window;
     QRect m_geometry;
-    bool m_propsDirty;
     bool m_overrideRedirect;
     bool m_hasAlpha;
     bool m_decorated;
@@ -138,6 +141,8 @@ private:
 
     struct WindowProperties {
         QString title;
+        QString wmName;
+        QString netWmName;
         QString appId;
         QPoint pos;
         QSize size;
@@ -150,6 +155,14 @@ private:
 
     WindowProperties m_properties;
 
+    // Properties changed since the last fetch and fetches in flight
+    QSet<xcb_atom_t> m_dirtyProperties;
+    QHash<xcb_atom_t, xcb_get_property_cookie_t> m_pendingProperties;
+
+    void fetchProperty(xcb_atom_t atom);
+    void fetchDirtyProperties();
+    bool updateProperty(xcb_atom_t atom, xcb_get_property_reply_t *reply);
+
     void dumpProperty(xcb_atom_t property, xcb_get_property_reply_t *reply);
     void *decodeProperty(xcb_atom_t type, xcb_get_property_reply_t *reply);
 
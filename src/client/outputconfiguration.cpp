@@ -100,6 +100,21 @@ void OutputConfiguration::setScaleFactor(Output *output, qint32 scaleFactor)
     d->scale(wlOutput, scaleFactor);
 }
 
+void OutputConfiguration::setCloneSource(Output *output, Output *source)
+{
+    Q_D(OutputConfiguration);
+
+    // Mirroring was introduced with version 2
+    if (wl_proxy_get_version(reinterpret_cast<wl_proxy *>(d->object())) < 2) {
+        qWarning("Output mirroring is not supported by the compositor");
+        return;
+    }
+
+    auto wlOutput = OutputPrivate::get(output)->object();
+    auto wlSource = source ? OutputPrivate::get(source)->object() : Q_NULLPTR;
+    d->clone(wlOutput, wlSource);
+}
+
 void OutputConfiguration::apply()
 {
     Q_D(OutputConfiguration);
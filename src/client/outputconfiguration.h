@@ -50,6 +50,7 @@ public:
     void setTransform(Output *output, Output::Transform transform);
     void setPosition(Output *output, const QPoint &position);
     void setScaleFactor(Output *output, qint32 scaleFactor);
+    void setCloneSource(Output *output, Output *source);
 
     void apply();
 
@@ -46,6 +46,8 @@
 #include "seat_p.h"
 #include "shm.h"
 #include "shm_p.h"
+#include "subcompositor.h"
+#include "subcompositor_p.h"
 #include "qwayland-fullscreen-shell-unstable-v1.h"
 
 #include <wayland-client.h>
@@ -79,6 +81,8 @@ static Registry::Interface nameToInterface(const char *interface)
         return Registry::SeatInterface;
     else if (strcmp(interface, "wl_shm") == 0)
         return Registry::ShmInterface;
+    else if (strcmp(interface, "wl_subcompositor") == 0)
+        return Registry::SubCompositorInterface;
     return Registry::UnknownInterface;
 }
 
@@ -101,6 +105,8 @@ static const wl_interface *wlInterface(Registry::Interface interface)
         return &wl_seat_interface;
     case Registry::ShmInterface:
         return &wl_shm_interface;
+    case Registry::SubCompositorInterface:
+        return &wl_subcompositor_interface;
     default:
         break;
     }
@@ -181,6 +187,9 @@ void RegistryPrivate::handleAnnounce(const char *interface, quint32 name, quint3
     case Registry::ShmInterface:
         Q_EMIT q->shmAnnounced(name, version);
         break;
+    case Registry::SubCompositorInterface:
+        Q_EMIT q->subCompositorAnnounced(name, version);
+        break;
     default:
         break;
     }
@@ -221,6 +230,9 @@ void RegistryPrivate::handleRemove(quint32 name)
             case Registry::ShmInterface:
                 Q_EMIT q->shmRemoved(name);
                 break;
+            case Registry::SubCompositorInterface:
+                Q_EMIT q->subCompositorRemoved(name);
+                break;
             default:
                 break;
             }
@@ -357,6 +369,14 @@ Shm *Registry::createShm(quint32 name, quint32 version, QObject *parent)
     return shm;
 }
 
+SubCompositor *Registry::createSubCompositor(quint32 name, quint32 version, QObject *parent)
+{
+    Q_D(Registry);
+    SubCompositor *subCompositor = new SubCompositor(parent);
+    SubCompositorPrivate::get(subCompositor)->init(d->registry, name, version);
+    return subCompositor;
+}
+
 OutputManagement *Registry::createOutputManagement(quint32 name, quint32 version, QObject *parent)
 {
     Q_D(Registry);
@@ -50,6 +50,7 @@ class Screencaster;
 class Screenshooter;
 class Seat;
 class Shm;
+class SubCompositor;
 
 class GREENISLANDCLIENT_EXPORT Registry : public QObject
 {
@@ -65,7 +66,8 @@ public:
         ScreencasterInterface,
         ScreenshooterInterface,
         SeatInterface,
-        ShmInterface
+        ShmInterface,
+        SubCompositorInterface
     };
     Q_ENUM(Interface)
 
@@ -83,6 +85,7 @@ public:
     Output *createOutput(quint32 name, quint32 version, QObject *parent = Q_NULLPTR);
     Seat *createSeat(quint32 name, quint32 version, QObject *parent = Q_NULLPTR);
     Shm *createShm(quint32 name, quint32 version, QObject *parent = Q_NULLPTR);
+    SubCompositor *createSubCompositor(quint32 name, quint32 version, QObject *parent = Q_NULLPTR);
 
     OutputManagement *createOutputManagement(quint32 name, quint32 version,
                                              QObject *parent = Q_NULLPTR);
@@ -116,6 +119,9 @@ Q_SIGNALS:
     void shmAnnounced(quint32 name, quint32 version);
     void shmRemoved(quint32 name);
 
+    void subCompositorAnnounced(quint32 name, quint32 version);
+    void subCompositorRemoved(quint32 name);
+
     void outputManagementAnnounced(quint32 name, quint32 version);
     void outputManagementRemoved(quint32 name);
 
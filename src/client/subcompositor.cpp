@@ -0,0 +1,81 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "subcompositor.h"
+#include "subcompositor_p.h"
+#include "subsurface.h"
+#include "subsurface_p.h"
+#include "surface.h"
+#include "surface_p.h"
+
+namespace GreenIsland {
+
+namespace Client {
+
+/*
+ * SubCompositorPrivate
+ */
+
+SubCompositorPrivate::SubCompositorPrivate()
+    : QtWayland::wl_subcompositor()
+{
+}
+
+/*
+ * SubCompositor
+ */
+
+SubCompositor::SubCompositor(QObject *parent)
+    : QObject(*new SubCompositorPrivate(), parent)
+{
+}
+
+SubSurface *SubCompositor::createSubSurface(Surface *surface, Surface *parentSurface,
+                                            QObject *parent)
+{
+    Q_D(SubCompositor);
+
+    if (!d->isInitialized())
+        return Q_NULLPTR;
+
+    SubSurface *subSurface = new SubSurface(surface, parentSurface, parent);
+    SubSurfacePrivate::get(subSurface)->init(
+                d->get_subsurface(SurfacePrivate::get(surface)->object(),
+                                  SurfacePrivate::get(parentSurface)->object()));
+    return subSurface;
+}
+
+QByteArray SubCompositor::interfaceName()
+{
+    return QByteArrayLiteral("wl_subcompositor");
+}
+
+} // namespace Client
+
+} // namespace GreenIsland
+
+#include "moc_subcompositor.cpp"
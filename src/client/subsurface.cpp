@@ -0,0 +1,140 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "subsurface.h"
+#include "subsurface_p.h"
+#include "surface.h"
+#include "surface_p.h"
+
+namespace GreenIsland {
+
+namespace Client {
+
+/*
+ * SubSurfacePrivate
+ */
+
+SubSurfacePrivate::SubSurfacePrivate()
+    : QtWayland::wl_subsurface()
+    , surface(Q_NULLPTR)
+    , parentSurface(Q_NULLPTR)
+    , synchronized(true)
+{
+}
+
+/*
+ * SubSurface
+ */
+
+SubSurface::SubSurface(Surface *surface, Surface *parentSurface, QObject *parent)
+    : QObject(*new SubSurfacePrivate(), parent)
+{
+    Q_D(SubSurface);
+    d->surface = surface;
+    d->parentSurface = parentSurface;
+}
+
+SubSurface::~SubSurface()
+{
+    Q_D(SubSurface);
+
+    // Unmaps the surface, which can then be reused
+    if (d->isInitialized())
+        d->destroy();
+}
+
+Surface *SubSurface::surface() const
+{
+    Q_D(const SubSurface);
+    return d->surface;
+}
+
+Surface *SubSurface::parentSurface() const
+{
+    Q_D(const SubSurface);
+    return d->parentSurface;
+}
+
+QPoint SubSurface::position() const
+{
+    Q_D(const SubSurface);
+    return d->position;
+}
+
+void SubSurface::setPosition(const QPoint &position)
+{
+    Q_D(SubSurface);
+
+    if (d->position == position)
+        return;
+
+    d->position = position;
+    d->set_position(position.x(), position.y());
+}
+
+void SubSurface::placeAbove(Surface *sibling)
+{
+    Q_D(SubSurface);
+    d->place_above(SurfacePrivate::get(sibling)->object());
+}
+
+void SubSurface::placeBelow(Surface *sibling)
+{
+    Q_D(SubSurface);
+    d->place_below(SurfacePrivate::get(sibling)->object());
+}
+
+bool SubSurface::isSynchronized() const
+{
+    Q_D(const SubSurface);
+    return d->synchronized;
+}
+
+void SubSurface::setSynchronized(bool synchronized)
+{
+    Q_D(SubSurface);
+
+    if (d->synchronized == synchronized)
+        return;
+
+    d->synchronized = synchronized;
+    if (synchronized)
+        d->set_sync();
+    else
+        d->set_desync();
+}
+
+QByteArray SubSurface::interfaceName()
+{
+    return QByteArrayLiteral("wl_subsurface");
+}
+
+} // namespace Client
+
+} // namespace GreenIsland
+
+#include "moc_subsurface.cpp"
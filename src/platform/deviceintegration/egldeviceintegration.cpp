@@ -333,6 +333,12 @@ void *EGLDeviceIntegration::wlDisplay() const
     return Q_NULLPTR;
 }
 
+QFunctionPointer EGLDeviceIntegration::platformFunction(const QByteArray &function) const
+{
+    Q_UNUSED(function);
+    return Q_NULLPTR;
+}
+
 } // namespace Platform
 
 } // namespace GreenIsland
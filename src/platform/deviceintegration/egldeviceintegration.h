@@ -113,6 +113,8 @@ public:
     virtual bool supportsPBuffers() const;
 
     virtual void *wlDisplay() const;
+
+    virtual QFunctionPointer platformFunction(const QByteArray &function) const;
 };
 
 class GREENISLANDPLATFORM_EXPORT EGLDeviceIntegrationPlugin : public QObject
@@ -104,8 +104,13 @@ void EglFSContext::swapBuffers(QPlatformSurface *surface)
     // draw the cursor
     if (surface->surface()->surfaceClass() == QSurface::Window) {
         QPlatformWindow *window = static_cast<QPlatformWindow *>(surface);
-        if (EglFSCursor *cursor = qobject_cast<EglFSCursor *>(window->screen()->cursor()))
+        if (EglFSCursor *cursor = qobject_cast<EglFSCursor *>(window->screen()->cursor())) {
             cursor->paintOnScreen();
+
+            // Partial swaps must include the cursor that was just painted
+            if (!swapDamage().isEmpty())
+                setSwapDamage(swapDamage() + cursor->cursorRect().translated(-window->geometry().topLeft()));
+        }
     }
 
     egl_device_integration()->waitForVSync(surface);
@@ -34,6 +34,8 @@
 #include "eglfscursor.h"
 #include "eglfsintegration.h"
 #include "eglfsscreen.h"
+#include "programbinarycache.h"
+#include "platformcompositor/openglcompositor.h"
 
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
@@ -135,12 +137,20 @@ void EglFSCursor::createShaderPrograms()
             "   gl_FragColor = texture2D(texture, textureCoord).bgra;\n"
             "}\n";
 
+    static const char *const attributeNames[] = { "vertexCoordEntry", "textureCoordEntry", 0 };
+
+    const QByteArray key = ProgramBinaryCache::cacheKey(textureVertexProgram, textureFragmentProgram,
+                                                        attributeNames);
+
     m_program = new QOpenGLShaderProgram;
-    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, textureVertexProgram);
-    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, textureFragmentProgram);
-    m_program->bindAttributeLocation("vertexCoordEntry", 0);
-    m_program->bindAttributeLocation("textureCoordEntry", 1);
-    m_program->link();
+    if (!ProgramBinaryCache::load(m_program, key)) {
+        m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, textureVertexProgram);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, textureFragmentProgram);
+        for (int i = 0; attributeNames[i]; i++)
+            m_program->bindAttributeLocation(attributeNames[i], i);
+        m_program->link();
+        ProgramBinaryCache::save(m_program, key);
+    }
 
     m_textureEntry = m_program->uniformLocation("texture");
 }
@@ -263,6 +273,16 @@ bool EglFSCursor::event(QEvent *e)
     if (e->type() == QEvent::User + 1) {
         CursorUpdateEvent *ev = static_cast<CursorUpdateEvent *>(e);
         m_updateRequested = false;
+
+        // The cursor is painted on top of the composited windows, the
+        // compositor has to restore what was under it; nothing to do
+        // when no compositor was ever created
+        if (OpenGLCompositor::hasInstance()) {
+            OpenGLCompositor *compositor = OpenGLCompositor::instance();
+            if (compositor->targetWindow())
+                compositor->update(ev->region().translated(-m_screen->geometry().topLeft()));
+        }
+
         QWindowSystemInterface::handleExposeEvent(m_screen->topLevelAt(ev->pos()), ev->region());
         QWindowSystemInterface::flushWindowSystemEvents(QEventLoop::ExcludeUserInputEvents);
         return true;
@@ -0,0 +1,258 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:QTLGPL$
+ *
+ * GNU Lesser General Public License Usage
+ * This file may be used under the terms of the GNU Lesser General
+ * Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.LGPLv3 included in the
+ * packaging of this file. Please review the following information to
+ * ensure the GNU Lesser General Public License version 3 requirements
+ * will be met: https://www.gnu.org/licenses/lgpl.html.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 2.0 or (at your option) the GNU General
+ * Public license version 3 or any later version approved by the KDE Free
+ * Qt Foundation. The licenses are as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 and LICENSE.GPLv3
+ * included in the packaging of this file. Please review the following
+ * information to ensure the GNU General Public License requirements will
+ * be met: https://www.gnu.org/licenses/gpl-2.0.html and
+ * https://www.gnu.org/licenses/gpl-3.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef GREENISLAND_EGLFSFUNCTIONS_H
+#define GREENISLAND_EGLFSFUNCTIONS_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+#include <QtGui/QGuiApplication>
+
+class QOpenGLShaderProgram;
+class QScreen;
+class QWindow;
+
+namespace GreenIsland {
+
+namespace Platform {
+
+/*
+ * Functions exposed by the eglfs platform plugin through
+ * QGuiApplication::platformFunction().
+ *
+ * This header is self contained, users don't need to link to the
+ * platform library.
+ */
+class EglFSFunctions
+{
+public:
+    /*
+     * Timing of the last frame that reached the screen, as reported
+     * by the display server: UST in microseconds on CLOCK_MONOTONIC,
+     * the media stream counter and the measured refresh interval.
+     */
+    struct Presentation {
+        Presentation() : ust(0), msc(0), refreshNsec(0) {}
+
+        quint64 ust;
+        quint64 msc;
+        quint32 refreshNsec;
+    };
+
+    typedef bool (*LastPresentationType)(QWindow *window, Presentation *presentation);
+    static QByteArray lastPresentationIdentifier() { return QByteArrayLiteral("EglFSLastPresentation"); }
+
+    static bool lastPresentation(QWindow *window, Presentation *presentation)
+    {
+        LastPresentationType func = reinterpret_cast<LastPresentationType>(
+                    QGuiApplication::platformFunction(lastPresentationIdentifier()));
+        return func && func(window, presentation);
+    }
+
+    typedef void (*PresentationCallback)(const Presentation &presentation, void *data);
+    typedef bool (*SetPresentationCallbackType)(QScreen *screen, PresentationCallback callback, void *data);
+    static QByteArray setPresentationCallbackIdentifier() { return QByteArrayLiteral("EglFSSetPresentationCallback"); }
+
+    /*
+     * Be told about each frame as soon as it reaches the screen.
+     * The callback runs on whatever thread handles the page flip,
+     * usually the render thread, and must not block.
+     * Passing a null callback removes it, once this returns the
+     * previous callback is not running anymore.
+     * Returns false when the screen doesn't report page flips.
+     */
+    static bool setPresentationCallback(QScreen *screen, PresentationCallback callback, void *data)
+    {
+        SetPresentationCallbackType func = reinterpret_cast<SetPresentationCallbackType>(
+                    QGuiApplication::platformFunction(setPresentationCallbackIdentifier()));
+        return func && func(screen, callback, data);
+    }
+
+    typedef bool (*SetScanoutCloneType)(QScreen *screen, QScreen *source);
+    static QByteArray setScanoutCloneIdentifier() { return QByteArrayLiteral("EglFSSetScanoutClone"); }
+
+    /*
+     * Make the screen scan out the very same buffers as the source
+     * screen, without rendering anything for it.  Passing a null
+     * source restores independent scan out.
+     * Returns false when the hardware cannot do it, for example
+     * because the modes differ, and the caller has to copy the
+     * contents itself.
+     */
+    static bool setScanoutClone(QScreen *screen, QScreen *source)
+    {
+        SetScanoutCloneType func = reinterpret_cast<SetScanoutCloneType>(
+                    QGuiApplication::platformFunction(setScanoutCloneIdentifier()));
+        return func && func(screen, source);
+    }
+
+    typedef bool (*AdaptiveSyncRangeType)(QScreen *screen, qreal *minimumRate, qreal *maximumRate);
+    static QByteArray adaptiveSyncRangeIdentifier() { return QByteArrayLiteral("EglFSAdaptiveSyncRange"); }
+
+    /*
+     * Refresh rates the screen can vary between with adaptive sync.
+     * Returns false when the screen or the driver cannot do it.
+     */
+    static bool adaptiveSyncRange(QScreen *screen, qreal *minimumRate, qreal *maximumRate)
+    {
+        AdaptiveSyncRangeType func = reinterpret_cast<AdaptiveSyncRangeType>(
+                    QGuiApplication::platformFunction(adaptiveSyncRangeIdentifier()));
+        return func && func(screen, minimumRate, maximumRate);
+    }
+
+    typedef bool (*SetAdaptiveSyncType)(QScreen *screen, bool enabled);
+    static QByteArray setAdaptiveSyncIdentifier() { return QByteArrayLiteral("EglFSSetAdaptiveSync"); }
+
+    /*
+     * Let the screen flip as soon as a frame is ready instead of
+     * waiting for a fixed vblank.  It takes effect with the next flip.
+     */
+    static bool setAdaptiveSync(QScreen *screen, bool enabled)
+    {
+        SetAdaptiveSyncType func = reinterpret_cast<SetAdaptiveSyncType>(
+                    QGuiApplication::platformFunction(setAdaptiveSyncIdentifier()));
+        return func && func(screen, enabled);
+    }
+
+    /*
+     * Color pipeline of a screen, applied by the display hardware
+     * after composition: a degamma LUT, a color transform matrix and
+     * a gamma LUT.  Sizes are the number of entries of each LUT.
+     */
+    enum ColorPipelineStage {
+        DegammaStage = 0x1,
+        ColorTransformStage = 0x2,
+        GammaStage = 0x4
+    };
+
+    struct ColorPipeline {
+        ColorPipeline() : stages(0), degammaSize(0), gammaSize(0) {}
+
+        int stages;
+        int degammaSize;
+        int gammaSize;
+    };
+
+    typedef bool (*ColorPipelineType)(QScreen *screen, ColorPipeline *pipeline);
+    static QByteArray colorPipelineIdentifier() { return QByteArrayLiteral("EglFSColorPipeline"); }
+
+    static bool colorPipeline(QScreen *screen, ColorPipeline *pipeline)
+    {
+        ColorPipelineType func = reinterpret_cast<ColorPipelineType>(
+                    QGuiApplication::platformFunction(colorPipelineIdentifier()));
+        return func && func(screen, pipeline);
+    }
+
+    /*
+     * LUTs hold red, green and blue entries interleaved, the matrix
+     * is 3x3 in row major order.  An empty LUT or matrix bypasses
+     * that stage.
+     */
+    struct ColorCorrection {
+        QVector<quint16> degammaLut;
+        QVector<qreal> colorTransform;
+        QVector<quint16> gammaLut;
+    };
+
+    typedef bool (*SetColorCorrectionType)(QScreen *screen, const ColorCorrection &correction);
+    static QByteArray setColorCorrectionIdentifier() { return QByteArrayLiteral("EglFSSetColorCorrection"); }
+
+    /*
+     * Program the color pipeline of the screen.
+     * Returns false when a stage is not supported or a LUT doesn't
+     * match its size, in which case nothing is changed.
+     */
+    static bool setColorCorrection(QScreen *screen, const ColorCorrection &correction)
+    {
+        SetColorCorrectionType func = reinterpret_cast<SetColorCorrectionType>(
+                    QGuiApplication::platformFunction(setColorCorrectionIdentifier()));
+        return func && func(screen, correction);
+    }
+
+    typedef QByteArray (*ProgramBinaryKeyType)(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                                               const char *const *attributeNames);
+    static QByteArray programBinaryKeyIdentifier() { return QByteArrayLiteral("EglFSProgramBinaryKey"); }
+
+    /*
+     * Shader program binaries cached on disk, shared by everything
+     * running in the compositor process.  The key covers the driver
+     * of the current context, the sources and the attribute names,
+     * which are bound to their index in the null terminated list.
+     * It is empty when the current context can't store binaries.
+     */
+    static QByteArray programBinaryKey(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                                       const char *const *attributeNames = Q_NULLPTR)
+    {
+        ProgramBinaryKeyType func = reinterpret_cast<ProgramBinaryKeyType>(
+                    QGuiApplication::platformFunction(programBinaryKeyIdentifier()));
+        return func ? func(vertexSource, fragmentSource, attributeNames) : QByteArray();
+    }
+
+    typedef bool (*HasProgramBinaryType)(const QByteArray &key);
+    static QByteArray hasProgramBinaryIdentifier() { return QByteArrayLiteral("EglFSHasProgramBinary"); }
+
+    static bool hasProgramBinary(const QByteArray &key)
+    {
+        HasProgramBinaryType func = reinterpret_cast<HasProgramBinaryType>(
+                    QGuiApplication::platformFunction(hasProgramBinaryIdentifier()));
+        return func && func(key);
+    }
+
+    typedef bool (*LoadProgramBinaryType)(QOpenGLShaderProgram *program, const QByteArray &key);
+    static QByteArray loadProgramBinaryIdentifier() { return QByteArrayLiteral("EglFSLoadProgramBinary"); }
+
+    /*
+     * The program must not have shaders attached, on success it is
+     * linked.  Returns false when there's nothing usable cached and
+     * the program has to be built from source.
+     */
+    static bool loadProgramBinary(QOpenGLShaderProgram *program, const QByteArray &key)
+    {
+        LoadProgramBinaryType func = reinterpret_cast<LoadProgramBinaryType>(
+                    QGuiApplication::platformFunction(loadProgramBinaryIdentifier()));
+        return func && func(program, key);
+    }
+
+    typedef void (*SaveProgramBinaryType)(QOpenGLShaderProgram *program, const QByteArray &key);
+    static QByteArray saveProgramBinaryIdentifier() { return QByteArrayLiteral("EglFSSaveProgramBinary"); }
+
+    static void saveProgramBinary(QOpenGLShaderProgram *program, const QByteArray &key)
+    {
+        SaveProgramBinaryType func = reinterpret_cast<SaveProgramBinaryType>(
+                    QGuiApplication::platformFunction(saveProgramBinaryIdentifier()));
+        if (func)
+            func(program, key);
+    }
+};
+
+} // namespace Platform
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_EGLFSFUNCTIONS_H
@@ -30,10 +30,12 @@
 
 #include "egldeviceintegration.h"
 #include "eglfscontext.h"
+#include "eglfsfunctions.h"
 #include "eglfsintegration.h"
 #include "eglfsnativeinterface.h"
 #include "eglfsscreen.h"
 #include "eglfswindow.h"
+#include "programbinarycache.h"
 
 namespace GreenIsland {
 
@@ -177,10 +179,27 @@ QPlatformNativeInterface::NativeResourceForContextFunction EglFSNativeInterface:
     return 0;
 }
 
+static QByteArray programBinaryKey(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                                   const char *const *attributeNames)
+{
+    if (!ProgramBinaryCache::isSupported())
+        return QByteArray();
+    return ProgramBinaryCache::cacheKey(vertexSource, fragmentSource, attributeNames);
+}
+
 QFunctionPointer EglFSNativeInterface::platformFunction(const QByteArray &function) const
 {
-    Q_UNUSED(function);
-    return 0;
+    // The program binary cache doesn't depend on the device
+    if (function == EglFSFunctions::programBinaryKeyIdentifier())
+        return QFunctionPointer(programBinaryKey);
+    if (function == EglFSFunctions::hasProgramBinaryIdentifier())
+        return QFunctionPointer(ProgramBinaryCache::contains);
+    if (function == EglFSFunctions::loadProgramBinaryIdentifier())
+        return QFunctionPointer(ProgramBinaryCache::load);
+    if (function == EglFSFunctions::saveProgramBinaryIdentifier())
+        return QFunctionPointer(ProgramBinaryCache::save);
+
+    return egl_device_integration()->platformFunction(function);
 }
 
 } // namespace Platform
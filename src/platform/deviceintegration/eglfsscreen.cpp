@@ -50,7 +50,8 @@ EglFSScreen::EglFSScreen(EGLDisplay dpy)
     : m_dpy(dpy),
       m_pointerWindow(0),
       m_surface(EGL_NO_SURFACE),
-      m_cursor(0)
+      m_cursor(0),
+      m_pos(0, 0)
 {
     m_cursor = egl_device_integration()->createCursor(this);
 }
@@ -63,7 +64,7 @@ EglFSScreen::~EglFSScreen()
 
 QRect EglFSScreen::geometry() const
 {
-    return QRect(QPoint(0, 0), egl_device_integration()->screenSize());
+    return QRect(m_pos, egl_device_integration()->screenSize());
 }
 
 int EglFSScreen::depth() const
@@ -243,6 +244,127 @@ void EglFSScreen::setCurrentMode(int modeId)
     Q_UNUSED(modeId);
 }
 
+/*!
+  Returns whether the mode with index \a modeId can be set,
+  without actually setting it.
+
+  The default implementation only checks that \a modeId is
+  a valid index from the modes list.
+
+  \sa QPlatformScreen::modes
+*/
+bool EglFSScreen::testMode(int modeId) const
+{
+    return modeId >= 0 && modeId < modes().size();
+}
+
+/*!
+  Moves the screen to \a pos in the virtual desktop.
+
+  The default implementation stores the position, which is then
+  returned by geometry(), and notifies Qt of the new geometry.
+  Subclasses that reimplement geometry() must reimplement this too.
+*/
+void EglFSScreen::setPosition(const QPoint &pos)
+{
+    if (m_pos == pos)
+        return;
+
+    m_pos = pos;
+    QWindowSystemInterface::handleScreenGeometryChange(screen(), geometry(), availableGeometry());
+    resizeMaximizedWindows();
+}
+
+/*!
+  Returns the transform applied by the display hardware while
+  scanning out the screen contents.
+
+  The default implementation always returns TransformNormal.
+*/
+EglFSScreen::Transform EglFSScreen::transform() const
+{
+    return TransformNormal;
+}
+
+/*!
+  Makes the display hardware apply \a transform while scanning out,
+  so that contents are rendered in their native orientation and the
+  geometry of the screen is rotated accordingly.
+
+  Returns false when the hardware cannot do it, in which case the
+  caller has to render the contents transformed.
+  The default implementation only accepts TransformNormal.
+*/
+bool EglFSScreen::setTransform(Transform transform)
+{
+    return transform == TransformNormal;
+}
+
+/*!
+  Maps \a pos from the scanout, for example the position reported
+  by a touch screen glued to the panel, to the screen contents.
+  Both positions are normalized to the 0-1 range.
+
+  \sa mapToScanout
+*/
+QPointF EglFSScreen::mapFromScanout(const QPointF &pos) const
+{
+    const Transform t = transform();
+    QPointF result;
+
+    switch (t) {
+    case Transform90:
+    case TransformFlipped90:
+        result = QPointF(1 - pos.y(), pos.x());
+        break;
+    case Transform180:
+    case TransformFlipped180:
+        result = QPointF(1 - pos.x(), 1 - pos.y());
+        break;
+    case Transform270:
+    case TransformFlipped270:
+        result = QPointF(pos.y(), 1 - pos.x());
+        break;
+    default:
+        result = pos;
+        break;
+    }
+
+    if (t >= TransformFlipped)
+        result.setX(1 - result.x());
+
+    return result;
+}
+
+/*!
+  Maps \a pos from the screen contents to the scanout, which is the
+  inverse of mapFromScanout().
+  Both positions are normalized to the 0-1 range.
+*/
+QPointF EglFSScreen::mapToScanout(const QPointF &pos) const
+{
+    const Transform t = transform();
+    QPointF result = pos;
+
+    // Contents are mirrored first and then rotated counter-clockwise
+    if (t >= TransformFlipped)
+        result.setX(1 - result.x());
+
+    switch (t) {
+    case Transform90:
+    case TransformFlipped90:
+        return QPointF(result.y(), 1 - result.x());
+    case Transform180:
+    case TransformFlipped180:
+        return QPointF(1 - result.x(), 1 - result.y());
+    case Transform270:
+    case TransformFlipped270:
+        return QPointF(1 - result.y(), result.x());
+    default:
+        return result;
+    }
+}
+
 /*!
   Returns the index of the preferred mode from the modes list.
 
@@ -56,6 +56,18 @@ public:
         qreal refreshRate;
     };
 
+    // Same values as wl_output.transform
+    enum Transform {
+        TransformNormal = 0,
+        Transform90,
+        Transform180,
+        Transform270,
+        TransformFlipped,
+        TransformFlipped90,
+        TransformFlipped180,
+        TransformFlipped270
+    };
+
     EglFSScreen(EGLDisplay display);
     ~EglFSScreen();
 
@@ -87,6 +99,15 @@ public:
 
     virtual int currentMode() const;
     virtual void setCurrentMode(int modeId);
+    virtual bool testMode(int modeId) const;
+
+    virtual void setPosition(const QPoint &pos);
+
+    virtual Transform transform() const;
+    virtual bool setTransform(Transform transform);
+
+    QPointF mapFromScanout(const QPointF &pos) const;
+    QPointF mapToScanout(const QPointF &pos) const;
 
     virtual int preferredMode() const;
     virtual void setPreferredMode(int modeId);
@@ -101,6 +122,7 @@ private:
     QWindow *m_pointerWindow;
     EGLSurface m_surface;
     QPlatformCursor *m_cursor;
+    QPoint m_pos;
 };
 
 } // namespace Platform
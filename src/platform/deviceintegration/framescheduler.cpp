@@ -0,0 +1,146 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "framescheduler.h"
+
+namespace GreenIsland {
+
+namespace Platform {
+
+static const qint64 nsecsPerSec = Q_INT64_C(1000000000);
+
+FrameScheduler::FrameScheduler()
+    : m_minimumRate(0)
+    , m_maximumRate(0)
+    , m_variable(false)
+    , m_frameInFlight(false)
+    , m_commitTime(-1)
+    , m_lastFlip(-1)
+{
+}
+
+qreal FrameScheduler::minimumRefreshRate() const
+{
+    return m_minimumRate;
+}
+
+qreal FrameScheduler::maximumRefreshRate() const
+{
+    return m_maximumRate;
+}
+
+void FrameScheduler::setRefreshRange(qreal minimumRate, qreal maximumRate)
+{
+    m_minimumRate = minimumRate;
+    m_maximumRate = maximumRate;
+}
+
+bool FrameScheduler::isVariable() const
+{
+    // Without a sane range there's nothing to vary
+    return m_variable && m_minimumRate > 0 && m_maximumRate > m_minimumRate;
+}
+
+void FrameScheduler::setVariable(bool variable)
+{
+    m_variable = variable;
+}
+
+bool FrameScheduler::hasPendingCommit() const
+{
+    return m_commitTime >= 0;
+}
+
+bool FrameScheduler::isFrameInFlight() const
+{
+    return m_frameInFlight;
+}
+
+void FrameScheduler::commit(qint64 timestamp)
+{
+    // Only the oldest commit matters, the frame will
+    // pick up all the others too
+    if (m_commitTime < 0)
+        m_commitTime = timestamp;
+}
+
+void FrameScheduler::frameStarted(qint64 timestamp)
+{
+    m_frameInFlight = true;
+
+    // Commits after this point are left for the next frame
+    if (m_commitTime >= 0 && m_commitTime <= timestamp)
+        m_commitTime = -1;
+}
+
+void FrameScheduler::flipCompleted(qint64 timestamp)
+{
+    m_frameInFlight = false;
+    m_lastFlip = timestamp;
+}
+
+qint64 FrameScheduler::lastFlip() const
+{
+    return m_lastFlip;
+}
+
+qint64 FrameScheduler::nextFrameTime() const
+{
+    // Wait for the flip before queueing another frame
+    if (m_frameInFlight)
+        return -1;
+
+    if (isVariable()) {
+        // Repeat the last frame rather than falling out of range
+        if (m_commitTime < 0)
+            return m_lastFlip >= 0 ? m_lastFlip + maximumInterval() : -1;
+
+        if (m_lastFlip < 0)
+            return m_commitTime;
+        return qMax(m_commitTime, m_lastFlip + minimumInterval());
+    }
+
+    if (m_commitTime < 0)
+        return -1;
+
+    // The flip waits for vblank anyway
+    return qMax(m_commitTime, m_lastFlip);
+}
+
+qint64 FrameScheduler::minimumInterval() const
+{
+    return qRound64(nsecsPerSec / m_maximumRate);
+}
+
+qint64 FrameScheduler::maximumInterval() const
+{
+    return qRound64(nsecsPerSec / m_minimumRate);
+}
+
+} // namespace Platform
+
+} // namespace GreenIsland
@@ -0,0 +1,93 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef GREENISLAND_FRAMESCHEDULER_H
+#define GREENISLAND_FRAMESCHEDULER_H
+
+#include <QtCore/QtGlobal>
+
+#include <GreenIsland/platform/greenislandplatform_export.h>
+
+namespace GreenIsland {
+
+namespace Platform {
+
+/*
+ * Decides when an output has to compose its next frame.
+ *
+ * With a fixed refresh rate a frame is composed as soon as there is
+ * something new and the previous flip completed, the flip then waits
+ * for vblank.  Content committed at a rate that doesn't divide the
+ * refresh rate is thus shown for an uneven number of vblanks.
+ *
+ * With a variable refresh rate the panel flips as soon as the frame
+ * is ready: the frame is composed when a client commits, but not
+ * earlier than the maximum refresh rate allows, and it's repeated
+ * before the panel would drop below its minimum refresh rate.
+ *
+ * It doesn't read any clock, all timestamps are in nanoseconds on
+ * the clock used by the caller.
+ */
+class GREENISLANDPLATFORM_EXPORT FrameScheduler
+{
+public:
+    FrameScheduler();
+
+    qreal minimumRefreshRate() const;
+    qreal maximumRefreshRate() const;
+    void setRefreshRange(qreal minimumRate, qreal maximumRate);
+
+    bool isVariable() const;
+    void setVariable(bool variable);
+
+    bool hasPendingCommit() const;
+    bool isFrameInFlight() const;
+
+    void commit(qint64 timestamp);
+    void frameStarted(qint64 timestamp);
+    void flipCompleted(qint64 timestamp);
+
+    qint64 lastFlip() const;
+    qint64 nextFrameTime() const;
+
+private:
+    qint64 minimumInterval() const;
+    qint64 maximumInterval() const;
+
+    qreal m_minimumRate;
+    qreal m_maximumRate;
+    bool m_variable;
+    bool m_frameInFlight;
+    qint64 m_commitTime;
+    qint64 m_lastFlip;
+};
+
+} // namespace Platform
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_FRAMESCHEDULER_H
@@ -0,0 +1,198 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "programbinarycache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace GreenIsland {
+
+namespace Platform {
+
+static const quint32 cacheMagic = 0x47495342; // GISB
+static const quint32 cacheVersion = 1;
+
+typedef void (QOPENGLF_APIENTRYP GetProgramBinaryFunc)(GLuint, GLsizei, GLsizei *, GLenum *, void *);
+typedef void (QOPENGLF_APIENTRYP ProgramBinaryFunc)(GLuint, GLenum, const void *, GLint);
+
+static bool resolveFunctions(GetProgramBinaryFunc *getProgramBinary, ProgramBinaryFunc *programBinary)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context || qEnvironmentVariableIsSet("GREENISLAND_DISABLE_SHADER_CACHE"))
+        return false;
+
+    const QPair<int, int> version = context->format().version();
+    QByteArray suffix;
+    if (context->isOpenGLES()) {
+        if (version.first < 3) {
+            if (!context->hasExtension(QByteArrayLiteral("GL_OES_get_program_binary")))
+                return false;
+            suffix = QByteArrayLiteral("OES");
+        }
+    } else if (version < qMakePair(4, 1)) {
+        if (!context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary")))
+            return false;
+    }
+
+    *getProgramBinary = reinterpret_cast<GetProgramBinaryFunc>(
+                context->getProcAddress(QByteArrayLiteral("glGetProgramBinary") + suffix));
+    *programBinary = reinterpret_cast<ProgramBinaryFunc>(
+                context->getProcAddress(QByteArrayLiteral("glProgramBinary") + suffix));
+    if (!*getProgramBinary || !*programBinary)
+        return false;
+
+    GLint formats = 0;
+    context->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+static QString cacheFileName(const QByteArray &key)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+            QStringLiteral("/greenisland/shaders/") + QString::fromLatin1(key);
+}
+
+bool ProgramBinaryCache::isSupported()
+{
+    GetProgramBinaryFunc getProgramBinary;
+    ProgramBinaryFunc programBinary;
+    return resolveFunctions(&getProgramBinary, &programBinary);
+}
+
+QByteArray ProgramBinaryCache::cacheKey(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                                        const char *const *attributeNames)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context)
+        return QByteArray();
+
+    QOpenGLFunctions *gl = context->functions();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(reinterpret_cast<const char *>(gl->glGetString(GL_VENDOR)));
+    hash.addData(reinterpret_cast<const char *>(gl->glGetString(GL_RENDERER)));
+    hash.addData(reinterpret_cast<const char *>(gl->glGetString(GL_VERSION)));
+    hash.addData(vertexSource);
+    hash.addData(fragmentSource);
+
+    // Attribute locations are baked into the binary
+    for (int i = 0; attributeNames && attributeNames[i]; i++)
+        hash.addData(QByteArray::number(i) + attributeNames[i]);
+
+    return hash.result().toHex();
+}
+
+bool ProgramBinaryCache::contains(const QByteArray &key)
+{
+    return !key.isEmpty() && QFile::exists(cacheFileName(key));
+}
+
+bool ProgramBinaryCache::load(QOpenGLShaderProgram *program, const QByteArray &key)
+{
+    GetProgramBinaryFunc getProgramBinary;
+    ProgramBinaryFunc programBinary;
+    if (key.isEmpty() || !resolveFunctions(&getProgramBinary, &programBinary))
+        return false;
+
+    QFile file(cacheFileName(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic = 0, version = 0, binaryFormat = 0;
+    QByteArray binary;
+    stream >> magic >> version >> binaryFormat >> binary;
+    if (stream.status() != QDataStream::Ok || magic != cacheMagic ||
+            version != cacheVersion || binary.isEmpty())
+        return false;
+
+    if (!program->create())
+        return false;
+
+    programBinary(program->programId(), binaryFormat, binary.constData(), binary.size());
+
+    // Without attached shaders link() only checks the link status
+    if (program->link())
+        return true;
+
+    // The driver rejected the binary, drop it so it gets rebuilt
+    file.remove();
+    return false;
+}
+
+void ProgramBinaryCache::save(QOpenGLShaderProgram *program, const QByteArray &key)
+{
+    GetProgramBinaryFunc getProgramBinary;
+    ProgramBinaryFunc programBinary;
+    if (key.isEmpty() || !program->isLinked() || !resolveFunctions(&getProgramBinary, &programBinary))
+        return;
+
+    GLint length = 0;
+    QOpenGLContext::currentContext()->functions()->glGetProgramiv(program->programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    QByteArray binary(length, Qt::Uninitialized);
+    GLenum binaryFormat = 0;
+    getProgramBinary(program->programId(), length, &length, &binaryFormat, binary.data());
+    if (length <= 0)
+        return;
+    binary.truncate(length);
+
+    const QString fileName = cacheFileName(key);
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    // Programs may be built from several threads at once,
+    // write atomically so a reader never sees a partial file
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << quint32(binaryFormat) << binary;
+    if (stream.status() == QDataStream::Ok)
+        file.commit();
+}
+
+} // namespace Platform
+
+} // namespace GreenIsland
@@ -0,0 +1,69 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef GREENISLAND_PROGRAMBINARYCACHE_H
+#define GREENISLAND_PROGRAMBINARYCACHE_H
+
+#include <QtCore/QByteArray>
+
+#include <GreenIsland/platform/greenislandplatform_export.h>
+
+class QOpenGLShaderProgram;
+
+namespace GreenIsland {
+
+namespace Platform {
+
+/*
+ * Stores linked shader programs under the generic cache location, keyed
+ * by driver vendor, renderer and version plus the sources and attribute
+ * bindings, so that slow driver compilers are only hit once per driver
+ * and a driver update simply misses the cache.
+ *
+ * Requires OpenGL ES 3.0, GL_OES_get_program_binary, OpenGL 4.1 or
+ * GL_ARB_get_program_binary on the current context.
+ */
+class GREENISLANDPLATFORM_EXPORT ProgramBinaryCache
+{
+public:
+    static bool isSupported();
+
+    // Attribute names are bound to their index in the null terminated list
+    static QByteArray cacheKey(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                               const char *const *attributeNames = Q_NULLPTR);
+    static bool contains(const QByteArray &key);
+
+    // The program must not have shaders attached; on success it is linked
+    static bool load(QOpenGLShaderProgram *program, const QByteArray &key);
+    static void save(QOpenGLShaderProgram *program, const QByteArray &key);
+};
+
+} // namespace Platform
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_PROGRAMBINARYCACHE_H
@@ -88,6 +88,11 @@ namespace Platform {
 #define EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR 0x00000002
 #endif
 
+// Constant from EGL_EXT_buffer_age
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
 // Constants for OpenGL which are not available in the ES headers.
 #ifndef GL_CONTEXT_FLAGS
 #define GL_CONTEXT_FLAGS 0x821E
@@ -115,6 +120,10 @@ EGLPlatformContext::EGLPlatformContext(const QSurfaceFormat &format, QPlatformOp
     , m_swapIntervalEnvChecked(false)
     , m_swapIntervalFromEnv(-1)
     , m_flags(flags)
+    , m_swapWithDamageChecked(false)
+    , m_swapBuffersWithDamage(Q_NULLPTR)
+    , m_bufferAgeChecked(false)
+    , m_hasBufferAge(false)
 {
     if (nativeHandle.isNull()) {
         m_eglConfig = config ? *config : EglUtils::configFromGLFormat(display, format);
@@ -432,10 +441,71 @@ void EGLPlatformContext::swapBuffers(QPlatformSurface *surface)
     eglBindAPI(m_api);
     EGLSurface eglSurface = eglSurfaceForPlatformSurface(surface);
     if (eglSurface != EGL_NO_SURFACE) { // skip if using surfaceless context
-        bool ok = eglSwapBuffers(m_eglDisplay, eglSurface);
+        if (!m_swapWithDamageChecked) {
+            m_swapWithDamageChecked = true;
+            if (EglUtils::hasEglExtension(m_eglDisplay, "EGL_KHR_swap_buffers_with_damage"))
+                m_swapBuffersWithDamage = reinterpret_cast<SwapBuffersWithDamageFunc>(
+                            eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+            else if (EglUtils::hasEglExtension(m_eglDisplay, "EGL_EXT_swap_buffers_with_damage"))
+                m_swapBuffersWithDamage = reinterpret_cast<SwapBuffersWithDamageFunc>(
+                            eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+        }
+
+        bool ok;
+        if (m_swapBuffersWithDamage && !m_swapDamage.isEmpty()) {
+            // EGL wants rectangles with a bottom-left origin
+            EGLint height = 0;
+            eglQuerySurface(m_eglDisplay, eglSurface, EGL_HEIGHT, &height);
+
+            QVector<EGLint> rects;
+            rects.reserve(m_swapDamage.rectCount() * 4);
+            Q_FOREACH (const QRect &rect, m_swapDamage.rects())
+                rects << rect.x() << height - rect.y() - rect.height() << rect.width() << rect.height();
+            ok = m_swapBuffersWithDamage(m_eglDisplay, eglSurface, rects.data(), m_swapDamage.rectCount());
+        } else {
+            ok = eglSwapBuffers(m_eglDisplay, eglSurface);
+        }
         if (!ok)
             qCWarning(lcEglConvenience, "eglSwapBuffers failed: %x", eglGetError());
     }
+
+    m_swapDamage = QRegion();
+}
+
+/*!
+    Returns the age of the back buffer of \a surface, that is how many
+    frames ago its content was presented, or 0 when the content is
+    undefined or EGL_EXT_buffer_age is not available.
+
+    The surface must be current.
+ */
+int EGLPlatformContext::bufferAge(QPlatformSurface *surface)
+{
+    if (!m_bufferAgeChecked) {
+        m_bufferAgeChecked = true;
+        m_hasBufferAge = EglUtils::hasEglExtension(m_eglDisplay, "EGL_EXT_buffer_age");
+    }
+    if (!m_hasBufferAge)
+        return 0;
+
+    EGLSurface eglSurface = eglSurfaceForPlatformSurface(surface);
+    if (eglSurface == EGL_NO_SURFACE)
+        return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(m_eglDisplay, eglSurface, EGL_BUFFER_AGE_EXT, &age))
+        return 0;
+    return age;
+}
+
+/*!
+    Sets the region, in surface coordinates with a top-left origin, that
+    changed since the previous frame.  The next swapBuffers() passes it
+    on with EGL_KHR_swap_buffers_with_damage when available.
+ */
+void EGLPlatformContext::setSwapDamage(const QRegion &region)
+{
+    m_swapDamage = region;
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
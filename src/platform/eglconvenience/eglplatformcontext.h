@@ -34,6 +34,7 @@
 #include <QtGui/qpa/qplatformwindow.h>
 #include <QtGui/qpa/qplatformopenglcontext.h>
 #include <QtCore/QVariant>
+#include <QtGui/QRegion>
 
 #include <GreenIsland/platform/greenislandplatform_export.h>
 
@@ -74,6 +75,11 @@ public:
     EGLDisplay eglDisplay() const;
     EGLConfig eglConfig() const;
 
+    int bufferAge(QPlatformSurface *surface);
+
+    QRegion swapDamage() const { return m_swapDamage; }
+    void setSwapDamage(const QRegion &region);
+
 protected:
     virtual EGLSurface eglSurfaceForPlatformSurface(QPlatformSurface *surface) = 0;
     virtual EGLSurface createTemporaryOffscreenSurface();
@@ -85,6 +91,9 @@ private:
     void adopt(const QVariant &nativeHandle, QPlatformOpenGLContext *share);
     void updateFormatFromGL();
 
+    typedef EGLBoolean (EGLAPIENTRYP SwapBuffersWithDamageFunc)(EGLDisplay dpy, EGLSurface surface,
+                                                                EGLint *rects, EGLint n_rects);
+
     EGLContext m_eglContext;
     EGLContext m_shareContext;
     EGLDisplay m_eglDisplay;
@@ -97,6 +106,11 @@ private:
     Flags m_flags;
     bool m_ownsContext;
     QVector<EGLint> m_contextAttrs;
+    QRegion m_swapDamage;
+    bool m_swapWithDamageChecked;
+    SwapBuffersWithDamageFunc m_swapBuffersWithDamage;
+    bool m_bufferAgeChecked;
+    bool m_hasBufferAge;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(EGLPlatformContext::Flags)
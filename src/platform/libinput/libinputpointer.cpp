@@ -58,7 +58,7 @@ void LibInputPointer::setPosition(const QPoint &pos)
     QScreen *const primaryScreen = QGuiApplication::primaryScreen();
     const QRect geometry = QHighDpi::toNativePixels(primaryScreen->virtualGeometry(), primaryScreen);
     m_pt.setX(qBound(geometry.left(), pos.x(), geometry.right()));
-    m_pt.setX(qBound(geometry.top(), pos.x(), geometry.bottom()));
+    m_pt.setY(qBound(geometry.top(), pos.y(), geometry.bottom()));
 }
 
 void LibInputPointer::handleButton(libinput_event_pointer *e)
@@ -36,6 +36,7 @@
 #include <QtGui/qpa/qwindowsysteminterface.h>
 
 #include "logging.h"
+#include "deviceintegration/eglfsscreen.h"
 #include "libinput/libinputhandler.h"
 #include "libinput/libinputtouch.h"
 
@@ -88,10 +89,28 @@ public:
 
     QPointF positionFromEvent(libinput_event_touch *e)
     {
+        QScreen *const primaryScreen = QGuiApplication::primaryScreen();
+
+        // A touch screen glued to a panel rotated by the display
+        // hardware reports positions in the scan out orientation.
+        // Touch devices are not associated with outputs yet, so only
+        // the transform of the primary screen is followed: a touch
+        // screen on any other rotated output is mapped wrongly
+        EglFSScreen *eglfsScreen = QGuiApplication::platformName() == QLatin1String("greenisland")
+                ? static_cast<EglFSScreen *>(primaryScreen->handle()) : Q_NULLPTR;
+        if (eglfsScreen && eglfsScreen->transform() != EglFSScreen::TransformNormal) {
+            const QPointF pos(libinput_event_touch_get_x_transformed(e, 1),
+                              libinput_event_touch_get_y_transformed(e, 1));
+            const QPointF mapped = eglfsScreen->mapFromScanout(pos);
+            const QRect geometry = primaryScreen->geometry();
+            return QPointF(geometry.x() + mapped.x() * geometry.width(),
+                           geometry.y() + mapped.y() * geometry.height());
+        }
+
         // Constrain size to the virtual desktop
-        const QSize size = QGuiApplication::primaryScreen()->virtualGeometry().size();
+        const QSize size = primaryScreen->virtualGeometry().size();
         const double x = libinput_event_touch_get_x_transformed(e, size.width());
-        const double y = libinput_event_touch_get_y_transformed(e, size.width());
+        const double y = libinput_event_touch_get_y_transformed(e, size.height());
         return QPointF(x, y);
     }
 
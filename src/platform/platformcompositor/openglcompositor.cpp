@@ -33,6 +33,7 @@
 #include <QtGui/QMatrix4x4>
 #include <QtGui/qpa/qplatformbackingstore.h>
 
+#include "eglconvenience/eglplatformcontext.h"
 #include "openglcompositor.h"
 
 namespace GreenIsland {
@@ -60,6 +61,11 @@ namespace Platform {
     raised and lowered (addWindow(), moveToTop(), etc.), and to
     schedule repaints (update()).
 
+    Repaints are restricted to the damaged region when possible: the
+    damage of the last frames is remembered and, if the EGL implementation
+    reports the age of the back buffer, only the region that changed
+    since that buffer was presented is drawn again.
+
     \note To get support for QWidget-based windows, just use
     QOpenGLCompositorBackingStore. It will automatically create
     textures from the raster-rendered content and trigger the
@@ -68,9 +74,20 @@ namespace Platform {
 
 static OpenGLCompositor *compositor = 0;
 
+// Above this number of rectangles a single scissor of the bounding
+// rectangle is cheaper than repainting everything once per rectangle
+static const int maxScissorRects = 4;
+
+static inline QRect toBottomLeftRect(const QRect &topLeftRect, int windowHeight)
+{
+    return QRect(topLeftRect.x(), windowHeight - topLeftRect.bottomRight().y() - 1,
+                 topLeftRect.width(), topLeftRect.height());
+}
+
 OpenGLCompositor::OpenGLCompositor()
     : m_context(0),
-      m_targetWindow(0)
+      m_targetWindow(0),
+      m_fullRepaint(true)
 {
     Q_ASSERT(!compositor);
     m_updateTimer.setSingleShot(true);
@@ -89,10 +106,26 @@ void OpenGLCompositor::setTarget(QOpenGLContext *context, QWindow *targetWindow)
 {
     m_context = context;
     m_targetWindow = targetWindow;
+    m_fullRepaint = true;
+    m_damageHistory.clear();
 }
 
+/*!
+    Schedules a repaint of the whole target window.
+ */
 void OpenGLCompositor::update()
 {
+    m_fullRepaint = true;
+    if (!m_updateTimer.isActive())
+        m_updateTimer.start();
+}
+
+/*!
+    Schedules a repaint of \a region, in target window coordinates.
+ */
+void OpenGLCompositor::update(const QRegion &region)
+{
+    m_damage += region;
     if (!m_updateTimer.isActive())
         m_updateTimer.start();
 }
@@ -115,35 +148,123 @@ void OpenGLCompositor::handleRenderAllRequest()
 
 void OpenGLCompositor::renderAll(QOpenGLFramebufferObject *fbo)
 {
+    const QRect targetWindowRect(QPoint(0, 0), m_targetWindow->geometry().size());
+
+    // Grabs always render everything and leave the damage for the next frame
+    QRegion frameDamage;
+    QRegion repaint = targetWindowRect;
+    EGLPlatformContext *eglContext = Q_NULLPTR;
+    if (!fbo) {
+        trackWindowChanges();
+
+        if (targetWindowRect.size() != m_lastTargetSize) {
+            m_lastTargetSize = targetWindowRect.size();
+            m_fullRepaint = true;
+            m_damageHistory.clear();
+        }
+
+        frameDamage = m_fullRepaint ? QRegion(targetWindowRect) : m_damage & targetWindowRect;
+        m_fullRepaint = false;
+        m_damage = QRegion();
+    }
+
+    for (int i = 0; i < m_windows.size(); ++i)
+        m_windows.at(i)->beginCompositing();
+
+    // Nothing changed, don't swap but let windows know the frame is done
+    if (!fbo && frameDamage.isEmpty()) {
+        for (int i = 0; i < m_windows.size(); ++i)
+            m_windows.at(i)->endCompositing();
+        return;
+    }
+
+    if (!fbo) {
+        eglContext = dynamic_cast<EGLPlatformContext *>(m_context->handle());
+        const int age = eglContext ? eglContext->bufferAge(m_targetWindow->handle()) : 0;
+        repaint = frameDamage + m_damageHistory.repaintRegion(age, targetWindowRect);
+    }
+
     if (fbo)
         fbo->bind();
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-    const QRect targetWindowRect(QPoint(0, 0), m_targetWindow->geometry().size());
     glViewport(0, 0, targetWindowRect.width(), targetWindowRect.height());
 
     if (!m_blitter.isCreated())
         m_blitter.create();
 
-    m_blitter.bind();
+    QVector<QRect> clipRects;
+    const bool partial = repaint != QRegion(targetWindowRect);
+    if (partial) {
+        if (repaint.rectCount() > maxScissorRects)
+            clipRects.append(repaint.boundingRect());
+        else
+            clipRects = repaint.rects();
+        glEnable(GL_SCISSOR_TEST);
+    } else {
+        clipRects.append(targetWindowRect);
+    }
 
-    for (int i = 0; i < m_windows.size(); ++i)
-        m_windows.at(i)->beginCompositing();
+    for (int c = 0; c < clipRects.size(); ++c) {
+        if (partial) {
+            const QRect scissor = toBottomLeftRect(clipRects.at(c), targetWindowRect.height());
+            glScissor(scissor.x(), scissor.y(), scissor.width(), scissor.height());
+        }
 
-    for (int i = 0; i < m_windows.size(); ++i)
-        render(m_windows.at(i));
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-    m_blitter.release();
-    if (!fbo)
+        m_blitter.bind();
+        for (int i = 0; i < m_windows.size(); ++i) {
+            const QWindow *sourceWindow = m_windows.at(i)->sourceWindow();
+            if (!partial || sourceWindow->geometry().intersects(clipRects.at(c)))
+                render(m_windows.at(i));
+        }
+        m_blitter.release();
+    }
+
+    if (partial)
+        glDisable(GL_SCISSOR_TEST);
+
+    if (!fbo) {
+        if (eglContext && frameDamage != QRegion(targetWindowRect))
+            eglContext->setSwapDamage(frameDamage);
         m_context->swapBuffers(m_targetWindow);
-    else
+        m_damageHistory.frameSwapped(frameDamage);
+    } else {
         fbo->release();
+    }
 
     for (int i = 0; i < m_windows.size(); ++i)
         m_windows.at(i)->endCompositing();
 }
 
+void OpenGLCompositor::damageWindow(OpenGLCompositorWindow *window)
+{
+    if (window->sourceWindow())
+        update(window->sourceWindow()->geometry());
+}
+
+void OpenGLCompositor::trackWindowChanges()
+{
+    // Windows can be moved, resized or faded without their content
+    // changing, damage both the old and the new area
+    for (int i = 0; i < m_windows.size(); ++i) {
+        OpenGLCompositorWindow *window = m_windows.at(i);
+        const QWindow *sourceWindow = window->sourceWindow();
+        if (!sourceWindow)
+            continue;
+
+        WindowState &state = m_windowStates[window];
+        const QRect geometry = sourceWindow->geometry();
+        const qreal opacity = sourceWindow->opacity();
+        if (state.geometry != geometry || !qFuzzyCompare(state.opacity, opacity)) {
+            m_damage += state.geometry;
+            m_damage += geometry;
+            state.geometry = geometry;
+            state.opacity = opacity;
+        }
+    }
+}
+
 struct BlendStateBinder
 {
     BlendStateBinder() : m_blend(false) {
@@ -167,11 +288,6 @@ struct BlendStateBinder
     bool m_blend;
 };
 
-static inline QRect toBottomLeftRect(const QRect &topLeftRect, int windowHeight)
-{
-    return QRect(topLeftRect.x(), windowHeight - topLeftRect.bottomRight().y() - 1,
-                 topLeftRect.width(), topLeftRect.height());
-}
 
 static void clippedBlit(const QPlatformTextureList *textures, int idx, const QRect &targetWindowRect, QOpenGLTextureBlitter *blitter)
 {
@@ -243,6 +359,11 @@ OpenGLCompositor *OpenGLCompositor::instance()
     return compositor;
 }
 
+bool OpenGLCompositor::hasInstance()
+{
+    return compositor != 0;
+}
+
 void OpenGLCompositor::destroy()
 {
     delete compositor;
@@ -253,13 +374,17 @@ void OpenGLCompositor::addWindow(OpenGLCompositorWindow *window)
 {
     if (!m_windows.contains(window)) {
         m_windows.append(window);
+        damageWindow(window);
         emit topWindowChanged(window);
     }
 }
 
 void OpenGLCompositor::removeWindow(OpenGLCompositorWindow *window)
 {
-    m_windows.removeOne(window);
+    if (m_windows.removeOne(window)) {
+        // Use the last painted geometry, the window might be gone already
+        update(m_windowStates.take(window).geometry);
+    }
     if (!m_windows.isEmpty())
         emit topWindowChanged(m_windows.last());
 }
@@ -268,6 +393,7 @@ void OpenGLCompositor::moveToTop(OpenGLCompositorWindow *window)
 {
     m_windows.removeOne(window);
     m_windows.append(window);
+    damageWindow(window);
     emit topWindowChanged(window);
 }
 
@@ -276,6 +402,7 @@ void OpenGLCompositor::changeWindowIndex(OpenGLCompositorWindow *window, int new
     int idx = m_windows.indexOf(window);
     if (idx != -1 && idx != newIdx) {
         m_windows.move(idx, newIdx);
+        damageWindow(window);
         if (newIdx == m_windows.size() - 1)
             emit topWindowChanged(m_windows.last());
     }
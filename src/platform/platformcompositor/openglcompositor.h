@@ -30,11 +30,15 @@
 #ifndef OPENGLCOMPOSITOR_H
 #define OPENGLCOMPOSITOR_H
 
+#include <QtCore/QHash>
 #include <QtCore/QTimer>
+#include <QtGui/QRegion>
 #include <QtGui/private/qopengltextureblitter_p.h>
 
 #include <GreenIsland/platform/greenislandplatform_export.h>
 
+#include "opengldamagehistory.h"
+
 class QOpenGLContext;
 class QOpenGLFramebufferObject;
 class QWindow;
@@ -59,6 +63,7 @@ class GREENISLANDPLATFORM_EXPORT OpenGLCompositor : public QObject
     Q_OBJECT
 public:
     static OpenGLCompositor *instance();
+    static bool hasInstance();
     static void destroy();
 
     void setTarget(QOpenGLContext *context, QWindow *window);
@@ -66,6 +71,7 @@ public:
     QWindow *targetWindow() const { return m_targetWindow; }
 
     void update();
+    void update(const QRegion &region);
     QImage grab();
 
     QList<OpenGLCompositorWindow *> windows() const { return m_windows; }
@@ -84,14 +90,27 @@ private:
     OpenGLCompositor();
     ~OpenGLCompositor();
 
+    struct WindowState {
+        WindowState() : opacity(1.0) { }
+        QRect geometry;
+        qreal opacity;
+    };
+
     void renderAll(QOpenGLFramebufferObject *fbo);
     void render(OpenGLCompositorWindow *window);
+    void damageWindow(OpenGLCompositorWindow *window);
+    void trackWindowChanges();
 
     QOpenGLContext *m_context;
     QWindow *m_targetWindow;
     QTimer m_updateTimer;
     QOpenGLTextureBlitter m_blitter;
     QList<OpenGLCompositorWindow *> m_windows;
+    QHash<OpenGLCompositorWindow *, WindowState> m_windowStates;
+    QRegion m_damage;
+    bool m_fullRepaint;
+    OpenGLDamageHistory m_damageHistory;
+    QSize m_lastTargetSize;
 };
 
 } // namespace Platform
@@ -37,10 +37,6 @@
 #include "openglcompositorbackingstore.h"
 #include "openglcompositor.h"
 
-#ifndef GL_UNPACK_ROW_LENGTH
-#define GL_UNPACK_ROW_LENGTH              0x0CF2
-#endif
-
 namespace GreenIsland {
 
 namespace Platform {
@@ -94,9 +90,10 @@ OpenGLCompositorBackingStore::~OpenGLCompositorBackingStore()
             ctx->makeCurrent(tempSurface.data());
         }
 
-        if (ctx && m_bsTextureContext && ctx->shareGroup() == m_bsTextureContext->shareGroup())
+        if (ctx && m_bsTextureContext && ctx->shareGroup() == m_bsTextureContext->shareGroup()) {
             glDeleteTextures(1, &m_bsTexture);
-        else
+            m_uploader.destroy();
+        } else
             qWarning("OpenGLCompositorBackingStore: Texture is not valid in the current context");
 
         if (tempSurface)
@@ -128,45 +125,7 @@ void OpenGLCompositorBackingStore::updateTexture()
     }
 
     if (!m_dirty.isNull()) {
-        QRegion fixed;
-        QRect imageRect = m_image.rect();
-
-        QOpenGLContext *ctx = QOpenGLContext::currentContext();
-        if (!ctx->isOpenGLES() || ctx->format().majorVersion() >= 3) {
-            foreach (const QRect &rect, m_dirty.rects()) {
-                QRect r = imageRect & rect;
-                glPixelStorei(GL_UNPACK_ROW_LENGTH, m_image.width());
-                glTexSubImage2D(GL_TEXTURE_2D, 0, r.x(), r.y(), r.width(), r.height(), GL_RGBA, GL_UNSIGNED_BYTE,
-                                m_image.constScanLine(r.y()) + r.x() * 4);
-                glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-            }
-        } else {
-            foreach (const QRect &rect, m_dirty.rects()) {
-                // intersect with image rect to be sure
-                QRect r = imageRect & rect;
-
-                // if the rect is wide enough it's cheaper to just
-                // extend it instead of doing an image copy
-                if (r.width() >= imageRect.width() / 2) {
-                    r.setX(0);
-                    r.setWidth(imageRect.width());
-                }
-
-                fixed |= r;
-            }
-            foreach (const QRect &rect, fixed.rects()) {
-                // if the sub-rect is full-width we can pass the image data directly to
-                // OpenGL instead of copying, since there's no gap between scanlines
-                if (rect.width() == imageRect.width()) {
-                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, rect.y(), rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE,
-                                    m_image.constScanLine(rect.y()));
-                } else {
-                    glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE,
-                                    m_image.copy(rect).constBits());
-                }
-            }
-        }
-
+        m_uploader.upload(m_image, m_dirty);
         m_dirty = QRegion();
     }
 }
@@ -175,7 +134,6 @@ void OpenGLCompositorBackingStore::flush(QWindow *window, const QRegion &region,
 {
     // Called for ordinary raster windows.
 
-    Q_UNUSED(region);
     Q_UNUSED(offset);
 
     OpenGLCompositor *compositor = OpenGLCompositor::instance();
@@ -191,7 +149,8 @@ void OpenGLCompositorBackingStore::flush(QWindow *window, const QRegion &region,
     m_textures->clear();
     m_textures->appendTexture(Q_NULLPTR, m_bsTexture, window->geometry());
 
-    compositor->update();
+    // Only the flushed area of the window changed
+    compositor->update(region.translated(window->geometry().topLeft()));
 }
 
 void OpenGLCompositorBackingStore::composeAndFlush(QWindow *window, const QRegion &region, const QPoint &offset,
@@ -232,7 +191,8 @@ void OpenGLCompositorBackingStore::composeAndFlush(QWindow *window, const QRegio
     textures->lock(true);
     m_lockedWidgetTextures = textures;
 
-    compositor->update();
+    // Widget textures may have changed anywhere in the window
+    compositor->update(window->geometry());
 }
 
 void OpenGLCompositorBackingStore::notifyComposited()
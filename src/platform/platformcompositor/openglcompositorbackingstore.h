@@ -36,6 +36,8 @@
 
 #include <GreenIsland/platform/greenislandplatform_export.h>
 
+#include "opengltextureuploader.h"
+
 class QOpenGLContext;
 class QPlatformTextureList;
 
@@ -75,6 +77,7 @@ private:
     QOpenGLContext *m_bsTextureContext;
     QPlatformTextureList *m_textures;
     QPlatformTextureList *m_lockedWidgetTextures;
+    OpenGLTextureUploader m_uploader;
 };
 
 } // namespace Platform
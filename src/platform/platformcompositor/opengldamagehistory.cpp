@@ -0,0 +1,89 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "opengldamagehistory.h"
+
+namespace GreenIsland {
+
+namespace Platform {
+
+/*!
+    \class OpenGLDamageHistory
+    \inmodule GreenIslandPlatform
+
+    Remembers the damage of the frames that were presented, so that a back
+    buffer whose age is known can be brought up to date by repainting only
+    what changed since it was last presented.
+
+    Only frames that are actually swapped must be recorded, a frame that
+    is skipped does not age the back buffers.
+ */
+
+OpenGLDamageHistory::OpenGLDamageHistory()
+{
+}
+
+/*!
+    Forgets all recorded frames, for example when the target is resized.
+ */
+void OpenGLDamageHistory::clear()
+{
+    m_frames.clear();
+}
+
+/*!
+    Records \a damage as the region that changed in the frame that was
+    just swapped.
+ */
+void OpenGLDamageHistory::frameSwapped(const QRegion &damage)
+{
+    m_frames.prepend(damage);
+    while (m_frames.size() > MaxFrames)
+        m_frames.removeLast();
+}
+
+/*!
+    Returns the region of \a targetRect that a back buffer of age
+    \a bufferAge is missing, not including the damage of the frame that
+    is about to be painted.  The whole \a targetRect is returned when the
+    content of the back buffer is undefined or not covered by the history,
+    for example right after clear().
+ */
+QRegion OpenGLDamageHistory::repaintRegion(int bufferAge, const QRect &targetRect) const
+{
+    if (bufferAge <= 0 || bufferAge > m_frames.size())
+        return targetRect;
+
+    QRegion region;
+    for (int i = 0; i < bufferAge - 1; ++i)
+        region += m_frames.at(i);
+    return region & targetRect;
+}
+
+} // namespace Platform
+
+} // namespace GreenIsland
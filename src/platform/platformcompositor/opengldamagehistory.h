@@ -0,0 +1,61 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef OPENGLDAMAGEHISTORY_H
+#define OPENGLDAMAGEHISTORY_H
+
+#include <QtCore/QList>
+#include <QtGui/QRegion>
+
+#include <GreenIsland/platform/greenislandplatform_export.h>
+
+namespace GreenIsland {
+
+namespace Platform {
+
+class GREENISLANDPLATFORM_EXPORT OpenGLDamageHistory
+{
+public:
+    // Enough for triple buffering with one frame of slack
+    enum { MaxFrames = 4 };
+
+    OpenGLDamageHistory();
+
+    void clear();
+    void frameSwapped(const QRegion &damage);
+
+    QRegion repaintRegion(int bufferAge, const QRect &targetRect) const;
+
+private:
+    QList<QRegion> m_frames;
+};
+
+} // namespace Platform
+
+} // namespace GreenIsland
+
+#endif // OPENGLDAMAGEHISTORY_H
@@ -0,0 +1,266 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+
+#include <string.h>
+
+#include "opengltextureuploader.h"
+
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH              0x0CF2
+#endif
+
+namespace GreenIsland {
+
+namespace Platform {
+
+// Merging is quadratic, past this many rectangles just take the bounds
+static const int maxMergeRects = 128;
+
+static inline qint64 area(const QRect &rect)
+{
+    return qint64(rect.width()) * rect.height();
+}
+
+/*!
+    \class OpenGLTextureUploader
+    \internal
+
+    Uploads the dirty parts of a raster image to the currently bound
+    texture.  Dirty rectangles are merged whenever uploading the extra
+    pixels is cheaper than another call into the driver, and the data
+    is staged through a small ring of pixel unpack buffers when they are
+    supported so that uploading doesn't wait for the previous frame.
+ */
+
+OpenGLTextureUploader::OpenGLTextureUploader()
+    : m_initialized(false)
+    , m_hasUnpackRowLength(false)
+    , m_hasPixelBuffers(false)
+    , m_currentBuffer(0)
+{
+    for (int i = 0; i < RingSize; ++i)
+        m_buffers[i] = QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer);
+}
+
+OpenGLTextureUploader::~OpenGLTextureUploader()
+{
+}
+
+/*!
+    Uploads the \a dirty region of \a image to the texture bound to
+    GL_TEXTURE_2D, which has the same size as the image.  The image
+    must be in QImage::Format_RGBA8888.
+ */
+void OpenGLTextureUploader::upload(const QImage &image, const QRegion &dirty)
+{
+    if (dirty.isEmpty())
+        return;
+
+    if (!m_initialized)
+        initialize(QOpenGLContext::currentContext());
+
+    QRegion region = dirty;
+    if (!m_hasUnpackRowLength) {
+        // Without unpack row length only full rows can be uploaded
+        // directly from the image, extend the wide rectangles
+        region = QRegion();
+        Q_FOREACH (QRect rect, dirty.rects()) {
+            if (rect.width() >= image.width() / 2) {
+                rect.setX(0);
+                rect.setWidth(image.width());
+            }
+            region |= rect;
+        }
+    }
+
+    const QVector<QRect> rects = mergeRects(region, image.rect());
+    if (rects.isEmpty())
+        return;
+
+    if (!m_hasPixelBuffers || !uploadThroughBuffer(image, rects))
+        uploadDirectly(image, rects);
+}
+
+/*!
+    Releases the pixel buffers, the context that was current during
+    upload() must be current.
+ */
+void OpenGLTextureUploader::destroy()
+{
+    for (int i = 0; i < RingSize; ++i)
+        m_buffers[i].destroy();
+    m_currentBuffer = 0;
+    m_staging.clear();
+    m_initialized = false;
+}
+
+/*!
+    Returns the rectangles of \a region, clipped to \a bounds, merging
+    them when the pixels added by the merge cost less than \a callCost.
+ */
+QVector<QRect> OpenGLTextureUploader::mergeRects(const QRegion &region, const QRect &bounds, int callCost)
+{
+    QVector<QRect> rects;
+    Q_FOREACH (const QRect &rect, region.rects()) {
+        const QRect clipped = rect & bounds;
+        if (!clipped.isEmpty())
+            rects.append(clipped);
+    }
+
+    if (rects.size() > maxMergeRects) {
+        rects.clear();
+        rects.append(region.boundingRect() & bounds);
+        return rects;
+    }
+
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < rects.size() && !merged; ++i) {
+            for (int j = i + 1; j < rects.size(); ++j) {
+                const QRect united = rects.at(i) | rects.at(j);
+                if (area(united) <= area(rects.at(i)) + area(rects.at(j)) + callCost) {
+                    rects[i] = united;
+                    rects.remove(j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return rects;
+}
+
+void OpenGLTextureUploader::initialize(QOpenGLContext *context)
+{
+    Q_ASSERT(context);
+
+    const QSurfaceFormat format = context->format();
+    const QPair<int, int> version = format.version();
+
+    if (context->isOpenGLES()) {
+        m_hasUnpackRowLength = version.first >= 3 || context->hasExtension("GL_EXT_unpack_subimage");
+        m_hasPixelBuffers = version.first >= 3;
+    } else {
+        m_hasUnpackRowLength = true;
+        m_hasPixelBuffers = version >= qMakePair(2, 1) || context->hasExtension("GL_ARB_pixel_buffer_object");
+    }
+
+    if (qEnvironmentVariableIntValue("GREENISLAND_QPA_DISABLE_PBO"))
+        m_hasPixelBuffers = false;
+
+    m_initialized = true;
+}
+
+bool OpenGLTextureUploader::uploadThroughBuffer(const QImage &image, const QVector<QRect> &rects)
+{
+    QOpenGLBuffer &buffer = m_buffers[m_currentBuffer];
+    m_currentBuffer = (m_currentBuffer + 1) % RingSize;
+
+    if (!buffer.isCreated()) {
+        if (!buffer.create())
+            return false;
+        buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    }
+
+    int size = 0;
+    Q_FOREACH (const QRect &rect, rects)
+        size += rect.width() * rect.height() * 4;
+
+    // Reallocating the storage orphans the data of the previous use of
+    // this buffer, so mapping doesn't wait for the upload to complete
+    buffer.bind();
+    buffer.allocate(size);
+    uchar *data = static_cast<uchar *>(buffer.map(QOpenGLBuffer::WriteOnly));
+    if (!data) {
+        buffer.release();
+        return false;
+    }
+
+    // Pack the rectangles tightly one after the other
+    QVector<int> offsets;
+    offsets.reserve(rects.size());
+    int offset = 0;
+    Q_FOREACH (const QRect &rect, rects) {
+        offsets.append(offset);
+        const int rowSize = rect.width() * 4;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            memcpy(data + offset, image.constScanLine(y) + rect.x() * 4, rowSize);
+            offset += rowSize;
+        }
+    }
+
+    buffer.unmap();
+
+    QOpenGLFunctions *funcs = QOpenGLContext::currentContext()->functions();
+    for (int i = 0; i < rects.size(); ++i) {
+        const QRect &rect = rects.at(i);
+        funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                               GL_RGBA, GL_UNSIGNED_BYTE,
+                               reinterpret_cast<const void *>(quintptr(offsets.at(i))));
+    }
+
+    buffer.release();
+    return true;
+}
+
+void OpenGLTextureUploader::uploadDirectly(const QImage &image, const QVector<QRect> &rects)
+{
+    QOpenGLFunctions *funcs = QOpenGLContext::currentContext()->functions();
+
+    Q_FOREACH (const QRect &rect, rects) {
+        if (rect.width() == image.width()) {
+            // Full rows are contiguous in the image, no copy needed
+            funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, rect.y(), rect.width(), rect.height(),
+                                   GL_RGBA, GL_UNSIGNED_BYTE, image.constScanLine(rect.y()));
+        } else if (m_hasUnpackRowLength) {
+            funcs->glPixelStorei(GL_UNPACK_ROW_LENGTH, image.width());
+            funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                                   GL_RGBA, GL_UNSIGNED_BYTE,
+                                   image.constScanLine(rect.y()) + rect.x() * 4);
+            funcs->glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        } else {
+            // Reuse the same staging memory rather than copying the image
+            const int rowSize = rect.width() * 4;
+            if (m_staging.size() < rowSize * rect.height())
+                m_staging.resize(rowSize * rect.height());
+            uchar *data = reinterpret_cast<uchar *>(m_staging.data());
+            for (int y = rect.top(); y <= rect.bottom(); ++y)
+                memcpy(data + (y - rect.top()) * rowSize, image.constScanLine(y) + rect.x() * 4, rowSize);
+            funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                                   GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+    }
+}
+
+} // namespace Platform
+
+} // namespace GreenIsland
@@ -0,0 +1,79 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef OPENGLTEXTUREUPLOADER_H
+#define OPENGLTEXTUREUPLOADER_H
+
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QRegion>
+
+#include <GreenIsland/platform/greenislandplatform_export.h>
+
+class QOpenGLContext;
+
+namespace GreenIsland {
+
+namespace Platform {
+
+class GREENISLANDPLATFORM_EXPORT OpenGLTextureUploader
+{
+public:
+    // Cost of a glTexSubImage2D call expressed in pixels: merging two
+    // rectangles is worth it when it uploads fewer extra pixels than this
+    enum { DefaultCallCost = 4096 };
+
+    OpenGLTextureUploader();
+    ~OpenGLTextureUploader();
+
+    void upload(const QImage &image, const QRegion &dirty);
+    void destroy();
+
+    static QVector<QRect> mergeRects(const QRegion &region, const QRect &bounds,
+                                     int callCost = DefaultCallCost);
+
+private:
+    enum { RingSize = 3 };
+
+    void initialize(QOpenGLContext *context);
+    bool uploadThroughBuffer(const QImage &image, const QVector<QRect> &rects);
+    void uploadDirectly(const QImage &image, const QVector<QRect> &rects);
+
+    bool m_initialized;
+    bool m_hasUnpackRowLength;
+    bool m_hasPixelBuffers;
+    QOpenGLBuffer m_buffers[RingSize];
+    int m_currentBuffer;
+    QByteArray m_staging;
+};
+
+} // namespace Platform
+
+} // namespace GreenIsland
+
+#endif // OPENGLTEXTUREUPLOADER_H
@@ -182,6 +182,12 @@ QStringList UdevDevice::deviceProperties() const
     return listFromEntries(udev_device_get_properties_list_entry(d->device));
 }
 
+QString UdevDevice::deviceProperty(const QString &name) const
+{
+    Q_D(const UdevDevice);
+    return QString::fromUtf8(udev_device_get_property_value(d->device, qPrintable(name)));
+}
+
 QStringList UdevDevice::sysfsProperties() const
 {
     Q_D(const UdevDevice);
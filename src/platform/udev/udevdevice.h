@@ -79,6 +79,7 @@ public:
     int sysfsNumber() const;
 
     QStringList deviceProperties() const;
+    QString deviceProperty(const QString &name) const;
     QStringList sysfsProperties() const;
 
     UdevDevice *parent() const;
@@ -91,6 +91,9 @@ public:
             Q_EMIT q->deviceOnlined(device);
         else if (strcmp(action, "offline") == 0)
             Q_EMIT q->deviceOfflined(device);
+
+        // Receivers are not supposed to keep the device around
+        delete device;
     }
 
     Udev *udev;
@@ -105,6 +108,10 @@ UdevMonitor::UdevMonitor(Udev *udev, QObject *parent)
     : QObject(*new UdevMonitorPrivate(udev), parent)
 {
     Q_D(UdevMonitor);
+
+    if (!d->monitor)
+        return;
+
     int fd = udev_monitor_get_fd(d->monitor);
     QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
     connect(notifier, SIGNAL(activated(int)), this, SLOT(_q_udevEventHandler()));
@@ -126,6 +133,7 @@ void UdevMonitor::filterSubSystemDevType(const QString &subSystem, const QString
     udev_monitor_filter_add_match_subsystem_devtype(d->monitor,
                                                     qPrintable(subSystem),
                                                     qPrintable(devType));
+    udev_monitor_filter_update(d->monitor);
 }
 
 void UdevMonitor::filterTag(const QString &tag)
@@ -136,8 +144,11 @@ void UdevMonitor::filterTag(const QString &tag)
         return;
 
     udev_monitor_filter_add_match_tag(d->monitor, qPrintable(tag));
+    udev_monitor_filter_update(d->monitor);
 }
 
 } // namespace Platform
 
 } // namespace GreenIsland
+
+#include "moc_udevmonitor.cpp"
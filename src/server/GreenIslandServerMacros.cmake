@@ -97,25 +97,35 @@ endfunction()
 #   greenisland_add_server_protocol(<source_files_var>
 #                                   PROTOCOL <xmlfile>
 #                                   BASENAME <basename>
-#                                   [PREFIX <prefix>])
+#                                   [PREFIX <prefix>]
+#                                   [ZERO_ALLOCATION])
 #
 # Generate C++ wrapper to Wayland server protocol files from ``<xmlfile>``
 # XML definition for the ``<basename>`` interface and append those files
 # to ``<source_files_var>``.  Pass the ``<prefix>`` argument if the interface
 # names don't start with ``qt_`` or ``wl_``.
 #
+# With ``ZERO_ALLOCATION`` request handlers receive string arguments as
+# ``const char *`` instead of ``QString`` and resources are kept in a flat
+# map that ``resourceMap()`` returns by reference.
+#
 # WaylandScanner is required and will be searched for.
 #
 function(greenisland_add_server_protocol out_var)
     # Parse arguments
+    set(options ZERO_ALLOCATION)
     set(oneValueArgs PROTOCOL BASENAME PREFIX)
-    cmake_parse_arguments(ARGS "" "${oneValueArgs}" "" ${ARGN})
+    cmake_parse_arguments(ARGS "${options}" "${oneValueArgs}" "" ${ARGN})
 
     if(ARGS_UNPARSED_ARGUMENTS)
         message(FATAL_ERROR "Unknown keywords given to greenisland_add_server_protocol(): \"${ARGS_UNPARSED_ARGUMENTS}\"")
     endif()
 
     set(_prefix "${ARGS_PREFIX}")
+    set(_options "")
+    if(ARGS_ZERO_ALLOCATION)
+        set(_options "--zero-allocation")
+    endif()
 
     find_package(WaylandScanner REQUIRED QUIET)
     ecm_add_wayland_server_protocol(${out_var}
@@ -129,11 +139,11 @@ function(greenisland_add_server_protocol out_var)
     set_source_files_properties(${_header} ${_code} GENERATED)
 
     add_custom_command(OUTPUT "${_header}"
-        COMMAND ${GreenIsland_WAYLAND_SCANNER_EXECUTABLE} server-header ${_infile} "" ${_prefix} > ${_header}
+        COMMAND ${GreenIsland_WAYLAND_SCANNER_EXECUTABLE} server-header ${_options} ${_infile} "" ${_prefix} > ${_header}
         DEPENDS ${_infile} VERBATIM)
 
     add_custom_command(OUTPUT "${_code}"
-        COMMAND ${GreenIsland_WAYLAND_SCANNER_EXECUTABLE} server-code ${_infile} "" ${_prefix} > ${_code}
+        COMMAND ${GreenIsland_WAYLAND_SCANNER_EXECUTABLE} server-code ${_options} ${_infile} "" ${_prefix} > ${_code}
         DEPENDS ${_infile} ${_header} VERBATIM)
 
     list(APPEND ${out_var} "${_code}")
@@ -34,6 +34,8 @@
 #include <QtGui/QWindow>
 #include <QtGui/qpa/qplatformnativeinterface.h>
 
+#include <GreenIsland/QtWaylandCompositor/private/qwlobjectpool_p.h>
+
 #include "diagnostic_p.h"
 #include "greenisland_version.h"
 
@@ -214,6 +216,26 @@ QString environment()
     return result;
 }
 
+QString objectPools()
+{
+    QString result;
+    QTextStream str(&result);
+
+    str << "Object pools:\n";
+    Q_FOREACH (const QtWayland::ObjectPool::Statistics &stats, QtWayland::ObjectPool::allStatistics()) {
+        str << "  " << stats.name
+            << ": object size " << stats.objectSize
+            << ", chunks " << stats.chunks
+            << ", capacity " << stats.capacity
+            << ", used " << stats.used
+            << ", peak " << stats.peak
+            << ", allocations " << stats.allocations
+            << '\n';
+    }
+
+    return result;
+}
+
 } // namespace DiagnosticOutput
 
 } // namespace GreenIsland
@@ -40,6 +40,7 @@ QString systemInformation();
 QString openGlContext();
 QString framework();
 QString environment();
+QString objectPools();
 
 } // namespace DiagnosticOutput
 
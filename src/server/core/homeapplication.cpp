@@ -104,6 +104,11 @@ HomeApplication::HomeApplication(QObject *parent)
     qInfo("%s", qPrintable(DiagnosticOutput::framework()));
     qInfo("%s", qPrintable(DiagnosticOutput::environment()));
 
+    // Report how much the object pools were used during this session
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, []() {
+        qInfo("%s", qPrintable(DiagnosticOutput::objectPools()));
+    });
+
     // Reroute the signal
     d->engine = new QQmlApplicationEngine(this);
     connect(d->engine, &QQmlApplicationEngine::objectCreated,
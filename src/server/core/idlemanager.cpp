@@ -0,0 +1,224 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+
+#include "idlemanager.h"
+#include "idlemanager_p.h"
+#include "quickoutput.h"
+#include "quickoutput_p.h"
+#include "serverlogging_p.h"
+#include "extensions/idleinhibitmanager.h"
+
+namespace GreenIsland {
+
+namespace Server {
+
+/*
+ * IdleManagerPrivate
+ */
+
+void IdleManagerPrivate::userActivity()
+{
+    // Input events come in at a high rate, only the time is
+    // recorded here and the timer catches up when it expires
+    lastActivity.start();
+
+    if (idle)
+        setIdle(false);
+    else if (timeout > 0 && !timer->isActive())
+        timer->start(timeout);
+}
+
+void IdleManagerPrivate::checkIdle()
+{
+    if (timeout <= 0 || idle)
+        return;
+
+    const qint64 remaining = timeout - lastActivity.elapsed();
+    if (remaining > 0) {
+        timer->start(int(remaining));
+        return;
+    }
+
+    // Video players and the like keep the outputs on, check
+    // again after another period of inactivity
+    IdleInhibitManager *inhibitManager = IdleInhibitManager::findIn(compositor);
+    if (inhibitManager && inhibitManager->isInhibited()) {
+        qCDebug(gLcCore) << "Idle inhibited by a client";
+        timer->start(timeout);
+        return;
+    }
+
+    setIdle(true);
+}
+
+void IdleManagerPrivate::setIdle(bool value)
+{
+    Q_Q(IdleManager);
+
+    if (idle == value)
+        return;
+
+    qCDebug(gLcCore) << (value ? "Going idle" : "Resuming from idle");
+
+    idle = value;
+
+    if (compositor) {
+        Q_FOREACH (QWaylandOutput *output, compositor->outputs()) {
+            QuickOutput *quickOutput = qobject_cast<QuickOutput *>(output);
+            if (quickOutput)
+                QuickOutputPrivate::get(quickOutput)->setIdle(idle);
+        }
+    }
+
+    if (!idle && timeout > 0)
+        timer->start(timeout);
+
+    Q_EMIT q->idleChanged();
+    if (idle)
+        Q_EMIT q->idleStarted();
+    else
+        Q_EMIT q->resumed();
+}
+
+/*
+ * IdleManager
+ */
+
+IdleManager::IdleManager(QObject *parent)
+    : QObject(*new IdleManagerPrivate(), parent)
+{
+    Q_D(IdleManager);
+
+    d->timer = new QTimer(this);
+    d->timer->setSingleShot(true);
+    connect(d->timer, &QTimer::timeout, this, [d] {
+        d->checkIdle();
+    });
+    d->lastActivity.start();
+
+    // Input reaches the seat through the output windows
+    qApp->installEventFilter(this);
+}
+
+QWaylandCompositor *IdleManager::compositor() const
+{
+    Q_D(const IdleManager);
+    return d->compositor;
+}
+
+void IdleManager::setCompositor(QWaylandCompositor *compositor)
+{
+    Q_D(IdleManager);
+
+    if (d->compositor == compositor)
+        return;
+
+    // Outputs of the old compositor must not stay blanked
+    d->setIdle(false);
+
+    d->compositor = compositor;
+    Q_EMIT compositorChanged();
+}
+
+int IdleManager::timeout() const
+{
+    Q_D(const IdleManager);
+    return d->timeout;
+}
+
+void IdleManager::setTimeout(int msecs)
+{
+    Q_D(IdleManager);
+
+    if (d->timeout == msecs)
+        return;
+
+    d->timeout = msecs;
+    Q_EMIT timeoutChanged();
+
+    // Zero or less disables idle detection
+    if (d->timeout > 0) {
+        d->lastActivity.start();
+        d->timer->start(d->timeout);
+    } else {
+        d->timer->stop();
+        d->setIdle(false);
+    }
+}
+
+bool IdleManager::isIdle() const
+{
+    Q_D(const IdleManager);
+    return d->idle;
+}
+
+void IdleManager::simulateUserActivity()
+{
+    Q_D(IdleManager);
+    d->userActivity();
+}
+
+bool IdleManager::eventFilter(QObject *object, QEvent *event)
+{
+    Q_D(IdleManager);
+
+    // Events are also delivered to items, count them once
+    if (!object->isWindowType())
+        return QObject::eventFilter(object, event);
+
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+    case QEvent::TabletPress:
+    case QEvent::TabletMove:
+    case QEvent::TabletRelease:
+        d->userActivity();
+        break;
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(object, event);
+}
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#include "moc_idlemanager.cpp"
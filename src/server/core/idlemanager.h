@@ -0,0 +1,77 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+#ifndef GREENISLAND_IDLEMANAGER_H
+#define GREENISLAND_IDLEMANAGER_H
+
+#include <QtCore/QObject>
+
+#include <GreenIsland/server/greenislandserver_export.h>
+
+class QWaylandCompositor;
+
+namespace GreenIsland {
+
+namespace Server {
+
+class IdleManagerPrivate;
+
+class GREENISLANDSERVER_EXPORT IdleManager : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(IdleManager)
+    Q_PROPERTY(QWaylandCompositor *compositor READ compositor WRITE setCompositor NOTIFY compositorChanged)
+    Q_PROPERTY(int timeout READ timeout WRITE setTimeout NOTIFY timeoutChanged)
+    Q_PROPERTY(bool idle READ isIdle NOTIFY idleChanged)
+public:
+    IdleManager(QObject *parent = Q_NULLPTR);
+
+    QWaylandCompositor *compositor() const;
+    void setCompositor(QWaylandCompositor *compositor);
+
+    int timeout() const;
+    void setTimeout(int msecs);
+
+    bool isIdle() const;
+
+    Q_INVOKABLE void simulateUserActivity();
+
+Q_SIGNALS:
+    void compositorChanged();
+    void timeoutChanged();
+    void idleChanged();
+    void idleStarted();
+    void resumed();
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event) Q_DECL_OVERRIDE;
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_IDLEMANAGER_H
@@ -0,0 +1,79 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+#ifndef GREENISLAND_IDLEMANAGER_P_H
+#define GREENISLAND_IDLEMANAGER_P_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/private/qobject_p.h>
+
+#include <GreenIsland/Server/IdleManager>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Green Island API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+class QTimer;
+
+namespace GreenIsland {
+
+namespace Server {
+
+class IdleManagerPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(IdleManager)
+public:
+    IdleManagerPrivate()
+        : compositor(Q_NULLPTR)
+        , timeout(0)
+        , idle(false)
+        , timer(Q_NULLPTR)
+    {
+    }
+
+    void userActivity();
+    void checkIdle();
+    void setIdle(bool value);
+
+    QWaylandCompositor *compositor;
+    int timeout;
+    bool idle;
+    QTimer *timer;
+    QElapsedTimer lastActivity;
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_IDLEMANAGER_P_H
@@ -26,17 +26,33 @@
  ***************************************************************************/
 
 #include <QtCore/QElapsedTimer>
-#include <QtCore/private/qobject_p.h>
+#include <QtCore/QTimer>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
 #include <QtGui/QScreen>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QSGSimpleTextureNode>
 
 #include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+#include <GreenIsland/QtWaylandCompositor/QWaylandQuickItem>
+#include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
+#include <GreenIsland/QtWaylandCompositor/QWaylandView>
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandquickitem_p.h>
 
+#include <GreenIsland/Platform/EglFSFunctions>
 #include <GreenIsland/Platform/EglFSScreen>
 
 #include "quickoutput.h"
+#include "quickoutput_p.h"
 #include "serverlogging_p.h"
 #include "extensions/screencaster.h"
 #include "screen/screenbackend.h"
+#include "screen/screenbackend_p.h"
+
+#include <time.h>
 
 namespace GreenIsland {
 
@@ -137,32 +153,773 @@ protected:
 };
 
 /*
- * OutputPrivate
+ * CloneFrames
  */
 
-class QuickOutputPrivate : public QObjectPrivate
+void CloneFrames::destroyBuffer(Buffer &buffer)
+{
+    QOpenGLContext *current = QOpenGLContext::currentContext();
+    if (!current)
+        return;
+
+    if (buffer.writeSync)
+        current->extraFunctions()->glDeleteSync(buffer.writeSync);
+    Q_FOREACH (GLsync sync, buffer.readSyncs)
+        current->extraFunctions()->glDeleteSync(sync);
+    if (buffer.texture)
+        current->functions()->glDeleteTextures(1, &buffer.texture);
+    buffer = Buffer();
+}
+
+bool CloneFrames::hasFences(QOpenGLContext *context)
+{
+    if (context->isOpenGLES())
+        return context->format().majorVersion() >= 3;
+    return context->format().version() >= qMakePair(3, 2);
+}
+
+/*
+ * CloneNode
+ */
+
+class CloneNode : public QSGSimpleTextureNode
 {
-    Q_DECLARE_PUBLIC(QuickOutput)
 public:
-    QuickOutputPrivate()
-        : initialized(false)
-        , nativeScreen(Q_NULLPTR)
-        , enabled(true)
-        , hotSpotSize(QSize(5, 5))
-        , hotSpotThreshold(1000)
-        , hotSpotPushTime(50)
+    CloneNode(const QSharedPointer<CloneFrames> &frames)
+        : frames(frames)
+        , reading(-1)
     {
+        setOwnsTexture(true);
     }
 
-    bool initialized;
-    Screen *nativeScreen;
-    bool enabled;
-    QSize hotSpotSize;
-    quint64 hotSpotThreshold;
-    quint64 hotSpotPushTime;
-    QList<QObject *> objects;
+    ~CloneNode()
+    {
+        QMutexLocker locker(&frames->mutex);
+        release();
+    }
+
+    // Called with the mutex held, once the commands sampling
+    // the buffer are fenced the source may write it again
+    void release()
+    {
+        if (reading < 0)
+            return;
+
+        CloneFrames::Buffer &buffer = frames->buffers[reading];
+        reading = -1;
+
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if (context) {
+            if (CloneFrames::hasFences(context)) {
+                buffer.readSyncs.append(context->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+                context->functions()->glFlush();
+            } else {
+                context->functions()->glFinish();
+            }
+        }
+
+        // The source is gone, the last reader cleans up
+        if (--buffer.readers == 0 && !frames->context)
+            frames->destroyBuffer(buffer);
+    }
+
+    QSharedPointer<CloneFrames> frames;
+    int reading;
 };
 
+/*
+ * CloneItem
+ */
+
+class CloneItem : public QQuickItem
+{
+public:
+    CloneItem(const QSharedPointer<CloneFrames> &frames, bool flipped, QQuickItem *parent)
+        : QQuickItem(parent)
+        , frames(frames)
+        , flipped(flipped)
+        , notSharingWarned(false)
+    {
+        setFlag(ItemHasContents, true);
+    }
+
+    QSharedPointer<CloneFrames> frames;
+    bool flipped;
+    bool notSharingWarned;
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) Q_DECL_OVERRIDE
+    {
+        CloneNode *node = static_cast<CloneNode *>(oldNode);
+
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        QMutexLocker locker(&frames->mutex);
+
+        bool usable = context && frames->context && frames->front >= 0;
+        if (usable && !QOpenGLContext::areSharing(context, frames->context)) {
+            // Texture names and fences mean nothing outside the share group
+            if (!notSharingWarned)
+                qCWarning(gLcCore) << "Cannot mirror an output whose OpenGL context is not shared,"
+                                   << "set Qt::AA_ShareOpenGLContexts before creating QGuiApplication";
+            notSharingWarned = true;
+            usable = false;
+        }
+        if (!usable) {
+            locker.unlock();
+            delete node;
+            return Q_NULLPTR;
+        }
+
+        if (!node) {
+            node = new CloneNode(frames);
+            node->setFiltering(QSGTexture::Linear);
+
+            // The frame was copied from a framebuffer, bottom row first
+            QSGSimpleTextureNode::TextureCoordinatesTransformMode mode =
+                    QSGSimpleTextureNode::MirrorVertically;
+            if (flipped)
+                mode |= QSGSimpleTextureNode::MirrorHorizontally;
+            node->setTextureCoordinatesTransform(mode);
+        }
+
+        // Move on to the latest frame, giving the previous buffer back
+        if (node->reading != frames->front) {
+            node->release();
+            node->reading = frames->front;
+            frames->buffers[node->reading].readers++;
+        }
+
+        // Wait on the GPU for the source to finish writing the frame
+        CloneFrames::Buffer &buffer = frames->buffers[node->reading];
+        if (buffer.writeSync)
+            context->extraFunctions()->glWaitSync(buffer.writeSync, 0, GL_TIMEOUT_IGNORED);
+
+        if (!node->texture() ||
+                node->texture()->textureId() != int(buffer.texture) ||
+                node->texture()->textureSize() != buffer.size)
+            node->setTexture(window()->createTextureFromId(buffer.texture, buffer.size));
+
+        // Scale to fit, letterboxing when the aspect ratios differ
+        const QSizeF fitted = QSizeF(buffer.size).scaled(QSizeF(width(), height()), Qt::KeepAspectRatio);
+        node->setRect(QRectF(QPointF((width() - fitted.width()) / 2,
+                                     (height() - fitted.height()) / 2), fitted));
+        node->markDirty(QSGNode::DirtyMaterial);
+
+        return node;
+    }
+};
+
+/*
+ * OutputPrivate
+ */
+
+void QuickOutputPrivate::startCloning()
+{
+    Q_Q(QuickOutput);
+
+    QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(q->window());
+    if (!quickWindow || !cloneSource)
+        return;
+
+    QuickOutputPrivate *sourcePrivate = get(cloneSource);
+    sourcePrivate->clones.append(q);
+
+    // Mirrored outputs are refreshed at a fixed rate
+    sourcePrivate->updateAdaptiveSync();
+    updateAdaptiveSync();
+
+    // The scene of this output is not shown anymore
+    Q_FOREACH (QQuickItem *item, quickWindow->contentItem()->childItems()) {
+        if (item->isVisible()) {
+            hiddenItems.append(item);
+            item->setVisible(false);
+        }
+    }
+
+    // Scanning out the very same buffers is the cheapest way, otherwise
+    // the frame of the source is copied and scaled with one blit
+    scanoutClone = nativeScreen && nativeScreen->screen() &&
+            sourcePrivate->nativeScreen && sourcePrivate->nativeScreen->screen() &&
+            Platform::EglFSFunctions::setScanoutClone(nativeScreen->screen(),
+                                                      sourcePrivate->nativeScreen->screen());
+    if (!scanoutClone) {
+        // Nothing to do when the display hardware rotates the scan out
+        const QWaylandOutput::Transform transform =
+                nativeScreen && nativeScreen->hasHardwareTransform()
+                ? QWaylandOutput::TransformNormal : q->transform();
+        const bool flipped = transform >= QWaylandOutput::TransformFlipped;
+
+        cloneItem = new CloneItem(sourcePrivate->cloneFrames, flipped, quickWindow->contentItem());
+        cloneItem->setSize(quickWindow->contentItem()->size());
+
+        // Honor the transform of this output, for example
+        // a projector mounted upside down
+        switch (transform) {
+        case QWaylandOutput::Transform90:
+        case QWaylandOutput::TransformFlipped90:
+        case QWaylandOutput::Transform270:
+        case QWaylandOutput::TransformFlipped270:
+            cloneItem->setSize(cloneItem->size().transposed());
+            cloneItem->setPosition(QPointF(quickWindow->width() - cloneItem->width(),
+                                           quickWindow->height() - cloneItem->height()) / 2);
+            cloneItem->setRotation(transform == QWaylandOutput::Transform90 ||
+                                   transform == QWaylandOutput::TransformFlipped90 ? 90 : 270);
+            break;
+        case QWaylandOutput::Transform180:
+        case QWaylandOutput::TransformFlipped180:
+            cloneItem->setRotation(180);
+            break;
+        default:
+            break;
+        }
+
+        sourcePrivate->blitClones.ref();
+        cloneSource->window()->requestUpdate();
+    }
+
+    // Timings may not match anymore, start over
+    cloneSourceModeConnection =
+            QObject::connect(cloneSource.data(), &QWaylandOutput::currentModeChanged, q, [this] {
+        stopCloning();
+        startCloning();
+    });
+}
+
+void QuickOutputPrivate::stopCloning()
+{
+    Q_Q(QuickOutput);
+
+    QObject::disconnect(cloneSourceModeConnection);
+
+    if (cloneSource) {
+        QuickOutputPrivate *sourcePrivate = get(cloneSource);
+        sourcePrivate->clones.removeOne(q);
+        if (cloneItem)
+            sourcePrivate->blitClones.deref();
+        sourcePrivate->updateAdaptiveSync();
+    }
+
+    if (scanoutClone && nativeScreen && nativeScreen->screen())
+        Platform::EglFSFunctions::setScanoutClone(nativeScreen->screen(), Q_NULLPTR);
+    scanoutClone = false;
+
+    delete cloneItem;
+    cloneItem = Q_NULLPTR;
+
+    Q_FOREACH (QQuickItem *item, hiddenItems) {
+        if (item)
+            item->setVisible(true);
+    }
+    hiddenItems.clear();
+}
+
+void QuickOutputPrivate::copyFrameForClones()
+{
+    Q_Q(QuickOutput);
+
+    if (blitClones.load() == 0)
+        return;
+
+    QQuickWindow *quickWindow = static_cast<QQuickWindow *>(q->window());
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!quickWindow || !context)
+        return;
+
+    QOpenGLFunctions *gl = context->functions();
+    const bool fences = CloneFrames::hasFences(context);
+    const QSize size = quickWindow->size() * quickWindow->devicePixelRatio();
+
+    QMutexLocker locker(&cloneFrames->mutex);
+    cloneFrames->context = context;
+
+    // Write a buffer no clone is sampling from, preferring the one
+    // that is not the latest frame; when every clone is still busy
+    // with both buffers this frame is skipped
+    int index = -1;
+    for (int i = 0; i < 2 && index < 0; ++i) {
+        if (i != cloneFrames->front && cloneFrames->buffers[i].readers == 0)
+            index = i;
+    }
+    if (index < 0 && cloneFrames->front >= 0 &&
+            cloneFrames->buffers[cloneFrames->front].readers == 0)
+        index = cloneFrames->front;
+    if (index < 0)
+        return;
+
+    CloneFrames::Buffer &buffer = cloneFrames->buffers[index];
+
+    // Reads issued by the clones before they let the buffer go
+    Q_FOREACH (GLsync sync, buffer.readSyncs) {
+        context->extraFunctions()->glWaitSync(sync, 0, GL_TIMEOUT_IGNORED);
+        context->extraFunctions()->glDeleteSync(sync);
+    }
+    buffer.readSyncs.clear();
+    if (buffer.writeSync) {
+        context->extraFunctions()->glDeleteSync(buffer.writeSync);
+        buffer.writeSync = 0;
+    }
+
+    if (!buffer.texture || buffer.size != size) {
+        if (buffer.texture)
+            gl->glDeleteTextures(1, &buffer.texture);
+        gl->glGenTextures(1, &buffer.texture);
+        gl->glBindTexture(GL_TEXTURE_2D, buffer.texture);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, size.width(), size.height(),
+                         0, GL_RGB, GL_UNSIGNED_BYTE, Q_NULLPTR);
+        buffer.size = size;
+    } else {
+        gl->glBindTexture(GL_TEXTURE_2D, buffer.texture);
+    }
+
+    // The frame is still in the back buffer, the swap comes later
+    gl->glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, size.width(), size.height());
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Clones wait on the GPU for the fence paired with this buffer
+    // when fences are available, otherwise the copy has to be
+    // complete right now
+    if (fences) {
+        buffer.writeSync = context->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        gl->glFlush();
+    } else {
+        gl->glFinish();
+    }
+
+    cloneFrames->front = index;
+
+    QMetaObject::invokeMethod(q, "updateClones", Qt::QueuedConnection);
+}
+
+void QuickOutputPrivate::releaseCloneFrame()
+{
+    QMutexLocker locker(&cloneFrames->mutex);
+
+    // Buffers still sampled by a clone are destroyed by its last reader
+    for (int i = 0; i < 2; ++i) {
+        if (cloneFrames->buffers[i].readers == 0)
+            cloneFrames->destroyBuffer(cloneFrames->buffers[i]);
+    }
+    cloneFrames->context = Q_NULLPTR;
+    cloneFrames->front = -1;
+}
+
+static const int colorLutSize = 256;
+
+static const char *colorVertexShader =
+        "attribute highp vec2 vertex;\n"
+        "varying highp vec2 coord;\n"
+        "void main() {\n"
+        "    coord = vertex * 0.5 + 0.5;\n"
+        "    gl_Position = vec4(vertex, 0.0, 1.0);\n"
+        "}\n";
+
+// Degamma, color transform and gamma fused in one pass,
+// the first row of the LUT texture is degamma and the
+// second one is gamma
+static const char *colorFragmentShader =
+        "uniform sampler2D frame;\n"
+        "uniform sampler2D lut;\n"
+        "uniform highp mat3 matrix;\n"
+        "varying highp vec2 coord;\n"
+        "highp vec3 lookup(highp vec3 c, highp float row) {\n"
+        "    c = clamp(c, 0.0, 1.0) * (255.0 / 256.0) + (0.5 / 256.0);\n"
+        "    return vec3(texture2D(lut, vec2(c.r, row)).r,\n"
+        "                texture2D(lut, vec2(c.g, row)).g,\n"
+        "                texture2D(lut, vec2(c.b, row)).b);\n"
+        "}\n"
+        "void main() {\n"
+        "    highp vec4 color = texture2D(frame, coord);\n"
+        "    highp vec3 c = matrix * lookup(color.rgb, 0.25);\n"
+        "    gl_FragColor = vec4(lookup(c, 0.75), color.a);\n"
+        "}\n";
+
+void QuickOutputPrivate::updateColorCorrection()
+{
+    Q_Q(QuickOutput);
+
+    Platform::EglFSFunctions::ColorCorrection correction;
+    if (nativeScreen && !nativeScreen->hasHardwareColorCorrection()) {
+        Platform::EglFSFunctions::ColorPipeline pipeline;
+        pipeline.stages = Platform::EglFSFunctions::DegammaStage |
+                Platform::EglFSFunctions::ColorTransformStage |
+                Platform::EglFSFunctions::GammaStage;
+        pipeline.degammaSize = colorLutSize;
+        pipeline.gammaSize = colorLutSize;
+        correction = Screen::get(nativeScreen)->colorCorrection(pipeline);
+    }
+
+    const bool enabled = !correction.gammaLut.isEmpty() || !correction.colorTransform.isEmpty();
+
+    QVector<uchar> lut(colorLutSize * 2 * 4);
+    for (int i = 0; i < colorLutSize; i++) {
+        for (int channel = 0; channel < 3; channel++) {
+            lut[i * 4 + channel] = correction.degammaLut.isEmpty()
+                    ? i : correction.degammaLut.at(i * 3 + channel) >> 8;
+            lut[(colorLutSize + i) * 4 + channel] = correction.gammaLut.isEmpty()
+                    ? i : correction.gammaLut.at(i * 3 + channel) >> 8;
+        }
+        lut[i * 4 + 3] = lut[(colorLutSize + i) * 4 + 3] = 255;
+    }
+
+    QMatrix3x3 matrix;
+    if (!correction.colorTransform.isEmpty()) {
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 3; column++)
+                matrix(row, column) = correction.colorTransform.at(row * 3 + column);
+        }
+    }
+
+    {
+        QMutexLocker locker(&colorMutex);
+        if (!enabled && !colorCorrection)
+            return;
+        colorCorrection = enabled;
+        colorLut = lut;
+        colorMatrix = matrix;
+        colorLutDirty = true;
+    }
+
+    QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(q->window());
+    if (quickWindow)
+        quickWindow->update();
+}
+
+void QuickOutputPrivate::beginColorCorrection()
+{
+    Q_Q(QuickOutput);
+
+    QQuickWindow *quickWindow = static_cast<QQuickWindow *>(q->window());
+    if (!quickWindow)
+        return;
+
+    QMutexLocker locker(&colorMutex);
+
+    if (!colorCorrection) {
+        if (colorFbo) {
+            quickWindow->setRenderTarget(Q_NULLPTR);
+            delete colorFbo;
+            colorFbo = Q_NULLPTR;
+        }
+        return;
+    }
+
+    // Render the scene off screen, it's drawn corrected afterwards
+    const QSize size = quickWindow->size() * quickWindow->devicePixelRatio();
+    if (!colorFbo || colorFbo->size() != size) {
+        delete colorFbo;
+        colorFbo = new QOpenGLFramebufferObject(size, QOpenGLFramebufferObject::CombinedDepthStencil);
+    }
+    quickWindow->setRenderTarget(colorFbo);
+}
+
+void QuickOutputPrivate::endColorCorrection()
+{
+    Q_Q(QuickOutput);
+
+    QQuickWindow *quickWindow = static_cast<QQuickWindow *>(q->window());
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!quickWindow || !context || !colorFbo || quickWindow->renderTarget() != colorFbo)
+        return;
+
+    QOpenGLFunctions *gl = context->functions();
+
+    if (!colorProgram) {
+        colorProgram = new QOpenGLShaderProgram();
+        colorProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, colorVertexShader);
+        colorProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, colorFragmentShader);
+        colorProgram->bindAttributeLocation("vertex", 0);
+        if (!colorProgram->link())
+            qCWarning(gLcCore) << "Failed to link the color correction shader:" << colorProgram->log();
+    }
+
+    if (!colorLutTexture) {
+        gl->glGenTextures(1, &colorLutTexture);
+        gl->glBindTexture(GL_TEXTURE_2D, colorLutTexture);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        colorLutDirty = true;
+    }
+
+    QMatrix3x3 matrix;
+    {
+        QMutexLocker locker(&colorMutex);
+        if (colorLutDirty) {
+            gl->glBindTexture(GL_TEXTURE_2D, colorLutTexture);
+            gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, colorLutSize, 2, 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, colorLut.constData());
+            colorLutDirty = false;
+        }
+        matrix = colorMatrix;
+    }
+
+    QOpenGLFramebufferObject::bindDefault();
+    gl->glViewport(0, 0, colorFbo->width(), colorFbo->height());
+    gl->glDisable(GL_BLEND);
+    gl->glDisable(GL_DEPTH_TEST);
+    gl->glDisable(GL_SCISSOR_TEST);
+    gl->glDisable(GL_STENCIL_TEST);
+
+    gl->glActiveTexture(GL_TEXTURE1);
+    gl->glBindTexture(GL_TEXTURE_2D, colorLutTexture);
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, colorFbo->texture());
+
+    colorProgram->bind();
+    colorProgram->setUniformValue("frame", 0);
+    colorProgram->setUniformValue("lut", 1);
+    colorProgram->setUniformValue("matrix", matrix);
+
+    static const GLfloat vertices[] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    colorProgram->enableAttributeArray(0);
+    colorProgram->setAttributeArray(0, GL_FLOAT, vertices, 2);
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    colorProgram->disableAttributeArray(0);
+    colorProgram->release();
+
+    quickWindow->resetOpenGLState();
+}
+
+void QuickOutputPrivate::releaseColorCorrection()
+{
+    Q_Q(QuickOutput);
+
+    QQuickWindow *quickWindow = static_cast<QQuickWindow *>(q->window());
+    if (quickWindow && colorFbo && quickWindow->renderTarget() == colorFbo)
+        quickWindow->setRenderTarget(Q_NULLPTR);
+
+    delete colorFbo;
+    colorFbo = Q_NULLPTR;
+    delete colorProgram;
+    colorProgram = Q_NULLPTR;
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context && colorLutTexture)
+        context->functions()->glDeleteTextures(1, &colorLutTexture);
+    colorLutTexture = 0;
+}
+
+static qint64 monotonicTime()
+{
+    // Same clock as the page flip events
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static void presentationCallback(const Platform::EglFSFunctions::Presentation &presentation, void *data)
+{
+    // Page flips are handled by the render thread
+    QuickOutput *output = static_cast<QuickOutput *>(data);
+    const qint64 timestamp = qint64(presentation.ust) * 1000;
+    QTimer::singleShot(0, output, [output, timestamp] {
+        QuickOutputPrivate::get(output)->flipCompleted(timestamp);
+    });
+}
+
+void QuickOutputPrivate::setFullScreenSurface(QWaylandSurface *surface)
+{
+    Q_Q(QuickOutput);
+
+    if (fullScreenSurface == surface)
+        return;
+
+    QObject::disconnect(fullScreenCommitConnection);
+    QObject::disconnect(fullScreenDestroyedConnection);
+    setFullScreenRedrawsDeferred(false);
+    fullScreenSurface = surface;
+
+    // Composition follows the commits of the fullscreen surface
+    if (fullScreenSurface) {
+        fullScreenCommitConnection =
+                QObject::connect(fullScreenSurface.data(), &QWaylandSurface::redraw, q, [this] {
+            frameScheduler.commit(monotonicTime());
+            scheduleFrame();
+        });
+        fullScreenDestroyedConnection =
+                QObject::connect(fullScreenSurface.data(), &QObject::destroyed, q, [this] {
+            updateAdaptiveSync();
+        });
+    }
+
+    updateAdaptiveSync();
+    setFullScreenRedrawsDeferred(adaptiveSyncActive);
+}
+
+void QuickOutputPrivate::setFullScreenRedrawsDeferred(bool deferred)
+{
+    Q_Q(QuickOutput);
+
+    if (!fullScreenSurface)
+        return;
+
+    // Only the items on our window, the surface might be shown elsewhere too
+    Q_FOREACH (QWaylandView *view, fullScreenSurface->views()) {
+        QWaylandQuickItem *item = qobject_cast<QWaylandQuickItem *>(view->renderObject());
+        if (item && item->window() == q->window())
+            QWaylandQuickItemPrivate::get(item)->setRedrawDeferred(deferred);
+    }
+}
+
+void QuickOutputPrivate::updateAdaptiveSyncRange()
+{
+    Q_Q(QuickOutput);
+
+    qreal minimumRate = 0, maximumRate = 0;
+    const bool capable = nativeScreen && nativeScreen->screen() &&
+            Platform::EglFSFunctions::adaptiveSyncRange(nativeScreen->screen(),
+                                                        &minimumRate, &maximumRate);
+    frameScheduler.setRefreshRange(minimumRate, maximumRate);
+
+    if (adaptiveSyncCapable != capable) {
+        adaptiveSyncCapable = capable;
+        Q_EMIT q->adaptiveSyncCapableChanged();
+    }
+
+    updateAdaptiveSync();
+}
+
+void QuickOutputPrivate::updateAdaptiveSync()
+{
+    Q_Q(QuickOutput);
+
+    bool active = false;
+    if (adaptiveSyncCapable && !cloneSource && clones.isEmpty()) {
+        switch (adaptiveSyncPolicy) {
+        case QuickOutput::AdaptiveSyncAlways:
+            active = true;
+            break;
+        case QuickOutput::AdaptiveSyncFullScreen:
+            active = !fullScreenSurface.isNull();
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (adaptiveSyncActive == active)
+        return;
+
+    QScreen *screen = nativeScreen ? nativeScreen->screen() : Q_NULLPTR;
+    if (screen && !Platform::EglFSFunctions::setAdaptiveSync(screen, active)) {
+        qCWarning(gLcCore) << "Unable to change adaptive sync for" << q;
+        return;
+    }
+
+    adaptiveSyncActive = active;
+    frameScheduler.setVariable(active);
+    if (!active && frameTimer)
+        frameTimer->stop();
+
+    // Flips are reported as they happen, the frame that was just
+    // swapped is still waiting for vblank
+    if (presentationScreen) {
+        Platform::EglFSFunctions::setPresentationCallback(presentationScreen, Q_NULLPTR, Q_NULLPTR);
+        presentationScreen = Q_NULLPTR;
+    }
+    if (active && screen && Platform::EglFSFunctions::setPresentationCallback(screen, presentationCallback, q))
+        presentationScreen = screen;
+
+    // Commits of the fullscreen surface wait for the scheduler
+    setFullScreenRedrawsDeferred(active);
+
+    Q_EMIT q->adaptiveSyncActiveChanged();
+
+    scheduleFrame();
+}
+
+void QuickOutputPrivate::scheduleFrame()
+{
+    Q_Q(QuickOutput);
+
+    // Fixed refresh rate frames are driven by vblank as usual
+    QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(q->window());
+    if (!adaptiveSyncActive || !quickWindow)
+        return;
+
+    const qint64 frameTime = frameScheduler.nextFrameTime();
+    if (frameTime < 0)
+        return;
+
+    if (!frameTimer) {
+        frameTimer = new QTimer(q);
+        frameTimer->setSingleShot(true);
+        frameTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(frameTimer, &QTimer::timeout, q, [this] {
+            renderFrame();
+        });
+    }
+
+    const qint64 delay = frameTime - monotonicTime();
+    if (delay <= 0) {
+        frameTimer->stop();
+        renderFrame();
+    } else {
+        frameTimer->start(int((delay + 999999) / 1000000));
+    }
+}
+
+void QuickOutputPrivate::renderFrame()
+{
+    Q_Q(QuickOutput);
+
+    QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(q->window());
+    if (!quickWindow)
+        return;
+
+    // Pick up the deferred commits, repeated frames have
+    // no changes at all and are forced the same way
+    if (fullScreenSurface) {
+        Q_FOREACH (QWaylandView *view, fullScreenSurface->views()) {
+            QWaylandQuickItem *item = qobject_cast<QWaylandQuickItem *>(view->renderObject());
+            if (item && item->window() == quickWindow)
+                item->update();
+        }
+    }
+    quickWindow->update();
+}
+
+void QuickOutputPrivate::flipCompleted(qint64 timestamp)
+{
+    if (!adaptiveSyncActive)
+        return;
+
+    frameScheduler.flipCompleted(timestamp);
+    scheduleFrame();
+}
+
+void QuickOutputPrivate::setIdle(bool value)
+{
+    Q_Q(QuickOutput);
+
+    if (idle == value)
+        return;
+
+    idle = value;
+
+    if (idle) {
+        // Clients stop drawing frames nobody looks at
+        idleFrameCallback = q->automaticFrameCallback();
+        q->setAutomaticFrameCallback(false);
+
+        // The platform stops rendering the scene while the output is off
+        idlePowerState = q->powerState();
+        q->setPowerState(QuickOutput::PowerStateOff);
+    } else {
+        q->setPowerState(idlePowerState);
+        q->setAutomaticFrameCallback(idleFrameCallback);
+
+        // Clients waiting for a frame callback get it with this frame
+        if (q->window())
+            q->update();
+    }
+}
+
 /*
  * Output
  */
@@ -191,6 +948,21 @@ QuickOutput::QuickOutput(QWaylandCompositor *compositor)
     });
 }
 
+QuickOutput::~QuickOutput()
+{
+    Q_D(QuickOutput);
+
+    // Outputs mirroring this one show their own scene again
+    Q_FOREACH (QuickOutput *clone, d->clones)
+        clone->setCloneSource(Q_NULLPTR);
+    setCloneSource(Q_NULLPTR);
+
+    if (d->presentationScreen)
+        Platform::EglFSFunctions::setPresentationCallback(d->presentationScreen, Q_NULLPTR, Q_NULLPTR);
+
+    delete d_ptr;
+}
+
 QQmlListProperty<QObject> QuickOutput::data()
 {
     Q_D(QuickOutput);
@@ -330,6 +1102,71 @@ void QuickOutput::setHotSpotPushTime(quint64 value)
     Q_EMIT hotSpotPushTimeChanged();
 }
 
+QuickOutput *QuickOutput::cloneSource() const
+{
+    Q_D(const QuickOutput);
+    return d->cloneSource;
+}
+
+/*
+ * Mirroring without scanout cloning samples the frames rendered by the
+ * source output, the application must set Qt::AA_ShareOpenGLContexts
+ * before creating QGuiApplication, otherwise the clone shows nothing.
+ */
+void QuickOutput::setCloneSource(QuickOutput *source)
+{
+    Q_D(QuickOutput);
+
+    if (d->cloneSource == source)
+        return;
+
+    if (source == this || (source && source->cloneSource())) {
+        qCWarning(gLcCore) << "Cannot mirror" << source << "on" << this;
+        return;
+    }
+
+    if (d->initialized)
+        d->stopCloning();
+    d->cloneSource = source;
+    if (d->initialized && d->cloneSource)
+        d->startCloning();
+    d->updateAdaptiveSync();
+
+    Q_EMIT cloneSourceChanged();
+}
+
+QuickOutput::AdaptiveSyncPolicy QuickOutput::adaptiveSyncPolicy() const
+{
+    Q_D(const QuickOutput);
+    return d->adaptiveSyncPolicy;
+}
+
+void QuickOutput::setAdaptiveSyncPolicy(AdaptiveSyncPolicy policy)
+{
+    Q_D(QuickOutput);
+
+    if (d->adaptiveSyncPolicy == policy)
+        return;
+
+    d->adaptiveSyncPolicy = policy;
+    Q_EMIT adaptiveSyncPolicyChanged();
+
+    if (d->initialized)
+        d->updateAdaptiveSync();
+}
+
+bool QuickOutput::isAdaptiveSyncCapable() const
+{
+    Q_D(const QuickOutput);
+    return d->adaptiveSyncCapable;
+}
+
+bool QuickOutput::isAdaptiveSyncActive() const
+{
+    Q_D(const QuickOutput);
+    return d->adaptiveSyncActive;
+}
+
 QuickOutput *QuickOutput::fromResource(wl_resource *resource)
 {
     return qobject_cast<QuickOutput *>(QWaylandOutput::fromResource(resource));
@@ -354,8 +1191,10 @@ void QuickOutput::initialize()
             this, &QuickOutput::readContent);
 
     // Add modes
-    QList<Screen::Mode> modes = d->nativeScreen->modes();
-    if (d->nativeScreen && modes.size() > 0 && !sizeFollowsWindow()) {
+    QList<Screen::Mode> modes;
+    if (d->nativeScreen)
+        modes = d->nativeScreen->modes();
+    if (modes.size() > 0 && !sizeFollowsWindow()) {
         int modeId = 0;
         Q_FOREACH (const Screen::Mode &mode, modes) {
             Mode::Flags flags;
@@ -373,10 +1212,55 @@ void QuickOutput::initialize()
         setCurrentMode(currentMode.size, currentMode.refreshRate);
     }
 
+    // Correct colors when the display hardware cannot, before
+    // the frame is copied for the outputs that mirror this one
+    connect(quickWindow, &QQuickWindow::beforeRendering, this, [d] {
+        d->beginColorCorrection();
+    }, Qt::DirectConnection);
+    connect(quickWindow, &QQuickWindow::afterRendering, this, [d] {
+        d->endColorCorrection();
+    }, Qt::DirectConnection);
+    connect(quickWindow, &QQuickWindow::sceneGraphInvalidated, this, [d] {
+        d->releaseColorCorrection();
+    }, Qt::DirectConnection);
+    if (d->nativeScreen) {
+        connect(d->nativeScreen, &Screen::colorCorrectionChanged, this, [d] {
+            d->updateColorCorrection();
+        });
+        d->updateColorCorrection();
+    }
+
+    // Copy each frame for the outputs that mirror this one
+    connect(quickWindow, &QQuickWindow::afterRendering, this, [d] {
+        d->copyFrameForClones();
+    }, Qt::DirectConnection);
+    connect(quickWindow, &QQuickWindow::sceneGraphInvalidated, this, [d] {
+        d->releaseCloneFrame();
+    }, Qt::DirectConnection);
+
+    // Pace frames when adaptive sync is active
+    connect(quickWindow, &QQuickWindow::afterAnimating, this, [d] {
+        if (d->adaptiveSyncActive)
+            d->frameScheduler.frameStarted(monotonicTime());
+    });
+    connect(quickWindow, &QQuickWindow::frameSwapped, this, [d] {
+        // Without page flip reports the swap is the best we know
+        if (!d->presentationScreen)
+            d->flipCompleted(monotonicTime());
+    }, Qt::QueuedConnection);
+    connect(this, &QWaylandOutput::currentModeChanged, this, [d] {
+        d->updateAdaptiveSyncRange();
+    });
+
     // Set the window visible now
     quickWindow->setVisible(true);
 
     d->initialized = true;
+
+    if (d->cloneSource)
+        d->startCloning();
+
+    d->updateAdaptiveSyncRange();
 }
 
 void QuickOutput::readContent()
@@ -393,6 +1277,17 @@ void QuickOutput::readContent()
         screencaster->recordFrame(quickWindow);
 }
 
+void QuickOutput::updateClones()
+{
+    Q_D(QuickOutput);
+
+    Q_FOREACH (QuickOutput *clone, d->clones) {
+        QuickOutputPrivate *clonePrivate = QuickOutputPrivate::get(clone);
+        if (clonePrivate->cloneItem)
+            clonePrivate->cloneItem->update();
+    }
+}
+
 } // namespace Server
 
 } // namespace GreenIsland
@@ -52,6 +52,10 @@ class GREENISLANDSERVER_EXPORT QuickOutput : public QWaylandQuickOutput
     Q_PROPERTY(QSize hotSpotSize READ hotSpotSize WRITE setHotSpotSize NOTIFY hotSpotSizeChanged)
     Q_PROPERTY(quint64 hotSpotThreshold READ hotSpotThreshold WRITE setHotSpotThreshold NOTIFY hotSpotThresholdChanged)
     Q_PROPERTY(quint64 hotSpotPushTime READ hotSpotPushTime WRITE setHotSpotPushTime NOTIFY hotSpotPushTimeChanged)
+    Q_PROPERTY(QuickOutput *cloneSource READ cloneSource WRITE setCloneSource NOTIFY cloneSourceChanged)
+    Q_PROPERTY(AdaptiveSyncPolicy adaptiveSyncPolicy READ adaptiveSyncPolicy WRITE setAdaptiveSyncPolicy NOTIFY adaptiveSyncPolicyChanged)
+    Q_PROPERTY(bool adaptiveSyncCapable READ isAdaptiveSyncCapable NOTIFY adaptiveSyncCapableChanged)
+    Q_PROPERTY(bool adaptiveSyncActive READ isAdaptiveSyncActive NOTIFY adaptiveSyncActiveChanged)
     Q_PROPERTY(QQmlListProperty<QObject> data READ data DESIGNABLE false)
     Q_CLASSINFO("DefaultProperty", "data")
 public:
@@ -71,8 +75,16 @@ public:
     };
     Q_ENUM(HotSpot)
 
+    enum AdaptiveSyncPolicy {
+        AdaptiveSyncNever = 0,
+        AdaptiveSyncFullScreen,
+        AdaptiveSyncAlways
+    };
+    Q_ENUM(AdaptiveSyncPolicy)
+
     QuickOutput();
     QuickOutput(QWaylandCompositor *compositor);
+    ~QuickOutput();
 
     QQmlListProperty<QObject> data();
 
@@ -94,6 +106,15 @@ public:
     quint64 hotSpotPushTime() const;
     void setHotSpotPushTime(quint64 value);
 
+    QuickOutput *cloneSource() const;
+    void setCloneSource(QuickOutput *source);
+
+    AdaptiveSyncPolicy adaptiveSyncPolicy() const;
+    void setAdaptiveSyncPolicy(AdaptiveSyncPolicy policy);
+
+    bool isAdaptiveSyncCapable() const;
+    bool isAdaptiveSyncActive() const;
+
     static QuickOutput *fromResource(wl_resource *resource);
 
 protected:
@@ -107,12 +128,17 @@ Q_SIGNALS:
     void hotSpotThresholdChanged();
     void hotSpotPushTimeChanged();
     void hotSpotTriggered(HotSpot hotSpot);
+    void cloneSourceChanged();
+    void adaptiveSyncPolicyChanged();
+    void adaptiveSyncCapableChanged();
+    void adaptiveSyncActiveChanged();
 
 private:
     QuickOutputPrivate *const d_ptr;
 
 private Q_SLOTS:
     void readContent();
+    void updateClones();
 };
 
 } // namespace Server
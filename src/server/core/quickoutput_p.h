@@ -0,0 +1,206 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2014-2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef GREENISLAND_QUICKOUTPUT_P_H
+#define GREENISLAND_QUICKOUTPUT_P_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+#include <QtCore/private/qobject_p.h>
+#include <QtGui/QMatrix3x3>
+#include <QtGui/QScreen>
+#include <QtGui/qopengl.h>
+
+#include <GreenIsland/Platform/FrameScheduler>
+
+#include <GreenIsland/Server/QuickOutput>
+
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Green Island API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+class QQuickItem;
+class QTimer;
+class QWaylandSurface;
+
+namespace GreenIsland {
+
+namespace Server {
+
+class CloneFrames
+{
+public:
+    struct Buffer
+    {
+        Buffer()
+            : texture(0)
+            , writeSync(0)
+            , readers(0)
+        {
+        }
+
+        GLuint texture;
+        QSize size;
+        GLsync writeSync;
+        QVector<GLsync> readSyncs;
+        int readers;
+    };
+
+    CloneFrames()
+        : context(Q_NULLPTR)
+        , front(-1)
+    {
+    }
+
+    void destroyBuffer(Buffer &buffer);
+
+    static bool hasFences(QOpenGLContext *context);
+
+    // Textures and fences live in the share group of the
+    // source context, null once the source scene graph is gone
+    QMutex mutex;
+    QOpenGLContext *context;
+    Buffer buffers[2];
+    int front;
+};
+
+class GREENISLANDSERVER_EXPORT QuickOutputPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QuickOutput)
+public:
+    QuickOutputPrivate()
+        : initialized(false)
+        , enabled(true)
+        , hotSpotSize(QSize(5, 5))
+        , hotSpotThreshold(1000)
+        , hotSpotPushTime(50)
+        , scanoutClone(false)
+        , cloneItem(Q_NULLPTR)
+        , cloneFrames(new CloneFrames)
+        , adaptiveSyncPolicy(QuickOutput::AdaptiveSyncFullScreen)
+        , adaptiveSyncCapable(false)
+        , adaptiveSyncActive(false)
+        , frameTimer(Q_NULLPTR)
+        , colorCorrection(false)
+        , colorLutDirty(false)
+        , colorFbo(Q_NULLPTR)
+        , colorProgram(Q_NULLPTR)
+        , colorLutTexture(0)
+        , idle(false)
+        , idleFrameCallback(true)
+        , idlePowerState(QuickOutput::PowerStateOn)
+    {
+    }
+
+    void startCloning();
+    void stopCloning();
+    void copyFrameForClones();
+    void releaseCloneFrame();
+
+    void setFullScreenSurface(QWaylandSurface *surface);
+    void updateAdaptiveSyncRange();
+    void updateAdaptiveSync();
+    void setFullScreenRedrawsDeferred(bool deferred);
+    void scheduleFrame();
+    void renderFrame();
+    void flipCompleted(qint64 timestamp);
+
+    void updateColorCorrection();
+    void beginColorCorrection();
+    void endColorCorrection();
+    void releaseColorCorrection();
+
+    void setIdle(bool value);
+
+    static QuickOutputPrivate *get(QuickOutput *output) { return output->d_func(); }
+
+    bool initialized;
+    QPointer<Screen> nativeScreen;
+    bool enabled;
+    QSize hotSpotSize;
+    quint64 hotSpotThreshold;
+    quint64 hotSpotPushTime;
+    QList<QObject *> objects;
+
+    // Mirror side, GUI thread only
+    QPointer<QuickOutput> cloneSource;
+    bool scanoutClone;
+    QQuickItem *cloneItem;
+    QList<QPointer<QQuickItem> > hiddenItems;
+    QMetaObject::Connection cloneSourceModeConnection;
+
+    // Source side, frames are written by our render thread and
+    // read by the render threads of the clones, the buffer being
+    // written is never one a clone is sampling from
+    QList<QuickOutput *> clones;
+    QAtomicInt blitClones;
+    QSharedPointer<CloneFrames> cloneFrames;
+
+    // Adaptive sync, GUI thread only
+    QuickOutput::AdaptiveSyncPolicy adaptiveSyncPolicy;
+    bool adaptiveSyncCapable;
+    bool adaptiveSyncActive;
+    QPointer<QWaylandSurface> fullScreenSurface;
+    QMetaObject::Connection fullScreenCommitConnection;
+    QMetaObject::Connection fullScreenDestroyedConnection;
+    Platform::FrameScheduler frameScheduler;
+    QTimer *frameTimer;
+    QPointer<QScreen> presentationScreen;
+
+    // Color correction when the display hardware cannot do it,
+    // set by the GUI thread and consumed by our render thread
+    QMutex colorMutex;
+    bool colorCorrection;
+    bool colorLutDirty;
+    QVector<uchar> colorLut;
+    QMatrix3x3 colorMatrix;
+    QOpenGLFramebufferObject *colorFbo;
+    QOpenGLShaderProgram *colorProgram;
+    GLuint colorLutTexture;
+
+    // Idle, GUI thread only
+    bool idle;
+    bool idleFrameCallback;
+    QuickOutput::PowerState idlePowerState;
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_QUICKOUTPUT_P_H
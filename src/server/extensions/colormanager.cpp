@@ -0,0 +1,217 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+
+#include <GreenIsland/Platform/EglFSFunctions>
+
+#include "colormanager.h"
+#include "colormanager_p.h"
+#include "core/quickoutput.h"
+#include "serverlogging_p.h"
+
+namespace GreenIsland {
+
+namespace Server {
+
+/*
+ * ColorManagerPrivate
+ */
+
+ColorManagerPrivate::ColorManagerPrivate()
+    : QWaylandCompositorExtensionPrivate()
+    , QtWaylandServer::greenisland_color_manager()
+{
+}
+
+void ColorManagerPrivate::color_manager_get_output_color(Resource *resource, uint32_t id,
+                                                         struct ::wl_resource *outputResource)
+{
+    QuickOutput *output = QuickOutput::fromResource(outputResource);
+    Screen *screen = output ? output->nativeScreen() : Q_NULLPTR;
+    if (!screen)
+        qCWarning(gLcColorManager) << "Colors of output" << output << "cannot be corrected";
+
+    new OutputColor(screen, resource->client(), id);
+}
+
+/*
+ * OutputColor
+ */
+
+OutputColor::OutputColor(Screen *screen, struct ::wl_client *client, uint32_t id)
+    : QtWaylandServer::greenisland_output_color(client, id, 1)
+    , m_screen(screen)
+    , m_pendingTemperature(6500)
+{
+    if (m_screen) {
+        m_pendingTemperature = m_screen->colorTemperature();
+        m_pendingCalibration = m_screen->calibration();
+        m_pendingMatrix = m_screen->colorMatrix();
+
+        m_hardwareConnection =
+                QObject::connect(m_screen.data(), &Screen::hardwareColorCorrectionChanged,
+                                 m_screen.data(), [this] {
+            sendCapabilities();
+        });
+    }
+
+    sendCapabilities();
+
+    Platform::EglFSFunctions::ColorPipeline pipeline;
+    if (m_screen && m_screen->screen())
+        Platform::EglFSFunctions::colorPipeline(m_screen->screen(), &pipeline);
+    send_gamma_size(pipeline.gammaSize);
+}
+
+OutputColor::~OutputColor()
+{
+    QObject::disconnect(m_hardwareConnection);
+}
+
+void OutputColor::sendCapabilities()
+{
+    uint32_t flags = 0;
+    if (m_screen && m_screen->hasHardwareColorCorrection())
+        flags |= capability_hardware;
+    send_capabilities(flags);
+}
+
+void OutputColor::output_color_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+
+    // Colors are back to normal when the client goes away
+    if (m_screen)
+        m_screen->resetColorCorrection();
+
+    delete this;
+}
+
+void OutputColor::output_color_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void OutputColor::output_color_set_temperature(Resource *resource, uint32_t kelvin)
+{
+    Q_UNUSED(resource);
+    m_pendingTemperature = qMin<uint32_t>(kelvin, 10000);
+}
+
+void OutputColor::output_color_set_calibration(Resource *resource, wl_array *ramp)
+{
+    const int size = ramp->size / sizeof(quint16);
+    if (ramp->size % sizeof(quint16) != 0 || (size > 0 && (size % 3 != 0 || size < 6))) {
+        wl_resource_post_error(resource->handle, error_bad_lut,
+                               "calibration ramp must have at least two red, green and blue entries");
+        return;
+    }
+
+    const quint16 *data = static_cast<const quint16 *>(ramp->data);
+    m_pendingCalibration = QVector<quint16>(size);
+    for (int i = 0; i < size; i++)
+        m_pendingCalibration[i] = data[i];
+}
+
+void OutputColor::output_color_set_color_matrix(Resource *resource, wl_array *matrix)
+{
+    if (matrix->size == 0) {
+        m_pendingMatrix.setToIdentity();
+        return;
+    }
+
+    if (matrix->size != 9 * sizeof(wl_fixed_t)) {
+        wl_resource_post_error(resource->handle, error_bad_matrix,
+                               "color matrix must have nine entries");
+        return;
+    }
+
+    // 16.16 fixed point rather than wl_fixed_t, which is only 24.8
+    const qint32 *data = static_cast<const qint32 *>(matrix->data);
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 3; column++)
+            m_pendingMatrix(row, column) = data[row * 3 + column] / 65536.0f;
+    }
+}
+
+void OutputColor::output_color_commit(Resource *resource, uint32_t duration)
+{
+    Q_UNUSED(resource);
+
+    if (!m_screen)
+        return;
+
+    m_screen->setColorTransitionDuration(duration);
+    m_screen->setColorTemperature(m_pendingTemperature);
+    m_screen->setCalibration(m_pendingCalibration);
+    m_screen->setColorMatrix(m_pendingMatrix);
+}
+
+/*
+ * ColorManager
+ */
+
+ColorManager::ColorManager()
+    : QWaylandCompositorExtensionTemplate<ColorManager>(*new ColorManagerPrivate())
+{
+}
+
+ColorManager::ColorManager(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<ColorManager>(compositor, *new ColorManagerPrivate())
+{
+}
+
+void ColorManager::initialize()
+{
+    Q_D(ColorManager);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qCWarning(gLcColorManager) << "Failed to find QWaylandCompositor when initializing ColorManager";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+const struct wl_interface *ColorManager::interface()
+{
+    return ColorManagerPrivate::interface();
+}
+
+QByteArray ColorManager::interfaceName()
+{
+    return ColorManagerPrivate::interfaceName();
+}
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#include "moc_colormanager.cpp"
@@ -0,0 +1,99 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+
+#ifndef GREENISLAND_COLORMANAGER_P_H
+#define GREENISLAND_COLORMANAGER_P_H
+
+#include <QtCore/QPointer>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandcompositorextension_p.h>
+
+#include <GreenIsland/Server/ColorManager>
+#include <GreenIsland/Server/Screen>
+#include <GreenIsland/server/private/qwayland-server-greenisland-colormanager.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Green Island API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+namespace GreenIsland {
+
+namespace Server {
+
+class GREENISLANDSERVER_EXPORT ColorManagerPrivate
+        : public QWaylandCompositorExtensionPrivate
+        , public QtWaylandServer::greenisland_color_manager
+{
+    Q_DECLARE_PUBLIC(ColorManager)
+public:
+    ColorManagerPrivate();
+
+    static ColorManagerPrivate *get(ColorManager *manager) { return manager->d_func(); }
+
+protected:
+    void color_manager_get_output_color(Resource *resource, uint32_t id,
+                                        struct ::wl_resource *outputResource) Q_DECL_OVERRIDE;
+};
+
+class OutputColor : public QtWaylandServer::greenisland_output_color
+{
+public:
+    OutputColor(Screen *screen, struct ::wl_client *client, uint32_t id);
+    ~OutputColor();
+
+protected:
+    void output_color_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
+    void output_color_destroy(Resource *resource) Q_DECL_OVERRIDE;
+    void output_color_set_temperature(Resource *resource, uint32_t kelvin) Q_DECL_OVERRIDE;
+    void output_color_set_calibration(Resource *resource, wl_array *ramp) Q_DECL_OVERRIDE;
+    void output_color_set_color_matrix(Resource *resource, wl_array *matrix) Q_DECL_OVERRIDE;
+    void output_color_commit(Resource *resource, uint32_t duration) Q_DECL_OVERRIDE;
+
+private:
+    void sendCapabilities();
+
+    QPointer<Screen> m_screen;
+    QMetaObject::Connection m_hardwareConnection;
+
+    int m_pendingTemperature;
+    QVector<quint16> m_pendingCalibration;
+    QMatrix3x3 m_pendingMatrix;
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_COLORMANAGER_P_H
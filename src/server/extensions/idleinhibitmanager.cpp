@@ -0,0 +1,178 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+#include <QtQuick/QQuickItem>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+#include <GreenIsland/QtWaylandCompositor/QWaylandView>
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandsurface_p.h>
+
+#include "idleinhibitmanager.h"
+#include "idleinhibitmanager_p.h"
+#include "serverlogging_p.h"
+
+namespace GreenIsland {
+
+namespace Server {
+
+/*
+ * IdleInhibitManagerPrivate
+ */
+
+IdleInhibitManagerPrivate::IdleInhibitManagerPrivate()
+    : QWaylandCompositorExtensionPrivate()
+    , QtWaylandServer::zwp_idle_inhibit_manager_v1()
+{
+}
+
+void IdleInhibitManagerPrivate::idle_inhibit_manager_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void IdleInhibitManagerPrivate::idle_inhibit_manager_v1_create_inhibitor(Resource *resource, uint32_t id,
+                                                                         struct ::wl_resource *surfaceResource)
+{
+    Q_Q(IdleInhibitManager);
+
+    QWaylandSurface *surface = QWaylandSurface::fromResource(surfaceResource);
+    qCDebug(gLcIdleInhibitManager) << "Idle inhibited by surface" << surface;
+
+    inhibitors.append(new IdleInhibitor(q, surface, resource->client(), id));
+}
+
+/*
+ * IdleInhibitor
+ */
+
+IdleInhibitor::IdleInhibitor(IdleInhibitManager *manager, QWaylandSurface *surface,
+                             struct ::wl_client *client, uint32_t id)
+    : QtWaylandServer::zwp_idle_inhibitor_v1(client, id, 1)
+    , m_manager(manager)
+    , m_surface(surface)
+{
+}
+
+IdleInhibitor::~IdleInhibitor()
+{
+    if (m_manager)
+        IdleInhibitManagerPrivate::get(m_manager)->inhibitors.removeOne(this);
+}
+
+bool IdleInhibitor::isActive() const
+{
+    if (!m_surface || !m_surface->isMapped())
+        return false;
+
+    // Only surfaces the user can actually see keep the outputs on
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+    if (surfacePrivate->offscreen ||
+            surfacePrivate->visibility == QWindow::Hidden ||
+            surfacePrivate->visibility == QWindow::Minimized)
+        return false;
+
+    // ...and that are shown on at least one output
+    Q_FOREACH (QWaylandView *view, m_surface->views()) {
+        if (!view->output())
+            continue;
+
+        QQuickItem *item = qobject_cast<QQuickItem *>(view->renderObject());
+        if (!item || item->isVisible())
+            return true;
+    }
+
+    return false;
+}
+
+void IdleInhibitor::idle_inhibitor_v1_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+
+    qCDebug(gLcIdleInhibitManager) << "Idle inhibition released by surface" << m_surface.data();
+    delete this;
+}
+
+void IdleInhibitor::idle_inhibitor_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+/*
+ * IdleInhibitManager
+ */
+
+IdleInhibitManager::IdleInhibitManager()
+    : QWaylandCompositorExtensionTemplate<IdleInhibitManager>(*new IdleInhibitManagerPrivate())
+{
+}
+
+IdleInhibitManager::IdleInhibitManager(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<IdleInhibitManager>(compositor, *new IdleInhibitManagerPrivate())
+{
+}
+
+void IdleInhibitManager::initialize()
+{
+    Q_D(IdleInhibitManager);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qCWarning(gLcIdleInhibitManager) << "Failed to find QWaylandCompositor when initializing IdleInhibitManager";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+// Visibility is checked on each call rather than tracked,
+// it's only needed when the outputs are about to idle
+bool IdleInhibitManager::isInhibited() const
+{
+    Q_D(const IdleInhibitManager);
+
+    Q_FOREACH (IdleInhibitor *inhibitor, d->inhibitors) {
+        if (inhibitor->isActive())
+            return true;
+    }
+
+    return false;
+}
+
+const struct wl_interface *IdleInhibitManager::interface()
+{
+    return IdleInhibitManagerPrivate::interface();
+}
+
+QByteArray IdleInhibitManager::interfaceName()
+{
+    return IdleInhibitManagerPrivate::interfaceName();
+}
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#include "moc_idleinhibitmanager.cpp"
@@ -0,0 +1,60 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+#ifndef GREENISLAND_IDLEINHIBITMANAGER_H
+#define GREENISLAND_IDLEINHIBITMANAGER_H
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositorExtension>
+
+#include <GreenIsland/server/greenislandserver_export.h>
+
+namespace GreenIsland {
+
+namespace Server {
+
+class IdleInhibitManagerPrivate;
+
+class GREENISLANDSERVER_EXPORT IdleInhibitManager : public QWaylandCompositorExtensionTemplate<IdleInhibitManager>
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(IdleInhibitManager)
+public:
+    IdleInhibitManager();
+    IdleInhibitManager(QWaylandCompositor *compositor);
+
+    void initialize() Q_DECL_OVERRIDE;
+
+    bool isInhibited() const;
+
+    static const struct wl_interface *interface();
+    static QByteArray interfaceName();
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_IDLEINHIBITMANAGER_H
@@ -0,0 +1,95 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+#ifndef GREENISLAND_IDLEINHIBITMANAGER_P_H
+#define GREENISLAND_IDLEINHIBITMANAGER_P_H
+
+#include <QtCore/QPointer>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandcompositorextension_p.h>
+
+#include <GreenIsland/Server/IdleInhibitManager>
+#include <GreenIsland/server/private/qwayland-server-idle-inhibit-unstable-v1.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Green Island API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+namespace GreenIsland {
+
+namespace Server {
+
+class IdleInhibitor;
+
+class GREENISLANDSERVER_EXPORT IdleInhibitManagerPrivate
+        : public QWaylandCompositorExtensionPrivate
+        , public QtWaylandServer::zwp_idle_inhibit_manager_v1
+{
+    Q_DECLARE_PUBLIC(IdleInhibitManager)
+public:
+    IdleInhibitManagerPrivate();
+
+    static IdleInhibitManagerPrivate *get(IdleInhibitManager *manager) { return manager->d_func(); }
+
+    QList<IdleInhibitor *> inhibitors;
+
+protected:
+    void idle_inhibit_manager_v1_destroy(Resource *resource) Q_DECL_OVERRIDE;
+    void idle_inhibit_manager_v1_create_inhibitor(Resource *resource, uint32_t id,
+                                                  struct ::wl_resource *surfaceResource) Q_DECL_OVERRIDE;
+};
+
+class IdleInhibitor : public QtWaylandServer::zwp_idle_inhibitor_v1
+{
+public:
+    IdleInhibitor(IdleInhibitManager *manager, QWaylandSurface *surface,
+                  struct ::wl_client *client, uint32_t id);
+    ~IdleInhibitor();
+
+    bool isActive() const;
+
+protected:
+    void idle_inhibitor_v1_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
+    void idle_inhibitor_v1_destroy(Resource *resource) Q_DECL_OVERRIDE;
+
+private:
+    QPointer<IdleInhibitManager> m_manager;
+    QPointer<QWaylandSurface> m_surface;
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_IDLEINHIBITMANAGER_P_H
@@ -27,6 +27,7 @@
 
 #include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
 
+#include "core/quickoutput.h"
 #include "outputchangeset.h"
 #include "outputchangeset_p.h"
 
@@ -34,6 +35,12 @@ namespace GreenIsland {
 
 namespace Server {
 
+static QWaylandOutput *currentCloneSource(QWaylandOutput *output)
+{
+    QuickOutput *quickOutput = qobject_cast<QuickOutput *>(output);
+    return quickOutput ? quickOutput->cloneSource() : Q_NULLPTR;
+}
+
 /*
  * OutputChangesetPrivate
  */
@@ -48,6 +55,7 @@ OutputChangesetPrivate::OutputChangesetPrivate(QWaylandOutput *output)
     , modeId(output->modes().indexOf(output->currentMode()))
     , position(output->position())
     , scaleFactor(output->scaleFactor())
+    , cloneSource(currentCloneSource(output))
 {
 }
 
@@ -104,6 +112,12 @@ bool OutputChangeset::isScaleFactorChanged() const
     return d->scaleFactor != d->output->scaleFactor();
 }
 
+bool OutputChangeset::isCloneSourceChanged() const
+{
+    Q_D(const OutputChangeset);
+    return d->cloneSource != currentCloneSource(d->output);
+}
+
 bool OutputChangeset::isEnabled() const
 {
     Q_D(const OutputChangeset);
@@ -140,6 +154,12 @@ int OutputChangeset::scaleFactor() const
     return d->scaleFactor;
 }
 
+QWaylandOutput *OutputChangeset::cloneSource() const
+{
+    Q_D(const OutputChangeset);
+    return d->cloneSource;
+}
+
 } // namespace Server
 
 } // namespace GreenIsland
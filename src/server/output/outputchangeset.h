@@ -52,12 +52,14 @@ class GREENISLANDSERVER_EXPORT OutputChangeset : public QObject
     Q_PROPERTY(bool modeIdChanged READ isModeIdChanged CONSTANT)
     Q_PROPERTY(bool positionChanged READ isPositionChanged CONSTANT)
     Q_PROPERTY(bool scaleFactorChanged READ isScaleFactorChanged CONSTANT)
+    Q_PROPERTY(bool cloneSourceChanged READ isCloneSourceChanged CONSTANT)
     Q_PROPERTY(bool enabled READ isEnabled CONSTANT)
     Q_PROPERTY(bool primary READ isPrimary CONSTANT)
     Q_PROPERTY(int modeId READ modeId CONSTANT)
     Q_PROPERTY(QWaylandOutput::Transform transform READ transform CONSTANT)
     Q_PROPERTY(QPoint position READ position CONSTANT)
     Q_PROPERTY(int scaleFactor READ scaleFactor CONSTANT)
+    Q_PROPERTY(QWaylandOutput *cloneSource READ cloneSource CONSTANT)
 public:
     QWaylandOutput *output() const;
 
@@ -67,6 +69,7 @@ public:
     bool isModeIdChanged() const;
     bool isPositionChanged() const;
     bool isScaleFactorChanged() const;
+    bool isCloneSourceChanged() const;
 
     bool isEnabled() const;
     bool isPrimary() const;
@@ -74,6 +77,7 @@ public:
     QWaylandOutput::Transform transform() const;
     QPoint position() const;
     int scaleFactor() const;
+    QWaylandOutput *cloneSource() const;
 
 private:
     explicit OutputChangeset(QWaylandOutput *output, QObject *parent = Q_NULLPTR);
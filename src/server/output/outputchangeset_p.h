@@ -61,6 +61,7 @@ public:
     int modeId;
     QPoint position;
     int scaleFactor;
+    QWaylandOutput *cloneSource;
 
     static OutputChangesetPrivate *get(OutputChangeset *changeset) { return changeset->d_func(); }
 };
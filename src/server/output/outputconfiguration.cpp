@@ -69,7 +69,8 @@ bool OutputConfigurationPrivate::hasPendingChanges(QWaylandOutput *output) const
             changeset->isModeIdChanged() ||
             changeset->isTransformChanged() ||
             changeset->isPositionChanged() ||
-            changeset->isScaleFactorChanged();
+            changeset->isScaleFactorChanged() ||
+            changeset->isCloneSourceChanged();
 }
 
 void OutputConfigurationPrivate::clearPendingChanges()
@@ -162,6 +163,16 @@ void OutputConfigurationPrivate::outputconfiguration_scale(Resource *resource,
     OutputChangesetPrivate::get(pendingChanges(output))->scaleFactor = scale;
 }
 
+void OutputConfigurationPrivate::outputconfiguration_clone(Resource *resource,
+                                                           struct ::wl_resource *outputResource,
+                                                           struct ::wl_resource *sourceResource)
+{
+    Q_UNUSED(resource);
+    QWaylandOutput *output = QWaylandOutput::fromResource(outputResource);
+    QWaylandOutput *source = sourceResource ? QWaylandOutput::fromResource(sourceResource) : Q_NULLPTR;
+    OutputChangesetPrivate::get(pendingChanges(output))->cloneSource = source;
+}
+
 void OutputConfigurationPrivate::outputconfiguration_apply(Resource *resource)
 {
     Q_UNUSED(resource);
@@ -87,6 +87,9 @@ protected:
     virtual void outputconfiguration_scale(Resource *resource,
                                            struct ::wl_resource *outputResource,
                                            int32_t scale) Q_DECL_OVERRIDE;
+    virtual void outputconfiguration_clone(Resource *resource,
+                                           struct ::wl_resource *outputResource,
+                                           struct ::wl_resource *sourceResource) Q_DECL_OVERRIDE;
     virtual void outputconfiguration_apply(Resource *resource) Q_DECL_OVERRIDE;
 };
 
@@ -101,7 +101,7 @@ void OutputManagement::initialize()
         qCWarning(gLcOutputManagement) << "Failed to find QWaylandCompositor when initializing OutputManagement";
         return;
     }
-    d->init(compositor->display(), 1);
+    d->init(compositor->display(), 2);
 }
 
 const struct wl_interface *OutputManagement::interface()
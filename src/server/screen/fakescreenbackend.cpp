@@ -135,6 +135,8 @@ void FakeScreenBackend::acquireConfiguration()
         QList<Screen::Mode> modes;
         modes.append({size, qreal(refreshRate) / 1000});
         screenPrivate->setModes(modes);
+        screenPrivate->setCurrentMode(0);
+        screenPrivate->setPreferredMode(0);
 
         switch (orientation) {
         case Qt::PortraitOrientation:
@@ -128,7 +128,7 @@ void NativeScreenBackend::handleScreenRemoved(QScreen *qscreen)
 {
     qCDebug(gLcNativeScreenBackend) << "Screen removed" << qscreen->name() << qscreen->availableGeometry();
 
-    QList<Screen *> list = ScreenBackend::get(this)->screens;
+    QList<Screen *> &list = ScreenBackend::get(this)->screens;
     auto it = list.begin();
     while (it != list.end()) {
         Screen *screen = (*it);
@@ -136,6 +136,8 @@ void NativeScreenBackend::handleScreenRemoved(QScreen *qscreen)
             it = list.erase(it);
             Q_EMIT screenRemoved(screen);
             screen->deleteLater();
+        } else {
+            ++it;
         }
     }
 }
@@ -150,7 +152,8 @@ void NativeScreenBackend::handleScreenChanged(QScreen *qscreen, Screen *screen)
     screenPrivate->setSize(qscreen->availableGeometry().size());
     screenPrivate->setRefreshRate(qscreen->refreshRate() * 1000);
     screenPrivate->setPhysicalSize(qscreen->physicalSize());
-    screenPrivate->setScaleFactor(qFloor(qscreen->devicePixelRatio()));
+    if (!screenPrivate->m_scaleFactorConfigured)
+        screenPrivate->setScaleFactor(qFloor(qscreen->devicePixelRatio()));
 
     Platform::EglFSScreen *eglfsScreen =
             static_cast<Platform::EglFSScreen *>(qscreen->handle());
@@ -184,6 +187,14 @@ void NativeScreenBackend::handleScreenChanged(QScreen *qscreen, Screen *screen)
         break;
     }
 
+    // Contents are already in their native orientation when
+    // the display hardware takes care of the transform
+    if (QGuiApplication::platformName() == QLatin1String("greenisland") && eglfsScreen &&
+            eglfsScreen->transform() != Platform::EglFSScreen::TransformNormal) {
+        screenPrivate->setTransform(static_cast<QWaylandOutput::Transform>(eglfsScreen->transform()));
+        screenPrivate->setHardwareTransform(true);
+    }
+
     QPlatformScreen::SubpixelAntialiasingType subpixel = qscreen->handle()->subpixelAntialiasingTypeHint();
     switch (subpixel) {
     case QPlatformScreen::Subpixel_None:
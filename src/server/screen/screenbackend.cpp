@@ -25,7 +25,10 @@
  * $END_LICENSE$
  ***************************************************************************/
 
+#include <QtCore/QTimer>
+#include <QtCore/QtMath>
 #include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
 #include <QtGui/qpa/qplatformintegration.h>
 #include <QtGui/qpa/qwindowsysteminterface.h>
 
@@ -41,6 +44,70 @@ namespace GreenIsland {
 
 namespace Server {
 
+/*
+ * ScreenColorState
+ */
+
+static const int colorRampSize = 256;
+
+ScreenColorState::ScreenColorState()
+    : whitePoint(1, 1, 1)
+    , ramp(colorRampSize * 3)
+{
+    for (int i = 0; i < colorRampSize; i++)
+        ramp[i * 3] = ramp[i * 3 + 1] = ramp[i * 3 + 2] = qreal(i) / (colorRampSize - 1);
+}
+
+bool ScreenColorState::isIdentity() const
+{
+    if (!qFuzzyCompare(whitePoint, QVector3D(1, 1, 1)) || !matrix.isIdentity())
+        return false;
+
+    for (int i = 0; i < ramp.size(); i++) {
+        if (qAbs(ramp.at(i) - qreal(i / 3) / (colorRampSize - 1)) > 1.0 / 0xffff)
+            return false;
+    }
+
+    return true;
+}
+
+qreal ScreenColorState::sample(int channel, qreal value) const
+{
+    const qreal pos = qBound<qreal>(0, value, 1) * (colorRampSize - 1);
+    const int index = qMin(int(pos), colorRampSize - 2);
+    const qreal fraction = pos - index;
+
+    const qreal a = ramp.at(index * 3 + channel);
+    const qreal b = ramp.at((index + 1) * 3 + channel);
+    return qBound<qreal>(0, (a + (b - a) * fraction) * whitePoint[channel], 1);
+}
+
+ScreenColorState ScreenColorState::interpolate(const ScreenColorState &from,
+                                               const ScreenColorState &to, qreal t)
+{
+    if (t <= 0)
+        return from;
+    if (t >= 1)
+        return to;
+
+    ScreenColorState result;
+    result.whitePoint = from.whitePoint + (to.whitePoint - from.whitePoint) * t;
+    for (int i = 0; i < result.ramp.size(); i++)
+        result.ramp[i] = from.ramp.at(i) + (to.ramp.at(i) - from.ramp.at(i)) * t;
+    result.matrix = from.matrix + (to.matrix - from.matrix) * float(t);
+    return result;
+}
+
+static qreal srgbToLinear(qreal value)
+{
+    return value <= 0.04045 ? value / 12.92 : qPow((value + 0.055) / 1.055, 2.4);
+}
+
+static qreal linearToSrgb(qreal value)
+{
+    return value <= 0.0031308 ? value * 12.92 : 1.055 * qPow(value, 1.0 / 2.4) - 0.055;
+}
+
 /*
  * ScreenPrivate
  */
@@ -111,6 +178,17 @@ void ScreenPrivate::setTransform(QWaylandOutput::Transform transform)
     Q_EMIT q->transformChanged();
 }
 
+void ScreenPrivate::setHardwareTransform(bool hardware)
+{
+    Q_Q(Screen);
+
+    if (m_hardwareTransform == hardware)
+        return;
+
+    m_hardwareTransform = hardware;
+    Q_EMIT q->hardwareTransformChanged();
+}
+
 void ScreenPrivate::setScaleFactor(int scale)
 {
     Q_Q(Screen);
@@ -152,6 +230,280 @@ void ScreenPrivate::setModes(const QList<Screen::Mode> &modes)
     Q_EMIT q->modesChanged();
 }
 
+Platform::EglFSScreen *ScreenPrivate::platformScreen() const
+{
+    if (!m_screen || QGuiApplication::platformName() != QLatin1String("greenisland"))
+        return Q_NULLPTR;
+    return static_cast<Platform::EglFSScreen *>(m_screen->handle());
+}
+
+ScreenState ScreenPrivate::state() const
+{
+    return {m_currentMode, m_position, m_transform, m_scaleFactor};
+}
+
+ScreenState ScreenPrivate::state(OutputChangeset *changeset) const
+{
+    ScreenState result = state();
+
+    if (changeset->isModeIdChanged())
+        result.modeId = changeset->modeId();
+    if (changeset->isPositionChanged())
+        result.position = changeset->position();
+    if (changeset->isTransformChanged())
+        result.transform = changeset->transform();
+    if (changeset->isScaleFactorChanged())
+        result.scaleFactor = changeset->scaleFactor();
+
+    return result;
+}
+
+bool ScreenPrivate::testState(const ScreenState &state) const
+{
+    if (state.modeId < 0 || state.modeId >= m_modes.size())
+        return false;
+    if (state.scaleFactor < 1)
+        return false;
+
+    if (m_screen) {
+        Platform::EglFSScreen *eglfsScreen = platformScreen();
+        if (!eglfsScreen) {
+            qCWarning(gLcScreenBackend) << "Output changeset can be applied only when using the greenisland QPA plugin";
+            return false;
+        }
+
+        if (state.modeId != eglfsScreen->currentMode() && !eglfsScreen->testMode(state.modeId))
+            return false;
+    }
+
+    return true;
+}
+
+bool ScreenPrivate::applyState(const ScreenState &state)
+{
+    if (m_screen) {
+        // Native screens are updated back by the backend when
+        // QScreen notifies the change
+        Platform::EglFSScreen *eglfsScreen = platformScreen();
+        if (!eglfsScreen)
+            return false;
+
+        if (state.modeId != eglfsScreen->currentMode())
+            eglfsScreen->setCurrentMode(state.modeId);
+        if (state.position != m_screen->geometry().topLeft())
+            eglfsScreen->setPosition(state.position);
+
+        // Let the display hardware rotate the scan out when it can,
+        // otherwise the scene is rotated when rendering
+        if (state.transform != m_transform) {
+            const bool hardware = eglfsScreen->setTransform(
+                        static_cast<Platform::EglFSScreen::Transform>(state.transform));
+            if (!hardware)
+                eglfsScreen->setTransform(Platform::EglFSScreen::TransformNormal);
+            setTransform(state.transform);
+            setHardwareTransform(hardware);
+        }
+
+        // The scale is up to the compositor, from now on it
+        // no longer follows the device pixel ratio
+        m_scaleFactorConfigured = true;
+        setScaleFactor(state.scaleFactor);
+    } else {
+        setTransform(state.transform);
+        if (state.modeId != m_currentMode) {
+            const Screen::Mode mode = m_modes.at(state.modeId);
+            setSize(mode.size);
+            setRefreshRate(qRound(mode.refreshRate * 1000));
+            setCurrentMode(state.modeId);
+        }
+        setPosition(state.position);
+        setScaleFactor(state.scaleFactor);
+    }
+
+    return true;
+}
+
+QVector3D ScreenPrivate::whitePoint(int kelvin)
+{
+    // Tanner Helland's approximation of the black body color,
+    // which is good enough for night light
+    auto blackBody = [](int temperature) {
+        const qreal t = qBound(1000, temperature, 40000) / 100.0;
+        qreal r, g, b;
+
+        if (t <= 66) {
+            r = 255;
+            g = 99.4708025861 * qLn(t) - 161.1195681661;
+        } else {
+            r = 329.698727446 * qPow(t - 60, -0.1332047592);
+            g = 288.1221695283 * qPow(t - 60, -0.0755148492);
+        }
+
+        if (t >= 66)
+            b = 255;
+        else if (t <= 19)
+            b = 0;
+        else
+            b = 138.5177312231 * qLn(t - 10) - 305.0447927307;
+
+        return QVector3D(qBound<qreal>(0, r, 255), qBound<qreal>(0, g, 255),
+                         qBound<qreal>(0, b, 255));
+    };
+
+    // Relative to D65 so that 6500 K leaves colors untouched
+    const QVector3D reference = blackBody(6500);
+    QVector3D gain = blackBody(kelvin);
+    gain = QVector3D(gain.x() / reference.x(), gain.y() / reference.y(),
+                     gain.z() / reference.z());
+
+    const float maximum = qMax(gain.x(), qMax(gain.y(), gain.z()));
+    return maximum > 0 ? gain / maximum : QVector3D(1, 1, 1);
+}
+
+ScreenColorState ScreenPrivate::targetColorState() const
+{
+    ScreenColorState state;
+    state.whitePoint = whitePoint(m_colorTemperature);
+    state.matrix = m_colorMatrix;
+
+    // Resample the calibration to the ramp size
+    const int size = m_calibration.size() / 3;
+    if (size >= 2) {
+        for (int i = 0; i < colorRampSize; i++) {
+            const qreal pos = qreal(i) * (size - 1) / (colorRampSize - 1);
+            const int index = qMin(int(pos), size - 2);
+            const qreal fraction = pos - index;
+
+            for (int channel = 0; channel < 3; channel++) {
+                const qreal a = m_calibration.at(index * 3 + channel) / 65535.0;
+                const qreal b = m_calibration.at((index + 1) * 3 + channel) / 65535.0;
+                state.ramp[i * 3 + channel] = a + (b - a) * fraction;
+            }
+        }
+    }
+
+    return state;
+}
+
+ScreenColorState ScreenPrivate::colorState() const
+{
+    return ScreenColorState::interpolate(m_colorFrom, m_colorTo, m_colorProgress);
+}
+
+Platform::EglFSFunctions::ColorCorrection ScreenPrivate::colorCorrection(const Platform::EglFSFunctions::ColorPipeline &pipeline) const
+{
+    Platform::EglFSFunctions::ColorCorrection correction;
+
+    const ScreenColorState state = colorState();
+    if (state.isIdentity())
+        return correction;
+
+    // The matrix works on linear light, encoded values are decoded
+    // by the degamma stage and encoded again before the ramp
+    const bool transform = !state.matrix.isIdentity() &&
+            (pipeline.stages & Platform::EglFSFunctions::ColorTransformStage);
+    const bool linearize = transform &&
+            (pipeline.stages & Platform::EglFSFunctions::DegammaStage);
+
+    if (transform) {
+        correction.colorTransform.resize(9);
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 3; column++)
+                correction.colorTransform[row * 3 + column] = state.matrix(row, column);
+        }
+    }
+
+    if (linearize) {
+        const int size = pipeline.degammaSize;
+        correction.degammaLut.resize(size * 3);
+        for (int i = 0; i < size; i++) {
+            const quint16 value = qRound(srgbToLinear(qreal(i) / (size - 1)) * 0xffff);
+            correction.degammaLut[i * 3] = correction.degammaLut[i * 3 + 1] =
+                    correction.degammaLut[i * 3 + 2] = value;
+        }
+    }
+
+    if (pipeline.stages & Platform::EglFSFunctions::GammaStage) {
+        const int size = pipeline.gammaSize;
+        correction.gammaLut.resize(size * 3);
+        for (int i = 0; i < size; i++) {
+            qreal value = qreal(i) / (size - 1);
+            if (linearize)
+                value = linearToSrgb(value);
+            for (int channel = 0; channel < 3; channel++)
+                correction.gammaLut[i * 3 + channel] = qRound(state.sample(channel, value) * 0xffff);
+        }
+    }
+
+    return correction;
+}
+
+void ScreenPrivate::startColorTransition()
+{
+    Q_Q(Screen);
+
+    // Start from wherever a running transition got so far
+    m_colorFrom = colorState();
+    m_colorTo = targetColorState();
+
+    if (m_colorTransitionDuration <= 0) {
+        if (m_colorTimer)
+            m_colorTimer->stop();
+        m_colorProgress = 1.0;
+        applyColorCorrection();
+        return;
+    }
+
+    if (!m_colorTimer) {
+        m_colorTimer = new QTimer(q);
+        m_colorTimer->setInterval(16);
+        QObject::connect(m_colorTimer, &QTimer::timeout, q, [this] {
+            stepColorTransition();
+        });
+    }
+
+    m_colorProgress = 0.0;
+    m_colorClock.start();
+    m_colorTimer->start();
+}
+
+void ScreenPrivate::stepColorTransition()
+{
+    m_colorProgress = qMin<qreal>(1.0, qreal(m_colorClock.elapsed()) / m_colorTransitionDuration);
+    if (m_colorProgress >= 1.0)
+        m_colorTimer->stop();
+    applyColorCorrection();
+}
+
+void ScreenPrivate::applyColorCorrection()
+{
+    Q_Q(Screen);
+
+    Platform::EglFSFunctions::ColorPipeline pipeline;
+    const bool supported = platformScreen() &&
+            Platform::EglFSFunctions::colorPipeline(m_screen, &pipeline);
+
+    // The display hardware does it for free, otherwise outputs
+    // need to correct colors while rendering
+    bool hardware = supported &&
+            (pipeline.stages & Platform::EglFSFunctions::GammaStage) &&
+            (colorState().matrix.isIdentity() ||
+             (pipeline.stages & Platform::EglFSFunctions::ColorTransformStage));
+    if (hardware)
+        hardware = Platform::EglFSFunctions::setColorCorrection(m_screen, colorCorrection(pipeline));
+    if (!hardware && supported)
+        Platform::EglFSFunctions::setColorCorrection(m_screen, Platform::EglFSFunctions::ColorCorrection());
+
+    if (m_hardwareColorCorrection != hardware) {
+        qCDebug(gLcScreenBackend) << "Color correction of" << m_model
+                                  << (hardware ? "is done by the hardware" : "falls back to rendering");
+        m_hardwareColorCorrection = hardware;
+        Q_EMIT q->hardwareColorCorrectionChanged();
+    }
+
+    Q_EMIT q->colorCorrectionChanged();
+}
+
 /*
  * Screen
  */
@@ -227,6 +579,12 @@ QWaylandOutput::Transform Screen::transform() const
     return d->m_transform;
 }
 
+bool Screen::hasHardwareTransform() const
+{
+    Q_D(const Screen);
+    return d->m_hardwareTransform;
+}
+
 int Screen::scaleFactor() const
 {
     Q_D(const Screen);
@@ -251,42 +609,140 @@ QList<Screen::Mode> Screen::modes() const
     return d->m_modes;
 }
 
-bool Screen::applyChangeset(OutputChangeset *changeset)
+int Screen::colorTemperature() const
+{
+    Q_D(const Screen);
+    return d->m_colorTemperature;
+}
+
+void Screen::setColorTemperature(int kelvin)
 {
     Q_D(Screen);
 
-    if (d->m_screen) {
-        Platform::EglFSScreen *eglfsScreen =
-                static_cast<Platform::EglFSScreen *>(d->m_screen->handle());
-        if (eglfsScreen) {
-            if (changeset->isModeIdChanged())
-                eglfsScreen->setCurrentMode(changeset->modeId());
-            if (changeset->isPositionChanged()) {
-                QRect geometry = d->m_screen->geometry();
-                geometry.setTopLeft(changeset->position());
-                QWindowSystemInterface::handleScreenGeometryChange(d->m_screen, geometry, d->m_screen->availableGeometry());
-            }
-        } else {
-            qCWarning(gLcScreenBackend) << "Output changeset can be applied only when using the greenisland QPA plugin";
-            return false;
-        }
-    } else {
-        if (changeset->isTransformChanged())
-            d->setTransform(changeset->transform());
-        if (changeset->isModeIdChanged())
-            d->setCurrentMode(changeset->modeId());
-        if (changeset->isPositionChanged())
-            d->setPosition(changeset->position());
-        if (changeset->isScaleFactorChanged())
-            d->setScaleFactor(changeset->scaleFactor());
+    kelvin = qBound(1000, kelvin, 10000);
+    if (d->m_colorTemperature == kelvin)
+        return;
+
+    d->m_colorTemperature = kelvin;
+    Q_EMIT colorTemperatureChanged();
+    d->startColorTransition();
+}
+
+int Screen::colorTransitionDuration() const
+{
+    Q_D(const Screen);
+    return d->m_colorTransitionDuration;
+}
+
+void Screen::setColorTransitionDuration(int msecs)
+{
+    Q_D(Screen);
+
+    if (d->m_colorTransitionDuration == msecs)
+        return;
+
+    d->m_colorTransitionDuration = msecs;
+    Q_EMIT colorTransitionDurationChanged();
+}
+
+QVector<quint16> Screen::calibration() const
+{
+    Q_D(const Screen);
+    return d->m_calibration;
+}
+
+bool Screen::setCalibration(const QVector<quint16> &ramp)
+{
+    Q_D(Screen);
+
+    // Red, green and blue interleaved, at least two points each
+    if (!ramp.isEmpty() && (ramp.size() % 3 != 0 || ramp.size() < 6)) {
+        qCWarning(gLcScreenBackend) << "Invalid calibration ramp for" << d->m_model;
+        return false;
     }
 
+    if (d->m_calibration == ramp)
+        return true;
+
+    d->m_calibration = ramp;
+    Q_EMIT calibrationChanged();
+    d->startColorTransition();
     return true;
 }
 
+QMatrix3x3 Screen::colorMatrix() const
+{
+    Q_D(const Screen);
+    return d->m_colorMatrix;
+}
+
+void Screen::setColorMatrix(const QMatrix3x3 &matrix)
+{
+    Q_D(Screen);
+
+    if (d->m_colorMatrix == matrix)
+        return;
+
+    d->m_colorMatrix = matrix;
+    Q_EMIT colorMatrixChanged();
+    d->startColorTransition();
+}
+
+bool Screen::hasHardwareColorCorrection() const
+{
+    Q_D(const Screen);
+    return d->m_hardwareColorCorrection;
+}
+
+void Screen::resetColorCorrection()
+{
+    Q_D(Screen);
+
+    const bool resetTemperature = d->m_colorTemperature != 6500;
+    const bool resetCalibration = !d->m_calibration.isEmpty();
+    const bool resetMatrix = !d->m_colorMatrix.isIdentity();
+    if (!resetTemperature && !resetCalibration && !resetMatrix)
+        return;
+
+    d->m_colorTemperature = 6500;
+    d->m_calibration.clear();
+    d->m_colorMatrix.setToIdentity();
+
+    if (resetTemperature)
+        Q_EMIT colorTemperatureChanged();
+    if (resetCalibration)
+        Q_EMIT calibrationChanged();
+    if (resetMatrix)
+        Q_EMIT colorMatrixChanged();
+    d->startColorTransition();
+}
+
+bool Screen::applyChangeset(OutputChangeset *changeset)
+{
+    Q_D(Screen);
+
+    const ScreenState state = d->state(changeset);
+    if (!d->testState(state)) {
+        qCWarning(gLcScreenBackend) << "Output changeset cannot be applied to" << d->m_model;
+        return false;
+    }
+
+    // Remember what we had, so that the changeset can be discarded
+    d->m_lastChangeset = changeset;
+    d->m_lastState = d->state();
+
+    return d->applyState(state);
+}
+
 void Screen::discardChangeset(OutputChangeset *changeset)
 {
-    Q_UNUSED(changeset);
+    Q_D(Screen);
+
+    if (!changeset || d->m_lastChangeset != changeset)
+        return;
+
+    d->applyState(d->m_lastState);
+    d->m_lastChangeset.clear();
 }
 
 /*
@@ -30,6 +30,8 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QSize>
+#include <QtCore/QVector>
+#include <QtGui/QMatrix3x3>
 
 #include <GreenIsland/QtWaylandCompositor/QWaylandOutput>
 
@@ -60,9 +62,13 @@ class GREENISLANDSERVER_EXPORT Screen : public QObject
     Q_PROPERTY(QSizeF physicalSize READ physicalSize NOTIFY physicalSizeChanged)
     Q_PROPERTY(QWaylandOutput::Subpixel subpixel READ subpixel NOTIFY subpixelChanged)
     Q_PROPERTY(QWaylandOutput::Transform transform READ transform NOTIFY transformChanged)
+    Q_PROPERTY(bool hardwareTransform READ hasHardwareTransform NOTIFY hardwareTransformChanged)
     Q_PROPERTY(int scaleFactor READ scaleFactor NOTIFY scaleFactorChanged)
     Q_PROPERTY(int currentMode READ currentMode NOTIFY currentModeChanged)
     Q_PROPERTY(int preferredMode READ preferredMode NOTIFY preferredModeChanged)
+    Q_PROPERTY(int colorTemperature READ colorTemperature WRITE setColorTemperature NOTIFY colorTemperatureChanged)
+    Q_PROPERTY(int colorTransitionDuration READ colorTransitionDuration WRITE setColorTransitionDuration NOTIFY colorTransitionDurationChanged)
+    Q_PROPERTY(bool hardwareColorCorrection READ hasHardwareColorCorrection NOTIFY hardwareColorCorrectionChanged)
 public:
     struct Mode {
         QSize size;
@@ -84,12 +90,29 @@ public:
     QSizeF physicalSize() const;
     QWaylandOutput::Subpixel subpixel() const;
     QWaylandOutput::Transform transform() const;
+    bool hasHardwareTransform() const;
     int scaleFactor() const;
 
     int currentMode() const;
     int preferredMode() const;
     QList<Mode> modes() const;
 
+    int colorTemperature() const;
+    void setColorTemperature(int kelvin);
+
+    int colorTransitionDuration() const;
+    void setColorTransitionDuration(int msecs);
+
+    QVector<quint16> calibration() const;
+    bool setCalibration(const QVector<quint16> &ramp);
+
+    QMatrix3x3 colorMatrix() const;
+    void setColorMatrix(const QMatrix3x3 &matrix);
+
+    bool hasHardwareColorCorrection() const;
+
+    Q_INVOKABLE void resetColorCorrection();
+
     Q_INVOKABLE bool applyChangeset(GreenIsland::Server::OutputChangeset *changeset);
     Q_INVOKABLE void discardChangeset(GreenIsland::Server::OutputChangeset *changeset);
 
@@ -102,10 +125,17 @@ Q_SIGNALS:
     void physicalSizeChanged();
     void subpixelChanged();
     void transformChanged();
+    void hardwareTransformChanged();
     void scaleFactorChanged();
     void currentModeChanged();
     void preferredModeChanged();
     void modesChanged();
+    void colorTemperatureChanged();
+    void colorTransitionDurationChanged();
+    void calibrationChanged();
+    void colorMatrixChanged();
+    void hardwareColorCorrectionChanged();
+    void colorCorrectionChanged();
 };
 
 class GREENISLANDSERVER_EXPORT ScreenBackend : public QObject
@@ -29,11 +29,17 @@
 #define GREENISLAND_SCREENBACKEND_P_H
 
 #include <QtCore/private/qobject_p.h>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QPoint>
+#include <QtCore/QPointer>
 #include <QtCore/QSize>
+#include <QtGui/QVector3D>
 
+#include <GreenIsland/Platform/EglFSFunctions>
 #include <GreenIsland/Server/ScreenBackend>
 
+class QTimer;
+
 //
 //  W A R N I N G
 //  -------------
@@ -47,8 +53,36 @@
 
 namespace GreenIsland {
 
+namespace Platform {
+class EglFSScreen;
+}
+
 namespace Server {
 
+struct ScreenState
+{
+    int modeId;
+    QPoint position;
+    QWaylandOutput::Transform transform;
+    int scaleFactor;
+};
+
+struct GREENISLANDSERVER_EXPORT ScreenColorState
+{
+    ScreenColorState();
+
+    // Per channel gain and calibration ramp, sampled at 256 points
+    // with red, green and blue interleaved
+    QVector3D whitePoint;
+    QVector<qreal> ramp;
+    QMatrix3x3 matrix;
+
+    bool isIdentity() const;
+    qreal sample(int channel, qreal value) const;
+    static ScreenColorState interpolate(const ScreenColorState &from,
+                                        const ScreenColorState &to, qreal t);
+};
+
 class GREENISLANDSERVER_EXPORT ScreenPrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(Screen)
@@ -59,9 +93,16 @@ public:
         , m_refreshRate(60000)
         , m_subpixel(QWaylandOutput::SubpixelNone)
         , m_transform(QWaylandOutput::TransformNormal)
+        , m_hardwareTransform(false)
         , m_scaleFactor(1)
+        , m_scaleFactorConfigured(false)
         , m_currentMode(-1)
         , m_preferredMode(-1)
+        , m_colorTemperature(6500)
+        , m_colorTransitionDuration(0)
+        , m_hardwareColorCorrection(false)
+        , m_colorProgress(1.0)
+        , m_colorTimer(Q_NULLPTR)
     {
     }
 
@@ -71,11 +112,27 @@ public:
     void setPhysicalSize(const QSizeF &size);
     void setSubpixel(QWaylandOutput::Subpixel subpixel);
     void setTransform(QWaylandOutput::Transform transform);
+    void setHardwareTransform(bool hardware);
     void setScaleFactor(int scale);
     void setCurrentMode(int modeId);
     void setPreferredMode(int modeId);
     void setModes(const QList<Screen::Mode> &modes);
 
+    Platform::EglFSScreen *platformScreen() const;
+
+    ScreenState state() const;
+    ScreenState state(OutputChangeset *changeset) const;
+    bool testState(const ScreenState &state) const;
+    bool applyState(const ScreenState &state);
+
+    static QVector3D whitePoint(int kelvin);
+    ScreenColorState targetColorState() const;
+    ScreenColorState colorState() const;
+    Platform::EglFSFunctions::ColorCorrection colorCorrection(const Platform::EglFSFunctions::ColorPipeline &pipeline) const;
+    void startColorTransition();
+    void stepColorTransition();
+    void applyColorCorrection();
+
     QScreen *m_screen;
     QString m_manufacturer;
     QString m_model;
@@ -85,10 +142,27 @@ public:
     QSizeF m_physicalSize;
     QWaylandOutput::Subpixel m_subpixel;
     QWaylandOutput::Transform m_transform;
+    bool m_hardwareTransform;
     int m_scaleFactor;
+    bool m_scaleFactorConfigured;
     int m_currentMode;
     int m_preferredMode;
     QList<Screen::Mode> m_modes;
+
+    QPointer<OutputChangeset> m_lastChangeset;
+    ScreenState m_lastState;
+
+    int m_colorTemperature;
+    int m_colorTransitionDuration;
+    QVector<quint16> m_calibration;
+    QMatrix3x3 m_colorMatrix;
+    bool m_hardwareColorCorrection;
+
+    ScreenColorState m_colorFrom;
+    ScreenColorState m_colorTo;
+    qreal m_colorProgress;
+    QElapsedTimer m_colorClock;
+    QTimer *m_colorTimer;
 };
 
 class GREENISLANDSERVER_EXPORT ScreenBackendPrivate : public QObjectPrivate
@@ -25,6 +25,15 @@
  * $END_LICENSE$
  ***************************************************************************/
 
+#include <QtCore/QRect>
+#include <QtGui/QWindow>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandOutput>
+
+#include "core/quickoutput.h"
+#include "output/outputchangeset.h"
+#include "output/outputconfiguration.h"
+#include "serverlogging_p.h"
 #include "screenmanager.h"
 #include "screenmanager_p.h"
 
@@ -32,15 +41,124 @@ namespace GreenIsland {
 
 namespace Server {
 
+/*
+ * ScreenManagerPrivate
+ */
+
+Screen *ScreenManagerPrivate::screenForOutput(QWaylandOutput *output) const
+{
+    QuickOutput *quickOutput = qobject_cast<QuickOutput *>(output);
+    if (quickOutput && quickOutput->nativeScreen())
+        return quickOutput->nativeScreen();
+
+    if (output->window()) {
+        Q_FOREACH (Screen *screen, backend->screens()) {
+            if (screen->screen() && screen->screen() == output->window()->screen())
+                return screen;
+        }
+    }
+
+    return Q_NULLPTR;
+}
+
+static QRect layoutRect(Screen *screen, const ScreenState &state)
+{
+    const QList<Screen::Mode> modes = screen->modes();
+    QSize size = state.modeId >= 0 && state.modeId < modes.size()
+            ? modes.at(state.modeId).size : screen->size();
+
+    switch (state.transform) {
+    case QWaylandOutput::Transform90:
+    case QWaylandOutput::Transform270:
+    case QWaylandOutput::TransformFlipped90:
+    case QWaylandOutput::TransformFlipped270:
+        size.transpose();
+        break;
+    default:
+        break;
+    }
+
+    return QRect(state.position, size / state.scaleFactor);
+}
+
+bool ScreenManagerPrivate::testLayout(const QHash<Screen *, ScreenState> &states) const
+{
+    // Screens that change may not partially overlap any other screen,
+    // the same exact geometry is fine because it means cloning
+    Q_FOREACH (Screen *screen, states.keys()) {
+        const QRect rect = layoutRect(screen, states.value(screen));
+
+        Q_FOREACH (Screen *other, backend->screens()) {
+            if (other == screen)
+                continue;
+
+            const QRect otherRect = layoutRect(other, states.contains(other)
+                                               ? states.value(other)
+                                               : Screen::get(other)->state());
+            if (rect != otherRect && rect.intersects(otherRect)) {
+                qCWarning(gLcScreenBackend) << "Screen" << screen->model()
+                                            << "would overlap" << other->model();
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void ScreenManagerPrivate::applyStates(const QHash<Screen *, ScreenState> &states)
+{
+    // All screens are changed without returning to the event loop,
+    // so the scene is laid out and rendered only once with the
+    // complete configuration
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it)
+        Screen::get(it.key())->applyState(it.value());
+}
+
+void ScreenManagerPrivate::applyCloneSources(const QList<QPair<QPointer<QuickOutput>, QPointer<QuickOutput> > > &sources)
+{
+    // Break every link first so that swapping source and
+    // mirror is not mistaken for a chain
+    typedef QPair<QPointer<QuickOutput>, QPointer<QuickOutput> > CloneLink;
+    Q_FOREACH (const CloneLink &link, sources) {
+        if (link.first)
+            link.first->setCloneSource(Q_NULLPTR);
+    }
+    Q_FOREACH (const CloneLink &link, sources) {
+        if (link.first && link.second)
+            link.first->setCloneSource(link.second);
+    }
+}
+
+/*
+ * ScreenManager
+ */
+
 ScreenManager::ScreenManager(QObject *parent)
     : QObject(*new ScreenManagerPrivate(), parent)
 {
     Q_D(ScreenManager);
 
+    // Automatic revert is opt-in, the client that requested
+    // the configuration is told only that it was applied
+    d->confirmationTimer = new QTimer(this);
+    d->confirmationTimer->setSingleShot(true);
+    d->confirmationTimer->setInterval(0);
+    connect(d->confirmationTimer, &QTimer::timeout, this, [this] {
+        qCWarning(gLcScreenBackend) << "Output configuration was not confirmed in time, reverting";
+        revertConfiguration();
+    });
+
     connect(d->backend, &ScreenBackend::screenAdded,
             this, &ScreenManager::screenAdded);
-    connect(d->backend, &ScreenBackend::screenRemoved,
-            this, &ScreenManager::screenRemoved);
+    connect(d->backend, &ScreenBackend::screenRemoved, this,
+            [this, d](Screen *screen) {
+        if (d->savedStates.remove(screen) > 0 && d->savedStates.isEmpty()) {
+            d->confirmationTimer->stop();
+            Q_EMIT confirmationPendingChanged();
+        }
+        Q_EMIT screenRemoved(screen);
+    });
     connect(d->backend, &ScreenBackend::primaryScreenChanged, this,
             [this, d](Screen *screen) {
         d->primaryScreen = screen;
@@ -54,12 +172,154 @@ Screen *ScreenManager::primaryScreen() const
     return d->primaryScreen;
 }
 
+int ScreenManager::confirmationTimeout() const
+{
+    Q_D(const ScreenManager);
+    return d->confirmationTimer->interval();
+}
+
+void ScreenManager::setConfirmationTimeout(int timeout)
+{
+    Q_D(ScreenManager);
+
+    if (d->confirmationTimer->interval() == timeout)
+        return;
+
+    d->confirmationTimer->setInterval(timeout);
+    Q_EMIT confirmationTimeoutChanged();
+}
+
+bool ScreenManager::isConfirmationPending() const
+{
+    Q_D(const ScreenManager);
+    return !d->savedStates.isEmpty() || !d->savedCloneSources.isEmpty();
+}
+
 int ScreenManager::indexOf(Screen *screen) const
 {
     Q_D(const ScreenManager);
     return d->backend->screens().indexOf(screen);
 }
 
+bool ScreenManager::applyConfiguration(OutputConfiguration *configuration)
+{
+    Q_D(ScreenManager);
+
+    if (!configuration)
+        return false;
+
+    if (isConfirmationPending()) {
+        qCWarning(gLcScreenBackend) << "Cannot apply an output configuration while another one waits for confirmation";
+        configuration->setFailed();
+        return false;
+    }
+
+    // Validate every changeset before touching any screen
+    QHash<Screen *, ScreenState> states;
+    QList<QPair<QPointer<QuickOutput>, QPointer<QuickOutput> > > cloneSources;
+    const QHash<QWaylandOutput *, OutputChangeset *> changes = configuration->changes();
+    for (auto it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        Screen *screen = d->screenForOutput(it.key());
+        if (!screen) {
+            qCWarning(gLcScreenBackend) << "Cannot find the screen of output" << it.key();
+            configuration->setFailed();
+            return false;
+        }
+
+        const ScreenState state = Screen::get(screen)->state(it.value());
+        if (!Screen::get(screen)->testState(state)) {
+            qCWarning(gLcScreenBackend) << "Output configuration is not valid for" << screen->model();
+            configuration->setFailed();
+            return false;
+        }
+
+        states.insert(screen, state);
+
+        if (it.value()->isCloneSourceChanged()) {
+            QuickOutput *output = qobject_cast<QuickOutput *>(it.key());
+            QuickOutput *source = qobject_cast<QuickOutput *>(it.value()->cloneSource());
+            if (!output || (it.value()->cloneSource() && !source) || source == output) {
+                qCWarning(gLcScreenBackend) << "Cannot mirror" << it.value()->cloneSource() << "on" << it.key();
+                configuration->setFailed();
+                return false;
+            }
+            cloneSources.append(qMakePair(QPointer<QuickOutput>(output), QPointer<QuickOutput>(source)));
+        }
+    }
+
+    // Mirrors cannot be mirrored in turn
+    typedef QPair<QPointer<QuickOutput>, QPointer<QuickOutput> > CloneLink;
+    Q_FOREACH (const CloneLink &link, cloneSources) {
+        if (!link.second)
+            continue;
+
+        QWaylandOutput *sourceSource = link.second->cloneSource();
+        OutputChangeset *sourceChangeset = changes.value(link.second);
+        if (sourceChangeset && sourceChangeset->isCloneSourceChanged())
+            sourceSource = sourceChangeset->cloneSource();
+        if (sourceSource) {
+            qCWarning(gLcScreenBackend) << "Cannot mirror" << link.second << "which is a mirror itself";
+            configuration->setFailed();
+            return false;
+        }
+    }
+
+    if (!d->testLayout(states)) {
+        configuration->setFailed();
+        return false;
+    }
+
+    // Without a timeout there is nothing to roll back to
+    if (d->confirmationTimer->interval() > 0) {
+        Q_FOREACH (Screen *screen, states.keys())
+            d->savedStates.insert(screen, Screen::get(screen)->state());
+        Q_FOREACH (const CloneLink &link, cloneSources)
+            d->savedCloneSources.append(qMakePair(link.first, QPointer<QuickOutput>(link.first->cloneSource())));
+    }
+
+    d->applyStates(states);
+    d->applyCloneSources(cloneSources);
+    configuration->setApplied();
+    Q_EMIT configurationApplied();
+
+    if (isConfirmationPending()) {
+        d->confirmationTimer->start();
+        Q_EMIT confirmationPendingChanged();
+    }
+
+    return true;
+}
+
+void ScreenManager::confirmConfiguration()
+{
+    Q_D(ScreenManager);
+
+    if (!isConfirmationPending())
+        return;
+
+    d->confirmationTimer->stop();
+    d->savedStates.clear();
+    d->savedCloneSources.clear();
+    Q_EMIT confirmationPendingChanged();
+}
+
+void ScreenManager::revertConfiguration()
+{
+    Q_D(ScreenManager);
+
+    if (!isConfirmationPending())
+        return;
+
+    d->confirmationTimer->stop();
+
+    d->applyStates(d->savedStates);
+    d->applyCloneSources(d->savedCloneSources);
+    d->savedStates.clear();
+    d->savedCloneSources.clear();
+    Q_EMIT configurationReverted();
+    Q_EMIT confirmationPendingChanged();
+}
+
 void ScreenManager::create()
 {
     Q_D(ScreenManager);
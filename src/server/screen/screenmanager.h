@@ -34,6 +34,7 @@ namespace GreenIsland {
 
 namespace Server {
 
+class OutputConfiguration;
 class ScreenManagerPrivate;
 
 class GREENISLANDSERVER_EXPORT ScreenManager : public QObject
@@ -41,19 +42,34 @@ class GREENISLANDSERVER_EXPORT ScreenManager : public QObject
     Q_OBJECT
     Q_DECLARE_PRIVATE(ScreenManager)
     Q_PROPERTY(Screen *primaryScreen READ primaryScreen NOTIFY primaryScreenChanged)
+    Q_PROPERTY(int confirmationTimeout READ confirmationTimeout WRITE setConfirmationTimeout NOTIFY confirmationTimeoutChanged)
+    Q_PROPERTY(bool confirmationPending READ isConfirmationPending NOTIFY confirmationPendingChanged)
 public:
     ScreenManager(QObject *parent = Q_NULLPTR);
 
     Screen *primaryScreen() const;
 
+    int confirmationTimeout() const;
+    void setConfirmationTimeout(int timeout);
+
+    bool isConfirmationPending() const;
+
     Q_INVOKABLE int indexOf(Screen *screen) const;
 
+    Q_INVOKABLE bool applyConfiguration(GreenIsland::Server::OutputConfiguration *configuration);
+    Q_INVOKABLE void confirmConfiguration();
+    Q_INVOKABLE void revertConfiguration();
+
     virtual void create();
 
 Q_SIGNALS:
     void screenAdded(Screen *screen);
     void screenRemoved(Screen *screen);
     void primaryScreenChanged(Screen *screen);
+    void confirmationTimeoutChanged();
+    void confirmationPendingChanged();
+    void configurationApplied();
+    void configurationReverted();
 };
 
 } // namespace Server
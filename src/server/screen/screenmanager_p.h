@@ -29,23 +29,37 @@
 #define GREENISLAND_SCREENMANAGER_P_H
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
 #include <QtCore/private/qobject_p.h>
 
 #include <GreenIsland/Server/ScreenManager>
 
 #include "screen/fakescreenbackend.h"
 #include "screen/nativescreenbackend.h"
+#include "screen/screenbackend_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandOutput;
+
+QT_END_NAMESPACE
 
 namespace GreenIsland {
 
 namespace Server {
 
+class QuickOutput;
+
 class GREENISLANDSERVER_EXPORT ScreenManagerPrivate : public QObjectPrivate
 {
+    Q_DECLARE_PUBLIC(ScreenManager)
 public:
     ScreenManagerPrivate()
         : QObjectPrivate()
         , primaryScreen(Q_NULLPTR)
+        , confirmationTimer(Q_NULLPTR)
     {
         // Determine the backend to use from the application
         const QString backendName = QCoreApplication::instance()->property("__greenisland_screen_backend").toString();
@@ -63,8 +77,17 @@ public:
         delete backend;
     }
 
+    Screen *screenForOutput(QWaylandOutput *output) const;
+    bool testLayout(const QHash<Screen *, ScreenState> &states) const;
+    void applyStates(const QHash<Screen *, ScreenState> &states);
+    void applyCloneSources(const QList<QPair<QPointer<QuickOutput>, QPointer<QuickOutput> > > &sources);
+
     ScreenBackend *backend;
     Screen *primaryScreen;
+
+    QTimer *confirmationTimer;
+    QHash<Screen *, ScreenState> savedStates;
+    QList<QPair<QPointer<QuickOutput>, QPointer<QuickOutput> > > savedCloneSources;
 };
 
 } // namespace Server
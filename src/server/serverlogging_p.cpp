@@ -29,8 +29,10 @@
 
 Q_LOGGING_CATEGORY(gLcCore, "greenisland.compositor", QtDebugMsg)
 Q_LOGGING_CATEGORY(gLcOutputManagement, "greenisland.outputmanagement", QtDebugMsg)
+Q_LOGGING_CATEGORY(gLcColorManager, "greenisland.protocols.colormanager", QtDebugMsg)
 Q_LOGGING_CATEGORY(gLcGtkShell, "greenisland.protocols.gtkshell", QtDebugMsg)
 Q_LOGGING_CATEGORY(gLcGtkShellTrace, "greenisland.protocols.gtkshell.trace", QtDebugMsg)
+Q_LOGGING_CATEGORY(gLcIdleInhibitManager, "greenisland.protocols.idleinhibit", QtDebugMsg)
 Q_LOGGING_CATEGORY(gLcScreencaster, "greenisland.protocols.screencaster", QtDebugMsg)
 Q_LOGGING_CATEGORY(gLcScreenshooter, "greenisland.protocols.screenshooter", QtDebugMsg)
 Q_LOGGING_CATEGORY(gLcTaskManager, "greenisland.protocols.taskmanager", QtDebugMsg)
@@ -32,8 +32,10 @@
 
 Q_DECLARE_LOGGING_CATEGORY(gLcCore)
 Q_DECLARE_LOGGING_CATEGORY(gLcOutputManagement)
+Q_DECLARE_LOGGING_CATEGORY(gLcColorManager)
 Q_DECLARE_LOGGING_CATEGORY(gLcGtkShell)
 Q_DECLARE_LOGGING_CATEGORY(gLcGtkShellTrace)
+Q_DECLARE_LOGGING_CATEGORY(gLcIdleInhibitManager)
 Q_DECLARE_LOGGING_CATEGORY(gLcScreencaster)
 Q_DECLARE_LOGGING_CATEGORY(gLcScreenshooter)
 Q_DECLARE_LOGGING_CATEGORY(gLcTaskManager)
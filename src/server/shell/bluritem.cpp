@@ -0,0 +1,907 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+
+#include <QtCore/qmath.h>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QVector2D>
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/private/qsgadaptationlayer_p.h>
+#include <QtQuick/private/qsgcontext_p.h>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandQuickItem>
+#include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
+
+#include "bluritem.h"
+#include "bluritem_p.h"
+#include "serverlogging_p.h"
+
+namespace GreenIsland {
+
+namespace Server {
+
+// Stale areas are rounded to tiles, it keeps the number of
+// rectangles and hence of draw calls low
+static const int tileSize = 64;
+
+// Beyond this many rectangles the bounding one is recomputed
+static const int maxStaleRects = 16;
+
+static const int maxIterations = 6;
+
+static const char *blurVertexShader =
+        "attribute highp vec2 vertex;\n"
+        "void main() {\n"
+        "    gl_Position = vec4(vertex, 0.0, 1.0);\n"
+        "}\n";
+
+// Dual filter blur, texture coordinates come from the fragment
+// position so that each level can be drawn in any rectangle and
+// odd sizes line up with the previous level
+static const char *downsampleFragmentShader =
+        "uniform sampler2D source;\n"
+        "uniform highp vec2 scale;\n"
+        "uniform highp vec2 delta;\n"
+        "void main() {\n"
+        "    highp vec2 coord = gl_FragCoord.xy * scale;\n"
+        "    mediump vec4 sum = texture2D(source, coord) * 4.0;\n"
+        "    sum += texture2D(source, coord - delta);\n"
+        "    sum += texture2D(source, coord + delta);\n"
+        "    sum += texture2D(source, coord + vec2(delta.x, -delta.y));\n"
+        "    sum += texture2D(source, coord - vec2(delta.x, -delta.y));\n"
+        "    gl_FragColor = sum / 8.0;\n"
+        "}\n";
+
+static const char *upsampleFragmentShader =
+        "uniform sampler2D source;\n"
+        "uniform highp vec2 scale;\n"
+        "uniform highp vec2 delta;\n"
+        "void main() {\n"
+        "    highp vec2 coord = gl_FragCoord.xy * scale;\n"
+        "    mediump vec4 sum = texture2D(source, coord + vec2(-2.0 * delta.x, 0.0));\n"
+        "    sum += texture2D(source, coord + vec2(-delta.x, delta.y)) * 2.0;\n"
+        "    sum += texture2D(source, coord + vec2(0.0, 2.0 * delta.y));\n"
+        "    sum += texture2D(source, coord + delta) * 2.0;\n"
+        "    sum += texture2D(source, coord + vec2(2.0 * delta.x, 0.0));\n"
+        "    sum += texture2D(source, coord + vec2(delta.x, -delta.y)) * 2.0;\n"
+        "    sum += texture2D(source, coord + vec2(0.0, -2.0 * delta.y));\n"
+        "    sum += texture2D(source, coord - delta) * 2.0;\n"
+        "    gl_FragColor = sum / 12.0;\n"
+        "}\n";
+
+static QRegion scaled(const QRegion &region, qreal factor)
+{
+    QRegion result;
+    Q_FOREACH (const QRect &rect, region.rects())
+        result |= QRectF(rect.x() * factor, rect.y() * factor,
+                         rect.width() * factor, rect.height() * factor).toAlignedRect();
+    return result;
+}
+
+static int alignToTile(int value)
+{
+    if (value >= 0)
+        return value / tileSize * tileSize;
+    return -((tileSize - 1 - value) / tileSize) * tileSize;
+}
+
+// Grows the region by the margin and rounds it to tiles
+static QRegion tiled(const QRegion &region, int margin)
+{
+    QRegion result;
+    Q_FOREACH (const QRect &rect, region.rects()) {
+        const QRect grown = rect.adjusted(-margin, -margin, margin, margin);
+        result |= QRect(QPoint(alignToTile(grown.left()), alignToTile(grown.top())),
+                        QPoint(alignToTile(grown.right()) + tileSize - 1,
+                               alignToTile(grown.bottom()) + tileSize - 1));
+    }
+    return result;
+}
+
+static QOpenGLShaderProgram *createBlurProgram(const char *fragmentShader)
+{
+    QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, blurVertexShader);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+    program->bindAttributeLocation("vertex", 0);
+    if (!program->link())
+        qCWarning(gLcCore) << "Failed to link the blur shader:" << program->log();
+    return program;
+}
+
+static QOpenGLFramebufferObject *createBlurTarget(const QSize &size)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+
+    QOpenGLFramebufferObject *fbo = new QOpenGLFramebufferObject(size);
+    gl->glBindTexture(GL_TEXTURE_2D, fbo->texture());
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Passes read a little outside of the area they compute
+    fbo->bind();
+    gl->glDisable(GL_SCISSOR_TEST);
+    gl->glClearColor(0, 0, 0, 0);
+    gl->glClear(GL_COLOR_BUFFER_BIT);
+
+    return fbo;
+}
+
+static void renderBlurLevel(QOpenGLShaderProgram *program,
+                            QOpenGLFramebufferObject *target, int level,
+                            const QSize &inputSize, float scale, float offset,
+                            const QVector<QRect> &rects)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+
+    target->bind();
+    gl->glViewport(0, 0, target->width(), target->height());
+
+    const QVector2D texel(1.0f / inputSize.width(), 1.0f / inputSize.height());
+    program->setUniformValue("source", 0);
+    program->setUniformValue("scale", texel * scale);
+    program->setUniformValue("delta", texel * offset);
+
+    static const GLfloat vertices[] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    program->enableAttributeArray(0);
+    program->setAttributeArray(0, GL_FLOAT, vertices, 2);
+
+    const QRect bounds(QPoint(0, 0), target->size());
+    Q_FOREACH (const QRect &rect, rects) {
+        // Round outwards, texels covering any stale pixel are drawn
+        const QRect scissor = QRect(QPoint(rect.left() >> level, rect.top() >> level),
+                                    QPoint(rect.right() >> level, rect.bottom() >> level)) & bounds;
+        if (scissor.isEmpty())
+            continue;
+        gl->glScissor(scissor.x(), scissor.y(), scissor.width(), scissor.height());
+        gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    program->disableAttributeArray(0);
+}
+
+/*
+ * BlurNode
+ */
+
+BlurNode::BlurNode(QQuickItem *item)
+    : QSGGeometryNode()
+    , m_window(item->window())
+    , m_layer(Q_NULLPTR)
+    , m_sourceNode(Q_NULLPTR)
+    , m_devicePixelRatio(1)
+    , m_iterations(0)
+    , m_offset(0)
+    , m_downsampleProgram(Q_NULLPTR)
+    , m_upsampleProgram(Q_NULLPTR)
+    , m_texture(Q_NULLPTR)
+    , m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0)
+    , m_valid(false)
+{
+    QQuickItemPrivate *d = QQuickItemPrivate::get(item);
+    m_layer = d->sceneGraphContext()->createLayer(d->sceneGraphRenderContext());
+
+    // The backdrop is captured again only when it's damaged
+    m_layer->setLive(false);
+    m_layer->setRecursive(false);
+    m_layer->setFormat(GL_RGBA);
+    m_layer->setHasMipmaps(false);
+    m_layer->setMirrorVertical(true);
+    m_layer->setFiltering(QSGTexture::Linear);
+
+    m_geometry.setDrawingMode(GL_TRIANGLES);
+    setGeometry(&m_geometry);
+
+    m_material.setFiltering(QSGTexture::Linear);
+    m_opaqueMaterial.setFiltering(QSGTexture::Linear);
+    setMaterial(&m_material);
+    setOpaqueMaterial(&m_opaqueMaterial);
+
+    setFlag(UsePreprocess);
+}
+
+BlurNode::~BlurNode()
+{
+    releasePyramid();
+    delete m_downsampleProgram;
+    delete m_upsampleProgram;
+    delete m_layer;
+}
+
+void BlurNode::sync(QSGNode *sourceNode, const QRectF &sourceRect,
+                    const QSize &size, qreal devicePixelRatio,
+                    int iterations, qreal offset)
+{
+    const bool resized = size != m_size || iterations != m_iterations;
+
+    if (sourceNode != m_sourceNode || sourceRect != m_sourceRect ||
+            size != m_size || devicePixelRatio != m_devicePixelRatio) {
+        m_sourceNode = sourceNode;
+        m_sourceRect = sourceRect;
+        m_devicePixelRatio = devicePixelRatio;
+        m_layer->setItem(sourceNode);
+        m_layer->setRect(sourceRect);
+        m_layer->setSize(size);
+        m_layer->setDevicePixelRatio(devicePixelRatio);
+        invalidate();
+    }
+
+    if (resized) {
+        m_size = size;
+        m_iterations = iterations;
+        createPyramid();
+        invalidate();
+    }
+
+    if (offset != m_offset) {
+        m_offset = offset;
+        invalidate();
+    }
+}
+
+void BlurNode::setRegion(const QRegion &region, const QSizeF &itemSize)
+{
+    m_clip = scaled(region, m_devicePixelRatio) & QRect(QPoint(0, 0), m_size);
+
+    if (region == m_region && itemSize == m_itemSize)
+        return;
+    m_region = region;
+    m_itemSize = itemSize;
+
+    const QVector<QRect> rects = region.rects();
+    m_geometry.allocate(rects.size() * 6);
+
+    QSGGeometry::TexturedPoint2D *vertices = m_geometry.vertexDataAsTexturedPoint2D();
+    Q_FOREACH (const QRect &rect, rects) {
+        const float left = rect.x();
+        const float top = rect.y();
+        const float right = rect.x() + rect.width();
+        const float bottom = rect.y() + rect.height();
+        const float s0 = left / itemSize.width();
+        const float t0 = top / itemSize.height();
+        const float s1 = right / itemSize.width();
+        const float t1 = bottom / itemSize.height();
+
+        vertices[0].set(left, top, s0, t0);
+        vertices[1].set(right, top, s1, t0);
+        vertices[2].set(left, bottom, s0, t1);
+        vertices[3].set(left, bottom, s0, t1);
+        vertices[4].set(right, top, s1, t0);
+        vertices[5].set(right, bottom, s1, t1);
+        vertices += 6;
+    }
+
+    markDirty(DirtyGeometry);
+}
+
+void BlurNode::addDamage(const QRegion &region)
+{
+    m_damage |= region;
+    m_layer->markDirtyTexture();
+    m_layer->scheduleUpdate();
+}
+
+void BlurNode::invalidate()
+{
+    m_valid = false;
+    m_damage = QRegion();
+    m_layer->markDirtyTexture();
+    m_layer->scheduleUpdate();
+}
+
+void BlurNode::preprocess()
+{
+    if (m_upsampled.isEmpty())
+        return;
+
+    const QRect bounds(QPoint(0, 0), m_size);
+    const int distance = margin();
+
+    // Clipped pixels read the backdrop up to the margin away,
+    // the pyramid is kept up to date on that area only
+    const QRegion needed = tiled(m_clip, distance) & bounds;
+
+    // Without windows to blur behind the backdrop is not captured,
+    // the pending grab happens as soon as there is one again
+    if (needed.isEmpty()) {
+        m_needed = needed;
+        m_damage = QRegion();
+        return;
+    }
+
+    const bool grabbed = m_layer->updateTexture();
+    if (!m_layer->textureId())
+        return;
+
+    QRegion stale;
+    if (!m_valid) {
+        stale = needed;
+    } else {
+        // Texels within the margin from the edge of the area computed
+        // before have read uninitialized ones and can't be reused
+        if (needed != m_needed)
+            stale = needed - (QRegion(bounds) - tiled(QRegion(bounds) - m_needed, distance));
+
+        // Damage spreads by the margin through the passes
+        if (grabbed)
+            stale |= tiled(m_damage, distance) & needed;
+    }
+
+    m_needed = needed;
+    m_damage = QRegion();
+    m_valid = true;
+
+    if (stale.isEmpty())
+        return;
+    if (stale.rectCount() > maxStaleRects)
+        stale = QRegion(stale.boundingRect());
+
+    render(stale);
+}
+
+int BlurNode::margin() const
+{
+    // Each pass reads up to offset + 1 texels away on the smaller
+    // of the two levels, summed up on the whole chain
+    return qCeil(3 * (m_offset + 1) * (1 << m_iterations));
+}
+
+QSize BlurNode::levelSize(int level) const
+{
+    const int round = (1 << level) - 1;
+    return QSize(qMax(1, (m_size.width() + round) >> level),
+                 qMax(1, (m_size.height() + round) >> level));
+}
+
+void BlurNode::createPyramid()
+{
+    releasePyramid();
+
+    for (int level = 0; level < m_iterations; level++) {
+        m_downsampled.append(createBlurTarget(levelSize(level + 1)));
+        m_upsampled.append(createBlurTarget(levelSize(level)));
+    }
+    QOpenGLFramebufferObject::bindDefault();
+
+    m_texture = m_window->createTextureFromId(m_upsampled.first()->texture(), m_size,
+                                              QQuickWindow::TextureHasAlphaChannel);
+    m_material.setTexture(m_texture);
+    m_opaqueMaterial.setTexture(m_texture);
+    markDirty(DirtyMaterial);
+}
+
+void BlurNode::releasePyramid()
+{
+    m_material.setTexture(Q_NULLPTR);
+    m_opaqueMaterial.setTexture(Q_NULLPTR);
+    delete m_texture;
+    m_texture = Q_NULLPTR;
+
+    qDeleteAll(m_downsampled);
+    m_downsampled.clear();
+    qDeleteAll(m_upsampled);
+    m_upsampled.clear();
+}
+
+void BlurNode::render(const QRegion &stale)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+
+    if (!m_downsampleProgram) {
+        m_downsampleProgram = createBlurProgram(downsampleFragmentShader);
+        m_upsampleProgram = createBlurProgram(upsampleFragmentShader);
+    }
+
+    gl->glDisable(GL_BLEND);
+    gl->glDisable(GL_DEPTH_TEST);
+    gl->glDisable(GL_STENCIL_TEST);
+    gl->glEnable(GL_SCISSOR_TEST);
+    gl->glActiveTexture(GL_TEXTURE0);
+
+    const QVector<QRect> rects = stale.rects();
+
+    // Each level is drawn from the previous one, starting
+    // with the backdrop and halving the size every time
+    m_downsampleProgram->bind();
+    for (int level = 1; level <= m_iterations; level++) {
+        if (level == 1)
+            m_layer->bind();
+        else
+            gl->glBindTexture(GL_TEXTURE_2D, m_downsampled.at(level - 2)->texture());
+        renderBlurLevel(m_downsampleProgram, m_downsampled.at(level - 1), level,
+                        levelSize(level - 1), 2.0f, m_offset, rects);
+    }
+
+    // Back up to the full size, the far samples are
+    // as distant as the ones of the downsampling
+    m_upsampleProgram->bind();
+    for (int level = m_iterations - 1; level >= 0; level--) {
+        QOpenGLFramebufferObject *input = level == m_iterations - 1
+                ? m_downsampled.last() : m_upsampled.at(level + 1);
+        gl->glBindTexture(GL_TEXTURE_2D, input->texture());
+        renderBlurLevel(m_upsampleProgram, m_upsampled.at(level), level,
+                        levelSize(level + 1), 0.5f, m_offset * 0.5f, rects);
+    }
+    m_upsampleProgram->release();
+
+    gl->glDisable(GL_SCISSOR_TEST);
+    m_window->resetOpenGLState();
+}
+
+/*
+ * BlurItemPrivate
+ */
+
+BlurItemPrivate::BlurItemPrivate()
+    : QQuickItemPrivate()
+    , source(Q_NULLPTR)
+    , sourceTracker(Q_NULLPTR)
+    , sourceStructureChanged(false)
+    , iterations(4)
+    , offset(1.5)
+    , fullDamage(true)
+{
+}
+
+void BlurItemPrivate::trackSource()
+{
+    Q_Q(BlurItem);
+
+    // Items are connected again only when the tree changed,
+    // otherwise their geometry is compared with the last scan
+    const bool reconnect = sourceStructureChanged;
+    sourceStructureChanged = false;
+    if (reconnect) {
+        delete sourceTracker;
+        sourceTracker = source ? new QObject(q) : Q_NULLPTR;
+    }
+
+    QHash<QQuickItem *, QRectF> rects;
+    if (source) {
+        if (reconnect) {
+            QObject::connect(source, &QQuickItem::childrenChanged, sourceTracker, [this, q] {
+                sourceStructureChanged = true;
+                q->polish();
+            });
+        }
+
+        Q_FOREACH (QQuickItem *child, source->childItems())
+            trackItem(child, rects, reconnect);
+    }
+
+    // Damage what moved, appeared or went away
+    for (auto it = rects.constBegin(); it != rects.constEnd(); ++it) {
+        const QRectF previous = itemRects.value(it.key());
+        if (previous != it.value()) {
+            addDamage(previous);
+            addDamage(it.value());
+        }
+    }
+    for (auto it = itemRects.constBegin(); it != itemRects.constEnd(); ++it) {
+        if (!rects.contains(it.key()))
+            addDamage(it.value());
+    }
+    itemRects = rects;
+}
+
+void BlurItemPrivate::trackItem(QQuickItem *item, QHash<QQuickItem *, QRectF> &rects, bool connectItem)
+{
+    Q_Q(BlurItem);
+
+    rects.insert(item, itemRect(item));
+
+    if (connectItem) {
+        // Geometry changes are collected until the next polish
+        auto changed = [q] { q->polish(); };
+        QObject::connect(item, &QQuickItem::xChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::yChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::zChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::widthChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::heightChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::opacityChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::visibleChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::scaleChanged, sourceTracker, changed);
+        QObject::connect(item, &QQuickItem::rotationChanged, sourceTracker, changed);
+
+        auto structureChanged = [this, q] {
+            sourceStructureChanged = true;
+            q->polish();
+        };
+        QObject::connect(item, &QQuickItem::childrenChanged, sourceTracker, structureChanged);
+
+        // Client content is the only one we know the damage of
+        QWaylandQuickItem *waylandItem = qobject_cast<QWaylandQuickItem *>(item);
+        if (waylandItem) {
+            QObject::connect(waylandItem, &QWaylandQuickItem::surfaceChanged,
+                             sourceTracker, structureChanged);
+
+            if (waylandItem->surface()) {
+                QPointer<QWaylandQuickItem> guard(waylandItem);
+                QObject::connect(waylandItem->surface(), &QWaylandSurface::damaged,
+                                 sourceTracker, [this, q, guard](const QRegion &region) {
+                    if (!guard || !guard->isVisible())
+                        return;
+
+                    const QPointF ratio = guard->mapToSurface(QPointF(1, 1));
+                    Q_FOREACH (const QRect &rect, region.rects()) {
+                        const QRectF itemRect(rect.x() / ratio.x(), rect.y() / ratio.y(),
+                                              rect.width() / ratio.x(), rect.height() / ratio.y());
+                        addDamage(guard->mapRectToItem(q, itemRect));
+                    }
+                });
+            }
+        }
+    }
+
+    Q_FOREACH (QQuickItem *child, item->childItems())
+        trackItem(child, rects, connectItem);
+}
+
+QRectF BlurItemPrivate::itemRect(QQuickItem *item) const
+{
+    Q_Q(const BlurItem);
+
+    if (!item->isVisible() || qFuzzyIsNull(item->opacity()))
+        return QRectF();
+    return item->mapRectToItem(q, item->boundingRect());
+}
+
+void BlurItemPrivate::addDamage(const QRectF &rect)
+{
+    Q_Q(BlurItem);
+
+    const QRect clipped = rect.toAlignedRect() & q->boundingRect().toAlignedRect();
+    if (clipped.isEmpty())
+        return;
+
+    damage |= clipped;
+    q->update();
+}
+
+void BlurItemPrivate::trackWindowSurfaces()
+{
+    Q_Q(BlurItem);
+
+    Q_FOREACH (const QPointer<QWaylandSurface> &surface, windowSurfaces) {
+        if (surface)
+            surface->removeEventFilter(q);
+    }
+    windowSurfaces.clear();
+
+    // The region is a dynamic property of the surface,
+    // changes are caught with an event filter
+    Q_FOREACH (QQuickItem *window, windowList) {
+        QWaylandQuickItem *waylandItem = qobject_cast<QWaylandQuickItem *>(window);
+        if (waylandItem && waylandItem->surface()) {
+            waylandItem->surface()->installEventFilter(q);
+            windowSurfaces.append(waylandItem->surface());
+        }
+    }
+}
+
+QRegion BlurItemPrivate::windowRegion() const
+{
+    Q_Q(const BlurItem);
+
+    QRegion region;
+
+    Q_FOREACH (QQuickItem *window, windowList) {
+        if (!window->isVisible())
+            continue;
+
+        // Shell items are blurred behind as a whole, client
+        // windows only where they asked for it
+        QWaylandQuickItem *waylandItem = qobject_cast<QWaylandQuickItem *>(window);
+        if (!waylandItem) {
+            region |= window->mapRectToItem(q, window->boundingRect()).toAlignedRect();
+            continue;
+        }
+        if (!waylandItem->surface())
+            continue;
+
+        const QRegion blurRegion =
+                waylandItem->surface()->property("blurBehindRegion").value<QRegion>();
+        const QPointF ratio = waylandItem->mapToSurface(QPointF(1, 1));
+        Q_FOREACH (const QRect &rect, blurRegion.rects()) {
+            const QRectF itemRect(rect.x() / ratio.x(), rect.y() / ratio.y(),
+                                  rect.width() / ratio.x(), rect.height() / ratio.y());
+            region |= waylandItem->mapRectToItem(q, itemRect).toAlignedRect();
+        }
+    }
+
+    return region & q->boundingRect().toAlignedRect();
+}
+
+void BlurItemPrivate::windows_append(QQmlListProperty<QQuickItem> *prop, QQuickItem *item)
+{
+    BlurItem *q = static_cast<BlurItem *>(prop->object);
+    BlurItemPrivate *d = BlurItemPrivate::get(q);
+
+    if (!item || d->windowList.contains(item))
+        return;
+
+    d->windowList.append(item);
+
+    auto changed = [q] { q->update(); };
+    QObject::connect(item, &QQuickItem::xChanged, q, changed);
+    QObject::connect(item, &QQuickItem::yChanged, q, changed);
+    QObject::connect(item, &QQuickItem::widthChanged, q, changed);
+    QObject::connect(item, &QQuickItem::heightChanged, q, changed);
+    QObject::connect(item, &QQuickItem::visibleChanged, q, changed);
+    QObject::connect(item, &QObject::destroyed, q, [q, d, item] {
+        d->windowList.removeAll(item);
+        d->trackWindowSurfaces();
+        q->update();
+        Q_EMIT q->windowsChanged();
+    });
+
+    QWaylandQuickItem *waylandItem = qobject_cast<QWaylandQuickItem *>(item);
+    if (waylandItem) {
+        QObject::connect(waylandItem, &QWaylandQuickItem::surfaceChanged, q, [q, d] {
+            d->trackWindowSurfaces();
+            q->update();
+        });
+    }
+
+    d->trackWindowSurfaces();
+    q->update();
+    Q_EMIT q->windowsChanged();
+}
+
+int BlurItemPrivate::windows_count(QQmlListProperty<QQuickItem> *prop)
+{
+    BlurItem *q = static_cast<BlurItem *>(prop->object);
+    return BlurItemPrivate::get(q)->windowList.size();
+}
+
+QQuickItem *BlurItemPrivate::windows_at(QQmlListProperty<QQuickItem> *prop, int index)
+{
+    BlurItem *q = static_cast<BlurItem *>(prop->object);
+    return BlurItemPrivate::get(q)->windowList.at(index);
+}
+
+void BlurItemPrivate::windows_clear(QQmlListProperty<QQuickItem> *prop)
+{
+    BlurItem *q = static_cast<BlurItem *>(prop->object);
+    BlurItemPrivate *d = BlurItemPrivate::get(q);
+
+    Q_FOREACH (QQuickItem *window, d->windowList)
+        QObject::disconnect(window, Q_NULLPTR, q, Q_NULLPTR);
+    d->windowList.clear();
+
+    d->trackWindowSurfaces();
+    q->update();
+    Q_EMIT q->windowsChanged();
+}
+
+/*
+ * BlurItem
+ */
+
+BlurItem::BlurItem(QQuickItem *parent)
+    : QQuickItem(*new BlurItemPrivate(), parent)
+{
+    setFlag(ItemHasContents);
+}
+
+BlurItem::~BlurItem()
+{
+    Q_D(BlurItem);
+
+    if (d->source) {
+        disconnect(d->sourceDestroyedConnection);
+        QQuickItemPrivate::get(d->source)->derefFromEffectItem(false);
+    }
+
+    Q_FOREACH (const QPointer<QWaylandSurface> &surface, d->windowSurfaces) {
+        if (surface)
+            surface->removeEventFilter(this);
+    }
+}
+
+QQuickItem *BlurItem::source() const
+{
+    Q_D(const BlurItem);
+    return d->source;
+}
+
+void BlurItem::setSource(QQuickItem *source)
+{
+    Q_D(BlurItem);
+
+    if (d->source == source)
+        return;
+
+    if (d->source) {
+        disconnect(d->sourceDestroyedConnection);
+        QQuickItemPrivate::get(d->source)->derefFromEffectItem(false);
+    }
+
+    d->source = source;
+
+    if (d->source) {
+        // Keeps the source in the scene graph like any other
+        // effect, the layer renders it from its own root node
+        QQuickItemPrivate::get(d->source)->refFromEffectItem(false);
+        d->sourceDestroyedConnection = connect(d->source, &QObject::destroyed, this, [this, d] {
+            d->source = Q_NULLPTR;
+            d->sourceStructureChanged = true;
+            polish();
+            update();
+            Q_EMIT sourceChanged();
+        });
+    }
+
+    d->sourceStructureChanged = true;
+    d->fullDamage = true;
+    polish();
+    update();
+    Q_EMIT sourceChanged();
+}
+
+QQmlListProperty<QQuickItem> BlurItem::windows()
+{
+    return QQmlListProperty<QQuickItem>(this, Q_NULLPTR,
+                                        BlurItemPrivate::windows_append,
+                                        BlurItemPrivate::windows_count,
+                                        BlurItemPrivate::windows_at,
+                                        BlurItemPrivate::windows_clear);
+}
+
+int BlurItem::iterations() const
+{
+    Q_D(const BlurItem);
+    return d->iterations;
+}
+
+void BlurItem::setIterations(int iterations)
+{
+    Q_D(BlurItem);
+
+    iterations = qBound(1, iterations, maxIterations);
+    if (d->iterations == iterations)
+        return;
+
+    d->iterations = iterations;
+    update();
+    Q_EMIT iterationsChanged();
+}
+
+qreal BlurItem::offset() const
+{
+    Q_D(const BlurItem);
+    return d->offset;
+}
+
+void BlurItem::setOffset(qreal offset)
+{
+    Q_D(BlurItem);
+
+    offset = qMax<qreal>(0, offset);
+    if (qFuzzyCompare(d->offset, offset))
+        return;
+
+    d->offset = offset;
+    update();
+    Q_EMIT offsetChanged();
+}
+
+void BlurItem::invalidate()
+{
+    Q_D(BlurItem);
+    d->fullDamage = true;
+    update();
+}
+
+void BlurItem::invalidate(const QRectF &rect)
+{
+    Q_D(BlurItem);
+    d->addDamage(rect);
+}
+
+bool BlurItem::eventFilter(QObject *object, QEvent *event)
+{
+    if (event->type() == QEvent::DynamicPropertyChange) {
+        QDynamicPropertyChangeEvent *propertyEvent = static_cast<QDynamicPropertyChangeEvent *>(event);
+        if (propertyEvent->propertyName() == "blurBehindRegion")
+            update();
+    }
+
+    return QQuickItem::eventFilter(object, event);
+}
+
+void BlurItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+
+    // Tracked rectangles are relative to this item
+    polish();
+    update();
+}
+
+void BlurItem::itemChange(ItemChange change, const ItemChangeData &data)
+{
+    Q_D(BlurItem);
+
+    // A new window means a new node, everything is computed again
+    if (change == ItemSceneChange) {
+        d->fullDamage = true;
+        polish();
+    }
+
+    QQuickItem::itemChange(change, data);
+}
+
+void BlurItem::updatePolish()
+{
+    Q_D(BlurItem);
+    d->trackSource();
+}
+
+QSGNode *BlurItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_D(BlurItem);
+    Q_UNUSED(data);
+
+    BlurNode *node = static_cast<BlurNode *>(oldNode);
+
+    const QRectF rect = boundingRect();
+    const qreal ratio = window()->effectiveDevicePixelRatio();
+    const QSize size = (rect.size() * ratio).toSize();
+
+    if (!d->source || d->source->window() != window() || size.isEmpty()) {
+        delete node;
+        return Q_NULLPTR;
+    }
+
+    if (!node)
+        node = new BlurNode(this);
+
+    node->sync(QQuickItemPrivate::get(d->source)->itemNode(),
+               mapRectToItem(d->source, rect), size, ratio,
+               d->iterations, d->offset);
+
+    if (d->fullDamage)
+        node->invalidate();
+    else if (!d->damage.isEmpty())
+        node->addDamage(scaled(d->damage, ratio));
+    d->damage = QRegion();
+    d->fullDamage = false;
+
+    node->setRegion(d->windowRegion(), rect.size());
+
+    return node;
+}
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#include "moc_bluritem.cpp"
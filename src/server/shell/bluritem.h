@@ -0,0 +1,87 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+
+#ifndef GREENISLAND_BLURITEM_H
+#define GREENISLAND_BLURITEM_H
+
+#include <QtQml/QQmlListProperty>
+#include <QtQuick/QQuickItem>
+
+#include <GreenIsland/server/greenislandserver_export.h>
+
+namespace GreenIsland {
+
+namespace Server {
+
+class BlurItemPrivate;
+
+class GREENISLANDSERVER_EXPORT BlurItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(BlurItem)
+    Q_PROPERTY(QQuickItem *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(QQmlListProperty<QQuickItem> windows READ windows NOTIFY windowsChanged)
+    Q_PROPERTY(int iterations READ iterations WRITE setIterations NOTIFY iterationsChanged)
+    Q_PROPERTY(qreal offset READ offset WRITE setOffset NOTIFY offsetChanged)
+public:
+    BlurItem(QQuickItem *parent = Q_NULLPTR);
+    ~BlurItem();
+
+    QQuickItem *source() const;
+    void setSource(QQuickItem *source);
+
+    QQmlListProperty<QQuickItem> windows();
+
+    int iterations() const;
+    void setIterations(int iterations);
+
+    qreal offset() const;
+    void setOffset(qreal offset);
+
+    Q_INVOKABLE void invalidate();
+    Q_INVOKABLE void invalidate(const QRectF &rect);
+
+Q_SIGNALS:
+    void sourceChanged();
+    void windowsChanged();
+    void iterationsChanged();
+    void offsetChanged();
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event) Q_DECL_OVERRIDE;
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) Q_DECL_OVERRIDE;
+    void itemChange(ItemChange change, const ItemChangeData &data) Q_DECL_OVERRIDE;
+    void updatePolish() Q_DECL_OVERRIDE;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) Q_DECL_OVERRIDE;
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_BLURITEM_H
@@ -0,0 +1,156 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+
+#ifndef GREENISLAND_BLURITEM_P_H
+#define GREENISLAND_BLURITEM_P_H
+
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+#include <QtGui/QRegion>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGTextureMaterial>
+#include <QtQuick/private/qquickitem_p.h>
+
+#include <GreenIsland/Server/BlurItem>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Green Island API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+class QSGLayer;
+class QWaylandSurface;
+
+namespace GreenIsland {
+
+namespace Server {
+
+class GREENISLANDSERVER_EXPORT BlurItemPrivate : public QQuickItemPrivate
+{
+    Q_DECLARE_PUBLIC(BlurItem)
+public:
+    BlurItemPrivate();
+
+    static BlurItemPrivate *get(BlurItem *item) { return item->d_func(); }
+
+    void trackSource();
+    void trackItem(QQuickItem *item, QHash<QQuickItem *, QRectF> &rects, bool connectItem);
+    QRectF itemRect(QQuickItem *item) const;
+    void addDamage(const QRectF &rect);
+
+    void trackWindowSurfaces();
+    QRegion windowRegion() const;
+
+    static void windows_append(QQmlListProperty<QQuickItem> *prop, QQuickItem *item);
+    static int windows_count(QQmlListProperty<QQuickItem> *prop);
+    static QQuickItem *windows_at(QQmlListProperty<QQuickItem> *prop, int index);
+    static void windows_clear(QQmlListProperty<QQuickItem> *prop);
+
+    QQuickItem *source;
+    QMetaObject::Connection sourceDestroyedConnection;
+    QObject *sourceTracker;
+    bool sourceStructureChanged;
+    QHash<QQuickItem *, QRectF> itemRects;
+
+    QList<QQuickItem *> windowList;
+    QList<QPointer<QWaylandSurface> > windowSurfaces;
+
+    int iterations;
+    qreal offset;
+
+    QRegion damage;
+    bool fullDamage;
+};
+
+class BlurNode : public QSGGeometryNode
+{
+public:
+    BlurNode(QQuickItem *item);
+    ~BlurNode();
+
+    void sync(QSGNode *sourceNode, const QRectF &sourceRect,
+              const QSize &size, qreal devicePixelRatio,
+              int iterations, qreal offset);
+    void setRegion(const QRegion &region, const QSizeF &itemSize);
+    void addDamage(const QRegion &region);
+    void invalidate();
+
+    void preprocess() Q_DECL_OVERRIDE;
+
+private:
+    QQuickWindow *m_window;
+    QSGLayer *m_layer;
+    QSGNode *m_sourceNode;
+    QRectF m_sourceRect;
+    QSize m_size;
+    qreal m_devicePixelRatio;
+    int m_iterations;
+    qreal m_offset;
+
+    // Level n of the pyramid is the size of the output divided
+    // by 2^n, the downsampled chain holds levels 1 to n and the
+    // upsampled one levels 0 to n - 1 with the result at level 0
+    QVector<QOpenGLFramebufferObject *> m_downsampled;
+    QVector<QOpenGLFramebufferObject *> m_upsampled;
+    QOpenGLShaderProgram *m_downsampleProgram;
+    QOpenGLShaderProgram *m_upsampleProgram;
+
+    QSGTexture *m_texture;
+    QSGTextureMaterial m_material;
+    QSGOpaqueTextureMaterial m_opaqueMaterial;
+    QSGGeometry m_geometry;
+    QRegion m_region;
+    QSizeF m_itemSize;
+
+    // Pixels of level 0
+    QRegion m_clip;
+    QRegion m_needed;
+    QRegion m_damage;
+    bool m_valid;
+
+    int margin() const;
+    QSize levelSize(int level) const;
+    void createPyramid();
+    void releasePyramid();
+    void render(const QRegion &stale);
+};
+
+} // namespace Server
+
+} // namespace GreenIsland
+
+#endif // GREENISLAND_BLURITEM_P_H
@@ -37,6 +37,7 @@
 #include "clientwindow.h"
 #include "clientwindow_p.h"
 #include "serverlogging_p.h"
+#include "core/quickoutput_p.h"
 #include "extensions/applicationmanager_p.h"
 
 namespace GreenIsland {
@@ -129,6 +130,51 @@ void ClientWindowPrivate::findOutputs()
     }
 }
 
+void ClientWindowPrivate::updateFullScreenOutputs()
+{
+    if (!surface)
+        return;
+
+    // Only an activated window is in front of everything else
+    const bool frontmost = active && fullscreen && !minimized;
+
+    Q_FOREACH (QWaylandOutput *output, surface->compositor()->outputs()) {
+        QuickOutput *quickOutput = qobject_cast<QuickOutput *>(output);
+        if (!quickOutput)
+            continue;
+
+        QuickOutputPrivate *outputPrivate = QuickOutputPrivate::get(quickOutput);
+        if (frontmost && outputsList.contains(output))
+            outputPrivate->setFullScreenSurface(surface);
+        else if (outputPrivate->fullScreenSurface == surface)
+            outputPrivate->setFullScreenSurface(Q_NULLPTR);
+    }
+}
+
+void ClientWindowPrivate::updateVisibility()
+{
+    if (!surface)
+        return;
+
+    // Not every shell registers its views, without any
+    // we cannot tell and the window is considered visible
+    bool visible = views.isEmpty();
+    Q_FOREACH (QWaylandQuickItem *view, views)
+        visible |= view->isVisible();
+
+    // Frame callbacks of hidden and minimized surfaces are throttled
+    QWindow::Visibility visibility = QWindow::Windowed;
+    if (minimized)
+        visibility = QWindow::Minimized;
+    else if (!visible)
+        visibility = QWindow::Hidden;
+    else if (fullscreen)
+        visibility = QWindow::FullScreen;
+    else if (maximized)
+        visibility = QWindow::Maximized;
+    surface->setVisibility(visibility);
+}
+
 void ClientWindowPrivate::setType(ClientWindow::Type type)
 {
     Q_Q(ClientWindow);
@@ -501,6 +547,31 @@ ClientWindow::ClientWindow(ApplicationManager *applicationManager, QWaylandSurfa
         d->findOutputs();
     });
 
+    // Let outputs know when a fullscreen window is in front
+    connect(this, &ClientWindow::activatedChanged, this, [this, d] {
+        d->updateFullScreenOutputs();
+    });
+    connect(this, &ClientWindow::minimizedChanged, this, [this, d] {
+        d->updateFullScreenOutputs();
+    });
+    connect(this, &ClientWindow::fullscreenChanged, this, [this, d] {
+        d->updateFullScreenOutputs();
+    });
+    connect(this, &ClientWindow::outputsChanged, this, [this, d] {
+        d->updateFullScreenOutputs();
+    });
+
+    // Tell the surface whether it can be seen
+    connect(this, &ClientWindow::minimizedChanged, this, [this, d] {
+        d->updateVisibility();
+    });
+    connect(this, &ClientWindow::maximizedChanged, this, [this, d] {
+        d->updateVisibility();
+    });
+    connect(this, &ClientWindow::fullscreenChanged, this, [this, d] {
+        d->updateVisibility();
+    });
+
     // Initialize
     d->initialize(surface);
 }
@@ -692,15 +763,23 @@ void ClientWindow::addWindowView(QWaylandQuickItem *item)
 {
     Q_D(ClientWindow);
 
-    if (!d->views.contains(item))
+    if (!d->views.contains(item)) {
         d->views.append(item);
+        connect(item, &QQuickItem::visibleChanged, this, [this, d] {
+            d->updateVisibility();
+        });
+        d->updateVisibility();
+    }
 }
 
 void ClientWindow::removeWindowView(QWaylandQuickItem *item)
 {
     Q_D(ClientWindow);
 
-    d->views.removeOne(item);
+    if (d->views.removeOne(item)) {
+        disconnect(item, &QQuickItem::visibleChanged, this, Q_NULLPTR);
+        d->updateVisibility();
+    }
 }
 
 void ClientWindow::activate()
@@ -90,6 +90,8 @@ public:
     void initialize(QWaylandSurface *surface);
 
     void findOutputs();
+    void updateFullScreenOutputs();
+    void updateVisibility();
 
     void setType(ClientWindow::Type type);
     void setParentWindow(ClientWindow *window);
@@ -264,6 +264,22 @@ void QWaylandBufferRef::bindToTexture() const
 
 }
 
+/*!
+ * Uploads \a plane of a YUV shared memory buffer to the current OpenGL
+ * texture. If \a damage is empty the whole plane is uploaded, otherwise
+ * only the damaged area of a texture previously bound to this plane is
+ * updated.
+ *
+ * \sa bufferFormatEgl()
+ */
+void QWaylandBufferRef::bindPlaneToTexture(int plane, const QRegion &damage) const
+{
+    if (d->nullOrDestroyed())
+        return;
+
+    d->buffer->bindPlaneToTexture(plane, damage);
+}
+
 void QWaylandBufferRef::updateTexture() const
 {
     if (d->nullOrDestroyed() || d->buffer->isSharedMemory())
@@ -38,6 +38,7 @@
 #define QWAYLANDBUFFERREF_H
 
 #include <QImage>
+#include <QRegion>
 
 #ifdef QT_WAYLAND_COMPOSITOR_GL
 #include <QtGui/qopengl.h>
@@ -100,6 +101,7 @@ public:
 #ifdef QT_WAYLAND_COMPOSITOR_GL
     GLuint textureForPlane(int plane) const;
     void bindToTexture() const;
+    void bindPlaneToTexture(int plane, const QRegion &damage = QRegion()) const;
     void updateTexture() const;
 #endif
 
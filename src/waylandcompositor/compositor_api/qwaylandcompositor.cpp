@@ -54,6 +54,10 @@
 
 #include "wayland_wrapper/qwldatadevice_p.h"
 #include "wayland_wrapper/qwldatadevicemanager_p.h"
+#include "wayland_wrapper/qwlframecallback_p.h"
+#include "wayland_wrapper/qwlobjectpool_p.h"
+#include "wayland_wrapper/qwlsurfacebuffer_p.h"
+#include "wayland_wrapper/qwlviewporter_p.h"
 
 #include "hardware_integration/qwlclientbufferintegration_p.h"
 #include "hardware_integration/qwlclientbufferintegrationfactory_p.h"
@@ -146,6 +150,8 @@ public:
 
 QWaylandCompositorPrivate::QWaylandCompositorPrivate(QWaylandCompositor *compositor)
     : display(0)
+    , viewporter(0)
+    , loop(0)
 #if defined (QT_WAYLAND_COMPOSITOR_GL)
     , use_hw_integration_extension(true)
     , client_buffer_integration(0)
@@ -161,6 +167,11 @@ QWaylandCompositorPrivate::QWaylandCompositorPrivate(QWaylandCompositor *composi
     eventHandler.reset(new QtWayland::WindowSystemEventHandler(compositor));
     timer.start();
 
+    frameCallbackPool = new QtWayland::ObjectPool(QByteArrayLiteral("FrameCallback"),
+                                                  sizeof(QtWayland::FrameCallback), 64);
+    surfaceBufferPool = new QtWayland::ObjectPool(QByteArrayLiteral("SurfaceBuffer"),
+                                                  sizeof(QtWayland::SurfaceBuffer));
+
     QWindowSystemInterfacePrivate::installWindowSystemEventHandler(eventHandler.data());
 }
 
@@ -174,15 +185,20 @@ void QWaylandCompositorPrivate::init()
         if (socketArg != -1 && socketArg + 1 < arguments.size())
             socket_name = arguments.at(socketArg + 1).toLocal8Bit();
     }
-    wl_compositor::init(display, 3);
+    wl_compositor::init(display, 4);
     wl_subcompositor::init(display, 1);
 
     data_device_manager =  new QtWayland::DataDeviceManager(q);
+    viewporter = new QtWayland::Viewporter(q);
 
     wl_display_init_shm(display);
     QVector<wl_shm_format> formats = QWaylandSharedMemoryFormatHelper::supportedWaylandFormats();
     foreach (wl_shm_format format, formats)
         wl_display_add_shm_format(display, format);
+#ifdef QT_WAYLAND_COMPOSITOR_GL
+    foreach (wl_shm_format format, QtWayland::SurfaceBuffer::supportedPlanarFormats())
+        wl_display_add_shm_format(display, format);
+#endif
 
     if (!socket_name.isEmpty()) {
         if (wl_display_add_socket(display, socket_name.constData()))
@@ -226,8 +242,13 @@ QWaylandCompositorPrivate::~QWaylandCompositorPrivate()
     qDeleteAll(outputs);
 
     delete data_device_manager;
+    delete viewporter;
 
     wl_display_destroy(display);
+
+    // Buffers still referenced by views keep their pool alive
+    frameCallbackPool->deref();
+    surfaceBufferPool->deref();
 }
 
 void QWaylandCompositorPrivate::destroySurface(QWaylandSurface *surface)
@@ -64,6 +64,8 @@ namespace QtWayland {
     class ClientBufferIntegration;
     class ServerBufferIntegration;
     class DataDeviceManager;
+    class ObjectPool;
+    class Viewporter;
 }
 
 class QWindowSystemEventHandler;
@@ -128,6 +130,10 @@ protected:
     QList<QWaylandSurface *> all_surfaces;
 
     QtWayland::DataDeviceManager *data_device_manager;
+    QtWayland::Viewporter *viewporter;
+
+    QtWayland::ObjectPool *frameCallbackPool;
+    QtWayland::ObjectPool *surfaceBufferPool;
 
     QElapsedTimer timer;
 
@@ -986,19 +986,30 @@ void QWaylandOutput::setWindow(QWindow *window)
 
 /*!
  * Tells the QWaylandOutput that a frame has started.
+ *
+ * Only surfaces whose primary output is this output are prepared
+ * for receiving frame callbacks.  Like sendFrameCallbacks() this
+ * must be called by the GUI thread.
  */
 void QWaylandOutput::frameStarted()
 {
     Q_D(QWaylandOutput);
     for (int i = 0; i < d->surfaceViews.size(); i++) {
         QWaylandSurfaceViewMapper &surfacemapper = d->surfaceViews[i];
-        if (surfacemapper.maybeThrottelingView())
+        if (!surfacemapper.surface)
+            continue;
+
+        if (QWaylandSurfacePrivate::get(surfacemapper.surface)->primaryOutput == this)
             surfacemapper.surface->frameStarted();
     }
 }
 
 /*!
- * Sends pending frame callbacks.
+ * Sends pending frame callbacks to surfaces whose primary output
+ * is this output.  The primary output of the surfaces is updated
+ * first, so this must be called by the GUI thread.
+ *
+ * \sa QWaylandSurface::primaryOutput
  */
 void QWaylandOutput::sendFrameCallbacks()
 {
@@ -1010,7 +1021,9 @@ void QWaylandOutput::sendFrameCallbacks()
                 surfaceEnter(surfacemapper.surface);
                 d->surfaceViews[i].has_entered = true;
             }
-            if (surfacemapper.maybeThrottelingView())
+            QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(surfacemapper.surface);
+            surfacePrivate->updatePrimaryOutput();
+            if (surfacePrivate->primaryOutput == this)
                 surfacemapper.surface->sendFrameCallbacks();
         }
     }
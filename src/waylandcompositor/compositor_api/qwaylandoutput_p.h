@@ -78,15 +78,6 @@ struct QWaylandSurfaceViewMapper
         , has_entered(false)
     {}
 
-    QWaylandView *maybeThrottelingView() const
-    {
-        for (int i = 0; i < views.size(); i++) {
-            if (surface && surface->throttlingView() == views.at(i))
-                return views.at(i);
-        }
-        return Q_NULLPTR;
-    }
-
     QWaylandSurface *surface;
     QVector<QWaylandView *> views;
     bool has_entered;
@@ -51,6 +51,7 @@
 #include "qwaylandquicksurface.h"
 #include "qwaylandquickoutput.h"
 #include "qwaylandquickitem.h"
+#include "qwaylandquickitem_p.h"
 #include "qwaylandoutput.h"
 #include <GreenIsland/QtWaylandCompositor/private/qwaylandcompositor_p.h>
 #include "qwaylandsurfacegrabber.h"
@@ -100,6 +101,9 @@ QWaylandQuickCompositor::QWaylandQuickCompositor(QObject *parent)
 void QWaylandQuickCompositor::create()
 {
     QWaylandCompositor::create();
+
+    if (qEnvironmentVariableIsSet("GREENISLAND_SHADER_CACHE_PREWARM"))
+        QWaylandBufferMaterialShader::prewarmProgramBinaryCache();
 }
 
 
@@ -46,16 +46,24 @@
 #include <GreenIsland/QtWaylandCompositor/private/qwlclientbufferintegration_p.h>
 #include <GreenIsland/QtWaylandCompositor/qwaylandseat.h>
 
+#include <GreenIsland/Platform/EglFSFunctions>
+
 #include <QtGui/QKeyEvent>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QScreen>
+#include <QtGui/QOffscreenSurface>
 #include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
 
+#include <QtQuick/QSGSimpleRectNode>
 #include <QtQuick/QSGSimpleTextureNode>
 #include <QtQuick/QQuickWindow>
 
+#include <QtCore/QFile>
 #include <QtCore/QMutexLocker>
 #include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 
 #include <wayland-server.h>
 #include <QThread>
@@ -133,6 +141,77 @@ static const struct {
     }
 };
 
+static const char *const bufferAttributeNames[] = { "qt_VertexPosition", "qt_VertexTexCoord", 0 };
+
+static QByteArray readShaderSource(const char *fileName)
+{
+    QFile file(QString::fromLatin1(fileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+static QByteArray programBinaryKey(QWaylandBufferRef::BufferFormatEgl format,
+                                   const QByteArray &vertexSource, const QByteArray &fragmentSource)
+{
+    return GreenIsland::Platform::EglFSFunctions::programBinaryKey(vertexSource,
+                                                                   fragmentSource + QByteArray::number(format),
+                                                                   bufferAttributeNames);
+}
+
+class QWaylandProgramBinaryPrewarmer : public QRunnable
+{
+public:
+    QWaylandProgramBinaryPrewarmer(QOffscreenSurface *surface)
+        : m_surface(surface)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QOpenGLContext context;
+        context.setFormat(m_surface->format());
+        if (context.create() && context.makeCurrent(m_surface)) {
+            buildPrograms(&context);
+            context.doneCurrent();
+        }
+
+        m_surface->deleteLater();
+    }
+
+private:
+    QOffscreenSurface *m_surface;
+
+    void buildPrograms(QOpenGLContext *context)
+    {
+        const int count = sizeof(bufferTypes) / sizeof(bufferTypes[0]);
+        for (int i = QWaylandBufferRef::BufferFormatEgl_RGB; i < count; i++) {
+            if (i == QWaylandBufferRef::BufferFormatEgl_EXTERNAL_OES &&
+                    !context->hasExtension(QByteArrayLiteral("GL_OES_EGL_image_external")))
+                continue;
+
+            const QWaylandBufferRef::BufferFormatEgl format = QWaylandBufferRef::BufferFormatEgl(i);
+            const QByteArray vertexSource = readShaderSource(bufferTypes[i].vertexShaderSourceFile);
+            const QByteArray fragmentSource = readShaderSource(bufferTypes[i].fragmentShaderSourceFile);
+            const QByteArray key = programBinaryKey(format, vertexSource, fragmentSource);
+
+            // Binaries can't be stored, or the platform has no cache
+            if (key.isEmpty())
+                return;
+            if (GreenIsland::Platform::EglFSFunctions::hasProgramBinary(key))
+                continue;
+
+            QOpenGLShaderProgram program;
+            program.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource);
+            program.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource);
+            for (int j = 0; bufferAttributeNames[j]; j++)
+                program.bindAttributeLocation(bufferAttributeNames[j], j);
+            if (program.link())
+                GreenIsland::Platform::EglFSFunctions::saveProgramBinary(&program, key);
+        }
+    }
+};
+
 QWaylandBufferMaterialShader::QWaylandBufferMaterialShader(QWaylandBufferRef::BufferFormatEgl format)
     : QSGMaterialShader()
     , m_format(format)
@@ -157,8 +236,41 @@ void QWaylandBufferMaterialShader::updateState(const QSGMaterialShader::RenderSt
 
 const char * const *QWaylandBufferMaterialShader::attributeNames() const
 {
-    static char const *const attr[] = { "qt_VertexPosition", "qt_VertexTexCoord", 0 };
-    return attr;
+    return bufferAttributeNames;
+}
+
+/*
+ * Compile the programs for all buffer formats on a background context
+ * and store them in the program binary cache, so that the first client
+ * using e.g. a YUV format doesn't stall the render thread.
+ */
+void QWaylandBufferMaterialShader::prewarmProgramBinaryCache()
+{
+    if (!QOpenGLContext::supportsThreadedOpenGL())
+        return;
+
+    // Offscreen surfaces must be created on the GUI thread
+    QOffscreenSurface *surface = new QOffscreenSurface();
+    surface->setFormat(QSurfaceFormat::defaultFormat());
+    surface->create();
+    if (!surface->isValid()) {
+        delete surface;
+        return;
+    }
+
+    QThreadPool::globalInstance()->start(new QWaylandProgramBinaryPrewarmer(surface));
+}
+
+void QWaylandBufferMaterialShader::compile()
+{
+    const QByteArray key = programBinaryKey(m_format,
+                                            readShaderSource(bufferTypes[m_format].vertexShaderSourceFile),
+                                            readShaderSource(bufferTypes[m_format].fragmentShaderSourceFile));
+    if (GreenIsland::Platform::EglFSFunctions::loadProgramBinary(program(), key))
+        return;
+
+    QSGMaterialShader::compile();
+    GreenIsland::Platform::EglFSFunctions::saveProgramBinary(program(), key);
 }
 
 void QWaylandBufferMaterialShader::initialize()
@@ -217,6 +329,32 @@ void QWaylandBufferMaterial::setTextureForPlane(int plane, uint texture)
     }
 }
 
+#ifdef QT_WAYLAND_COMPOSITOR_GL
+/*
+ * Uploads the planes of a YUV shared memory buffer, textures are kept
+ * between buffers so only the damaged area needs to be uploaded unless
+ * the buffer size has changed.
+ */
+void QWaylandBufferMaterial::uploadSharedMemory(const QWaylandBufferRef &ref, const QRegion &damage)
+{
+    const bool reallocate = m_uploadedSize != ref.size();
+    if (!reallocate && damage.isEmpty())
+        return;
+
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+    const GLenum target = bufferTypes[m_format].textureTarget;
+
+    ensureTextures(bufferTypes[m_format].planeCount);
+
+    for (int plane = 0; plane < m_textures.size(); plane++) {
+        gl->glBindTexture(target, m_textures[plane]);
+        ref.bindPlaneToTexture(plane, reallocate ? QRegion() : damage);
+    }
+
+    m_uploadedSize = ref.size();
+}
+#endif
+
 void QWaylandBufferMaterial::bind()
 {
     QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
@@ -314,7 +452,7 @@ public:
 #ifdef QT_WAYLAND_COMPOSITOR_GL
                 buffer.bindToTexture();
 #endif
-                m_sgTex = surfaceItem->window()->createTextureFromId(texture , QSize(surfaceItem->width(), surfaceItem->height()), opt);
+                m_sgTex = surfaceItem->window()->createTextureFromId(texture , buffer.size(), opt);
             }
         }
         emit textureChanged();
@@ -789,8 +927,10 @@ void QWaylandQuickItem::handleSurfaceChanged()
         disconnect(d->oldSurface, &QWaylandSurface::parentChanged, this, &QWaylandQuickItem::parentChanged);
         disconnect(d->oldSurface, &QWaylandSurface::sizeChanged, this, &QWaylandQuickItem::updateSize);
         disconnect(d->oldSurface, &QWaylandSurface::bufferScaleChanged, this, &QWaylandQuickItem::updateSize);
+        disconnect(d->oldSurface, &QWaylandSurface::destinationSizeChanged, this, &QWaylandQuickItem::updateSize);
+        disconnect(d->oldSurface, &QWaylandSurface::sourceGeometryChanged, this, &QQuickItem::update);
         disconnect(d->oldSurface, &QWaylandSurface::configure, this, &QWaylandQuickItem::updateBuffer);
-        disconnect(d->oldSurface, &QWaylandSurface::redraw, this, &QQuickItem::update);
+        disconnect(d->redrawConnection);
         disconnect(d->oldSurface, &QWaylandSurface::childAdded, this, &QWaylandQuickItem::handleSubsurfaceAdded);
         disconnect(d->oldSurface, &QWaylandSurface::dragStarted, this, &QWaylandQuickItem::handleDragStarted);
 #ifndef QT_NO_IM
@@ -802,8 +942,13 @@ void QWaylandQuickItem::handleSurfaceChanged()
         connect(newSurface, &QWaylandSurface::parentChanged, this, &QWaylandQuickItem::parentChanged);
         connect(newSurface, &QWaylandSurface::sizeChanged, this, &QWaylandQuickItem::updateSize);
         connect(newSurface, &QWaylandSurface::bufferScaleChanged, this, &QWaylandQuickItem::updateSize);
+        connect(newSurface, &QWaylandSurface::destinationSizeChanged, this, &QWaylandQuickItem::updateSize);
+        connect(newSurface, &QWaylandSurface::sourceGeometryChanged, this, &QQuickItem::update);
         connect(newSurface, &QWaylandSurface::configure, this, &QWaylandQuickItem::updateBuffer);
-        connect(newSurface, &QWaylandSurface::redraw, this, &QQuickItem::update);
+        d->redrawConnection = connect(newSurface, &QWaylandSurface::redraw, this, [this, d] {
+            if (!d->redrawDeferred)
+                update();
+        });
         connect(newSurface, &QWaylandSurface::childAdded, this, &QWaylandQuickItem::handleSubsurfaceAdded);
         connect(newSurface, &QWaylandSurface::dragStarted, this, &QWaylandQuickItem::handleDragStarted);
 #ifndef QT_NO_IM
@@ -879,7 +1024,7 @@ void QWaylandQuickItem::updateSize()
 {
     Q_D(QWaylandQuickItem);
     if (d->sizeFollowsSurface && surface()) {
-        setSize(surface()->size() * (d->scaleFactor() / surface()->bufferScale()));
+        setSize(QSizeF(surface()->destinationSize()) * d->scaleFactor());
     }
 }
 
@@ -1067,6 +1212,26 @@ void QWaylandQuickItem::updateInputMethod(Qt::InputMethodQueries queries)
 }
 #endif
 
+/*
+ * Clients often use a single pixel buffer scaled up with wp_viewport
+ * for backgrounds and fills, those are drawn with a solid color instead
+ * of uploading a texture.
+ */
+static bool isSolidColorBuffer(const QWaylandBufferRef &ref)
+{
+    return ref.isSharedMemory() && ref.size() == QSize(1, 1)
+            && bufferTypes[ref.bufferFormatEgl()].canProvideTexture;
+}
+
+static QColor solidColorForBuffer(const QWaylandBufferRef &ref)
+{
+    QRgb pixel = ref.image().pixel(0, 0);
+    struct ::wl_shm_buffer *shmBuffer = wl_shm_buffer_get(ref.wl_buffer());
+    if (shmBuffer && wl_shm_buffer_get_format(shmBuffer) == WL_SHM_FORMAT_XRGB8888)
+        pixel |= 0xff000000;
+    return QColor::fromRgba(qUnpremultiply(pixel));
+}
+
 QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
     Q_D(QWaylandQuickItem);
@@ -1078,11 +1243,53 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
     }
 
     QWaylandBufferRef ref = d->view->currentBuffer();
+
+    QWaylandQuickItemPrivate::PaintNodeType paintNodeType = QWaylandQuickItemPrivate::MaterialPaintNode;
+    if (isSolidColorBuffer(ref))
+        paintNodeType = QWaylandQuickItemPrivate::SolidColorPaintNode;
+    else if (bufferTypes[ref.bufferFormatEgl()].canProvideTexture)
+        paintNodeType = QWaylandQuickItemPrivate::TexturePaintNode;
+
+    if (oldNode && paintNodeType != d->paintNodeType) {
+        delete oldNode;
+        oldNode = 0;
+    }
+    d->paintNodeType = paintNodeType;
+
+    if (paintNodeType == QWaylandQuickItemPrivate::SolidColorPaintNode) {
+        QSGSimpleRectNode *node = static_cast<QSGSimpleRectNode *>(oldNode);
+
+        if (!node) {
+            node = new QSGSimpleRectNode();
+            d->newTexture = true;
+        }
+
+        if (d->newTexture) {
+            d->newTexture = false;
+            node->setColor(solidColorForBuffer(ref));
+        }
+
+        node->setRect(QRectF(0, 0, width(), height()));
+
+        return node;
+    }
+
     const bool invertY = ref.origin() == QWaylandSurface::OriginBottomLeft;
     const QRectF rect = invertY ? QRectF(0, height(), width(), -height())
                                 : QRectF(0, 0, width(), height());
 
-    if (ref.isSharedMemory() || bufferTypes[ref.bufferFormatEgl()].canProvideTexture) {
+    // Crop the buffer to the source geometry, scaling to the destination
+    // size is done by drawing the source into the item rect
+    const QSizeF bufferSize = ref.size();
+    const QRectF sourceGeometry = surface()->sourceGeometry();
+    const int bufferScale = surface()->bufferScale();
+    QRectF source(sourceGeometry.topLeft() * bufferScale, sourceGeometry.size() * bufferScale);
+    if (source.isEmpty())
+        source = QRectF(QPointF(0, 0), bufferSize);
+    if (invertY)
+        source.moveTop(bufferSize.height() - source.bottom());
+
+    if (paintNodeType == QWaylandQuickItemPrivate::TexturePaintNode) {
         QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode *>(oldNode);
 
         if (!node) {
@@ -1101,10 +1308,13 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
 
         d->provider->setSmooth(smooth());
         node->setRect(rect);
+        node->setSourceRect(source);
 
         return node;
     } else {
-        Q_ASSERT(!d->provider);
+        // Release the buffer held since the item last used a texture node
+        if (d->provider)
+            d->provider->setBufferRef(this, QWaylandBufferRef());
 
         QSGGeometryNode *node = static_cast<QSGGeometryNode *>(oldNode);
 
@@ -1119,26 +1329,34 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
         if (!geometry)
             geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4);
 
-        if (!material)
+        if (!material || material->format() != ref.bufferFormatEgl()) {
             material = new QWaylandBufferMaterial(ref.bufferFormatEgl());
+            d->newTexture = true;
+        }
 
         if (d->newTexture) {
             d->newTexture = false;
 #ifdef QT_WAYLAND_COMPOSITOR_GL
-            for (int plane = 0; plane < bufferTypes[ref.bufferFormatEgl()].planeCount; plane++)
-                if (uint texture = ref.textureForPlane(plane))
-                    material->setTextureForPlane(plane, texture);
-#endif
+            if (ref.isSharedMemory()) {
+                material->uploadSharedMemory(ref, d->view->currentDamage());
+            } else {
+                for (int plane = 0; plane < bufferTypes[ref.bufferFormatEgl()].planeCount; plane++)
+                    if (uint texture = ref.textureForPlane(plane))
+                        material->setTextureForPlane(plane, texture);
+                material->bind();
+                ref.bindToTexture();
+            }
+#else
             material->bind();
-#ifdef QT_WAYLAND_COMPOSITOR_GL
-            ref.bindToTexture();
 #endif
         }
 
 #ifdef QT_WAYLAND_COMPOSITOR_GL
         ref.updateTexture();
 #endif
-        QSGGeometry::updateTexturedRectGeometry(geometry, rect, QRectF(0, 0, 1, 1));
+        const QRectF normalizedSource(source.x() / bufferSize.width(), source.y() / bufferSize.height(),
+                                      source.width() / bufferSize.width(), source.height() / bufferSize.height());
+        QSGGeometry::updateTexturedRectGeometry(geometry, rect, normalizedSource);
 
         node->setGeometry(geometry);
         node->setFlag(QSGNode::OwnsGeometry, true);
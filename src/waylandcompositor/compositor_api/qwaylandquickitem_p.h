@@ -69,7 +69,10 @@ public:
     void updateState(const RenderState &state, QSGMaterial *newEffect, QSGMaterial *oldEffect) Q_DECL_OVERRIDE;
     char const *const *attributeNames() const Q_DECL_OVERRIDE;
 
+    static void prewarmProgramBinaryCache();
+
 protected:
+    void compile() Q_DECL_OVERRIDE;
     void initialize() Q_DECL_OVERRIDE;
 
 private:
@@ -85,7 +88,12 @@ public:
     QWaylandBufferMaterial(QWaylandBufferRef::BufferFormatEgl format);
     ~QWaylandBufferMaterial();
 
+    QWaylandBufferRef::BufferFormatEgl format() const { return m_format; }
+
     void setTextureForPlane(int plane, uint texture);
+#ifdef QT_WAYLAND_COMPOSITOR_GL
+    void uploadSharedMemory(const QWaylandBufferRef &ref, const QRegion &damage);
+#endif
 
     void bind();
 
@@ -98,12 +106,20 @@ private:
 
     const QWaylandBufferRef::BufferFormatEgl m_format;
     QVarLengthArray<GLuint, 3> m_textures;
+    QSize m_uploadedSize;
 };
 
 class QWaylandQuickItemPrivate : public QQuickItemPrivate
 {
     Q_DECLARE_PUBLIC(QWaylandQuickItem)
 public:
+    enum PaintNodeType {
+        NoPaintNode,
+        TexturePaintNode,
+        MaterialPaintNode,
+        SolidColorPaintNode
+    };
+
     QWaylandQuickItemPrivate()
         : QQuickItemPrivate()
         , view(Q_NULLPTR)
@@ -114,8 +130,10 @@ public:
         , inputEventsEnabled(true)
         , isDragging(false)
         , newTexture(false)
+        , paintNodeType(NoPaintNode)
         , focusOnClick(true)
         , sizeFollowsSurface(true)
+        , redrawDeferred(false)
         , connectedWindow(Q_NULLPTR)
         , origin(QWaylandSurface::OriginTopLeft)
     {
@@ -154,6 +172,20 @@ public:
         inputEventsEnabled = enable;
     }
 
+    static QWaylandQuickItemPrivate *get(QWaylandQuickItem *item) { return item->d_func(); }
+
+    // Commits no longer repaint the item, whoever set this
+    // calls update() when it wants a frame
+    void setRedrawDeferred(bool deferred)
+    {
+        Q_Q(QWaylandQuickItem);
+        if (redrawDeferred == deferred)
+            return;
+        redrawDeferred = deferred;
+        if (!deferred)
+            q->update();
+    }
+
     bool shouldSendInputEvents() const { return view->surface() && inputEventsEnabled; }
     qreal scaleFactor() const;
 
@@ -167,8 +199,11 @@ public:
     bool inputEventsEnabled;
     bool isDragging;
     bool newTexture;
+    PaintNodeType paintNodeType;
     bool focusOnClick;
     bool sizeFollowsSurface;
+    bool redrawDeferred;
+    QMetaObject::Connection redrawConnection;
 
     QQuickWindow *connectedWindow;
     QWaylandSurface::Origin origin;
@@ -64,9 +64,14 @@ void QWaylandQuickOutput::initialize()
         qWarning("Initialization error: Could not locate QQuickWindow on initializing QWaylandQuickOutput %p.\n", this);
         return;
     }
+    // With the threaded render loop these are emitted by the render thread
+    // and queued, frame callbacks are prepared and sent by the GUI thread
+    // which owns the surface views and their primary outputs
     connect(quickWindow, &QQuickWindow::beforeSynchronizing,
-            this, &QWaylandQuickOutput::updateStarted,
+            this, [this] { m_updateScheduled = false; },
             Qt::DirectConnection);
+    connect(quickWindow, &QQuickWindow::beforeSynchronizing,
+            this, &QWaylandQuickOutput::updateStarted);
 
     connect(quickWindow, &QQuickWindow::beforeRendering,
             this, &QWaylandQuickOutput::doFrameCallbacks);
@@ -41,6 +41,9 @@
 #include "wayland_wrapper/qwldatadevice_p.h"
 #include "wayland_wrapper/qwldatadevicemanager_p.h"
 #include "wayland_wrapper/qwlregion_p.h"
+#include "wayland_wrapper/qwlframecallback_p.h"
+#include "wayland_wrapper/qwlobjectpool_p.h"
+#include "wayland_wrapper/qwlviewporter_p.h"
 
 #include "extensions/qwlextendedsurface_p.h"
 #include "qwaylandinputmethodcontrol_p.h"
@@ -49,6 +52,7 @@
 #include <GreenIsland/QtWaylandCompositor/QWaylandClient>
 #include <GreenIsland/QtWaylandCompositor/QWaylandView>
 #include <GreenIsland/QtWaylandCompositor/QWaylandBufferRef>
+#include <GreenIsland/QtWaylandCompositor/QWaylandOutput>
 
 #include <GreenIsland/QtWaylandCompositor/private/qwaylandcompositor_p.h>
 #include <GreenIsland/QtWaylandCompositor/private/qwaylandview_p.h>
@@ -59,56 +63,17 @@
 #include <QtGui/QGuiApplication>
 #include <QtGui/QScreen>
 
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QQuickWindow>
+
 #include <QtCore/QDebug>
+#include <QtCore/QVarLengthArray>
 
 QT_BEGIN_NAMESPACE
 
-namespace QtWayland {
-class FrameCallback {
-public:
-    FrameCallback(QWaylandSurface *surf, wl_resource *res)
-        : surface(surf)
-        , resource(res)
-        , canSend(false)
-    {
-#if WAYLAND_VERSION_MAJOR < 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR <= 2)
-        res->data = this;
-        res->destroy = destroyCallback;
-#else
-        wl_resource_set_implementation(res, 0, this, destroyCallback);
-#endif
-    }
-    ~FrameCallback()
-    {
-    }
-    void destroy()
-    {
-        if (resource)
-            wl_resource_destroy(resource);
-        else
-            delete this;
-    }
-    void send(uint time)
-    {
-        wl_callback_send_done(resource, time);
-        wl_resource_destroy(resource);
-    }
-    static void destroyCallback(wl_resource *res)
-    {
-#if WAYLAND_VERSION_MAJOR < 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR <= 2)
-        FrameCallback *_this = static_cast<FrameCallback *>(res->data);
-#else
-        FrameCallback *_this = static_cast<FrameCallback *>(wl_resource_get_user_data(res));
-#endif
-        if (_this->surface)
-            QWaylandSurfacePrivate::get(_this->surface)->removeFrameCallback(_this);
-        delete _this;
-    }
-    QWaylandSurface *surface;
-    wl_resource *resource;
-    bool canSend;
-};
-}
+// Rate at which hidden, minimized and off-screen surfaces receive frame callbacks
+static const int hiddenFrameCallbackRate = 1;
+
 static QRegion infiniteRegion() {
     return QRegion(QRect(QPoint(std::numeric_limits<int>::min(), std::numeric_limits<int>::min()),
                          QPoint(std::numeric_limits<int>::max(), std::numeric_limits<int>::max())));
@@ -127,18 +92,30 @@ QWaylandSurfacePrivate::QWaylandSurfacePrivate()
     , role(0)
     , inputRegion(infiniteRegion())
     , bufferScale(1)
+    , bufferTransform(WL_OUTPUT_TRANSFORM_NORMAL)
     , isCursorSurface(false)
     , destroyed(false)
     , mapped(false)
     , isInitialized(false)
     , contentOrientation(Qt::PrimaryOrientation)
+    , visibility(QWindow::Windowed)
     , inputMethodControl(Q_NULLPTR)
+    , viewport(Q_NULLPTR)
+    , offscreen(false)
+    , maxFrameCallbackRate(0)
+    , lastFrameCallbackTime(0)
+    , frameCallbackCountStart(0)
+    , frameCallbackCount(0)
+    , frameCallbackRate(0)
     , subsurface(0)
 {
     pending.buffer = 0;
     pending.newlyAttached = false;
     pending.inputRegion = infiniteRegion();
     pending.bufferScale = 1;
+    pending.bufferTransform = WL_OUTPUT_TRANSFORM_NORMAL;
+    wl_list_init(&pendingFrameCallbacks);
+    wl_list_init(&frameCallbacks);
 #ifndef QT_NO_DEBUG
     addUninitializedSurface(this);
 #endif
@@ -151,14 +128,18 @@ QWaylandSurfacePrivate::~QWaylandSurfacePrivate()
     }
     views.clear();
 
+    if (viewport)
+        viewport->detachSurface();
+
     bufferRef = QWaylandBufferRef();
 
     for (int i = 0; i < bufferPool.size(); i++)
         bufferPool[i]->setDestroyIfUnused(true);
 
-    foreach (QtWayland::FrameCallback *c, pendingFrameCallbacks)
+    QtWayland::FrameCallback *c, *tmp;
+    wl_list_for_each_safe(c, tmp, &pendingFrameCallbacks, link)
         c->destroy();
-    foreach (QtWayland::FrameCallback *c, frameCallbacks)
+    wl_list_for_each_safe(c, tmp, &frameCallbacks, link)
         c->destroy();
 }
 
@@ -181,10 +162,166 @@ void QWaylandSurfacePrivate::setBufferScale(int scale)
     emit q->bufferScaleChanged();
 }
 
-void QWaylandSurfacePrivate::removeFrameCallback(QtWayland::FrameCallback *callback)
+/*
+ * Applies the committed crop and scale state. Both the source geometry
+ * and the destination size are in surface coordinates, when the client
+ * doesn't use wp_viewport they cover the whole buffer.
+ */
+void QWaylandSurfacePrivate::updateViewport()
+{
+    Q_Q(QWaylandSurface);
+
+    const int scale = qMax(1, bufferScale);
+    QSize bufferSize = size;
+    if (bufferTransform & WL_OUTPUT_TRANSFORM_90)
+        bufferSize.transpose();
+
+    QRectF newSourceGeometry(QPointF(0, 0), QSizeF(bufferSize) / scale);
+    QSize newDestinationSize = bufferSize / scale;
+
+    if (viewport && !bufferSize.isEmpty()) {
+        if (pending.sourceGeometry.isValid()) {
+            if (!newSourceGeometry.contains(pending.sourceGeometry)) {
+                wl_resource_post_error(viewport->resource()->handle,
+                                       QtWaylandServer::wp_viewport::error_out_of_buffer,
+                                       "source rectangle extends outside of the content area");
+                return;
+            }
+
+            newSourceGeometry = pending.sourceGeometry;
+
+            if (!pending.destinationSize.isValid()) {
+                newDestinationSize = newSourceGeometry.size().toSize();
+                if (QSizeF(newDestinationSize) != newSourceGeometry.size()) {
+                    wl_resource_post_error(viewport->resource()->handle,
+                                           QtWaylandServer::wp_viewport::error_bad_size,
+                                           "source size is not integer and destination size is not set");
+                    return;
+                }
+            }
+        }
+
+        if (pending.destinationSize.isValid())
+            newDestinationSize = pending.destinationSize;
+    }
+
+    if (sourceGeometry != newSourceGeometry) {
+        sourceGeometry = newSourceGeometry;
+        emit q->sourceGeometryChanged();
+    }
+
+    if (destinationSize != newDestinationSize) {
+        destinationSize = newDestinationSize;
+        emit q->destinationSizeChanged();
+    }
+}
+
+static qreal visibleAreaForView(QWaylandView *view, const QSize &surfaceSize)
 {
-    pendingFrameCallbacks.removeOne(callback);
-    frameCallbacks.removeOne(callback);
+    QQuickItem *item = qobject_cast<QQuickItem *>(view->renderObject());
+    if (!item) {
+        // Views not backed by an item are assumed to be fully visible
+        return qMax(1, surfaceSize.width() * surfaceSize.height());
+    }
+
+    if (!item->window() || !item->isVisible() || qFuzzyIsNull(item->opacity()))
+        return 0;
+
+    const QRectF sceneRect = item->mapRectToScene(QRectF(0, 0, item->width(), item->height()));
+    const QRectF visibleRect = sceneRect.intersected(QRectF(QPointF(0, 0), item->window()->size()));
+    return visibleRect.width() * visibleRect.height();
+}
+
+/*
+ * The primary output is the output where the surface has the largest
+ * visible area, its frame callbacks are driven only by that output.
+ * When no view is visible the surface is off-screen and we fall back
+ * to the output of the throttling view.
+ */
+void QWaylandSurfacePrivate::updatePrimaryOutput()
+{
+    Q_Q(QWaylandSurface);
+
+    QVarLengthArray<QPair<QWaylandOutput *, qreal>, 4> areas;
+    for (int i = 0; i < views.size(); i++) {
+        QWaylandView *view = views.at(i);
+        if (!view->output())
+            continue;
+
+        const qreal area = visibleAreaForView(view, size);
+        int j = 0;
+        for (; j < areas.size(); j++) {
+            if (areas.at(j).first == view->output()) {
+                areas[j].second += area;
+                break;
+            }
+        }
+        if (j == areas.size())
+            areas.append(qMakePair(view->output(), area));
+    }
+
+    QWaylandOutput *newPrimaryOutput = Q_NULLPTR;
+    qreal largestArea = 0;
+    for (int i = 0; i < areas.size(); i++) {
+        if (areas.at(i).second > largestArea) {
+            newPrimaryOutput = areas.at(i).first;
+            largestArea = areas.at(i).second;
+        }
+    }
+
+    offscreen = !newPrimaryOutput;
+    if (offscreen) {
+        QWaylandView *view = q->throttlingView();
+        newPrimaryOutput = view ? view->output() : Q_NULLPTR;
+    }
+
+    if (primaryOutput != newPrimaryOutput) {
+        primaryOutput = newPrimaryOutput;
+        emit q->primaryOutputChanged();
+    }
+}
+
+int QWaylandSurfacePrivate::effectiveFrameCallbackRate() const
+{
+    if (offscreen || visibility == QWindow::Hidden || visibility == QWindow::Minimized) {
+        if (maxFrameCallbackRate > 0)
+            return qMin(maxFrameCallbackRate, hiddenFrameCallbackRate);
+        return hiddenFrameCallbackRate;
+    }
+
+    return maxFrameCallbackRate;
+}
+
+bool QWaylandSurfacePrivate::isFrameCallbackThrottled(uint time) const
+{
+    const int rate = effectiveFrameCallbackRate();
+    if (rate <= 0 || lastFrameCallbackTime == 0)
+        return false;
+    return time - lastFrameCallbackTime < uint(1000 / rate);
+}
+
+void QWaylandSurfacePrivate::updateFrameCallbackRate(uint time, int sent)
+{
+    Q_Q(QWaylandSurface);
+
+    if (sent > 0) {
+        lastFrameCallbackTime = time;
+        frameCallbackCount += sent;
+    }
+
+    const uint elapsed = time - frameCallbackCountStart;
+    if (elapsed < 1000)
+        return;
+
+    const int rate = frameCallbackCountStart == 0 ? frameCallbackCount
+                                                  : int(frameCallbackCount * 1000 / elapsed);
+    frameCallbackCountStart = time;
+    frameCallbackCount = 0;
+
+    if (frameCallbackRate != rate) {
+        frameCallbackRate = rate;
+        emit q->frameCallbackRateChanged();
+    }
 }
 
 void QWaylandSurfacePrivate::notifyViewsAboutDestruction()
@@ -225,6 +362,11 @@ void QWaylandSurfacePrivate::surface_destroy_resource(Resource *)
     Q_Q(QWaylandSurface);
     notifyViewsAboutDestruction();
 
+    if (viewport) {
+        viewport->detachSurface();
+        viewport = Q_NULLPTR;
+    }
+
     destroyed = true;
     emit q->surfaceDestroyed();
     q->destroy();
@@ -246,14 +388,20 @@ void QWaylandSurfacePrivate::surface_attach(Resource *, struct wl_resource *buff
 
 void QWaylandSurfacePrivate::surface_damage(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    pending.damage = pending.damage.united(QRect(x, y, width, height));
+    pending.damage.add(QRect(x, y, width, height));
+}
+
+void QWaylandSurfacePrivate::surface_damage_buffer(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    pending.bufferDamage.add(QRect(x, y, width, height));
 }
 
 void QWaylandSurfacePrivate::surface_frame(Resource *resource, uint32_t callback)
 {
     Q_Q(QWaylandSurface);
     struct wl_resource *frame_callback = wl_resource_create(resource->client(), &wl_callback_interface, wl_callback_interface.version, callback);
-    pendingFrameCallbacks << new QtWayland::FrameCallback(q, frame_callback);
+    QtWayland::FrameCallback *c = QtWayland::FrameCallback::create(q, frame_callback);
+    wl_list_insert(pendingFrameCallbacks.prev, &c->link);
 }
 
 void QWaylandSurfacePrivate::surface_set_opaque_region(Resource *, struct wl_resource *region)
@@ -275,23 +423,26 @@ void QWaylandSurfacePrivate::surface_commit(Resource *)
     Q_Q(QWaylandSurface);
 
     if (pending.buffer || pending.newlyAttached) {
-        setBackBuffer(pending.buffer, pending.damage);
+        setBackBuffer(pending.buffer, pendingBufferDamage());
     }
 
     pending.buffer = 0;
     pending.offset = QPoint();
     pending.newlyAttached = false;
-    pending.damage = QRegion();
+    pending.damage.clear();
+    pending.bufferDamage.clear();
 
     setBufferScale(pending.bufferScale);
+    bufferTransform = pending.bufferTransform;
+    updateViewport();
 
     if (buffer)
         buffer->setCommitted();
 
-    frameCallbacks << pendingFrameCallbacks;
-    pendingFrameCallbacks.clear();
+    wl_list_insert_list(frameCallbacks.prev, &pendingFrameCallbacks);
+    wl_list_init(&pendingFrameCallbacks);
 
-    inputRegion = pending.inputRegion.intersected(QRect(QPoint(), size));
+    inputRegion = pending.inputRegion.intersected(QRect(QPoint(), destinationSize));
 
     emit q->redraw();
 }
@@ -300,6 +451,7 @@ void QWaylandSurfacePrivate::surface_set_buffer_transform(Resource *resource, in
 {
     Q_UNUSED(resource);
     Q_Q(QWaylandSurface);
+    pending.bufferTransform = orientation;
     QScreen *screen = QGuiApplication::primaryScreen();
     bool isPortrait = screen->primaryOrientation() == Qt::PortraitOrientation;
     Qt::ScreenOrientation oldOrientation = contentOrientation;
@@ -351,6 +503,105 @@ void QWaylandSurfacePrivate::setBackBuffer(QtWayland::SurfaceBuffer *b, const QR
         emit q->offsetForNextFrame(pending.offset);
 }
 
+static QPoint surfaceToBufferPoint(int x, int y, int width, int height, int transform, int scale)
+{
+    QPoint point;
+
+    switch (transform) {
+    case WL_OUTPUT_TRANSFORM_FLIPPED:
+        point = QPoint(width - x, y);
+        break;
+    case WL_OUTPUT_TRANSFORM_90:
+        point = QPoint(height - y, x);
+        break;
+    case WL_OUTPUT_TRANSFORM_FLIPPED_90:
+        point = QPoint(height - y, width - x);
+        break;
+    case WL_OUTPUT_TRANSFORM_180:
+        point = QPoint(width - x, height - y);
+        break;
+    case WL_OUTPUT_TRANSFORM_FLIPPED_180:
+        point = QPoint(x, height - y);
+        break;
+    case WL_OUTPUT_TRANSFORM_270:
+        point = QPoint(y, width - x);
+        break;
+    case WL_OUTPUT_TRANSFORM_FLIPPED_270:
+        point = QPoint(y, x);
+        break;
+    default:
+        point = QPoint(x, y);
+        break;
+    }
+
+    return point * scale;
+}
+
+/*
+ * Maps \a rect from surface coordinates to buffer coordinates, where
+ * \a surfaceSize is the size of the surface in surface coordinates.
+ */
+static QRect surfaceToBufferRect(const QRect &rect, const QSize &surfaceSize, int transform, int scale)
+{
+    const QPoint p1 = surfaceToBufferPoint(rect.x(), rect.y(),
+                                           surfaceSize.width(), surfaceSize.height(),
+                                           transform, scale);
+    const QPoint p2 = surfaceToBufferPoint(rect.x() + rect.width(), rect.y() + rect.height(),
+                                           surfaceSize.width(), surfaceSize.height(),
+                                           transform, scale);
+
+    return QRect(QPoint(qMin(p1.x(), p2.x()), qMin(p1.y(), p2.y())),
+                 QSize(qAbs(p2.x() - p1.x()), qAbs(p2.y() - p1.y())));
+}
+
+/*
+ * Returns the damage accumulated since the last commit in buffer coordinates,
+ * wl_surface.damage is in surface coordinates and is mapped with the pending
+ * buffer scale and transform while wl_surface.damage_buffer is used as is.
+ */
+QRegion QWaylandSurfacePrivate::pendingBufferDamage() const
+{
+    if (pending.damage.isEmpty())
+        return pending.bufferDamage.region();
+
+    const int scale = qMax(1, pending.bufferScale);
+    const bool cropped = viewport && (pending.sourceGeometry.isValid() || pending.destinationSize.isValid());
+    const bool identity = !cropped && scale == 1 && pending.bufferTransform == WL_OUTPUT_TRANSFORM_NORMAL;
+    if (identity && pending.bufferDamage.isEmpty())
+        return pending.damage.region();
+
+    QtWayland::DamageAccumulator damage = pending.bufferDamage;
+    if (identity) {
+        foreach (const QRect &rect, pending.damage.rects())
+            damage.add(rect);
+        return damage.region();
+    }
+
+    QSize bufferSize = pending.buffer ? pending.buffer->size() : size;
+    if (pending.bufferTransform & WL_OUTPUT_TRANSFORM_90)
+        bufferSize.transpose();
+    const QSize surfaceSize = bufferSize / scale;
+
+    // With a viewport the damage is relative to the destination size
+    // and has to be mapped back to the source rectangle first
+    const QRectF source = pending.sourceGeometry.isValid() ? pending.sourceGeometry
+                                                           : QRectF(QPointF(0, 0), surfaceSize);
+    const QSizeF destination = pending.destinationSize.isValid() ? QSizeF(pending.destinationSize)
+                                                                 : source.size();
+    const qreal sx = source.width() / destination.width();
+    const qreal sy = source.height() / destination.height();
+
+    foreach (const QRect &rect, pending.damage.rects()) {
+        QRect r = rect;
+        if (cropped) {
+            r = QRectF(source.x() + rect.x() * sx, source.y() + rect.y() * sy,
+                       rect.width() * sx, rect.height() * sy).toAlignedRect();
+        }
+        damage.add(surfaceToBufferRect(r, surfaceSize, pending.bufferTransform, scale));
+    }
+    return damage.region();
+}
+
 QtWayland::SurfaceBuffer *QWaylandSurfacePrivate::createSurfaceBuffer(struct ::wl_resource *buffer)
 {
     Q_Q(QWaylandSurface);
@@ -364,7 +615,8 @@ QtWayland::SurfaceBuffer *QWaylandSurfacePrivate::createSurfaceBuffer(struct ::w
     }
 
     if (!newBuffer) {
-        newBuffer = new QtWayland::SurfaceBuffer(q);
+        QtWayland::ObjectPool *pool = QWaylandCompositorPrivate::get(compositor)->surfaceBufferPool;
+        newBuffer = pool->create<QtWayland::SurfaceBuffer>(q);
         newBuffer->initialize(buffer);
         bufferPool.append(newBuffer);
         if (bufferPool.size() > 3)
@@ -538,6 +790,48 @@ int QWaylandSurface::bufferScale() const
     return d->bufferScale;
 }
 
+/*!
+ * \qmlproperty rect QtWaylandCompositor::WaylandSurface::sourceGeometry
+ *
+ * This property holds the part of the buffer, in surface coordinates, that
+ * is shown by the WaylandSurface. Clients can crop the buffer with the
+ * wp_viewport interface, otherwise this covers the whole buffer.
+ */
+
+/*!
+ * \property QWaylandSurface::sourceGeometry
+ *
+ * This property holds the part of the buffer, in surface coordinates, that
+ * is shown by the QWaylandSurface. Clients can crop the buffer with the
+ * wp_viewport interface, otherwise this covers the whole buffer.
+ */
+QRectF QWaylandSurface::sourceGeometry() const
+{
+    Q_D(const QWaylandSurface);
+    return d->sourceGeometry;
+}
+
+/*!
+ * \qmlproperty size QtWaylandCompositor::WaylandSurface::destinationSize
+ *
+ * This property holds the size of the WaylandSurface in surface coordinates.
+ * The source geometry is scaled to this size, clients can change it with
+ * the wp_viewport interface.
+ */
+
+/*!
+ * \property QWaylandSurface::destinationSize
+ *
+ * This property holds the size of the QWaylandSurface in surface coordinates.
+ * The source geometry is scaled to this size, clients can change it with
+ * the wp_viewport interface.
+ */
+QSize QWaylandSurface::destinationSize() const
+{
+    Q_D(const QWaylandSurface);
+    return d->destinationSize;
+}
+
 /*!
  * \qmlproperty enum QtWaylandCompositor::WaylandSurface::contentOrientation
  *
@@ -608,7 +902,8 @@ QWaylandCompositor *QWaylandSurface::compositor() const
 void QWaylandSurface::frameStarted()
 {
     Q_D(QWaylandSurface);
-    foreach (QtWayland::FrameCallback *c, d->frameCallbacks)
+    QtWayland::FrameCallback *c;
+    wl_list_for_each(c, &d->frameCallbacks, link)
         c->canSend = true;
 }
 
@@ -619,16 +914,122 @@ void QWaylandSurface::sendFrameCallbacks()
 {
     Q_D(QWaylandSurface);
     uint time = d->compositor->currentTimeMsecs();
-    int i = 0;
-    while (i < d->frameCallbacks.size()) {
-        if (d->frameCallbacks.at(i)->canSend) {
-            d->frameCallbacks.at(i)->surface = Q_NULLPTR;
-            d->frameCallbacks.at(i)->send(time);
-            d->frameCallbacks.removeAt(i);
-        } else {
-            i++;
+    if (d->isFrameCallbackThrottled(time)) {
+        d->updateFrameCallbackRate(time, 0);
+        return;
+    }
+
+    int sent = 0;
+    QtWayland::FrameCallback *c, *tmp;
+    wl_list_for_each_safe(c, tmp, &d->frameCallbacks, link) {
+        if (c->canSend) {
+            c->send(time);
+            sent++;
         }
     }
+
+    d->updateFrameCallbackRate(time, sent);
+}
+
+/*!
+ * \qmlproperty enum QtWaylandCompositor::WaylandSurface::visibility
+ *
+ * This property holds the visibility of the WaylandSurface as decided by
+ * the shell. Hidden and minimized surfaces receive frame callbacks at a
+ * reduced rate.
+ */
+
+/*!
+ * \property QWaylandSurface::visibility
+ *
+ * This property holds the visibility of the QWaylandSurface as decided by
+ * the shell. Hidden and minimized surfaces receive frame callbacks at a
+ * reduced rate.
+ */
+QWindow::Visibility QWaylandSurface::visibility() const
+{
+    Q_D(const QWaylandSurface);
+    return d->visibility;
+}
+
+void QWaylandSurface::setVisibility(QWindow::Visibility visibility)
+{
+    Q_D(QWaylandSurface);
+    if (d->visibility == visibility)
+        return;
+    d->visibility = visibility;
+    emit visibilityChanged();
+}
+
+/*!
+ * \qmlproperty object QtWaylandCompositor::WaylandSurface::primaryOutput
+ *
+ * This property holds the output where the WaylandSurface has the largest
+ * visible area. Frame callbacks are sent when this output renders.
+ */
+
+/*!
+ * \property QWaylandSurface::primaryOutput
+ *
+ * This property holds the output where the QWaylandSurface has the largest
+ * visible area. Frame callbacks are sent when this output renders.
+ */
+QWaylandOutput *QWaylandSurface::primaryOutput() const
+{
+    Q_D(const QWaylandSurface);
+    return d->primaryOutput.data();
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::WaylandSurface::maxFrameCallbackRate
+ *
+ * This property holds the maximum number of frame callbacks per second
+ * sent to the WaylandSurface, or 0 for no limit.
+ *
+ * The default is 0.
+ */
+
+/*!
+ * \property QWaylandSurface::maxFrameCallbackRate
+ *
+ * This property holds the maximum number of frame callbacks per second
+ * sent to the QWaylandSurface, or 0 for no limit.
+ *
+ * The default is 0.
+ */
+int QWaylandSurface::maxFrameCallbackRate() const
+{
+    Q_D(const QWaylandSurface);
+    return d->maxFrameCallbackRate;
+}
+
+void QWaylandSurface::setMaxFrameCallbackRate(int rate)
+{
+    Q_D(QWaylandSurface);
+    rate = qMax(0, rate);
+    if (d->maxFrameCallbackRate == rate)
+        return;
+    d->maxFrameCallbackRate = rate;
+    emit maxFrameCallbackRateChanged();
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::WaylandSurface::frameCallbackRate
+ *
+ * This property holds the number of frame callbacks sent to the
+ * WaylandSurface during the last second.
+ */
+
+/*!
+ * \property QWaylandSurface::frameCallbackRate
+ *
+ * This property holds the number of frame callbacks sent to the
+ * QWaylandSurface during the last second.
+ */
+int QWaylandSurface::frameCallbackRate() const
+{
+    Q_D(const QWaylandSurface);
+    return d->frameCallbackRate;
 }
 
 /*!
@@ -61,6 +61,7 @@ class QWaylandView;
 class QWaylandSurfaceOp;
 class QWaylandInputMethodControl;
 class QWaylandDrag;
+class QWaylandOutput;
 
 class QWaylandSurfaceRole
 {
@@ -80,10 +81,16 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandSurface : public QWaylandObject
     Q_PROPERTY(QWaylandClient *client READ client CONSTANT)
     Q_PROPERTY(QSize size READ size NOTIFY sizeChanged)
     Q_PROPERTY(int bufferScale READ bufferScale NOTIFY bufferScaleChanged)
+    Q_PROPERTY(QRectF sourceGeometry READ sourceGeometry NOTIFY sourceGeometryChanged)
+    Q_PROPERTY(QSize destinationSize READ destinationSize NOTIFY destinationSizeChanged)
     Q_PROPERTY(Qt::ScreenOrientation contentOrientation READ contentOrientation NOTIFY contentOrientationChanged)
     Q_PROPERTY(QWaylandSurface::Origin origin READ origin NOTIFY originChanged)
     Q_PROPERTY(bool isMapped READ isMapped NOTIFY mappedChanged)
     Q_PROPERTY(bool cursorSurface READ isCursorSurface WRITE markAsCursorSurface)
+    Q_PROPERTY(QWindow::Visibility visibility READ visibility WRITE setVisibility NOTIFY visibilityChanged)
+    Q_PROPERTY(QWaylandOutput *primaryOutput READ primaryOutput NOTIFY primaryOutputChanged)
+    Q_PROPERTY(int maxFrameCallbackRate READ maxFrameCallbackRate WRITE setMaxFrameCallbackRate NOTIFY maxFrameCallbackRateChanged)
+    Q_PROPERTY(int frameCallbackRate READ frameCallbackRate NOTIFY frameCallbackRateChanged)
 
 public:
     enum Origin {
@@ -110,6 +117,9 @@ public:
     QSize size() const;
     int bufferScale() const;
 
+    QRectF sourceGeometry() const;
+    QSize destinationSize() const;
+
     Qt::ScreenOrientation contentOrientation() const;
 
     Origin origin() const;
@@ -124,6 +134,16 @@ public:
     Q_INVOKABLE void frameStarted();
     Q_INVOKABLE void sendFrameCallbacks();
 
+    QWindow::Visibility visibility() const;
+    void setVisibility(QWindow::Visibility visibility);
+
+    QWaylandOutput *primaryOutput() const;
+
+    int maxFrameCallbackRate() const;
+    void setMaxFrameCallbackRate(int rate);
+
+    int frameCallbackRate() const;
+
     QWaylandView *throttlingView() const;
     void setThrottlingView(QWaylandView *view);
 
@@ -150,6 +170,8 @@ Q_SIGNALS:
     void childAdded(QWaylandSurface *child);
     void sizeChanged();
     void bufferScaleChanged();
+    void sourceGeometryChanged();
+    void destinationSizeChanged();
     void offsetForNextFrame(const QPoint &offset);
     void contentOrientationChanged();
     void surfaceDestroyed();
@@ -158,6 +180,10 @@ Q_SIGNALS:
     void subsurfacePlaceAbove(QWaylandSurface *sibling);
     void subsurfacePlaceBelow(QWaylandSurface *sibling);
     void dragStarted(QWaylandDrag *drag);
+    void visibilityChanged();
+    void primaryOutputChanged();
+    void maxFrameCallbackRateChanged();
+    void frameCallbackRateChanged();
 
     void configure(bool hasBuffer);
     void redraw();
@@ -55,11 +55,14 @@
 #include <private/qwlsurfacebuffer_p.h>
 #include <GreenIsland/QtWaylandCompositor/qwaylandsurface.h>
 #include <GreenIsland/QtWaylandCompositor/qwaylandbufferref.h>
+#include <GreenIsland/QtWaylandCompositor/qwaylandoutput.h>
 
 #include <GreenIsland/QtWaylandCompositor/private/qwlregion_p.h>
+#include <GreenIsland/QtWaylandCompositor/private/qwldamageaccumulator_p.h>
 
 #include <QtCore/QVector>
 #include <QtCore/QRect>
+#include <QtCore/QPointer>
 #include <QtGui/QRegion>
 #include <QtGui/QImage>
 #include <QtGui/QWindow>
@@ -81,6 +84,7 @@ class QWaylandInputMethodControl;
 
 namespace QtWayland {
 class FrameCallback;
+class Viewport;
 }
 
 class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandSurfacePrivate : public QObjectPrivate, public QtWaylandServer::wl_surface
@@ -101,8 +105,12 @@ public:
 
     void setSize(const QSize &size);
     void setBufferScale(int bufferScale);
+    void updateViewport();
 
-    void removeFrameCallback(QtWayland::FrameCallback *callback);
+    void updatePrimaryOutput();
+    int effectiveFrameCallbackRate() const;
+    bool isFrameCallbackThrottled(uint time) const;
+    void updateFrameCallbackRate(uint time, int sent);
 
     void notifyViewsAboutDestruction();
 
@@ -124,6 +132,8 @@ protected:
                         struct wl_resource *buffer, int x, int y) Q_DECL_OVERRIDE;
     void surface_damage(Resource *resource,
                         int32_t x, int32_t y, int32_t width, int32_t height) Q_DECL_OVERRIDE;
+    void surface_damage_buffer(Resource *resource,
+                               int32_t x, int32_t y, int32_t width, int32_t height) Q_DECL_OVERRIDE;
     void surface_frame(Resource *resource,
                        uint32_t callback) Q_DECL_OVERRIDE;
     void surface_set_opaque_region(Resource *resource,
@@ -136,6 +146,7 @@ protected:
 
     void setBackBuffer(QtWayland::SurfaceBuffer *buffer, const QRegion &damage);
     QtWayland::SurfaceBuffer *createSurfaceBuffer(struct ::wl_resource *buffer);
+    QRegion pendingBufferDamage() const;
 
 public: //member variables
     QWaylandCompositor *compositor;
@@ -149,18 +160,22 @@ public: //member variables
 
     struct {
         QtWayland::SurfaceBuffer *buffer;
-        QRegion damage;
+        QtWayland::DamageAccumulator damage;
+        QtWayland::DamageAccumulator bufferDamage;
         QPoint offset;
         bool newlyAttached;
         QRegion inputRegion;
         int bufferScale;
+        int bufferTransform;
+        QRectF sourceGeometry;
+        QSize destinationSize;
     } pending;
 
     QPoint lastLocalMousePos;
     QPoint lastGlobalMousePos;
 
-    QList<QtWayland::FrameCallback *> pendingFrameCallbacks;
-    QList<QtWayland::FrameCallback *> frameCallbacks;
+    struct wl_list pendingFrameCallbacks;
+    struct wl_list frameCallbacks;
 
     QRegion inputRegion;
     QRegion opaqueRegion;
@@ -168,7 +183,10 @@ public: //member variables
     QVector<QtWayland::SurfaceBuffer *> bufferPool;
 
     QSize size;
+    QRectF sourceGeometry;
+    QSize destinationSize;
     int bufferScale;
+    int bufferTransform;
     bool isCursorSurface;
     bool destroyed;
     bool mapped;
@@ -176,6 +194,15 @@ public: //member variables
     Qt::ScreenOrientation contentOrientation;
     QWindow::Visibility visibility;
     QWaylandInputMethodControl *inputMethodControl;
+    QtWayland::Viewport *viewport;
+
+    QPointer<QWaylandOutput> primaryOutput;
+    bool offscreen;
+    int maxFrameCallbackRate;
+    uint lastFrameCallbackTime;
+    uint frameCallbackCountStart;
+    int frameCallbackCount;
+    int frameCallbackRate;
 
     class Subsurface : public QtWaylandServer::wl_subsurface
     {
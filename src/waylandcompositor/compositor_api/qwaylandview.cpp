@@ -204,8 +204,13 @@ void QWaylandView::attach(const QWaylandBufferRef &ref, const QRegion &damage)
 {
     Q_D(QWaylandView);
     QMutexLocker locker(&d->bufferMutex);
+    // Damage of buffers replaced before they became current is kept,
+    // renderers updating textures partially need all of it
+    if (d->nextBuffer != d->currentBuffer)
+        d->nextDamage += damage;
+    else
+        d->nextDamage = damage;
     d->nextBuffer = ref;
-    d->nextDamage = damage;
 }
 
 /*!
@@ -63,7 +63,7 @@ void QWaylandQtWindowManagerPrivate::windowmanager_destroy_resource(Resource *re
     urls.remove(resource);
 }
 
-void QWaylandQtWindowManagerPrivate::windowmanager_open_url(Resource *resource, uint32_t remaining, const QString &newUrl)
+void QWaylandQtWindowManagerPrivate::windowmanager_open_url(Resource *resource, uint32_t remaining, const char *newUrl)
 {
     Q_Q(QWaylandQtWindowManager);
 
@@ -75,7 +75,7 @@ void QWaylandQtWindowManagerPrivate::windowmanager_open_url(Resource *resource,
 
     QString url = urls.value(resource, QString());
 
-    url.append(newUrl);
+    url.append(QString::fromUtf8(newUrl));
 
     if (remaining)
         urls.insert(resource, url);
@@ -68,7 +68,7 @@ public:
 protected:
     void windowmanager_bind_resource(Resource *resource) Q_DECL_OVERRIDE;
     void windowmanager_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
-    void windowmanager_open_url(Resource *resource, uint32_t remaining, const QString &url) Q_DECL_OVERRIDE;
+    void windowmanager_open_url(Resource *resource, uint32_t remaining, const char *url) Q_DECL_OVERRIDE;
 
 private:
     bool showIsFullScreen;
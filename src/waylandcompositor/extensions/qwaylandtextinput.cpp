@@ -484,24 +484,24 @@ void QWaylandTextInputPrivate::zwp_text_input_v2_set_content_type(Resource *reso
     pendingState->changedState |= Qt::ImHints;
 }
 
-void QWaylandTextInputPrivate::zwp_text_input_v2_set_preferred_language(Resource *resource, const QString &language)
+void QWaylandTextInputPrivate::zwp_text_input_v2_set_preferred_language(Resource *resource, const char *language)
 {
     if (resource != focusResource)
         return;
 
-    pendingState->preferredLanguage = language;
+    pendingState->preferredLanguage = QString::fromUtf8(language);
 
     pendingState->changedState |= Qt::ImPreferredLanguage;
 }
 
-void QWaylandTextInputPrivate::zwp_text_input_v2_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor)
+void QWaylandTextInputPrivate::zwp_text_input_v2_set_surrounding_text(Resource *resource, const char *text, int32_t cursor, int32_t anchor)
 {
     if (resource != focusResource)
         return;
 
-    pendingState->surroundingText = text;
-    pendingState->cursorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(text, cursor);
-    pendingState->anchorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(text, anchor);
+    pendingState->surroundingText = QString::fromUtf8(text);
+    pendingState->cursorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(pendingState->surroundingText, cursor);
+    pendingState->anchorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(pendingState->surroundingText, anchor);
 
     pendingState->changedState |= Qt::ImSurroundingText | Qt::ImCursorPosition | Qt::ImAnchorPosition;
 }
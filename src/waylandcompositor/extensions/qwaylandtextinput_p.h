@@ -123,10 +123,10 @@ protected:
     void zwp_text_input_v2_disable(Resource *resource, wl_resource *surface) Q_DECL_OVERRIDE;
     void zwp_text_input_v2_show_input_panel(Resource *resource) Q_DECL_OVERRIDE;
     void zwp_text_input_v2_hide_input_panel(Resource *resource) Q_DECL_OVERRIDE;
-    void zwp_text_input_v2_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor) Q_DECL_OVERRIDE;
+    void zwp_text_input_v2_set_surrounding_text(Resource *resource, const char *text, int32_t cursor, int32_t anchor) Q_DECL_OVERRIDE;
     void zwp_text_input_v2_set_content_type(Resource *resource, uint32_t hint, uint32_t purpose) Q_DECL_OVERRIDE;
     void zwp_text_input_v2_set_cursor_rectangle(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) Q_DECL_OVERRIDE;
-    void zwp_text_input_v2_set_preferred_language(Resource *resource, const QString &language) Q_DECL_OVERRIDE;
+    void zwp_text_input_v2_set_preferred_language(Resource *resource, const char *language) Q_DECL_OVERRIDE;
     void zwp_text_input_v2_update_state(Resource *resource, uint32_t serial, uint32_t flags) Q_DECL_OVERRIDE;
 };
 
@@ -218,20 +218,22 @@ void QWaylandWlShellSurfacePrivate::shell_surface_pong(Resource *resource,
 }
 
 void QWaylandWlShellSurfacePrivate::shell_surface_set_title(Resource *resource,
-                             const QString &title)
+                             const char *title)
 {
     Q_UNUSED(resource);
-    if (title == m_title)
+    const QString newTitle = QString::fromUtf8(title);
+    if (newTitle == m_title)
         return;
     Q_Q(QWaylandWlShellSurface);
-    m_title = title;
+    m_title = newTitle;
     emit q->titleChanged();
 }
 
 void QWaylandWlShellSurfacePrivate::shell_surface_set_class(Resource *resource,
-                             const QString &className)
+                             const char *class_)
 {
     Q_UNUSED(resource);
+    const QString className = QString::fromUtf8(class_);
     if (className == m_className)
         return;
     Q_Q(QWaylandWlShellSurface);
@@ -134,9 +134,9 @@ private:
     void shell_surface_pong(Resource *resource,
                             uint32_t serial) Q_DECL_OVERRIDE;
     void shell_surface_set_title(Resource *resource,
-                                 const QString &title) Q_DECL_OVERRIDE;
+                                 const char *title) Q_DECL_OVERRIDE;
     void shell_surface_set_class(Resource *resource,
-                                 const QString &class_) Q_DECL_OVERRIDE;
+                                 const char *class_) Q_DECL_OVERRIDE;
 
     static QWaylandSurfaceRole s_role;
 };
@@ -48,6 +48,7 @@
 #include <GreenIsland/QtWaylandCompositor/QWaylandSeat>
 
 #include <QtCore/QObject>
+#include <QtCore/QTimer>
 
 #include <algorithm>
 
@@ -227,6 +228,12 @@ QWaylandXdgSurfacePrivate::QWaylandXdgSurfacePrivate()
     , m_windowType(UnknownWindowType)
     , m_unsetWindowGeometry(true)
     , m_lastAckedConfigure({{}, QSize(0, 0), 0})
+    , m_scheduledConfigure({{}, QSize(0, 0), 0})
+    , m_hasScheduledConfigure(false)
+    , m_configureQueued(false)
+    , m_configuresSent(0)
+    , m_configuresCoalesced(0)
+    , m_configuresAcked(0)
 {
 }
 
@@ -250,6 +257,64 @@ void QWaylandXdgSurfacePrivate::handleFocusReceived()
     q->sendConfigure(current.size, current.states);
 }
 
+uint QWaylandXdgSurfacePrivate::scheduleConfigure(const QSize &size, const QVector<uint> &states)
+{
+    Q_Q(QWaylandXdgSurface);
+
+    // Merge into the configure that is still waiting to be sent, the
+    // client will only see the latest size and states
+    bool queue = true;
+    if (m_hasScheduledConfigure) {
+        m_scheduledConfigure.size = size;
+        m_scheduledConfigure.states = states;
+        ++m_configuresCoalesced;
+
+        // A configure held back by resize throttling keeps waiting for
+        // the ack only as long as the states are unchanged
+        queue = m_pendingConfigures.isEmpty() || states != m_pendingConfigures.last().states;
+    } else {
+        QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(q->extensionContainer());
+        Q_ASSERT(compositor);
+        m_scheduledConfigure = ConfigureEvent{states, size, compositor->nextSerial()};
+        m_hasScheduledConfigure = true;
+    }
+
+    // Dropped together with the surface when the client destroys it
+    if (queue && !m_configureQueued) {
+        m_configureQueued = true;
+        QTimer::singleShot(0, q, [this] {
+            sendScheduledConfigure();
+        });
+    }
+
+    return m_scheduledConfigure.serial;
+}
+
+void QWaylandXdgSurfacePrivate::sendScheduledConfigure()
+{
+    m_configureQueued = false;
+
+    if (!m_hasScheduledConfigure || !resource())
+        return;
+
+    // During an interactive resize keep at most one configure in flight,
+    // a slow client would otherwise fall behind the pointer; the held
+    // configure is sent when the client acks and keeps the latest size.
+    // Only size steps are held, state changes go out right away
+    if (m_scheduledConfigure.states.contains(QWaylandXdgSurface::State::ResizingState) &&
+            !m_pendingConfigures.isEmpty() &&
+            m_scheduledConfigure.states == m_pendingConfigures.last().states)
+        return;
+
+    const ConfigureEvent &config = m_scheduledConfigure;
+    auto statesBytes = QByteArray::fromRawData((char *)config.states.data(),
+                                               config.states.size() * sizeof(QWaylandXdgSurface::State));
+    m_pendingConfigures.append(config);
+    send_configure(config.size.width(), config.size.height(), statesBytes, config.serial);
+    m_hasScheduledConfigure = false;
+    ++m_configuresSent;
+}
+
 QRect QWaylandXdgSurfacePrivate::calculateFallbackWindowGeometry() const
 {
     // TODO: The unset window geometry should include subsurfaces as well, so this solution
@@ -368,13 +433,14 @@ void QWaylandXdgSurfacePrivate::xdg_surface_set_parent(Resource *resource, wl_re
     }
 }
 
-void QWaylandXdgSurfacePrivate::xdg_surface_set_app_id(Resource *resource, const QString &app_id)
+void QWaylandXdgSurfacePrivate::xdg_surface_set_app_id(Resource *resource, const char *app_id)
 {
     Q_UNUSED(resource);
-    if (app_id == m_appId)
+    const QString appId = QString::fromUtf8(app_id);
+    if (appId == m_appId)
         return;
     Q_Q(QWaylandXdgSurface);
-    m_appId = app_id;
+    m_appId = appId;
     emit q->appIdChanged();
 }
 
@@ -407,6 +473,12 @@ void QWaylandXdgSurfacePrivate::xdg_surface_ack_configure(Resource *resource, ui
             break;
     }
 
+    ++m_configuresAcked;
+
+    // Release a configure held back by resize throttling
+    if (m_hasScheduledConfigure && !m_configureQueued)
+        sendScheduledConfigure();
+
     QVector<uint> changedStates;
     std::set_symmetric_difference(
                 m_lastAckedConfigure.states.begin(), m_lastAckedConfigure.states.end(),
@@ -438,13 +510,14 @@ void QWaylandXdgSurfacePrivate::xdg_surface_ack_configure(Resource *resource, ui
     emit q->ackConfigure(serial);
 }
 
-void QWaylandXdgSurfacePrivate::xdg_surface_set_title(Resource *resource, const QString &title)
+void QWaylandXdgSurfacePrivate::xdg_surface_set_title(Resource *resource, const char *title)
 {
     Q_UNUSED(resource);
-    if (title == m_title)
+    const QString newTitle = QString::fromUtf8(title);
+    if (newTitle == m_title)
         return;
     Q_Q(QWaylandXdgSurface);
-    m_title = title;
+    m_title = newTitle;
     emit q->titleChanged();
 }
 
@@ -851,6 +924,34 @@ bool QWaylandXdgSurface::activated() const
     return d->m_lastAckedConfigure.states.contains(QWaylandXdgSurface::State::ActivatedState);
 }
 
+/*!
+ * Returns the number of configure events sent to the client.
+ */
+uint QWaylandXdgSurface::configuresSent() const
+{
+    Q_D(const QWaylandXdgSurface);
+    return d->m_configuresSent;
+}
+
+/*!
+ * Returns the number of configure requests that were merged into another
+ * configure event instead of being sent on their own.
+ */
+uint QWaylandXdgSurface::configuresCoalesced() const
+{
+    Q_D(const QWaylandXdgSurface);
+    return d->m_configuresCoalesced;
+}
+
+/*!
+ * Returns the number of configure events acknowledged by the client.
+ */
+uint QWaylandXdgSurface::configuresAcked() const
+{
+    Q_D(const QWaylandXdgSurface);
+    return d->m_configuresAcked;
+}
+
 /*!
  * Returns the Wayland interface for the QWaylandXdgSurface.
  */
@@ -909,17 +1010,16 @@ QSize QWaylandXdgSurface::sizeForResize(const QSizeF &size, const QPointF &delta
 
 /*!
  * Sends a configure event to the client. Known states are enumerated in QWaylandXdgSurface::State
+ *
+ * The event is sent when control returns to the event loop, configure
+ * requests made before that are merged and share the returned serial.
+ * While the client is being resized only one configure is sent at a time,
+ * the next one carrying the latest size follows the client's acknowledgment.
  */
 uint QWaylandXdgSurface::sendConfigure(const QSize &size, const QVector<uint> &states)
 {
     Q_D(QWaylandXdgSurface);
-    auto statesBytes = QByteArray::fromRawData((char *)states.data(), states.size() * sizeof(State));
-    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
-    Q_ASSERT(compositor);
-    uint32_t serial = compositor->nextSerial();
-    d->m_pendingConfigures.append(QWaylandXdgSurfacePrivate::ConfigureEvent{states, size, serial});
-    d->send_configure(size.width(), size.height(), statesBytes, serial);
-    return serial;
+    return d->scheduleConfigure(size, states);
 }
 
 uint QWaylandXdgSurface::sendConfigure(const QSize &size, const QVector<QWaylandXdgSurface::State> &states)
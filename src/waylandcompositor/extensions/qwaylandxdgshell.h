@@ -143,6 +143,10 @@ public:
     bool resizing() const;
     bool activated() const;
 
+    uint configuresSent() const;
+    uint configuresCoalesced() const;
+    uint configuresAcked() const;
+
     QWaylandXdgShell *shell() const;
 
     QWaylandSurface *surface() const;
@@ -113,6 +113,8 @@ public:
 
     void handleFocusLost();
     void handleFocusReceived();
+    uint scheduleConfigure(const QSize &size, const QVector<uint> &states);
+    void sendScheduledConfigure();
     QRect calculateFallbackWindowGeometry() const;
     void updateFallbackWindowGeometry();
 
@@ -130,7 +132,23 @@ private:
 
     QList<ConfigureEvent> m_pendingConfigures;
     ConfigureEvent m_lastAckedConfigure;
-    ConfigureEvent lastSentConfigure() const { return m_pendingConfigures.empty() ? m_lastAckedConfigure : m_pendingConfigures.first(); }
+
+    // State changes made within one event loop iteration are merged here
+    // and sent as a single configure event
+    ConfigureEvent m_scheduledConfigure;
+    bool m_hasScheduledConfigure;
+    bool m_configureQueued;
+
+    uint m_configuresSent;
+    uint m_configuresCoalesced;
+    uint m_configuresAcked;
+
+    ConfigureEvent lastSentConfigure() const
+    {
+        if (m_hasScheduledConfigure)
+            return m_scheduledConfigure;
+        return m_pendingConfigures.empty() ? m_lastAckedConfigure : m_pendingConfigures.last();
+    }
 
     void xdg_surface_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
 
@@ -146,11 +164,11 @@ private:
     void xdg_surface_unset_fullscreen(Resource *resource) Q_DECL_OVERRIDE;
     void xdg_surface_set_minimized(Resource *resource) Q_DECL_OVERRIDE;
     void xdg_surface_set_parent(Resource *resource, struct ::wl_resource *parent) Q_DECL_OVERRIDE;
-    void xdg_surface_set_app_id(Resource *resource, const QString &app_id) Q_DECL_OVERRIDE;
+    void xdg_surface_set_app_id(Resource *resource, const char *app_id) Q_DECL_OVERRIDE;
     void xdg_surface_show_window_menu(Resource *resource, struct ::wl_resource *seatResource,
                                       uint32_t serial, int32_t x, int32_t y) Q_DECL_OVERRIDE;
     void xdg_surface_ack_configure(Resource *resource, uint32_t serial) Q_DECL_OVERRIDE;
-    void xdg_surface_set_title(Resource *resource, const QString &title) Q_DECL_OVERRIDE;
+    void xdg_surface_set_title(Resource *resource, const char *title) Q_DECL_OVERRIDE;
     void xdg_surface_set_window_geometry(Resource *resource, int32_t x, int32_t y,
                                          int32_t width, int32_t height) Q_DECL_OVERRIDE;
 
@@ -94,7 +94,7 @@ void ExtendedSurface::setParentSurface(QWaylandSurface *surface)
 }
 
 void ExtendedSurface::extended_surface_update_generic_property(Resource *resource,
-                                                               const QString &name,
+                                                               const char *name,
                                                                struct wl_array *value)
 {
     Q_UNUSED(resource);
@@ -102,7 +102,7 @@ void ExtendedSurface::extended_surface_update_generic_property(Resource *resourc
     QByteArray byteValue((const char*)value->data, value->size);
     QDataStream ds(&byteValue, QIODevice::ReadOnly);
     ds >> variantValue;
-    setWindowPropertyImpl(name,variantValue);
+    setWindowPropertyImpl(QString::fromUtf8(name), variantValue);
 }
 
 Qt::ScreenOrientations ExtendedSurface::contentOrientationMask() const
@@ -135,7 +135,7 @@ private:
     QVariantMap m_windowProperties;
 
     void extended_surface_update_generic_property(Resource *resource,
-                                                  const QString &name,
+                                                  const char *name,
                                                   struct wl_array *value) Q_DECL_OVERRIDE;
 
     void extended_surface_set_content_orientation_mask(Resource *resource,
@@ -43,6 +43,10 @@
 #include <QUrl>
 #include <QBuffer>
 #include <QImageWriter>
+#include <QRunnable>
+#include <QThread>
+
+#include <unistd.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -51,23 +55,8 @@ QByteArray QWaylandMimeHelper::getByteArray(QMimeData *mimeData, const QString &
     QByteArray content;
     if (mimeType == QLatin1String("text/plain")) {
         content = mimeData->text().toUtf8();
-    } else if (mimeData->hasImage()
-               && (mimeType == QLatin1String("application/x-qt-image")
-                   || mimeType.startsWith(QLatin1String("image/")))) {
-        QImage image = qvariant_cast<QImage>(mimeData->imageData());
-        if (!image.isNull()) {
-            QBuffer buf;
-            buf.open(QIODevice::ReadWrite);
-            QByteArray fmt = "BMP";
-            if (mimeType.startsWith(QLatin1String("image/"))) {
-                QByteArray imgFmt = mimeType.mid(6).toUpper().toLatin1();
-                if (QImageWriter::supportedImageFormats().contains(imgFmt))
-                    fmt = imgFmt;
-            }
-            QImageWriter wr(&buf, fmt);
-            wr.write(image);
-            content = buf.buffer();
-        }
+    } else if (isImageConversion(mimeData, mimeType)) {
+        content = encodeImage(qvariant_cast<QImage>(mimeData->imageData()), mimeType);
     } else if (mimeType == QLatin1String("application/x-color")) {
         content = qvariant_cast<QColor>(mimeData->colorData()).name().toLatin1();
     } else if (mimeType == QLatin1String("text/uri-list")) {
@@ -82,4 +71,171 @@ QByteArray QWaylandMimeHelper::getByteArray(QMimeData *mimeData, const QString &
     return content;
 }
 
+bool QWaylandMimeHelper::isImageConversion(QMimeData *mimeData, const QString &mimeType)
+{
+    return mimeData->hasImage()
+            && (mimeType == QLatin1String("application/x-qt-image")
+                || mimeType.startsWith(QLatin1String("image/")));
+}
+
+/*
+ * Encodes \a image in the format of \a mimeType, or BMP if the format
+ * is not supported.  This is safe to call from any thread.
+ */
+QByteArray QWaylandMimeHelper::encodeImage(const QImage &image, const QString &mimeType)
+{
+    if (image.isNull())
+        return QByteArray();
+
+    QBuffer buf;
+    buf.open(QIODevice::ReadWrite);
+    QByteArray fmt = "BMP";
+    if (mimeType.startsWith(QLatin1String("image/"))) {
+        QByteArray imgFmt = mimeType.mid(6).toUpper().toLatin1();
+        if (QImageWriter::supportedImageFormats().contains(imgFmt))
+            fmt = imgFmt;
+    }
+    QImageWriter wr(&buf, fmt);
+    wr.write(image);
+    return buf.buffer();
+}
+
+class QWaylandImageConversion : public QRunnable
+{
+public:
+    QWaylandImageConversion(QWaylandMimeConverter *converter, uint generation,
+                            const QString &mimeType, const QImage &image)
+        : m_converter(converter)
+        , m_generation(generation)
+        , m_mimeType(mimeType)
+        , m_image(image)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        const QByteArray content = QWaylandMimeHelper::encodeImage(m_image, m_mimeType);
+
+        // The converter waits for the pool before going away
+        QMetaObject::invokeMethod(m_converter, "conversionFinished", Qt::QueuedConnection,
+                                  Q_ARG(uint, m_generation),
+                                  Q_ARG(QString, m_mimeType),
+                                  Q_ARG(QByteArray, content));
+    }
+
+private:
+    QWaylandMimeConverter *m_converter;
+    uint m_generation;
+    QString m_mimeType;
+    QImage m_image;
+};
+
+QWaylandMimeConverter::QWaylandMimeConverter(QObject *parent)
+    : QObject(parent)
+    , m_mimeData(0)
+    , m_generation(0)
+{
+    // Encoding is mostly memory bound, don't compete with the renderer
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+QWaylandMimeConverter::~QWaylandMimeConverter()
+{
+    m_pool.waitForDone();
+
+    Q_FOREACH (const QList<int> &fds, m_waiting) {
+        Q_FOREACH (int fd, fds)
+            close(fd);
+    }
+}
+
+/*
+ * Sets the data to convert from, the mime data must stay valid
+ * until it's replaced or invalidate() is called after it changed.
+ */
+void QWaylandMimeConverter::setMimeData(QMimeData *mimeData)
+{
+    m_mimeData = mimeData;
+    invalidate();
+}
+
+/*
+ * Discards the cached conversions because the data changed.  Receivers
+ * that are waiting for a conversion still get the old data.
+ */
+void QWaylandMimeConverter::invalidate()
+{
+    ++m_generation;
+    m_cache.clear();
+}
+
+bool QWaylandMimeConverter::isCached(const QString &mimeType) const
+{
+    return m_cache.contains(mimeType);
+}
+
+/*
+ * Writes the data converted to \a mimeType to \a fd, which is closed
+ * when done.  Images are encoded on a thread pool, the event loop
+ * keeps running in the meantime.
+ */
+void QWaylandMimeConverter::send(const QString &mimeType, int fd)
+{
+    QHash<QString, QByteArray>::const_iterator it = m_cache.constFind(mimeType);
+    if (it != m_cache.constEnd()) {
+        write(it.value(), fd);
+        return;
+    }
+
+    if (!m_mimeData) {
+        close(fd);
+        return;
+    }
+
+    if (QWaylandMimeHelper::isImageConversion(m_mimeData, mimeType)) {
+        // Join a conversion that is already running
+        const ConversionKey key(m_generation, mimeType);
+        QHash<ConversionKey, QList<int> >::iterator waiting = m_waiting.find(key);
+        if (waiting != m_waiting.end()) {
+            waiting.value().append(fd);
+            return;
+        }
+
+        m_waiting.insert(key, QList<int>() << fd);
+        const QImage image = qvariant_cast<QImage>(m_mimeData->imageData());
+        m_pool.start(new QWaylandImageConversion(this, m_generation, mimeType, image));
+        return;
+    }
+
+    // Everything else is cheap enough to convert right away
+    const QByteArray content = QWaylandMimeHelper::getByteArray(m_mimeData, mimeType);
+    m_cache.insert(mimeType, content);
+    write(content, fd);
+}
+
+/*
+ * Blocks until the running conversions are done, their results are
+ * delivered by the event loop.
+ */
+void QWaylandMimeConverter::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+void QWaylandMimeConverter::conversionFinished(uint generation, const QString &mimeType, const QByteArray &content)
+{
+    if (generation == m_generation) {
+        m_cache.insert(mimeType, content);
+        Q_EMIT converted(mimeType);
+    }
+
+    Q_FOREACH (int fd, m_waiting.take(ConversionKey(generation, mimeType)))
+        write(content, fd);
+}
+
+void QWaylandMimeConverter::write(const QByteArray &content, int fd)
+{
+    m_writer.write(content, fd);
+}
+
 QT_END_NAMESPACE
@@ -42,14 +42,69 @@
 
 #include <QString>
 #include <QByteArray>
+#include <QHash>
+#include <QImage>
 #include <QMimeData>
+#include <QPair>
+#include <QThreadPool>
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandpipewriter_p.h>
 
 QT_BEGIN_NAMESPACE
 
-class QWaylandMimeHelper
+class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandMimeHelper
 {
 public:
     static QByteArray getByteArray(QMimeData *mimeData, const QString &mimeType);
+
+    static bool isImageConversion(QMimeData *mimeData, const QString &mimeType);
+    static QByteArray encodeImage(const QImage &image, const QString &mimeType);
+};
+
+/*
+ * Converts the data of a selection to the mime types requested by
+ * clients and writes it to their file descriptors without blocking.
+ *
+ * Image encoding runs on a thread pool, results are cached until the
+ * selection changes so pasting the same image into several clients
+ * only encodes it once per format.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandMimeConverter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QWaylandMimeConverter(QObject *parent = 0);
+    ~QWaylandMimeConverter();
+
+    QMimeData *mimeData() const { return m_mimeData; }
+    void setMimeData(QMimeData *mimeData);
+
+    quint32 generation() const { return m_generation; }
+    void invalidate();
+
+    bool isCached(const QString &mimeType) const;
+    void send(const QString &mimeType, int fd);
+
+    void waitForDone();
+
+Q_SIGNALS:
+    void converted(const QString &mimeType);
+
+private Q_SLOTS:
+    void conversionFinished(uint generation, const QString &mimeType, const QByteArray &content);
+
+private:
+    typedef QPair<quint32, QString> ConversionKey;
+
+    void write(const QByteArray &content, int fd);
+
+    QMimeData *m_mimeData;
+    quint32 m_generation;
+    QHash<QString, QByteArray> m_cache;
+    QHash<ConversionKey, QList<int> > m_waiting;
+    QWaylandPipeWriter m_writer;
+    QThreadPool m_pool;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwaylandpipewriter_p.h"
+
+#include <QtCore/QSocketNotifier>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+
+QT_BEGIN_NAMESPACE
+
+// Upper bound of the data written for a single notification, so that
+// a fast receiver cannot starve the event loop
+static const qint64 maxBytesPerWakeup = 4 * 1024 * 1024;
+
+static const qint64 sendfileChunkSize = 1024 * 1024;
+
+QWaylandPipeWriter::QWaylandPipeWriter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QWaylandPipeWriter::~QWaylandPipeWriter()
+{
+    Q_FOREACH (int fd, m_writers.keys())
+        finishWriter(fd);
+}
+
+/*
+ * Writes \a content to \a fd and closes it.
+ */
+void QWaylandPipeWriter::write(const QByteArray &content, int fd)
+{
+    if (content.isEmpty()) {
+        close(fd);
+        return;
+    }
+
+    Writer writer;
+    writer.content = content;
+    writer.size = content.size();
+    startWriter(fd, writer);
+}
+
+/*
+ * Copies the first \a size bytes of \a sourceFd to \a fd with
+ * sendfile(), without reading them into memory.  Both file
+ * descriptors are closed when done.
+ */
+void QWaylandPipeWriter::write(int sourceFd, qint64 size, int fd)
+{
+    if (size <= 0) {
+        close(sourceFd);
+        close(fd);
+        return;
+    }
+
+    Writer writer;
+    writer.sourceFd = sourceFd;
+    writer.size = size;
+    startWriter(fd, writer);
+}
+
+void QWaylandPipeWriter::writeToReceiver(int fd)
+{
+    if (!m_writers.contains(fd))
+        return;
+
+    Writer &writer = m_writers[fd];
+    qint64 written = 0;
+
+    while (writer.offset < writer.size && written < maxBytesPerWakeup) {
+        const qint64 size = qMin(writer.size - writer.offset, maxBytesPerWakeup - written);
+
+        ssize_t n;
+        if (writer.sourceFd >= 0) {
+            off_t offset = writer.offset;
+            n = sendfile(fd, writer.sourceFd, &offset, qMin(size, sendfileChunkSize));
+        } else {
+            n = QT_WRITE(fd, writer.content.constData() + writer.offset, size);
+        }
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            break;
+        }
+        if (n == 0)
+            break;
+
+        writer.offset += n;
+        written += n;
+    }
+
+    // Wait for the next notification if we only yielded to the event loop
+    if (writer.offset < writer.size && written >= maxBytesPerWakeup)
+        return;
+
+    // Done, failed or the receiver went away
+    finishWriter(fd);
+}
+
+void QWaylandPipeWriter::startWriter(int fd, const Writer &writer)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    m_writers.insert(fd, writer);
+    m_writers[fd].notifier = new QSocketNotifier(fd, QSocketNotifier::Write, this);
+    connect(m_writers[fd].notifier, SIGNAL(activated(int)), SLOT(writeToReceiver(int)));
+
+    writeToReceiver(fd);
+}
+
+void QWaylandPipeWriter::finishWriter(int fd)
+{
+    Writer writer = m_writers.take(fd);
+    delete writer.notifier;
+    if (writer.sourceFd >= 0)
+        close(writer.sourceFd);
+    close(fd);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QWAYLANDPIPEWRITER_P_H
+#define QWAYLANDPIPEWRITER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSocketNotifier;
+
+/*
+ * Writes data to the file descriptors of receivers without blocking,
+ * a bit at a time whenever they can take more.  File descriptors are
+ * closed when done or when the receiver goes away.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandPipeWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QWaylandPipeWriter(QObject *parent = 0);
+    ~QWaylandPipeWriter();
+
+    void write(const QByteArray &content, int fd);
+    void write(int sourceFd, qint64 size, int fd);
+
+private Q_SLOTS:
+    void writeToReceiver(int fd);
+
+private:
+    struct Writer {
+        Writer() : notifier(0), sourceFd(-1), offset(0), size(0) { }
+        QSocketNotifier *notifier;
+        QByteArray content;
+        int sourceFd;
+        qint64 offset;
+        qint64 size;
+    };
+
+    void startWriter(int fd, const Writer &writer);
+    void finishWriter(int fd);
+
+    QHash<int, Writer> m_writers;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDPIPEWRITER_P_H
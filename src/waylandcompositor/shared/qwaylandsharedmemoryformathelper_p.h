@@ -53,6 +53,8 @@ public:
     static inline wl_shm_format fromQImageFormat(QImage::Format format);
     static inline QImage::Format fromWaylandShmFormat(wl_shm_format format);
     static inline QVector<wl_shm_format> supportedWaylandFormats();
+    static inline QVector<wl_shm_format> planarWaylandFormats();
+    static inline bool isPlanarWaylandFormat(wl_shm_format format);
 
 private:
 //IMPLEMENTATION (which has to be inline in the header because of the include trick)
@@ -131,6 +133,22 @@ QVector<wl_shm_format> QWaylandSharedMemoryFormatHelper::supportedWaylandFormats
     return retFormats;
 }
 
+// YUV formats have no QImage equivalent, they are uploaded one plane per
+// texture and converted to RGB by the shaders
+QVector<wl_shm_format> QWaylandSharedMemoryFormatHelper::planarWaylandFormats()
+{
+    QVector<wl_shm_format> retFormats;
+    retFormats << WL_SHM_FORMAT_NV12 << WL_SHM_FORMAT_YUV420 << WL_SHM_FORMAT_YUYV;
+    return retFormats;
+}
+
+bool QWaylandSharedMemoryFormatHelper::isPlanarWaylandFormat(wl_shm_format format)
+{
+    return format == WL_SHM_FORMAT_NV12
+            || format == WL_SHM_FORMAT_YUV420
+            || format == WL_SHM_FORMAT_YUYV;
+}
+
 QT_END_NAMESPACE
 
 #endif //QWAYLANDSHAREDMEMORYFORMATHELPER_H
@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwldamageaccumulator_p.h"
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+static inline qint64 area(const QRect &rect)
+{
+    return qint64(rect.width()) * qint64(rect.height());
+}
+
+DamageAccumulator::DamageAccumulator()
+    : m_collapsed(false)
+{
+}
+
+void DamageAccumulator::add(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    m_boundingRect |= rect;
+    if (m_collapsed)
+        return;
+
+    if (!m_rects.isEmpty()) {
+        QRect &last = m_rects[m_rects.size() - 1];
+        if (last.contains(rect))
+            return;
+
+        // Merge with the last rectangle when the bounding box of the two
+        // doesn't cover more than 1/8 of area that wasn't damaged
+        const QRect united = last | rect;
+        const qint64 covered = area(last) + area(rect) - area(last & rect);
+        if (area(united) - covered <= area(united) / 8) {
+            last = united;
+            return;
+        }
+    }
+
+    if (m_rects.size() == MaxRects) {
+        m_rects.clear();
+        m_collapsed = true;
+        return;
+    }
+
+    m_rects.append(rect);
+}
+
+void DamageAccumulator::clear()
+{
+    m_rects.clear();
+    m_boundingRect = QRect();
+    m_collapsed = false;
+}
+
+QVector<QRect> DamageAccumulator::rects() const
+{
+    if (m_collapsed)
+        return QVector<QRect>() << m_boundingRect;
+
+    QVector<QRect> result;
+    result.reserve(m_rects.size());
+    for (int i = 0; i < m_rects.size(); i++)
+        result.append(m_rects.at(i));
+    return result;
+}
+
+QRegion DamageAccumulator::region() const
+{
+    if (m_collapsed || m_rects.size() == 1)
+        return QRegion(m_boundingRect);
+
+    QRegion result;
+    for (int i = 0; i < m_rects.size(); i++)
+        result += m_rects.at(i);
+    return result;
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QTWAYLAND_QWLDAMAGEACCUMULATOR_P_H
+#define QTWAYLAND_QWLDAMAGEACCUMULATOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+
+#include <QtCore/QRect>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+#include <QtGui/QRegion>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+/*
+ * Collects damage rectangles sent by a client between two commits.
+ *
+ * Appending is O(1): a rectangle is either merged with the last one,
+ * when the union doesn't waste too much area, or appended to a small
+ * inline list. Once the list is full the damage collapses to its
+ * bounding box, so chatty clients cannot make us build huge regions.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT DamageAccumulator
+{
+public:
+    enum { MaxRects = 16 };
+
+    DamageAccumulator();
+
+    void add(const QRect &rect);
+    void clear();
+
+    bool isEmpty() const { return m_boundingRect.isEmpty(); }
+    bool isCollapsed() const { return m_collapsed; }
+
+    QRect boundingRect() const { return m_boundingRect; }
+    QVector<QRect> rects() const;
+
+    QRegion region() const;
+
+private:
+    QVarLengthArray<QRect, MaxRects> m_rects;
+    QRect m_boundingRect;
+    bool m_collapsed;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QTWAYLAND_QWLDAMAGEACCUMULATOR_P_H
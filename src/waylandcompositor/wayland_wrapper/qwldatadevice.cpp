@@ -82,6 +82,9 @@ void DataDevice::setFocus(QWaylandClient *focusClient)
     if (m_selectionSource) {
         DataOffer *offer = new DataOffer(m_selectionSource, resource);
         send_selection(resource->handle, offer->resource()->handle);
+    } else {
+        // The selection may belong to the compositor or a selection provider
+        QWaylandCompositorPrivate::get(m_compositor)->dataDeviceManager()->offerFromCompositorToClient(resource->handle);
     }
 }
 
@@ -135,6 +138,19 @@ void DataDevice::sourceDestroyed(DataSource *source)
         m_selectionSource = 0;
 }
 
+/*
+ * Tells the client owning the selection that it's been replaced by
+ * a selection that doesn't come from a Wayland client.
+ */
+void DataDevice::cancelSelection()
+{
+    if (!m_selectionSource)
+        return;
+
+    m_selectionSource->cancel();
+    m_selectionSource = 0;
+}
+
 void DataDevice::dragMove(QWaylandSurface *target, const QPointF &pos)
 {
     if (target != m_dragFocus)
@@ -43,13 +43,9 @@
 #include "qwldatadevice_p.h"
 #include "qwldatasource_p.h"
 #include "qwldataoffer_p.h"
-#include "qwaylandmimehelper_p.h"
 
 #include <QtCore/QDebug>
-#include <QtCore/QSocketNotifier>
-#include <fcntl.h>
-#include <QtCore/private/qcore_unix_p.h>
-#include <QtCore/QFile>
+#include <unistd.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -60,9 +56,13 @@ DataDeviceManager::DataDeviceManager(QWaylandCompositor *compositor)
     , wl_data_device_manager(compositor->display(), 1)
     , m_compositor(compositor)
     , m_current_selection_source(0)
-    , m_retainedReadNotifier(0)
+    , m_selectionProvider(0)
     , m_compositorOwnsSelection(false)
 {
+    connect(&m_retainedSelection, SIGNAL(sendRequested(QString,int)),
+            SLOT(sendToRetainedSelection(QString,int)));
+    connect(&m_retainedSelection, SIGNAL(finished()),
+            SLOT(retainedSelectionFinished()));
 }
 
 void DataDeviceManager::setCurrentSelectionSource(DataSource *source)
@@ -74,8 +74,7 @@ void DataDeviceManager::setCurrentSelectionSource(DataSource *source)
     }
 
     m_compositorOwnsSelection = false;
-
-    finishReadFromClient();
+    m_selectionProvider = 0;
 
     m_current_selection_source = source;
     if (source)
@@ -87,92 +86,32 @@ void DataDeviceManager::setCurrentSelectionSource(DataSource *source)
     //    2. make it possible for the compositor to participate in copy-paste
     // The downside is decreased performance, therefore this mode has to be enabled
     // explicitly in the compositors.
-    if (source && m_compositor->retainedSelectionEnabled()) {
-        m_retainedData.clear();
-        m_retainedReadIndex = 0;
-        retain();
-    }
+    if (source && m_compositor->retainedSelectionEnabled())
+        m_retainedSelection.start(source->mimeTypes());
+    else
+        m_retainedSelection.abort();
+
+    Q_EMIT selectionChanged();
 }
 
 void DataDeviceManager::sourceDestroyed(DataSource *source)
 {
+    // Keep what was already retained, the rest can't be read anymore
     if (m_current_selection_source == source)
-        finishReadFromClient();
+        m_retainedSelection.abort();
 }
 
-void DataDeviceManager::retain()
+void DataDeviceManager::sendToRetainedSelection(const QString &mimeType, int fd)
 {
-    QList<QString> offers = m_current_selection_source->mimeTypes();
-    finishReadFromClient();
-    if (m_retainedReadIndex >= offers.count()) {
-        QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(&m_retainedData);
-        return;
-    }
-    QString mimeType = offers.at(m_retainedReadIndex);
-    m_retainedReadBuf.clear();
-    int fd[2];
-    if (pipe(fd) == -1) {
-        qWarning("Clipboard: Failed to create pipe");
-        return;
-    }
-    fcntl(fd[0], F_SETFL, fcntl(fd[0], F_GETFL, 0) | O_NONBLOCK);
-    m_current_selection_source->send(mimeType, fd[1]);
-    m_retainedReadNotifier = new QSocketNotifier(fd[0], QSocketNotifier::Read, this);
-    connect(m_retainedReadNotifier, SIGNAL(activated(int)), SLOT(readFromClient(int)));
+    if (m_current_selection_source)
+        m_current_selection_source->send(mimeType, fd);
+    else
+        close(fd);
 }
 
-void DataDeviceManager::finishReadFromClient(bool exhausted)
+void DataDeviceManager::retainedSelectionFinished()
 {
-    Q_UNUSED(exhausted);
-    if (m_retainedReadNotifier) {
-        if (exhausted) {
-            int fd = m_retainedReadNotifier->socket();
-            delete m_retainedReadNotifier;
-            close(fd);
-        } else {
-            // Do not close the handle or destroy the read notifier here
-            // or else clients may SIGPIPE.
-            m_obsoleteRetainedReadNotifiers.append(m_retainedReadNotifier);
-        }
-        m_retainedReadNotifier = 0;
-    }
-}
-
-void DataDeviceManager::readFromClient(int fd)
-{
-    static char buf[4096];
-    int obsCount = m_obsoleteRetainedReadNotifiers.count();
-    for (int i = 0; i < obsCount; ++i) {
-        QSocketNotifier *sn = m_obsoleteRetainedReadNotifiers.at(i);
-        if (sn->socket() == fd) {
-            // Read and drop the data, stopping to read and closing the handle
-            // is not yet safe because that could kill the client with SIGPIPE
-            // when it still tries to write.
-            int n;
-            do {
-                n = QT_READ(fd, buf, sizeof buf);
-            } while (n > 0);
-            if (n != -1 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
-                m_obsoleteRetainedReadNotifiers.removeAt(i);
-                delete sn;
-                close(fd);
-            }
-            return;
-        }
-    }
-    int n = QT_READ(fd, buf, sizeof buf);
-    if (n <= 0) {
-        if (n != -1 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
-            finishReadFromClient(true);
-            QList<QString> offers = m_current_selection_source->mimeTypes();
-            QString mimeType = offers.at(m_retainedReadIndex);
-            m_retainedData.setData(mimeType, m_retainedReadBuf);
-            ++m_retainedReadIndex;
-            retain();
-        }
-    } else {
-        m_retainedReadBuf.append(buf, n);
-    }
+    QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(m_retainedSelection.mimeData());
 }
 
 DataSource *DataDeviceManager::currentSelectionSource()
@@ -191,14 +130,59 @@ void DataDeviceManager::overrideSelection(const QMimeData &mimeData)
     if (formats.isEmpty())
         return;
 
-    m_retainedData.clear();
-    foreach (const QString &format, formats)
-        m_retainedData.setData(format, mimeData.data(format));
+    cancelCurrentSelectionSource();
+    m_retainedSelection.setMimeData(mimeData);
 
-    QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(&m_retainedData);
+    QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(m_retainedSelection.mimeData());
 
     m_compositorOwnsSelection = true;
+    m_selectionProvider = 0;
+
+    offerToFocusedClient();
+    Q_EMIT selectionChanged();
+}
 
+/*
+ * Makes the compositor own the selection with data from \a provider,
+ * which must stay valid until the selection changes again or it's
+ * replaced.  Setting the same provider again announces new contents,
+ * passing null drops the selection if the provider owns it.
+ */
+void DataDeviceManager::setSelectionProvider(SelectionProvider *provider)
+{
+    if (!provider && !m_selectionProvider)
+        return;
+
+    m_selectionProvider = provider;
+    m_compositorOwnsSelection = provider != 0;
+    if (provider) {
+        cancelCurrentSelectionSource();
+        m_retainedSelection.abort();
+        offerToFocusedClient();
+    }
+
+    Q_EMIT selectionChanged();
+}
+
+/*
+ * The Wayland client that owned the selection is told it lost it,
+ * so newly focused clients are not offered its stale data anymore.
+ */
+void DataDeviceManager::cancelCurrentSelectionSource()
+{
+    DataSource *source = m_current_selection_source;
+    if (!source)
+        return;
+
+    m_current_selection_source = 0;
+    if (source->device())
+        source->device()->cancelSelection();
+    else
+        source->cancel();
+}
+
+void DataDeviceManager::offerToFocusedClient()
+{
     QWaylandSeat *dev = m_compositor->defaultSeat();
     QWaylandSurface *focusSurface = dev->keyboardFocus();
     if (focusSurface)
@@ -212,13 +196,15 @@ bool DataDeviceManager::offerFromCompositorToClient(wl_resource *clientDataDevic
         return false;
 
     wl_client *client = clientDataDeviceResource->client;
-    //qDebug("compositor offers %d types to %p", m_retainedData.formats().count(), client);
+    //qDebug("compositor offers %d types to %p", m_retainedSelection.formats().count(), client);
 
     struct wl_resource *selectionOffer =
              wl_resource_create(client, &wl_data_offer_interface, -1, 0);
     wl_resource_set_implementation(selectionOffer, &compositor_offer_interface, this, 0);
     wl_data_device_send_data_offer(clientDataDeviceResource, selectionOffer);
-    foreach (const QString &format, m_retainedData.formats()) {
+    const QStringList formats = m_selectionProvider ? m_selectionProvider->mimeTypes()
+                                                    : m_retainedSelection.formats();
+    foreach (const QString &format, formats) {
         QByteArray ba = format.toLatin1();
         wl_data_offer_send_offer(selectionOffer, ba.constData());
     }
@@ -229,7 +215,7 @@ bool DataDeviceManager::offerFromCompositorToClient(wl_resource *clientDataDevic
 
 void DataDeviceManager::offerRetainedSelection(wl_resource *clientDataDeviceResource)
 {
-    if (m_retainedData.formats().isEmpty())
+    if (!m_selectionProvider && m_retainedSelection.formats().isEmpty())
         return;
 
     m_compositorOwnsSelection = true;
@@ -256,13 +242,10 @@ void DataDeviceManager::comp_receive(wl_client *client, wl_resource *resource, c
     Q_UNUSED(client);
     DataDeviceManager *self = static_cast<DataDeviceManager *>(resource->data);
     //qDebug("client %p wants data for type %s from compositor", client, mime_type);
-    QByteArray content = QWaylandMimeHelper::getByteArray(&self->m_retainedData, QString::fromLatin1(mime_type));
-    if (!content.isEmpty()) {
-        QFile f;
-        if (f.open(fd, QIODevice::WriteOnly))
-            f.write(content);
-    }
-    close(fd);
+    if (self->m_selectionProvider)
+        self->m_selectionProvider->send(QString::fromLatin1(mime_type), fd);
+    else
+        self->m_retainedSelection.write(QString::fromLatin1(mime_type), fd);
 }
 
 void DataDeviceManager::comp_destroy(wl_client *, wl_resource *)
@@ -52,21 +52,36 @@
 #include <QtCore/QMap>
 #include <QtGui/QClipboard>
 #include <QtCore/QMimeData>
+#include <QtCore/QStringList>
 
 #include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
 
 #include <GreenIsland/QtWaylandCompositor/private/qwayland-server-wayland.h>
 
-QT_BEGIN_NAMESPACE
+#include <GreenIsland/QtWaylandCompositor/private/qwlretainedselection_p.h>
 
-class QSocketNotifier;
+QT_BEGIN_NAMESPACE
 
 namespace QtWayland {
 
 class DataDevice;
 class DataSource;
 
-class DataDeviceManager : public QObject, public QtWaylandServer::wl_data_device_manager
+/*
+ * Lets the compositor own the selection without having its data at
+ * hand, for example to bridge it from another windowing system.
+ * Data is only requested when a client pastes.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT SelectionProvider
+{
+public:
+    virtual ~SelectionProvider() {}
+
+    virtual QStringList mimeTypes() const = 0;
+    virtual void send(const QString &mimeType, int fd) = 0;
+};
+
+class Q_WAYLAND_COMPOSITOR_EXPORT DataDeviceManager : public QObject, public QtWaylandServer::wl_data_device_manager
 {
     Q_OBJECT
 
@@ -81,33 +96,38 @@ public:
     void sourceDestroyed(DataSource *source);
 
     void overrideSelection(const QMimeData &mimeData);
+
+    SelectionProvider *selectionProvider() const { return m_selectionProvider; }
+    void setSelectionProvider(SelectionProvider *provider);
+
     bool offerFromCompositorToClient(wl_resource *clientDataDeviceResource);
     void offerRetainedSelection(wl_resource *clientDataDeviceResource);
 
+Q_SIGNALS:
+    void selectionChanged();
+
 protected:
     void data_device_manager_create_data_source(Resource *resource, uint32_t id) Q_DECL_OVERRIDE;
     void data_device_manager_get_data_device(Resource *resource, uint32_t id, struct ::wl_resource *seat) Q_DECL_OVERRIDE;
 
 private Q_SLOTS:
-    void readFromClient(int fd);
+    void sendToRetainedSelection(const QString &mimeType, int fd);
+    void retainedSelectionFinished();
 
 private:
-    void retain();
-    void finishReadFromClient(bool exhausted = false);
-
     QWaylandCompositor *m_compositor;
     QList<DataDevice *> m_data_device_list;
 
     DataSource *m_current_selection_source;
 
-    QMimeData m_retainedData;
-    QSocketNotifier *m_retainedReadNotifier;
-    QList<QSocketNotifier *> m_obsoleteRetainedReadNotifiers;
-    int m_retainedReadIndex;
-    QByteArray m_retainedReadBuf;
+    RetainedSelection m_retainedSelection;
+    SelectionProvider *m_selectionProvider;
 
     bool m_compositorOwnsSelection;
 
+    void offerToFocusedClient();
+    void cancelCurrentSelectionSource();
+
 
     static void comp_accept(struct wl_client *client,
                             struct wl_resource *resource,
@@ -61,19 +61,19 @@ DataOffer::~DataOffer()
 {
 }
 
-void DataOffer::data_offer_accept(Resource *resource, uint32_t serial, const QString &mimeType)
+void DataOffer::data_offer_accept(Resource *resource, uint32_t serial, const char *mimeType)
 {
     Q_UNUSED(resource);
     Q_UNUSED(serial);
     if (m_dataSource)
-        m_dataSource->accept(mimeType);
+        m_dataSource->accept(QString::fromUtf8(mimeType));
 }
 
-void DataOffer::data_offer_receive(Resource *resource, const QString &mimeType, int32_t fd)
+void DataOffer::data_offer_receive(Resource *resource, const char *mimeType, int32_t fd)
 {
     Q_UNUSED(resource);
     if (m_dataSource)
-        m_dataSource->send(mimeType, fd);
+        m_dataSource->send(QString::fromUtf8(mimeType), fd);
     else
         close(fd);
 }
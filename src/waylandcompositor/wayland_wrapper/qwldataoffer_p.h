@@ -65,8 +65,8 @@ public:
     ~DataOffer();
 
 protected:
-    void data_offer_accept(Resource *resource, uint32_t serial, const QString &mime_type) Q_DECL_OVERRIDE;
-    void data_offer_receive(Resource *resource, const QString &mime_type, int32_t fd) Q_DECL_OVERRIDE;
+    void data_offer_accept(Resource *resource, uint32_t serial, const char *mime_type) Q_DECL_OVERRIDE;
+    void data_offer_receive(Resource *resource, const char *mime_type, int32_t fd) Q_DECL_OVERRIDE;
     void data_offer_destroy(Resource *resource) Q_DECL_OVERRIDE;
     void data_offer_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
 
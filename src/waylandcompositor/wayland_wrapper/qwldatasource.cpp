@@ -103,9 +103,9 @@ DataSource *DataSource::fromResource(struct ::wl_resource *resource)
     return static_cast<DataSource *>(Resource::fromResource(resource)->data_source_object);
 }
 
-void DataSource::data_source_offer(Resource *, const QString &mime_type)
+void DataSource::data_source_offer(Resource *, const char *mime_type)
 {
-    m_mimeTypes.append(mime_type);
+    m_mimeTypes.append(QString::fromUtf8(mime_type));
 }
 
 void DataSource::data_source_destroy(Resource *resource)
@@ -60,7 +60,7 @@ class DataOffer;
 class DataDevice;
 class DataDeviceManager;
 
-class DataSource : public QObject, public QtWaylandServer::wl_data_source
+class Q_WAYLAND_COMPOSITOR_EXPORT DataSource : public QObject, public QtWaylandServer::wl_data_source
 {
 public:
     DataSource(struct wl_client *client, uint32_t id, uint32_t time);
@@ -73,12 +73,13 @@ public:
     void cancel();
 
     void setManager(DataDeviceManager *mgr);
+    DataDevice *device() const { return m_device; }
     void setDevice(DataDevice *device);
 
     static DataSource *fromResource(struct ::wl_resource *resource);
 
 protected:
-    void data_source_offer(Resource *resource, const QString &mime_type) Q_DECL_OVERRIDE;
+    void data_source_offer(Resource *resource, const char *mime_type) Q_DECL_OVERRIDE;
     void data_source_destroy(Resource *resource) Q_DECL_OVERRIDE;
     void data_source_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
 
@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwlframecallback_p.h"
+#include "qwlobjectpool_p.h"
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandcompositor_p.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+FrameCallback::FrameCallback(struct ::wl_resource *res)
+    : resource(res)
+    , canSend(false)
+{
+    wl_list_init(&link);
+    wl_resource_set_implementation(res, 0, this, destroyCallback);
+}
+
+FrameCallback::~FrameCallback()
+{
+}
+
+FrameCallback *FrameCallback::create(QWaylandSurface *surface, struct ::wl_resource *resource)
+{
+    ObjectPool *pool = QWaylandCompositorPrivate::get(surface->compositor())->frameCallbackPool;
+    return pool->create<FrameCallback>(resource);
+}
+
+void FrameCallback::destroy()
+{
+    wl_resource_destroy(resource);
+}
+
+void FrameCallback::send(uint time)
+{
+    wl_list_remove(&link);
+    wl_list_init(&link);
+
+    wl_callback_send_done(resource, time);
+    wl_resource_destroy(resource);
+}
+
+void FrameCallback::destroyCallback(struct ::wl_resource *res)
+{
+    FrameCallback *that = static_cast<FrameCallback *>(wl_resource_get_user_data(res));
+    wl_list_remove(&that->link);
+    ObjectPool::destroy(that);
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QTWAYLAND_QWLFRAMECALLBACK_P_H
+#define QTWAYLAND_QWLFRAMECALLBACK_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+
+#include <wayland-server.h>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandSurface;
+
+namespace QtWayland {
+
+class ObjectPool;
+
+/*
+ * A wl_callback created by wl_surface.frame.
+ *
+ * Callbacks are allocated from the compositor's frame callback pool
+ * and linked into the surface lists with \c link, so they can
+ * unlink themselves in constant time when the client destroys them.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT FrameCallback
+{
+public:
+    static FrameCallback *create(QWaylandSurface *surface, struct ::wl_resource *resource);
+
+    void destroy();
+    void send(uint time);
+
+    struct ::wl_resource *resource;
+    bool canSend;
+    struct wl_list link;
+
+private:
+    FrameCallback(struct ::wl_resource *resource);
+    ~FrameCallback();
+
+    static void destroyCallback(struct ::wl_resource *resource);
+
+    friend class ObjectPool;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QTWAYLAND_QWLFRAMECALLBACK_P_H
@@ -0,0 +1,189 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwlobjectpool_p.h"
+
+#include <QtCore/QGlobalStatic>
+
+#include <stdlib.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+// Keep objects aligned as malloc() would do
+static const int slotAlignment = 16;
+static const int headerSize = 16;
+
+static inline int alignedSize(int size)
+{
+    return (size + slotAlignment - 1) & ~(slotAlignment - 1);
+}
+
+struct ObjectPoolRegistry
+{
+    QMutex mutex;
+    QVector<ObjectPool *> pools;
+};
+
+Q_GLOBAL_STATIC(ObjectPoolRegistry, poolRegistry)
+
+ObjectPool::ObjectPool(const QByteArray &name, int objectSize, int objectsPerChunk)
+    : m_name(name)
+    , m_objectSize(objectSize)
+    , m_slotSize(headerSize + alignedSize(objectSize))
+    , m_objectsPerChunk(objectsPerChunk)
+    , m_ref(1)
+    , m_freeList(Q_NULLPTR)
+    , m_used(0)
+    , m_peak(0)
+    , m_allocations(0)
+{
+    Q_STATIC_ASSERT(sizeof(Slot) <= headerSize);
+
+    if (ObjectPoolRegistry *registry = poolRegistry()) {
+        QMutexLocker locker(&registry->mutex);
+        registry->pools.append(this);
+    }
+}
+
+ObjectPool::~ObjectPool()
+{
+    if (ObjectPoolRegistry *registry = poolRegistry()) {
+        QMutexLocker locker(&registry->mutex);
+        registry->pools.removeOne(this);
+    }
+
+    for (char *chunk : m_chunks)
+        ::free(chunk);
+}
+
+void ObjectPool::ref()
+{
+    m_ref.ref();
+}
+
+void ObjectPool::deref()
+{
+    if (!m_ref.deref())
+        delete this;
+}
+
+void ObjectPool::grow()
+{
+    char *chunk = static_cast<char *>(::malloc(m_slotSize * m_objectsPerChunk));
+    if (!chunk)
+        qFatal("Unable to allocate memory for the %s pool", m_name.constData());
+    m_chunks.append(chunk);
+
+    for (int i = m_objectsPerChunk - 1; i >= 0; i--) {
+        Slot *slot = reinterpret_cast<Slot *>(chunk + i * m_slotSize);
+        slot->pool = this;
+        slot->nextFree = m_freeList;
+        m_freeList = slot;
+    }
+}
+
+void *ObjectPool::allocate()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_freeList)
+        grow();
+
+    Slot *slot = m_freeList;
+    m_freeList = slot->nextFree;
+    slot->nextFree = Q_NULLPTR;
+
+    m_used++;
+    m_peak = qMax(m_peak, m_used);
+    m_allocations++;
+
+    // Every live object keeps the pool alive
+    m_ref.ref();
+
+    return reinterpret_cast<char *>(slot) + headerSize;
+}
+
+void ObjectPool::release(void *object)
+{
+    if (!object)
+        return;
+
+    Slot *slot = reinterpret_cast<Slot *>(static_cast<char *>(object) - headerSize);
+    ObjectPool *pool = slot->pool;
+
+    {
+        QMutexLocker locker(&pool->m_mutex);
+        slot->nextFree = pool->m_freeList;
+        pool->m_freeList = slot;
+        pool->m_used--;
+    }
+
+    pool->deref();
+}
+
+ObjectPool::Statistics ObjectPool::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Statistics stats;
+    stats.name = m_name;
+    stats.objectSize = m_objectSize;
+    stats.chunks = m_chunks.size();
+    stats.capacity = m_chunks.size() * m_objectsPerChunk;
+    stats.used = m_used;
+    stats.peak = m_peak;
+    stats.allocations = m_allocations;
+    return stats;
+}
+
+QVector<ObjectPool::Statistics> ObjectPool::allStatistics()
+{
+    QVector<Statistics> result;
+
+    if (ObjectPoolRegistry *registry = poolRegistry()) {
+        QMutexLocker locker(&registry->mutex);
+        for (ObjectPool *pool : registry->pools)
+            result.append(pool->statistics());
+    }
+
+    return result;
+}
+
+}
+
+QT_END_NAMESPACE
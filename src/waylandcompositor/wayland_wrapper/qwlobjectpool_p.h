@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QTWAYLAND_QWLOBJECTPOOL_P_H
+#define QTWAYLAND_QWLOBJECTPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+#include <new>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+/*
+ * Fixed size object allocator backed by chunks of memory and an
+ * intrusive free list.
+ *
+ * Each slot starts with a small header pointing back to the pool,
+ * so objects can be released without knowing where they come from.
+ * The pool is reference counted: the owner holds a reference and so
+ * does every live object, which lets objects such as surface buffers
+ * outlive the compositor and be released from the render thread.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT ObjectPool
+{
+public:
+    struct Statistics {
+        QByteArray name;
+        int objectSize;
+        int chunks;
+        int capacity;
+        int used;
+        int peak;
+        quint64 allocations;
+    };
+
+    ObjectPool(const QByteArray &name, int objectSize, int objectsPerChunk = 32);
+
+    void ref();
+    void deref();
+
+    void *allocate();
+    static void release(void *object);
+
+    template <typename T, typename... Args>
+    T *create(Args &&... args)
+    {
+        return new (allocate()) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    static void destroy(T *object)
+    {
+        if (!object)
+            return;
+        object->~T();
+        release(object);
+    }
+
+    Statistics statistics() const;
+    static QVector<Statistics> allStatistics();
+
+private:
+    struct Slot {
+        ObjectPool *pool;
+        Slot *nextFree;
+    };
+
+    ~ObjectPool();
+
+    void grow();
+
+    QByteArray m_name;
+    const int m_objectSize;
+    const int m_slotSize;
+    const int m_objectsPerChunk;
+
+    QAtomicInt m_ref;
+    mutable QMutex m_mutex;
+    QVector<char *> m_chunks;
+    Slot *m_freeList;
+    int m_used;
+    int m_peak;
+    quint64 m_allocations;
+
+    Q_DISABLE_COPY(ObjectPool)
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QTWAYLAND_QWLOBJECTPOOL_P_H
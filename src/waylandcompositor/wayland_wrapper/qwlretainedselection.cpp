@@ -0,0 +1,582 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwlretainedselection_p.h"
+
+#include <QtCore/QSocketNotifier>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC         0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING   0x0002U
+#endif
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS         (1024 + 9)
+#define F_SEAL_SEAL         0x0001
+#define F_SEAL_SHRINK       0x0002
+#define F_SEAL_GROW         0x0004
+#define F_SEAL_WRITE        0x0008
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+static const size_t chunkSize = 64 * 1024;
+
+// Upper bound of the data read from a source for a single notification
+static const qint64 maxBytesPerWakeup = 4 * 1024 * 1024;
+
+static int createMemfd(const char *name)
+{
+#ifdef __NR_memfd_create
+    return syscall(__NR_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    Q_UNUSED(name);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static bool writeAll(int fd, const char *data, qint64 size)
+{
+    while (size > 0) {
+        const ssize_t n = QT_WRITE(fd, data, size);
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Moves data from a pipe to a file, in the kernel when possible
+static ssize_t moveToFile(int from, int to, size_t size)
+{
+    ssize_t n = splice(from, Q_NULLPTR, to, Q_NULLPTR, size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n >= 0 || errno != EINVAL)
+        return n;
+
+    static char buffer[chunkSize];
+    n = QT_READ(from, buffer, qMin(size, sizeof(buffer)));
+    if (n > 0 && !writeAll(to, buffer, n))
+        return -1;
+    return n;
+}
+
+/*
+ * RetainedMimeData
+ */
+
+RetainedMimeData::RetainedMimeData(RetainedSelection *selection)
+    : QMimeData()
+    , m_selection(selection)
+{
+}
+
+QStringList RetainedMimeData::formats() const
+{
+    return m_selection->formats();
+}
+
+bool RetainedMimeData::hasFormat(const QString &mimeType) const
+{
+    return m_selection->indexOf(mimeType) >= 0;
+}
+
+QVariant RetainedMimeData::retrieveData(const QString &mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+
+    // Images provided by the compositor are kept as they are
+    if (mimeType == QLatin1String("application/x-qt-image") && !m_selection->m_image.isNull())
+        return m_selection->m_image;
+
+    const int index = m_selection->indexOf(mimeType);
+    if (index < 0)
+        return QVariant();
+    return m_selection->readData(index);
+}
+
+/*
+ * RetainedSelection
+ */
+
+RetainedSelection::RetainedSelection(QObject *parent)
+    : QObject(parent)
+    , m_typeLimit(DefaultTypeLimit)
+    , m_totalLimit(DefaultTotalLimit)
+    , m_totalSize(0)
+    , m_mimeData(this)
+    , m_finished(true)
+    , m_spillFailed(false)
+{
+    m_converter.setMimeData(&m_mimeData);
+}
+
+RetainedSelection::~RetainedSelection()
+{
+    clear();
+
+    Q_FOREACH (int fd, m_drainers.keys()) {
+        delete m_drainers.take(fd);
+        close(fd);
+    }
+}
+
+/*
+ * Starts retaining a new selection offering \a mimeTypes, the data
+ * of the previous selection is discarded.  The sendRequested() signal
+ * is emitted for each mime type that has to be read, its handler must
+ * take ownership of the file descriptor.
+ */
+void RetainedSelection::start(const QStringList &mimeTypes)
+{
+    clear();
+
+    QStringList sorted = mimeTypes;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const QString &a, const QString &b) {
+        return priority(a) < priority(b);
+    });
+
+    m_entries.reserve(sorted.size());
+    Q_FOREACH (const QString &mimeType, sorted) {
+        Entry entry;
+        entry.mimeType = mimeType;
+        m_entries.append(entry);
+    }
+
+    m_finished = false;
+    startReads();
+    checkFinished();
+}
+
+/*
+ * Stops reading, for example because the source went away: mime types
+ * that were completely read are kept, the others are dropped.
+ */
+void RetainedSelection::abort()
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).state == Pending || m_entries.at(i).state == Reading)
+            drop(i);
+    }
+    checkFinished();
+}
+
+/*
+ * Discards all the retained data.  Receivers that are being served
+ * keep their own reference to the data and are not interrupted.
+ */
+void RetainedSelection::clear()
+{
+    for (int i = 0; i < m_entries.size(); ++i)
+        drop(i);
+    m_entries.clear();
+    m_image = QImage();
+    m_totalSize = 0;
+    m_finished = true;
+    m_spillFailed = false;
+    m_converter.invalidate();
+}
+
+/*
+ * Retains a copy of the data provided by the compositor itself.
+ */
+void RetainedSelection::setMimeData(const QMimeData &mimeData)
+{
+    clear();
+
+    // Asking QMimeData for the bytes of an image would encode it as PNG
+    // here, keep the image and let the converter encode it on demand
+    if (mimeData.hasImage())
+        m_image = qvariant_cast<QImage>(mimeData.imageData());
+
+    Q_FOREACH (const QString &format, mimeData.formats()) {
+        Entry entry;
+        entry.mimeType = format;
+        entry.state = Complete;
+        if (format != QLatin1String("application/x-qt-image") || m_image.isNull())
+            entry.data = mimeData.data(format);
+        entry.size = entry.data.size();
+        m_totalSize += entry.size;
+        m_entries.append(entry);
+    }
+
+    m_converter.invalidate();
+}
+
+bool RetainedSelection::isFinished() const
+{
+    return m_finished;
+}
+
+QStringList RetainedSelection::formats() const
+{
+    QStringList list;
+    Q_FOREACH (const Entry &entry, m_entries) {
+        if (entry.state == Complete)
+            list.append(entry.mimeType);
+    }
+    return list;
+}
+
+/*
+ * Returns how many bytes of retained data live in the compositor heap.
+ */
+qint64 RetainedSelection::residentSize() const
+{
+    qint64 size = 0;
+    Q_FOREACH (const Entry &entry, m_entries)
+        size += entry.data.size();
+    return size;
+}
+
+/*
+ * Returns how many bytes of retained data were moved to memfds.
+ */
+qint64 RetainedSelection::spilledSize() const
+{
+    qint64 size = 0;
+    Q_FOREACH (const Entry &entry, m_entries) {
+        if (entry.memfd >= 0)
+            size += entry.size;
+    }
+    return size;
+}
+
+/*
+ * Sends the data for \a mimeType to \a fd without blocking, the file
+ * descriptor is closed when done.  Mime types that were not retained
+ * are converted from the retained data when possible.
+ */
+void RetainedSelection::write(const QString &mimeType, int fd)
+{
+    const int index = indexOf(mimeType);
+    if (index < 0 || m_entries.at(index).memfd < 0) {
+        m_converter.send(mimeType, fd);
+        return;
+    }
+
+    // Duplicate the descriptor so that the transfer survives clear()
+    const int memfd = fcntl(m_entries.at(index).memfd, F_DUPFD_CLOEXEC, 0);
+    if (memfd < 0) {
+        close(fd);
+        return;
+    }
+
+    m_writer.write(memfd, m_entries.at(index).size, fd);
+}
+
+/*
+ * Returns the priority of \a mimeType, lower values are retained first.
+ */
+int RetainedSelection::priority(const QString &mimeType)
+{
+    if (mimeType == QLatin1String("text/plain;charset=utf-8"))
+        return 0;
+    if (mimeType.startsWith(QLatin1String("text/plain"))
+            || mimeType == QLatin1String("UTF8_STRING")
+            || mimeType == QLatin1String("STRING")
+            || mimeType == QLatin1String("TEXT"))
+        return 1;
+    if (mimeType == QLatin1String("text/uri-list")
+            || mimeType == QLatin1String("text/x-moz-url"))
+        return 2;
+    if (mimeType.startsWith(QLatin1String("text/")))
+        return 3;
+    if (mimeType == QLatin1String("image/png"))
+        return 4;
+    if (mimeType.startsWith(QLatin1String("image/")))
+        return 5;
+    return 6;
+}
+
+void RetainedSelection::readFromSource(int fd)
+{
+    if (m_drainers.contains(fd)) {
+        drain(fd);
+        return;
+    }
+
+    if (!m_readers.contains(fd))
+        return;
+
+    const int index = m_readers.value(fd).entry;
+    qint64 moved = 0;
+
+    while (moved < maxBytesPerWakeup) {
+        Entry &entry = m_entries[index];
+
+        ssize_t n;
+        if (entry.memfd >= 0) {
+            n = moveToFile(fd, entry.memfd, chunkSize);
+        } else {
+            const int oldSize = entry.data.size();
+            entry.data.resize(oldSize + int(chunkSize));
+            n = QT_READ(fd, entry.data.data() + oldSize, chunkSize);
+            entry.data.resize(oldSize + qMax<ssize_t>(n, 0));
+        }
+
+        if (n == 0) {
+            complete(fd);
+            break;
+        }
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                qWarning("Clipboard: Failed to read \"%s\": %s",
+                         qPrintable(entry.mimeType), strerror(errno));
+                drop(index);
+                startReads();
+                checkFinished();
+            }
+            break;
+        }
+
+        moved += n;
+        entry.size += n;
+        m_totalSize += n;
+
+        if (entry.size > m_typeLimit) {
+            drop(index);
+            startReads();
+            checkFinished();
+            break;
+        }
+
+        if (m_totalSize > m_totalLimit) {
+            enforceLimits();
+            startReads();
+            checkFinished();
+            if (m_entries.at(index).state == Dropped)
+                break;
+        }
+
+        // Without memfds the data stays in the heap, the limits still apply
+        if (entry.memfd < 0 && entry.size > SpillThreshold && !m_spillFailed)
+            spill(entry);
+    }
+}
+
+int RetainedSelection::indexOf(const QString &mimeType) const
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).state == Complete && m_entries.at(i).mimeType == mimeType)
+            return i;
+    }
+    return -1;
+}
+
+QByteArray RetainedSelection::readData(int index) const
+{
+    const Entry &entry = m_entries.at(index);
+    if (entry.memfd < 0)
+        return entry.data;
+
+    QByteArray data;
+    data.resize(entry.size);
+    qint64 offset = 0;
+    while (offset < entry.size) {
+        const ssize_t n = pread(entry.memfd, data.data() + offset, entry.size - offset, offset);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR)
+                continue;
+            return QByteArray();
+        }
+        offset += n;
+    }
+    return data;
+}
+
+void RetainedSelection::startReads()
+{
+    for (int i = 0; i < m_entries.size() && m_readers.size() < MaxConcurrentReads; ++i) {
+        if (m_entries.at(i).state != Pending)
+            continue;
+
+        int fd[2];
+        if (pipe(fd) == -1) {
+            qWarning("Clipboard: Failed to create pipe");
+            m_entries[i].state = Dropped;
+            continue;
+        }
+        fcntl(fd[0], F_SETFL, fcntl(fd[0], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd[0], F_SETFD, FD_CLOEXEC);
+
+        m_entries[i].state = Reading;
+
+        Reader reader;
+        reader.entry = i;
+        reader.notifier = new QSocketNotifier(fd[0], QSocketNotifier::Read, this);
+        connect(reader.notifier, SIGNAL(activated(int)), SLOT(readFromSource(int)));
+        m_readers.insert(fd[0], reader);
+
+        Q_EMIT sendRequested(m_entries.at(i).mimeType, fd[1]);
+    }
+}
+
+bool RetainedSelection::spill(Entry &entry)
+{
+    const int fd = createMemfd("greenisland-selection");
+    if (fd < 0) {
+        qWarning("Clipboard: Failed to create memfd: %s", strerror(errno));
+        m_spillFailed = true;
+        return false;
+    }
+
+    if (!writeAll(fd, entry.data.constData(), entry.data.size())) {
+        qWarning("Clipboard: Failed to spill \"%s\": %s",
+                 qPrintable(entry.mimeType), strerror(errno));
+        close(fd);
+        m_spillFailed = true;
+        return false;
+    }
+
+    entry.memfd = fd;
+    entry.data = QByteArray();
+    return true;
+}
+
+void RetainedSelection::complete(int fd)
+{
+    Reader reader = m_readers.take(fd);
+    delete reader.notifier;
+    close(fd);
+
+    Entry &entry = m_entries[reader.entry];
+    if (entry.memfd >= 0)
+        fcntl(entry.memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    else
+        entry.data.squeeze();
+    entry.state = Complete;
+    m_converter.invalidate();
+
+    startReads();
+    checkFinished();
+}
+
+void RetainedSelection::drain(int fd)
+{
+    // Read and drop the data: closing the pipe while the source is
+    // still writing would kill it with SIGPIPE
+    static char buffer[chunkSize];
+    ssize_t n;
+    do {
+        n = QT_READ(fd, buffer, sizeof(buffer));
+    } while (n > 0);
+
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        delete m_drainers.take(fd);
+        close(fd);
+    }
+}
+
+void RetainedSelection::drop(int index)
+{
+    Entry &entry = m_entries[index];
+    if (entry.state == Dropped)
+        return;
+
+    if (entry.state == Reading) {
+        QHash<int, Reader>::iterator it = m_readers.begin();
+        while (it != m_readers.end()) {
+            if (it.value().entry == index) {
+                m_drainers.insert(it.key(), it.value().notifier);
+                it = m_readers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (entry.state == Complete)
+        m_converter.invalidate();
+
+    m_totalSize -= entry.size;
+    entry.state = Dropped;
+    entry.size = 0;
+    entry.data = QByteArray();
+    if (entry.memfd >= 0) {
+        close(entry.memfd);
+        entry.memfd = -1;
+    }
+}
+
+void RetainedSelection::enforceLimits()
+{
+    // Make room by dropping the least important types first, and don't
+    // bother reading types that are even less important
+    for (int i = m_entries.size() - 1; i >= 0 && m_totalSize > m_totalLimit; --i) {
+        for (int j = i; j < m_entries.size(); ++j) {
+            if (m_entries.at(j).state == Pending)
+                m_entries[j].state = Dropped;
+        }
+        drop(i);
+    }
+}
+
+void RetainedSelection::checkFinished()
+{
+    if (m_finished)
+        return;
+
+    Q_FOREACH (const Entry &entry, m_entries) {
+        if (entry.state == Pending || entry.state == Reading)
+            return;
+    }
+
+    m_finished = true;
+    Q_EMIT finished();
+}
+
+} // namespace QtWayland
+
+QT_END_NAMESPACE
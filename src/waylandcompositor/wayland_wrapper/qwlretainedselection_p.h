@@ -0,0 +1,197 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QTWAYLAND_QWLRETAINEDSELECTION_P_H
+#define QTWAYLAND_QWLRETAINEDSELECTION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QMimeData>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandmimehelper_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSocketNotifier;
+
+namespace QtWayland {
+
+class RetainedSelection;
+
+/*
+ * Exposes the retained data to the compositor, payloads that were
+ * spilled to a memfd are only read back when somebody asks for them.
+ */
+class RetainedMimeData : public QMimeData
+{
+public:
+    explicit RetainedMimeData(RetainedSelection *selection);
+
+    QStringList formats() const Q_DECL_OVERRIDE;
+    bool hasFormat(const QString &mimeType) const Q_DECL_OVERRIDE;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QVariant::Type type) const Q_DECL_OVERRIDE;
+
+private:
+    RetainedSelection *m_selection;
+};
+
+/*
+ * Pulls the data of a selection from the source client so that it
+ * outlives the client.
+ *
+ * Mime types are read a few at a time in order of priority (text first)
+ * with per-type and total size caps: types that don't fit are dropped,
+ * lower priority ones first.  Large payloads are moved into sealed
+ * memfds with splice() and are served to receivers with sendfile(),
+ * without ever being copied into the compositor address space.
+ * Other mime types are converted by QWaylandMimeConverter.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT RetainedSelection : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        DefaultTypeLimit = 64 * 1024 * 1024,
+        DefaultTotalLimit = 128 * 1024 * 1024,
+        SpillThreshold = 256 * 1024,
+        MaxConcurrentReads = 4
+    };
+
+    explicit RetainedSelection(QObject *parent = 0);
+    ~RetainedSelection();
+
+    qint64 typeLimit() const { return m_typeLimit; }
+    void setTypeLimit(qint64 limit) { m_typeLimit = limit; }
+
+    qint64 totalLimit() const { return m_totalLimit; }
+    void setTotalLimit(qint64 limit) { m_totalLimit = limit; }
+
+    void start(const QStringList &mimeTypes);
+    void abort();
+    void clear();
+    void setMimeData(const QMimeData &mimeData);
+
+    bool isFinished() const;
+    QStringList formats() const;
+    QMimeData *mimeData() { return &m_mimeData; }
+
+    qint64 residentSize() const;
+    qint64 spilledSize() const;
+
+    void write(const QString &mimeType, int fd);
+
+    static int priority(const QString &mimeType);
+
+Q_SIGNALS:
+    void sendRequested(const QString &mimeType, int fd);
+    void finished();
+
+private Q_SLOTS:
+    void readFromSource(int fd);
+
+private:
+    enum State {
+        Pending,
+        Reading,
+        Complete,
+        Dropped
+    };
+
+    struct Entry {
+        Entry() : state(Pending), size(0), memfd(-1) { }
+        QString mimeType;
+        State state;
+        qint64 size;
+        QByteArray data;
+        int memfd;
+    };
+
+    struct Reader {
+        Reader() : entry(-1), notifier(0) { }
+        int entry;
+        QSocketNotifier *notifier;
+    };
+
+    int indexOf(const QString &mimeType) const;
+    QByteArray readData(int index) const;
+    void startReads();
+    bool spill(Entry &entry);
+    void complete(int fd);
+    void drain(int fd);
+    void drop(int index);
+    void enforceLimits();
+    void checkFinished();
+
+    qint64 m_typeLimit;
+    qint64 m_totalLimit;
+    qint64 m_totalSize;
+    QVector<Entry> m_entries;
+    QHash<int, Reader> m_readers;
+    QHash<int, QSocketNotifier *> m_drainers;
+    QWaylandPipeWriter m_writer;
+    QImage m_image;
+    RetainedMimeData m_mimeData;
+    QWaylandMimeConverter m_converter;
+    bool m_finished;
+    bool m_spillFailed;
+
+    friend class RetainedMimeData;
+};
+
+} // namespace QtWayland
+
+QT_END_NAMESPACE
+
+#endif // QTWAYLAND_QWLRETAINEDSELECTION_P_H
@@ -35,9 +35,12 @@
 ****************************************************************************/
 
 #include "qwlsurfacebuffer_p.h"
+#include "qwlobjectpool_p.h"
 
 #ifdef QT_WAYLAND_COMPOSITOR_GL
 #include "hardware_integration/qwlclientbufferintegration_p.h"
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
 #include <qpa/qplatformopenglcontext.h>
 #endif
 
@@ -156,7 +159,7 @@ void SurfaceBuffer::setDestroyIfUnused(bool destroy)
 void SurfaceBuffer::destroyIfUnused()
 {
     if (!m_used && m_destroyIfUnused)
-        delete this;
+        ObjectPool::destroy(this);
 }
 
 QSize SurfaceBuffer::size() const
@@ -192,8 +195,18 @@ QWaylandSurface::Origin SurfaceBuffer::origin() const
     return QWaylandSurface::OriginTopLeft;
 }
 
+bool SurfaceBuffer::isPlanarSharedMemory() const
+{
+    if (wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer))
+        return QWaylandSharedMemoryFormatHelper::isPlanarWaylandFormat(wl_shm_format(wl_shm_buffer_get_format(shmBuffer)));
+    return false;
+}
+
 QImage SurfaceBuffer::image() const
 {
+    if (isPlanarSharedMemory())
+        return QImage();
+
     if (wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer)) {
         int width = wl_shm_buffer_get_width(shmBuffer);
         int height = wl_shm_buffer_get_height(shmBuffer);
@@ -207,7 +220,20 @@ QImage SurfaceBuffer::image() const
 
 QWaylandBufferRef::BufferFormatEgl SurfaceBuffer::bufferFormatEgl() const
 {
-    Q_ASSERT(isSharedMemory() == false);
+    // Shared memory buffers are rendered with the same shaders as
+    // EGL buffers, YUV formats have a texture for each plane
+    if (wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer)) {
+        switch (wl_shm_buffer_get_format(shmBuffer)) {
+        case WL_SHM_FORMAT_NV12:
+            return QWaylandBufferRef::BufferFormatEgl_Y_UV;
+        case WL_SHM_FORMAT_YUV420:
+            return QWaylandBufferRef::BufferFormatEgl_Y_U_V;
+        case WL_SHM_FORMAT_YUYV:
+            return QWaylandBufferRef::BufferFormatEgl_Y_XUXV;
+        default:
+            return QWaylandBufferRef::BufferFormatEgl_RGBA;
+        }
+    }
 
 #ifdef QT_WAYLAND_COMPOSITOR_GL
     if (QtWayland::ClientBufferIntegration *clientInt = QWaylandCompositorPrivate::get(m_compositor)->clientBufferIntegration())
@@ -241,8 +267,221 @@ void SurfaceBuffer::bindToTexture() const
     }
 }
 
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_RG8
+#define GL_RG8 0x822B
+#endif
+
+struct PlaneUploadSupport
+{
+    // One and two channel textures, otherwise luminance and
+    // luminance alpha textures give the same red channel
+    bool redGreen;
+    // OpenGL ES 3 wants sized internal formats for them
+    bool sizedRedGreen;
+    // Rows of a damaged rectangle can be uploaded at once
+    bool rowLength;
+};
+
+static PlaneUploadSupport planeUploadSupport(QOpenGLContext *context)
+{
+    PlaneUploadSupport support;
+
+    if (context->isOpenGLES()) {
+        const bool es3 = context->format().majorVersion() >= 3;
+        support.redGreen = es3 || context->hasExtension(QByteArrayLiteral("GL_EXT_texture_rg"));
+        support.sizedRedGreen = es3;
+        support.rowLength = es3 || context->hasExtension(QByteArrayLiteral("GL_EXT_unpack_subimage"));
+    } else {
+        support.redGreen = context->format().version() >= qMakePair(3, 0) ||
+                context->hasExtension(QByteArrayLiteral("GL_ARB_texture_rg"));
+        support.sizedRedGreen = support.redGreen;
+        support.rowLength = true;
+    }
+
+    return support;
+}
+
+/*
+ * Planar formats that can be uploaded with the OpenGL implementation.
+ * NV12 samples its chroma from the red and green channels, which
+ * luminance alpha textures cannot provide, the other formats work
+ * everywhere. A temporary context is used when none is current.
+ */
+QVector<wl_shm_format> SurfaceBuffer::supportedPlanarFormats()
+{
+    QVector<wl_shm_format> formats;
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    QScopedPointer<QOpenGLContext> tempContext;
+    QScopedPointer<QOffscreenSurface> tempSurface;
+    if (!context) {
+        tempContext.reset(new QOpenGLContext());
+        tempSurface.reset(new QOffscreenSurface());
+        tempSurface->setFormat(QSurfaceFormat::defaultFormat());
+        tempSurface->create();
+        tempContext->setFormat(tempSurface->format());
+        if (!tempContext->create() || !tempContext->makeCurrent(tempSurface.data()))
+            return formats;
+        context = tempContext.data();
+    }
+
+    const PlaneUploadSupport support = planeUploadSupport(context);
+    foreach (wl_shm_format format, QWaylandSharedMemoryFormatHelper::planarWaylandFormats()) {
+        if (format != WL_SHM_FORMAT_NV12 || support.redGreen)
+            formats.append(format);
+    }
+
+    if (tempContext)
+        tempContext->doneCurrent();
+
+    return formats;
+}
+
+struct PlaneLayout
+{
+    int offset;
+    int width;
+    int height;
+    int stride;
+    int bytesPerPixel;
+    int hsub;
+    int vsub;
+};
+
+static bool planeLayout(uint32_t format, int plane, int width, int height, int stride, PlaneLayout *layout)
+{
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+
+    switch (format) {
+    case WL_SHM_FORMAT_NV12:
+        if (plane == 0)
+            *layout = { 0, width, height, stride, 1, 1, 1 };
+        else if (plane == 1)
+            *layout = { stride * height, chromaWidth, chromaHeight, stride, 2, 2, 2 };
+        else
+            return false;
+        return true;
+    case WL_SHM_FORMAT_YUV420:
+        if (plane == 0)
+            *layout = { 0, width, height, stride, 1, 1, 1 };
+        else if (plane == 1)
+            *layout = { stride * height, chromaWidth, chromaHeight, stride / 2, 1, 2, 2 };
+        else if (plane == 2)
+            *layout = { stride * height + stride / 2 * chromaHeight, chromaWidth, chromaHeight, stride / 2, 1, 2, 2 };
+        else
+            return false;
+        return true;
+    case WL_SHM_FORMAT_YUYV:
+        // Luma is sampled from the red channel of each Y/chroma pair,
+        // chroma from the green and alpha channels of each YUYV quad
+        if (plane == 0)
+            *layout = { 0, width, height, stride, 2, 1, 1 };
+        else if (plane == 1)
+            *layout = { 0, chromaWidth, height, stride, 4, 2, 1 };
+        else
+            return false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void uploadPlaneRect(const PlaneLayout &layout, const PlaneUploadSupport &support,
+                            GLenum format, const uchar *data, const QRect &rect)
+{
+    const uchar *origin = data + rect.y() * layout.stride + rect.x() * layout.bytesPerPixel;
+
+    if (layout.stride == rect.width() * layout.bytesPerPixel) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                        format, GL_UNSIGNED_BYTE, origin);
+    } else if (support.rowLength) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, layout.stride / layout.bytesPerPixel);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                        format, GL_UNSIGNED_BYTE, origin);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    } else {
+        // Padded rows cannot be skipped by OpenGL ES 2
+        for (int row = 0; row < rect.height(); row++)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y() + row, rect.width(), 1,
+                            format, GL_UNSIGNED_BYTE, origin + row * layout.stride);
+    }
+}
+
+/*
+ * Uploads \a plane of a YUV shared memory buffer to the currently bound
+ * texture. When \a damage is empty the texture storage is reallocated
+ * and the whole plane is uploaded, otherwise only the damaged area.
+ */
+void SurfaceBuffer::bindPlaneToTexture(int plane, const QRegion &damage) const
+{
+    wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer);
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!shmBuffer || !context)
+        return;
+
+    PlaneLayout layout;
+    if (!planeLayout(wl_shm_buffer_get_format(shmBuffer), plane,
+                     wl_shm_buffer_get_width(shmBuffer), wl_shm_buffer_get_height(shmBuffer),
+                     wl_shm_buffer_get_stride(shmBuffer), &layout))
+        return;
+
+    const PlaneUploadSupport support = planeUploadSupport(context);
+    GLenum format = GL_RGBA;
+    GLint internalFormat = GL_RGBA;
+    if (layout.bytesPerPixel == 1) {
+        format = support.redGreen ? GL_RED : GL_LUMINANCE;
+        internalFormat = support.sizedRedGreen ? GL_R8 : format;
+    } else if (layout.bytesPerPixel == 2) {
+        format = support.redGreen ? GL_RG : GL_LUMINANCE_ALPHA;
+        internalFormat = support.sizedRedGreen ? GL_RG8 : format;
+    }
+
+    wl_shm_buffer_begin_access(shmBuffer);
+    const uchar *data = static_cast<const uchar *>(wl_shm_buffer_get_data(shmBuffer)) + layout.offset;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (damage.isEmpty()) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, layout.width, layout.height, 0,
+                     format, GL_UNSIGNED_BYTE, Q_NULLPTR);
+        uploadPlaneRect(layout, support, format, data, QRect(0, 0, layout.width, layout.height));
+    } else {
+        foreach (const QRect &rect, damage.rects()) {
+            // Subsampled planes are rounded outwards
+            const int x1 = rect.left() / layout.hsub;
+            const int y1 = rect.top() / layout.vsub;
+            const int x2 = qMin(layout.width, (rect.right() + layout.hsub) / layout.hsub);
+            const int y2 = qMin(layout.height, (rect.bottom() + layout.vsub) / layout.vsub);
+            if (x2 <= x1 || y2 <= y1)
+                continue;
+
+            uploadPlaneRect(layout, support, format, data, QRect(x1, y1, x2 - x1, y2 - y1));
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    wl_shm_buffer_end_access(shmBuffer);
+}
+
 uint SurfaceBuffer::textureForPlane(int plane) const
 {
+    if (isSharedMemory())
+        return 0;
+
     if (QtWayland::ClientBufferIntegration *clientInt = QWaylandCompositorPrivate::get(m_compositor)->clientBufferIntegration())
         return clientInt->textureForBuffer(m_buffer, plane);
 
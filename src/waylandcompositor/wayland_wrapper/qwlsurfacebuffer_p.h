@@ -49,8 +49,10 @@
 //
 
 #include <QtCore/QRect>
+#include <QtGui/QRegion>
 #include <QtGui/qopengl.h>
 #include <QImage>
+#include <QVector>
 #include <QAtomicInt>
 
 #include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
@@ -72,13 +74,13 @@ struct surface_buffer_destroy_listener
     class SurfaceBuffer *surfaceBuffer;
 };
 
+class ObjectPool;
+
 class SurfaceBuffer
 {
 public:
     SurfaceBuffer(QWaylandSurface *surface);
 
-    ~SurfaceBuffer();
-
     void initialize(struct ::wl_resource *bufferResource);
     void destructBufferState();
 
@@ -102,17 +104,23 @@ public:
     QSize size() const;
     QWaylandSurface::Origin origin() const;
     bool isSharedMemory() const { return wl_shm_buffer_get(m_buffer); }
+    bool isPlanarSharedMemory() const;
 
     QImage image() const;
     QWaylandBufferRef::BufferFormatEgl bufferFormatEgl() const;
 #ifdef QT_WAYLAND_COMPOSITOR_GL
     void bindToTexture() const;
+    void bindPlaneToTexture(int plane, const QRegion &damage) const;
     uint textureForPlane(int plane) const;
     void updateTexture() const;
+
+    static QVector<wl_shm_format> supportedPlanarFormats();
 #endif
 
     static bool hasContent(SurfaceBuffer *buffer) { return buffer && buffer->waylandBufferHandle(); }
 private:
+    ~SurfaceBuffer();
+
     void ref();
     void deref();
     void destroyIfUnused();
@@ -136,6 +144,7 @@ private:
     static void destroy_listener_callback(wl_listener *listener, void *data);
 
     friend class ::QWaylandBufferRef;
+    friend class ObjectPool;
 };
 
 }
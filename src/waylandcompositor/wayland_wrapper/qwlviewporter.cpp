@@ -0,0 +1,160 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwlviewporter_p.h"
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+#include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandsurface_p.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+Viewporter::Viewporter(QWaylandCompositor *compositor)
+    : QtWaylandServer::wp_viewporter(compositor->display(), 1)
+{
+}
+
+void Viewporter::viewporter_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void Viewporter::viewporter_get_viewport(Resource *resource, uint32_t id, struct ::wl_resource *surfaceResource)
+{
+    QWaylandSurface *surface = QWaylandSurface::fromResource(surfaceResource);
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(surface);
+
+    if (surfacePrivate->viewport) {
+        wl_resource_post_error(resource->handle, error_viewport_exists,
+                               "a viewport for that surface already exists");
+        return;
+    }
+
+    surfacePrivate->viewport = new Viewport(surface, resource->client(), id);
+}
+
+Viewport::Viewport(QWaylandSurface *surface, struct ::wl_client *client, uint32_t id)
+    : QtWaylandServer::wp_viewport(client, id, 1)
+    , m_surface(surface)
+{
+}
+
+Viewport::~Viewport()
+{
+    if (!m_surface)
+        return;
+
+    // Crop and scale state is removed on the next commit
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+    surfacePrivate->viewport = Q_NULLPTR;
+    surfacePrivate->pending.sourceGeometry = QRectF();
+    surfacePrivate->pending.destinationSize = QSize();
+}
+
+void Viewport::detachSurface()
+{
+    m_surface = Q_NULLPTR;
+}
+
+void Viewport::viewport_destroy_resource(Resource *)
+{
+    delete this;
+}
+
+void Viewport::viewport_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void Viewport::viewport_set_source(Resource *resource, wl_fixed_t x, wl_fixed_t y,
+                                   wl_fixed_t width, wl_fixed_t height)
+{
+    if (!m_surface) {
+        wl_resource_post_error(resource->handle, error_no_surface,
+                               "the wl_surface was destroyed");
+        return;
+    }
+
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+
+    const wl_fixed_t unset = wl_fixed_from_int(-1);
+    if (x == unset && y == unset && width == unset && height == unset) {
+        surfacePrivate->pending.sourceGeometry = QRectF();
+        return;
+    }
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0) {
+        wl_resource_post_error(resource->handle, error_bad_value,
+                               "source rectangle must be non-negative (%f, %f) and non-empty (%f x %f)",
+                               wl_fixed_to_double(x), wl_fixed_to_double(y),
+                               wl_fixed_to_double(width), wl_fixed_to_double(height));
+        return;
+    }
+
+    surfacePrivate->pending.sourceGeometry = QRectF(wl_fixed_to_double(x), wl_fixed_to_double(y),
+                                                    wl_fixed_to_double(width), wl_fixed_to_double(height));
+}
+
+void Viewport::viewport_set_destination(Resource *resource, int32_t width, int32_t height)
+{
+    if (!m_surface) {
+        wl_resource_post_error(resource->handle, error_no_surface,
+                               "the wl_surface was destroyed");
+        return;
+    }
+
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+
+    if (width == -1 && height == -1) {
+        surfacePrivate->pending.destinationSize = QSize();
+        return;
+    }
+
+    if (width <= 0 || height <= 0) {
+        wl_resource_post_error(resource->handle, error_bad_value,
+                               "destination size must be positive (%d x %d)",
+                               width, height);
+        return;
+    }
+
+    surfacePrivate->pending.destinationSize = QSize(width, height);
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QTWAYLAND_QWLVIEWPORTER_P_H
+#define QTWAYLAND_QWLVIEWPORTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <GreenIsland/QtWaylandCompositor/qwaylandexport.h>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwayland-server-viewporter.h>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandCompositor;
+class QWaylandSurface;
+
+namespace QtWayland {
+
+class Q_WAYLAND_COMPOSITOR_EXPORT Viewporter : public QtWaylandServer::wp_viewporter
+{
+public:
+    Viewporter(QWaylandCompositor *compositor);
+
+protected:
+    void viewporter_destroy(Resource *resource) Q_DECL_OVERRIDE;
+    void viewporter_get_viewport(Resource *resource, uint32_t id, struct ::wl_resource *surface) Q_DECL_OVERRIDE;
+};
+
+/*
+ * Crop and scale state of a surface.
+ *
+ * The state is stored as pending state on the surface and applied
+ * on the next wl_surface.commit, the viewport is detached from the
+ * surface when either one of them is destroyed.
+ */
+class Q_WAYLAND_COMPOSITOR_EXPORT Viewport : public QtWaylandServer::wp_viewport
+{
+public:
+    Viewport(QWaylandSurface *surface, struct ::wl_client *client, uint32_t id);
+    ~Viewport();
+
+    QWaylandSurface *surface() const { return m_surface; }
+    void detachSurface();
+
+protected:
+    void viewport_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
+
+    void viewport_destroy(Resource *resource) Q_DECL_OVERRIDE;
+    void viewport_set_source(Resource *resource, wl_fixed_t x, wl_fixed_t y,
+                             wl_fixed_t width, wl_fixed_t height) Q_DECL_OVERRIDE;
+    void viewport_set_destination(Resource *resource, int32_t width, int32_t height) Q_DECL_OVERRIDE;
+
+private:
+    QWaylandSurface *m_surface;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QTWAYLAND_QWLVIEWPORTER_P_H
@@ -41,6 +41,7 @@
 #include <GreenIsland/Client/Seat>
 #include <GreenIsland/Client/Shm>
 #include <GreenIsland/Client/ShmPool>
+#include <GreenIsland/Client/SubCompositor>
 #include <GreenIsland/Client/Surface>
 #include <GreenIsland/Server/Screencaster>
 #include <GreenIsland/Server/Screenshooter>
@@ -234,6 +235,13 @@ private Q_SLOTS:
         delete pool;
     }
 
+    void testSubCompositor()
+    {
+        TEST_CREATE_BEGIN();
+        TEST_CREATE_BODY(SIGNAL(subCompositorAnnounced(quint32,quint32)), createSubCompositor);
+        TEST_CREATE_END();
+    }
+
     void testScreencaster()
     {
         TEST_CREATE_BEGIN();
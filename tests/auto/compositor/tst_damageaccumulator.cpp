@@ -0,0 +1,168 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwldamageaccumulator_p.h>
+
+using namespace QtWayland;
+
+class TestDamageAccumulator : public QObject
+{
+    Q_OBJECT
+public:
+    TestDamageAccumulator(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+    }
+
+private:
+    // Every other pixel of a row, the worst case for QRegion banding
+    static QVector<QRect> checkerboard(int size)
+    {
+        QVector<QRect> rects;
+        for (int y = 0; y < size; y++) {
+            for (int x = y % 2; x < size; x += 2)
+                rects.append(QRect(x, y, 1, 1));
+        }
+        return rects;
+    }
+
+    // Thin diagonal stripes, like a text cursor moving around
+    static QVector<QRect> diagonal(int count)
+    {
+        QVector<QRect> rects;
+        for (int i = 0; i < count; i++)
+            rects.append(QRect(i * 7 % 1920, i * 13 % 1080, 2, 16));
+        return rects;
+    }
+
+private Q_SLOTS:
+    void testEmpty()
+    {
+        DamageAccumulator damage;
+        QVERIFY(damage.isEmpty());
+
+        damage.add(QRect());
+        damage.add(QRect(10, 10, 0, 5));
+        QVERIFY(damage.isEmpty());
+        QVERIFY(damage.region().isEmpty());
+    }
+
+    void testMergeAdjacent()
+    {
+        DamageAccumulator damage;
+        for (int y = 0; y < 100; y++)
+            damage.add(QRect(0, y, 200, 1));
+
+        QVERIFY(!damage.isCollapsed());
+        QCOMPARE(damage.rects().size(), 1);
+        QCOMPARE(damage.region(), QRegion(0, 0, 200, 100));
+    }
+
+    void testDisjoint()
+    {
+        DamageAccumulator damage;
+        damage.add(QRect(0, 0, 10, 10));
+        damage.add(QRect(100, 100, 10, 10));
+
+        QVERIFY(!damage.isCollapsed());
+        QCOMPARE(damage.rects().size(), 2);
+        QCOMPARE(damage.boundingRect(), QRect(0, 0, 110, 110));
+        QCOMPARE(damage.region(), QRegion(0, 0, 10, 10) + QRegion(100, 100, 10, 10));
+    }
+
+    void testCollapse()
+    {
+        DamageAccumulator damage;
+        QRegion expected;
+        foreach (const QRect &rect, diagonal(DamageAccumulator::MaxRects + 1)) {
+            damage.add(rect);
+            expected += rect;
+        }
+
+        QVERIFY(damage.isCollapsed());
+        QCOMPARE(damage.rects().size(), 1);
+        QCOMPARE(damage.region(), QRegion(expected.boundingRect()));
+
+        damage.clear();
+        QVERIFY(damage.isEmpty());
+        QVERIFY(!damage.isCollapsed());
+    }
+
+    void testCoversRegion()
+    {
+        DamageAccumulator damage;
+        QRegion expected;
+        foreach (const QRect &rect, diagonal(DamageAccumulator::MaxRects)) {
+            damage.add(rect);
+            expected += rect;
+        }
+
+        QVERIFY((expected - damage.region()).isEmpty());
+    }
+
+    void benchmarkRegion_data()
+    {
+        QTest::addColumn<QVector<QRect> >("rects");
+
+        QTest::newRow("checkerboard") << checkerboard(64);
+        QTest::newRow("diagonal") << diagonal(2000);
+    }
+
+    void benchmarkRegion()
+    {
+        QFETCH(QVector<QRect>, rects);
+
+        QBENCHMARK {
+            QRegion region;
+            foreach (const QRect &rect, rects)
+                region = region.united(rect);
+        }
+    }
+
+    void benchmarkAccumulator_data()
+    {
+        benchmarkRegion_data();
+    }
+
+    void benchmarkAccumulator()
+    {
+        QFETCH(QVector<QRect>, rects);
+
+        QBENCHMARK {
+            DamageAccumulator damage;
+            foreach (const QRect &rect, rects)
+                damage.add(rect);
+            damage.region();
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestDamageAccumulator)
+
+#include "tst_damageaccumulator.moc"
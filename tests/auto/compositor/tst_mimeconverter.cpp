@@ -0,0 +1,198 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwaylandmimehelper_p.h>
+
+#include <thread>
+
+#include <unistd.h>
+
+// Reads everything the converter writes to a pipe
+class Receiver
+{
+public:
+    Receiver()
+        : fd(-1)
+    {
+        int fds[2];
+        if (pipe(fds) == 0) {
+            fd = fds[1];
+            const int readFd = fds[0];
+            thread = std::thread([this, readFd] {
+                char buffer[4096];
+                ssize_t n;
+                while ((n = ::read(readFd, buffer, sizeof(buffer))) > 0)
+                    data.append(buffer, n);
+                ::close(readFd);
+                done.storeRelease(1);
+            });
+        }
+    }
+
+    ~Receiver()
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    bool isDone() const
+    {
+        return done.loadAcquire();
+    }
+
+    int fd;
+    QByteArray data;
+    QAtomicInt done;
+    std::thread thread;
+};
+
+class TestMimeConverter : public QObject
+{
+    Q_OBJECT
+public:
+    TestMimeConverter(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+    }
+
+private:
+    static QImage screenshot(const QSize &size)
+    {
+        QImage image(size, QImage::Format_ARGB32);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        for (int i = 0; i < size.width(); i += 16)
+            painter.fillRect(i, (i * 7) % size.height(), 12, 40, QColor::fromHsv(i % 360, 200, 200));
+        return image;
+    }
+
+private Q_SLOTS:
+    void testText()
+    {
+        QMimeData mimeData;
+        mimeData.setText(QStringLiteral("Hello world"));
+
+        QWaylandMimeConverter converter;
+        converter.setMimeData(&mimeData);
+
+        Receiver receiver;
+        converter.send(QStringLiteral("text/plain"), receiver.fd);
+        QTRY_VERIFY(receiver.isDone());
+
+        QCOMPARE(receiver.data, QByteArray("Hello world"));
+        QVERIFY(converter.isCached(QStringLiteral("text/plain")));
+    }
+
+    void testImage()
+    {
+        const QImage image = screenshot(QSize(640, 480));
+
+        QMimeData mimeData;
+        mimeData.setImageData(image);
+
+        QWaylandMimeConverter converter;
+        converter.setMimeData(&mimeData);
+
+        // Both receivers share the same conversion
+        QSignalSpy convertedSpy(&converter, SIGNAL(converted(QString)));
+        Receiver first, second;
+        converter.send(QStringLiteral("image/png"), first.fd);
+        converter.send(QStringLiteral("image/png"), second.fd);
+        QVERIFY(!converter.isCached(QStringLiteral("image/png")));
+
+        QTRY_VERIFY(first.isDone() && second.isDone());
+        QCOMPARE(convertedSpy.count(), 1);
+        QVERIFY(converter.isCached(QStringLiteral("image/png")));
+
+        QCOMPARE(first.data, second.data);
+        QCOMPARE(QImage::fromData(first.data, "PNG").convertToFormat(image.format()), image);
+    }
+
+    void testInvalidate()
+    {
+        QMimeData mimeData;
+        mimeData.setImageData(screenshot(QSize(64, 64)));
+
+        QWaylandMimeConverter converter;
+        converter.setMimeData(&mimeData);
+
+        Receiver receiver;
+        converter.send(QStringLiteral("image/png"), receiver.fd);
+
+        // The receiver still gets the data it asked for, but it's not
+        // cached for the new selection
+        const quint32 generation = converter.generation();
+        converter.invalidate();
+        QVERIFY(converter.generation() != generation);
+
+        QTRY_VERIFY(receiver.isDone());
+        QVERIFY(!receiver.data.isEmpty());
+        QVERIFY(!converter.isCached(QStringLiteral("image/png")));
+    }
+
+    void benchmarkPaste_data()
+    {
+        QTest::addColumn<bool>("cached");
+
+        QTest::newRow("first") << false;
+        QTest::newRow("cached") << true;
+    }
+
+    void benchmarkPaste()
+    {
+        QFETCH(bool, cached);
+
+        QMimeData mimeData;
+        mimeData.setImageData(screenshot(QSize(1920, 1080)));
+
+        QWaylandMimeConverter converter;
+        converter.setMimeData(&mimeData);
+
+        if (cached) {
+            Receiver receiver;
+            converter.send(QStringLiteral("image/png"), receiver.fd);
+            QTRY_VERIFY_WITH_TIMEOUT(receiver.isDone(), 30000);
+        }
+
+        QBENCHMARK {
+            if (!cached)
+                converter.invalidate();
+
+            Receiver receiver;
+            converter.send(QStringLiteral("image/png"), receiver.fd);
+            QTRY_VERIFY_WITH_TIMEOUT(receiver.isDone(), 30000);
+        }
+    }
+};
+
+QTEST_MAIN(TestMimeConverter)
+
+#include "tst_mimeconverter.moc"
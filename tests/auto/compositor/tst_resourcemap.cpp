@@ -0,0 +1,160 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwayland-server-wayland.h>
+
+struct FakeResource
+{
+    int id;
+};
+
+typedef QtWaylandServer::ResourceMap<FakeResource> FlatMap;
+
+static const int clientCount = 8;
+
+// Client pointers are only used as keys, they are never dereferenced
+static struct ::wl_client *fakeClient(int i)
+{
+    return reinterpret_cast<struct ::wl_client *>(quintptr(0x1000 + i * 0x100));
+}
+
+class TestResourceMap : public QObject
+{
+    Q_OBJECT
+public:
+    TestResourceMap(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+        for (int i = 0; i < clientCount; i++)
+            m_resources[i].id = i;
+    }
+
+private:
+    FakeResource m_resources[clientCount];
+
+private Q_SLOTS:
+    void lookup()
+    {
+        FakeResource first = { 100 };
+        FlatMap map;
+
+        QVERIFY(map.isEmpty());
+        QCOMPARE(map.value(fakeClient(0)), static_cast<FakeResource *>(0));
+        QCOMPARE(map.value(fakeClient(0), &first), &first);
+
+        for (int i = 0; i < clientCount; i++)
+            map.insert(fakeClient(i), &m_resources[i]);
+        QCOMPARE(map.size(), clientCount);
+
+        for (int i = 0; i < clientCount; i++)
+            QCOMPARE(map.value(fakeClient(i)), &m_resources[i]);
+        QVERIFY(!map.contains(fakeClient(clientCount)));
+
+        // Like QMultiMap the latest resource bound by a client wins
+        map.insert(fakeClient(2), &first);
+        QCOMPARE(map.value(fakeClient(2)), &first);
+        QCOMPARE(map.values(fakeClient(2)).size(), 2);
+
+        map.remove(fakeClient(2), &first);
+        QCOMPARE(map.value(fakeClient(2)), &m_resources[2]);
+
+        map.remove(fakeClient(2), &m_resources[2]);
+        QVERIFY(!map.contains(fakeClient(2)));
+        QCOMPARE(map.size(), clientCount - 1);
+    }
+
+    void iterate()
+    {
+        FlatMap map;
+        for (int i = 0; i < clientCount; i++)
+            map.insert(fakeClient(i), &m_resources[i]);
+
+        int i = 0;
+        for (FlatMap::const_iterator it = map.begin(); it != map.end(); ++it, ++i) {
+            QCOMPARE(it.key(), fakeClient(i));
+            QCOMPARE(*it, &m_resources[i]);
+        }
+        QCOMPARE(i, clientCount);
+
+        i = 0;
+        Q_FOREACH (FakeResource *resource, map)
+            QCOMPARE(resource->id, i++);
+        QCOMPARE(map.values().size(), clientCount);
+    }
+
+    void manyClients()
+    {
+        // More clients than the inline storage, lookups go through the index
+        FakeResource resources[clientCount * 2];
+        FlatMap map;
+        for (int i = 0; i < clientCount * 2; i++) {
+            resources[i].id = i;
+            map.insert(fakeClient(i), &resources[i]);
+        }
+        QCOMPARE(map.size(), clientCount * 2);
+
+        for (int i = 0; i < clientCount * 2; i++)
+            QCOMPARE(map.value(fakeClient(i)), &resources[i]);
+        QVERIFY(!map.contains(fakeClient(clientCount * 2)));
+
+        // A second bind by the same client replaces it until it's removed
+        FakeResource second = { 100 };
+        map.insert(fakeClient(3), &second);
+        QCOMPARE(map.value(fakeClient(3)), &second);
+        map.remove(fakeClient(3), &resources[3]);
+        QCOMPARE(map.value(fakeClient(3)), &second);
+        map.remove(fakeClient(3), &second);
+        QVERIFY(!map.contains(fakeClient(3)));
+
+        // Shrinking back to inline storage keeps the remaining entries
+        for (int i = 0; i < clientCount * 2; i++) {
+            if (i != 3 && i != 5)
+                map.remove(fakeClient(i), &resources[i]);
+        }
+        QCOMPARE(map.size(), 1);
+        QCOMPARE(map.value(fakeClient(5)), &resources[5]);
+        QVERIFY(!map.contains(fakeClient(0)));
+
+        for (int i = 0; i < clientCount * 2; i++) {
+            if (i != 5)
+                map.insert(fakeClient(i), &resources[i]);
+        }
+        for (int i = 0; i < clientCount * 2; i++)
+            QCOMPARE(map.value(fakeClient(i)), &resources[i]);
+
+        int count = 0;
+        for (FlatMap::const_iterator it = map.begin(); it != map.end(); ++it)
+            count++;
+        QCOMPARE(count, clientCount * 2);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestResourceMap)
+
+#include "tst_resourcemap.moc"
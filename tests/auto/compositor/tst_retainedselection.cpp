@@ -0,0 +1,263 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <GreenIsland/QtWaylandCompositor/private/qwlretainedselection_p.h>
+
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace QtWayland;
+
+// Plays the source client: writes the payload of each requested mime
+// type from its own thread, like a client would from its own process
+class FakeSource
+{
+public:
+    FakeSource(RetainedSelection *selection)
+    {
+        QObject::connect(selection, &RetainedSelection::sendRequested,
+                         [this](const QString &mimeType, int fd) {
+            requested.append(mimeType);
+            const QByteArray data = payloads.value(mimeType);
+            threads.push_back(std::thread([data, fd] {
+                const char *ptr = data.constData();
+                qint64 size = data.size();
+                while (size > 0) {
+                    const ssize_t n = ::write(fd, ptr, size);
+                    if (n <= 0)
+                        break;
+                    ptr += n;
+                    size -= n;
+                }
+                ::close(fd);
+            }));
+        });
+    }
+
+    ~FakeSource()
+    {
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    static QByteArray payload(int size, char seed)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; i++)
+            data[i] = char(seed + i % 251);
+        return data;
+    }
+
+    QHash<QString, QByteArray> payloads;
+    QStringList requested;
+    std::vector<std::thread> threads;
+};
+
+static qint64 residentMemory()
+{
+    QFile file(QStringLiteral("/proc/self/statm"));
+    if (!file.open(QFile::ReadOnly))
+        return 0;
+    const QList<QByteArray> values = file.readAll().split(' ');
+    return values.size() > 1 ? values.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
+class TestRetainedSelection : public QObject
+{
+    Q_OBJECT
+public:
+    TestRetainedSelection(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void testPriority()
+    {
+        RetainedSelection selection;
+        FakeSource source(&selection);
+
+        selection.start(QStringList()
+                        << QStringLiteral("application/x-foo")
+                        << QStringLiteral("image/png")
+                        << QStringLiteral("text/html")
+                        << QStringLiteral("text/plain;charset=utf-8"));
+        QTRY_VERIFY(selection.isFinished());
+
+        QCOMPARE(source.requested, QStringList()
+                 << QStringLiteral("text/plain;charset=utf-8")
+                 << QStringLiteral("text/html")
+                 << QStringLiteral("image/png")
+                 << QStringLiteral("application/x-foo"));
+    }
+
+    void testRetain()
+    {
+        RetainedSelection selection;
+        FakeSource source(&selection);
+        source.payloads.insert(QStringLiteral("text/plain"), "Hello world");
+        source.payloads.insert(QStringLiteral("image/png"), FakeSource::payload(1024 * 1024, 'a'));
+
+        QSignalSpy finishedSpy(&selection, SIGNAL(finished()));
+        selection.start(source.payloads.keys());
+        QTRY_COMPARE(finishedSpy.count(), 1);
+
+        QCOMPARE(selection.formats().size(), 2);
+        QCOMPARE(selection.mimeData()->text(), QStringLiteral("Hello world"));
+        QCOMPARE(selection.mimeData()->data(QStringLiteral("image/png")),
+                 source.payloads.value(QStringLiteral("image/png")));
+
+        // The image is large enough to leave the heap
+        QCOMPARE(selection.residentSize(), qint64(11));
+        QCOMPARE(selection.spilledSize(), qint64(1024 * 1024));
+    }
+
+    void testTypeLimit()
+    {
+        RetainedSelection selection;
+        selection.setTypeLimit(512 * 1024);
+        FakeSource source(&selection);
+        source.payloads.insert(QStringLiteral("text/plain"), "Hello world");
+        source.payloads.insert(QStringLiteral("image/png"), FakeSource::payload(1024 * 1024, 'a'));
+
+        selection.start(source.payloads.keys());
+        QTRY_VERIFY(selection.isFinished());
+
+        QCOMPARE(selection.formats(), QStringList() << QStringLiteral("text/plain"));
+    }
+
+    void testTotalLimit()
+    {
+        RetainedSelection selection;
+        selection.setTotalLimit(450 * 1024);
+        FakeSource source(&selection);
+        source.payloads.insert(QStringLiteral("text/plain"), FakeSource::payload(200 * 1024, 'a'));
+        source.payloads.insert(QStringLiteral("text/html"), FakeSource::payload(200 * 1024, 'b'));
+        source.payloads.insert(QStringLiteral("image/png"), FakeSource::payload(200 * 1024, 'c'));
+
+        selection.start(source.payloads.keys());
+        QTRY_VERIFY(selection.isFinished());
+
+        // The least important type is dropped
+        QCOMPARE(selection.formats(), QStringList()
+                 << QStringLiteral("text/plain")
+                 << QStringLiteral("text/html"));
+    }
+
+    void testWrite_data()
+    {
+        QTest::addColumn<int>("size");
+
+        QTest::newRow("heap") << 1024;
+        QTest::newRow("memfd") << 8 * 1024 * 1024;
+    }
+
+    void testWrite()
+    {
+        QFETCH(int, size);
+
+        RetainedSelection selection;
+        FakeSource source(&selection);
+        source.payloads.insert(QStringLiteral("image/png"), FakeSource::payload(size, 'a'));
+
+        selection.start(source.payloads.keys());
+        QTRY_VERIFY(selection.isFinished());
+
+        int fd[2];
+        QVERIFY(pipe(fd) == 0);
+        selection.write(QStringLiteral("image/png"), fd[1]);
+
+        // Read from another thread while the event loop serves the data
+        QByteArray received;
+        QAtomicInt done;
+        const int readFd = fd[0];
+        std::thread reader([&received, &done, readFd] {
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::read(readFd, buffer, sizeof(buffer))) > 0)
+                received.append(buffer, n);
+            ::close(readFd);
+            done.storeRelease(1);
+        });
+        QTRY_VERIFY(done.loadAcquire());
+        reader.join();
+
+        QCOMPARE(received, source.payloads.value(QStringLiteral("image/png")));
+    }
+
+    void benchmarkLargeCopy_data()
+    {
+        QTest::addColumn<int>("formats");
+        QTest::addColumn<int>("size");
+
+        QTest::newRow("4x1MB") << 4 << 1024 * 1024;
+        QTest::newRow("3x32MB") << 3 << 32 * 1024 * 1024;
+        QTest::newRow("1x128MB") << 1 << 128 * 1024 * 1024;
+    }
+
+    void benchmarkLargeCopy()
+    {
+        QFETCH(int, formats);
+        QFETCH(int, size);
+
+        QStringList mimeTypes;
+        QHash<QString, QByteArray> payloads;
+        for (int i = 0; i < formats; i++) {
+            const QString mimeType = QStringLiteral("image/x-format%1").arg(i);
+            mimeTypes.append(mimeType);
+            payloads.insert(mimeType, FakeSource::payload(size, char('a' + i)));
+        }
+
+        const qint64 memoryBefore = residentMemory();
+        qint64 resident = 0;
+        qint64 spilled = 0;
+
+        QBENCHMARK {
+            RetainedSelection selection;
+            FakeSource source(&selection);
+            source.payloads = payloads;
+
+            selection.start(mimeTypes);
+            QTRY_VERIFY_WITH_TIMEOUT(selection.isFinished(), 60000);
+            QCOMPARE(selection.formats().size(), formats);
+
+            resident = selection.residentSize();
+            spilled = selection.spilledSize();
+        }
+
+        qDebug("Retained %lld bytes in the heap and %lld bytes in memfds, resident memory grew by %lld bytes",
+               resident, spilled, residentMemory() - memoryBefore);
+    }
+};
+
+QTEST_MAIN(TestRetainedSelection)
+
+#include "tst_retainedselection.moc"
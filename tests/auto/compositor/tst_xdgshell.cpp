@@ -0,0 +1,243 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+#include <GreenIsland/QtWaylandCompositor/QWaylandXdgShell>
+
+#include <wayland-client.h>
+
+#include "wayland-xdg-shell-client-protocol.h"
+
+#include <poll.h>
+#include <string.h>
+
+static const QByteArray s_socketName = QByteArrayLiteral("greenisland-test-xdgshell-0");
+
+typedef QVector<QWaylandXdgSurface::State> States;
+
+// Creates an xdg_surface and records the configure events it receives,
+// never acks so that a resize configure stays in flight
+class XdgClient : public QThread
+{
+public:
+    XdgClient()
+        : QThread()
+        , compositor(Q_NULLPTR)
+        , shell(Q_NULLPTR)
+    {
+    }
+
+    ~XdgClient()
+    {
+        requestInterruption();
+        wait();
+    }
+
+    int configureCount() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_states.size();
+    }
+
+    QVector<uint> lastStates() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_states.isEmpty() ? QVector<uint>() : m_states.last();
+    }
+
+    wl_compositor *compositor;
+    xdg_shell *shell;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        wl_display *display = wl_display_connect(s_socketName.constData());
+        if (!display)
+            return;
+
+        wl_registry *registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &s_registryListener, this);
+        wl_display_roundtrip(display);
+
+        if (compositor && shell) {
+            xdg_shell_use_unstable_version(shell, XDG_SHELL_VERSION_CURRENT);
+
+            wl_surface *surface = wl_compositor_create_surface(compositor);
+            xdg_surface *xdgSurface = xdg_shell_get_xdg_surface(shell, surface);
+            xdg_surface_add_listener(xdgSurface, &s_xdgSurfaceListener, this);
+
+            pollfd pfd = { wl_display_get_fd(display), POLLIN, 0 };
+            while (!isInterruptionRequested()) {
+                wl_display_flush(display);
+                if (poll(&pfd, 1, 10) > 0 && wl_display_dispatch(display) < 0)
+                    break;
+            }
+
+            xdg_surface_destroy(xdgSurface);
+            wl_surface_destroy(surface);
+        }
+
+        if (shell)
+            xdg_shell_destroy(shell);
+        if (compositor)
+            wl_compositor_destroy(compositor);
+        wl_registry_destroy(registry);
+        wl_display_disconnect(display);
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QList<QVector<uint> > m_states;
+
+    static void handleGlobal(void *data, wl_registry *registry, uint32_t name,
+                             const char *interface, uint32_t version)
+    {
+        Q_UNUSED(version);
+
+        XdgClient *self = static_cast<XdgClient *>(data);
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor *>(
+                        wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        else if (strcmp(interface, xdg_shell_interface.name) == 0)
+            self->shell = static_cast<xdg_shell *>(
+                        wl_registry_bind(registry, name, &xdg_shell_interface, 1));
+    }
+
+    static void handleGlobalRemove(void *data, wl_registry *registry, uint32_t name)
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(registry);
+        Q_UNUSED(name);
+    }
+
+    static void handleConfigure(void *data, xdg_surface *surface, int32_t width, int32_t height,
+                                wl_array *states, uint32_t serial)
+    {
+        Q_UNUSED(surface);
+        Q_UNUSED(width);
+        Q_UNUSED(height);
+        Q_UNUSED(serial);
+
+        XdgClient *self = static_cast<XdgClient *>(data);
+        const uint32_t *values = static_cast<const uint32_t *>(states->data);
+        QVector<uint> received;
+        for (size_t i = 0; i < states->size / sizeof(uint32_t); i++)
+            received.append(values[i]);
+
+        QMutexLocker locker(&self->m_mutex);
+        self->m_states.append(received);
+    }
+
+    static void handleClose(void *data, xdg_surface *surface)
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(surface);
+    }
+
+    static const wl_registry_listener s_registryListener;
+    static const xdg_surface_listener s_xdgSurfaceListener;
+};
+
+const wl_registry_listener XdgClient::s_registryListener = {
+    XdgClient::handleGlobal,
+    XdgClient::handleGlobalRemove
+};
+
+const xdg_surface_listener XdgClient::s_xdgSurfaceListener = {
+    XdgClient::handleConfigure,
+    XdgClient::handleClose
+};
+
+class TestXdgShell : public QObject
+{
+    Q_OBJECT
+public:
+    TestXdgShell(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void testStateChangeWhileResizing()
+    {
+        QWaylandCompositor compositor;
+        compositor.setSocketName(s_socketName);
+        compositor.create();
+
+        QWaylandXdgShell shell(&compositor);
+        QSignalSpy createdSpy(&shell, SIGNAL(xdgSurfaceCreated(QWaylandXdgSurface*)));
+        QVERIFY(createdSpy.isValid());
+
+        XdgClient client;
+        client.start();
+        QVERIFY(createdSpy.wait());
+        QWaylandXdgSurface *xdgSurface = createdSpy.first().first().value<QWaylandXdgSurface *>();
+        QVERIFY(xdgSurface);
+
+        const QSize size(400, 300);
+        const States resizing = States() << QWaylandXdgSurface::ResizingState;
+        const States activeResizing = States() << QWaylandXdgSurface::ResizingState
+                                               << QWaylandXdgSurface::ActivatedState;
+        const States active = States() << QWaylandXdgSurface::ActivatedState;
+
+        // The first resize configure goes out and is never acked
+        xdgSurface->sendConfigure(size, resizing);
+        QTRY_COMPARE(client.configureCount(), 1);
+        QCOMPARE(xdgSurface->configuresSent(), 1u);
+
+        // Further size steps are held until the client acks
+        xdgSurface->sendConfigure(size + QSize(10, 10), resizing);
+        QTest::qWait(100);
+        QCOMPARE(xdgSurface->configuresSent(), 1u);
+        QCOMPARE(client.configureCount(), 1);
+
+        // Activation is merged into the held configure and sent right away
+        xdgSurface->sendConfigure(size + QSize(20, 20), activeResizing);
+        QTRY_COMPARE(client.configureCount(), 2);
+        QCOMPARE(xdgSurface->configuresSent(), 2u);
+        QCOMPARE(xdgSurface->configuresCoalesced(), 1u);
+        QCOMPARE(client.lastStates(), QVector<uint>() << QWaylandXdgSurface::ResizingState
+                                                      << QWaylandXdgSurface::ActivatedState);
+
+        // Same for leaving the resizing state
+        xdgSurface->sendConfigure(size + QSize(30, 30), activeResizing);
+        QTest::qWait(100);
+        QCOMPARE(xdgSurface->configuresSent(), 2u);
+        xdgSurface->sendConfigure(size + QSize(30, 30), active);
+        QTRY_COMPARE(client.configureCount(), 3);
+        QCOMPARE(xdgSurface->configuresSent(), 3u);
+        QCOMPARE(client.lastStates(), QVector<uint>() << QWaylandXdgSurface::ActivatedState);
+    }
+};
+
+QTEST_MAIN(TestXdgShell)
+
+#include "tst_xdgshell.moc"
@@ -0,0 +1,109 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <GreenIsland/Platform/OpenGLDamageHistory>
+
+using namespace GreenIsland::Platform;
+
+static const QRect targetRect(0, 0, 1280, 800);
+
+class TestDamageHistory : public QObject
+{
+    Q_OBJECT
+public:
+    TestDamageHistory(QObject *parent = 0)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void testUndefinedContent()
+    {
+        OpenGLDamageHistory history;
+        QCOMPARE(history.repaintRegion(0, targetRect), QRegion(targetRect));
+        QCOMPARE(history.repaintRegion(1, targetRect), QRegion(targetRect));
+
+        history.frameSwapped(QRect(0, 0, 10, 10));
+        QCOMPARE(history.repaintRegion(0, targetRect), QRegion(targetRect));
+        QCOMPARE(history.repaintRegion(2, targetRect), QRegion(targetRect));
+
+        history.clear();
+        QCOMPARE(history.repaintRegion(1, targetRect), QRegion(targetRect));
+    }
+
+    void testBufferAge()
+    {
+        const QRect first(0, 0, 100, 100);
+        const QRect second(200, 200, 50, 50);
+        const QRect third(400, 0, 10, 10);
+
+        OpenGLDamageHistory history;
+        history.frameSwapped(first);
+        history.frameSwapped(second);
+        history.frameSwapped(third);
+
+        // Age 1 holds the previous frame, nothing is missing
+        QCOMPARE(history.repaintRegion(1, targetRect), QRegion());
+        QCOMPARE(history.repaintRegion(2, targetRect), QRegion(third));
+        QCOMPARE(history.repaintRegion(3, targetRect), QRegion(third) + second);
+    }
+
+    void testIdleFrame()
+    {
+        const QRect first(0, 0, 100, 100);
+        const QRect second(200, 200, 50, 50);
+
+        // The compositor skips frames without damage, they are not swapped
+        // and must not be recorded: with double buffering the back buffer
+        // after the second frame is the one presented with the first
+        OpenGLDamageHistory history;
+        history.frameSwapped(targetRect);
+        history.frameSwapped(first);
+        // idle tick, nothing swapped
+        history.frameSwapped(second);
+
+        QCOMPARE(history.repaintRegion(2, targetRect), QRegion(second));
+        QCOMPARE(history.repaintRegion(3, targetRect), QRegion(second) + first);
+    }
+
+    void testLimit()
+    {
+        OpenGLDamageHistory history;
+        for (int i = 0; i < OpenGLDamageHistory::MaxFrames + 2; ++i)
+            history.frameSwapped(QRect(i * 10, 0, 10, 10));
+
+        QVERIFY(history.repaintRegion(OpenGLDamageHistory::MaxFrames, targetRect) != QRegion(targetRect));
+        QCOMPARE(history.repaintRegion(OpenGLDamageHistory::MaxFrames + 1, targetRect),
+                 QRegion(targetRect));
+    }
+};
+
+QTEST_MAIN(TestDamageHistory)
+
+#include "tst_damagehistory.moc"
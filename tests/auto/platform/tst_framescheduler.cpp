@@ -0,0 +1,287 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <GreenIsland/Platform/FrameScheduler>
+
+using namespace GreenIsland::Platform;
+
+static const qint64 msecs = Q_INT64_C(1000000);
+
+/*
+ * Simulated panel: with a fixed refresh rate a frame is flipped
+ * at the first vblank after it's ready, with a variable refresh
+ * rate as soon as it's ready but not faster than the maximum
+ * refresh rate.
+ */
+class FlipClock
+{
+public:
+    FlipClock(qreal refreshRate, bool variable)
+        : m_interval(qRound64(1000 * msecs / refreshRate))
+        , m_variable(variable)
+        , m_lastFlip(-1)
+    {
+    }
+
+    qint64 flip(qint64 ready)
+    {
+        qint64 flip;
+        if (m_variable) {
+            flip = m_lastFlip < 0 ? ready : qMax(ready, m_lastFlip + m_interval);
+        } else {
+            flip = ((ready + m_interval - 1) / m_interval) * m_interval;
+            if (flip <= m_lastFlip)
+                flip = m_lastFlip + m_interval;
+        }
+        m_lastFlip = flip;
+        return flip;
+    }
+
+private:
+    qint64 m_interval;
+    bool m_variable;
+    qint64 m_lastFlip;
+};
+
+struct Presentation {
+    qint64 flip;
+    bool repeated;
+};
+
+// Feeds commits at a steady rate, composes when the scheduler says so and
+// returns the flips; composition takes renderTime before the frame is ready
+static QVector<Presentation> simulate(FrameScheduler &scheduler, FlipClock &clock,
+                                      qint64 contentInterval, qint64 renderTime,
+                                      int count)
+{
+    QVector<Presentation> presentations;
+    qint64 nextCommit = 0;
+
+    while (presentations.size() < count) {
+        const qint64 frameTime = scheduler.nextFrameTime();
+        if (frameTime < 0 || nextCommit <= frameTime) {
+            scheduler.commit(nextCommit);
+            nextCommit += contentInterval;
+            continue;
+        }
+
+        const bool repeated = !scheduler.hasPendingCommit();
+        scheduler.frameStarted(frameTime);
+        const qint64 flip = clock.flip(frameTime + renderTime);
+
+        // Clients keep committing while the frame is in flight
+        while (nextCommit < flip) {
+            scheduler.commit(nextCommit);
+            nextCommit += contentInterval;
+        }
+
+        scheduler.flipCompleted(flip);
+        presentations.append({ flip, repeated });
+    }
+
+    return presentations;
+}
+
+static QVector<qint64> intervals(const QVector<Presentation> &presentations)
+{
+    QVector<qint64> result;
+    for (int i = 1; i < presentations.size(); ++i)
+        result.append(presentations.at(i).flip - presentations.at(i - 1).flip);
+    return result;
+}
+
+class TestFrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    TestFrameScheduler(QObject *parent = 0)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void idle()
+    {
+        FrameScheduler scheduler;
+        QCOMPARE(scheduler.nextFrameTime(), qint64(-1));
+
+        // Nothing to repeat before the first flip
+        scheduler.setRefreshRange(48, 144);
+        scheduler.setVariable(true);
+        QCOMPARE(scheduler.nextFrameTime(), qint64(-1));
+    }
+
+    void invalidRange_data()
+    {
+        QTest::addColumn<qreal>("minimumRate");
+        QTest::addColumn<qreal>("maximumRate");
+
+        QTest::newRow("unknown") << qreal(0) << qreal(0);
+        QTest::newRow("inverted") << qreal(144) << qreal(48);
+        QTest::newRow("empty") << qreal(60) << qreal(60);
+    }
+
+    void invalidRange()
+    {
+        QFETCH(qreal, minimumRate);
+        QFETCH(qreal, maximumRate);
+
+        FrameScheduler scheduler;
+        scheduler.setRefreshRange(minimumRate, maximumRate);
+        scheduler.setVariable(true);
+        QVERIFY(!scheduler.isVariable());
+    }
+
+    void fixedWaitsForFlip()
+    {
+        FrameScheduler scheduler;
+
+        scheduler.commit(0);
+        QCOMPARE(scheduler.nextFrameTime(), qint64(0));
+        scheduler.frameStarted(0);
+        QVERIFY(!scheduler.hasPendingCommit());
+
+        scheduler.commit(5 * msecs);
+        QVERIFY(scheduler.hasPendingCommit());
+        QCOMPARE(scheduler.nextFrameTime(), qint64(-1));
+
+        scheduler.flipCompleted(16 * msecs);
+        QCOMPARE(scheduler.nextFrameTime(), 16 * msecs);
+
+        // No repeated frames
+        scheduler.frameStarted(16 * msecs);
+        scheduler.flipCompleted(33 * msecs);
+        QCOMPARE(scheduler.nextFrameTime(), qint64(-1));
+    }
+
+    void variableFollowsCommits()
+    {
+        FrameScheduler scheduler;
+        scheduler.setRefreshRange(48, 144);
+        scheduler.setVariable(true);
+        QVERIFY(scheduler.isVariable());
+
+        scheduler.commit(0);
+        scheduler.frameStarted(0);
+        scheduler.flipCompleted(2 * msecs);
+
+        scheduler.commit(20 * msecs);
+        QCOMPARE(scheduler.nextFrameTime(), 20 * msecs);
+
+        // Too early for the panel
+        scheduler.frameStarted(20 * msecs);
+        scheduler.flipCompleted(22 * msecs);
+        scheduler.commit(23 * msecs);
+        QCOMPARE(scheduler.nextFrameTime(), 22 * msecs + qRound64(1000 * msecs / 144.0));
+    }
+
+    void variableRepeatsFrames()
+    {
+        FrameScheduler scheduler;
+        scheduler.setRefreshRange(48, 144);
+        scheduler.setVariable(true);
+
+        scheduler.commit(0);
+        scheduler.frameStarted(0);
+        scheduler.flipCompleted(2 * msecs);
+
+        QVERIFY(!scheduler.hasPendingCommit());
+        QCOMPARE(scheduler.nextFrameTime(), 2 * msecs + qRound64(1000 * msecs / 48.0));
+    }
+
+    void judder()
+    {
+        // 50 fps content on a 60 Hz panel
+        FrameScheduler scheduler;
+        FlipClock clock(60, false);
+        const QVector<qint64> fixed = intervals(simulate(scheduler, clock, 20 * msecs, 2 * msecs, 60));
+
+        const qint64 vblank = qRound64(1000 * msecs / 60.0);
+        bool uneven = false;
+        Q_FOREACH (qint64 interval, fixed) {
+            QVERIFY(qAbs(interval - vblank) <= 1 || qAbs(interval - 2 * vblank) <= 1);
+            uneven |= qAbs(interval - 2 * vblank) <= 1;
+        }
+        QVERIFY(uneven);
+
+        // The same content with adaptive sync is paced evenly
+        FrameScheduler variableScheduler;
+        variableScheduler.setRefreshRange(48, 144);
+        variableScheduler.setVariable(true);
+        FlipClock variableClock(144, true);
+        const QVector<Presentation> presentations =
+                simulate(variableScheduler, variableClock, 20 * msecs, 2 * msecs, 60);
+        Q_FOREACH (const Presentation &presentation, presentations)
+            QVERIFY(!presentation.repeated);
+        Q_FOREACH (qint64 interval, intervals(presentations))
+            QCOMPARE(interval, 20 * msecs);
+    }
+
+    void variableRange_data()
+    {
+        QTest::addColumn<qint64>("contentInterval");
+        QTest::addColumn<bool>("repeats");
+
+        QTest::newRow("250 fps") << 4 * msecs << false;
+        QTest::newRow("100 fps") << 10 * msecs << false;
+        QTest::newRow("30 fps") << 33 * msecs << true;
+        QTest::newRow("10 fps") << 100 * msecs << true;
+    }
+
+    void variableRange()
+    {
+        QFETCH(qint64, contentInterval);
+        QFETCH(bool, repeats);
+
+        FrameScheduler scheduler;
+        scheduler.setRefreshRange(48, 144);
+        scheduler.setVariable(true);
+        FlipClock clock(144, true);
+
+        const QVector<Presentation> presentations =
+                simulate(scheduler, clock, contentInterval, 2 * msecs, 100);
+
+        // The panel is never driven out of its range
+        const qint64 shortest = qRound64(1000 * msecs / 144.0);
+        const qint64 longest = qRound64(1000 * msecs / 48.0) + 2 * msecs;
+        Q_FOREACH (qint64 interval, intervals(presentations)) {
+            QVERIFY(interval >= shortest);
+            QVERIFY(interval <= longest);
+        }
+
+        bool repeated = false;
+        Q_FOREACH (const Presentation &presentation, presentations)
+            repeated |= presentation.repeated;
+        QCOMPARE(repeated, repeats);
+    }
+};
+
+QTEST_MAIN(TestFrameScheduler)
+
+#include "tst_framescheduler.moc"
@@ -0,0 +1,261 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+
+#include <GreenIsland/Platform/OpenGLTextureUploader>
+
+using namespace GreenIsland::Platform;
+
+typedef QVector<QRegion> DirtyTrace;
+
+Q_DECLARE_METATYPE(DirtyTrace)
+
+static const QSize windowSize(1280, 800);
+
+class TestTextureUpload : public QObject
+{
+    Q_OBJECT
+public:
+    TestTextureUpload(QObject *parent = 0)
+        : QObject(parent)
+        , m_hasContext(false)
+    {
+    }
+
+private:
+    // Traces are recorded from QPlatformBackingStore::beginPaint(), one
+    // frame per line with rectangles as "x,y,width,height" separated by ';'
+    static DirtyTrace loadTrace(const QString &fileName)
+    {
+        DirtyTrace trace;
+
+        QFile file(fileName);
+        if (!file.open(QFile::ReadOnly))
+            return trace;
+
+        while (!file.atEnd()) {
+            QRegion frame;
+            const QList<QByteArray> rects = file.readLine().trimmed().split(';');
+            Q_FOREACH (const QByteArray &rect, rects) {
+                const QList<QByteArray> values = rect.split(',');
+                if (values.size() == 4)
+                    frame |= QRect(values.at(0).toInt(), values.at(1).toInt(),
+                                   values.at(2).toInt(), values.at(3).toInt());
+            }
+            if (!frame.isEmpty())
+                trace.append(frame);
+        }
+
+        return trace;
+    }
+
+    // Typing in a text editor: a few glyphs, the caret and the line number
+    static DirtyTrace typingTrace()
+    {
+        DirtyTrace trace;
+        for (int i = 0; i < 120; ++i) {
+            const int line = 40 + (i / 60) * 18;
+            const int column = 60 + (i % 60) * 9;
+            QRegion frame;
+            frame |= QRect(column - 9, line, 18, 18);
+            frame |= QRect(column + 9, line, 2, 18);
+            frame |= QRect(8, line, 40, 18);
+            frame |= QRect(1100, 780, 160, 18);
+            trace.append(frame);
+        }
+        return trace;
+    }
+
+    // Scrolling a list view: exposed stripe plus scroll bar and rows
+    // that change their hover state
+    static DirtyTrace scrollingTrace()
+    {
+        DirtyTrace trace;
+        for (int i = 0; i < 120; ++i) {
+            QRegion frame;
+            frame |= QRect(0, 60, 1260, 700);
+            frame |= QRect(1264, 60 + i * 5, 16, 80);
+            trace.append(frame);
+        }
+        return trace;
+    }
+
+    // A dialog with many small widgets being updated independently
+    static DirtyTrace widgetsTrace()
+    {
+        DirtyTrace trace;
+        for (int i = 0; i < 120; ++i) {
+            QRegion frame;
+            for (int j = 0; j < 24; ++j)
+                frame |= QRect(20 + (j % 6) * 200, 20 + (j / 6) * 40 + (i % 3), 120 + (i * j) % 40, 24);
+            frame |= QRect(20, 700, (i * 10) % 1200 + 8, 16);
+            trace.append(frame);
+        }
+        return trace;
+    }
+
+    static QList<QPair<QByteArray, DirtyTrace> > traces()
+    {
+        QList<QPair<QByteArray, DirtyTrace> > list;
+        list.append(qMakePair(QByteArray("typing"), typingTrace()));
+        list.append(qMakePair(QByteArray("scrolling"), scrollingTrace()));
+        list.append(qMakePair(QByteArray("widgets"), widgetsTrace()));
+
+        const QString fileName = QString::fromLocal8Bit(qgetenv("GREENISLAND_DIRTY_TRACE"));
+        if (!fileName.isEmpty())
+            list.append(qMakePair(QByteArray("recorded"), loadTrace(fileName)));
+
+        return list;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_surface.setFormat(QSurfaceFormat::defaultFormat());
+        m_surface.create();
+        m_context.setFormat(QSurfaceFormat::defaultFormat());
+        m_hasContext = m_surface.isValid() && m_context.create() && m_context.makeCurrent(&m_surface);
+    }
+
+    void cleanupTestCase()
+    {
+        if (m_hasContext)
+            m_context.doneCurrent();
+    }
+
+    void testMerge()
+    {
+        QRegion region;
+        region |= QRect(0, 0, 10, 10);
+        region |= QRect(12, 0, 10, 10);
+        region |= QRect(600, 400, 10, 10);
+
+        // Nearby rectangles are merged, distant ones are not
+        const QVector<QRect> rects = OpenGLTextureUploader::mergeRects(region, QRect(0, 0, 800, 600), 100);
+        QCOMPARE(rects.size(), 2);
+        QVERIFY(rects.contains(QRect(0, 0, 22, 10)));
+        QVERIFY(rects.contains(QRect(600, 400, 10, 10)));
+
+        // A high call cost merges everything
+        QCOMPARE(OpenGLTextureUploader::mergeRects(region, QRect(0, 0, 800, 600), 800 * 600).size(), 1);
+
+        // Rectangles are clipped to the bounds
+        const QVector<QRect> clipped = OpenGLTextureUploader::mergeRects(QRegion(-10, -10, 20, 20), QRect(0, 0, 800, 600));
+        QCOMPARE(clipped.size(), 1);
+        QCOMPARE(clipped.at(0), QRect(0, 0, 10, 10));
+    }
+
+    void testMergeCoversTrace_data()
+    {
+        QTest::addColumn<DirtyTrace>("trace");
+
+        typedef QPair<QByteArray, DirtyTrace> NamedTrace;
+        Q_FOREACH (const NamedTrace &trace, traces())
+            QTest::newRow(trace.first.constData()) << trace.second;
+    }
+
+    void testMergeCoversTrace()
+    {
+        QFETCH(DirtyTrace, trace);
+
+        const QRect bounds(QPoint(0, 0), windowSize);
+        Q_FOREACH (const QRegion &frame, trace) {
+            const QVector<QRect> rects = OpenGLTextureUploader::mergeRects(frame, bounds);
+            QVERIFY(rects.size() <= frame.rectCount());
+
+            QRegion covered;
+            Q_FOREACH (const QRect &rect, rects)
+                covered |= rect;
+            QVERIFY((frame & bounds).subtracted(covered).isEmpty());
+        }
+    }
+
+    void benchmarkUpload_data()
+    {
+        QTest::addColumn<DirtyTrace>("trace");
+        QTest::addColumn<bool>("merged");
+
+        typedef QPair<QByteArray, DirtyTrace> NamedTrace;
+        Q_FOREACH (const NamedTrace &trace, traces()) {
+            QTest::newRow((trace.first + "-per-rect").constData()) << trace.second << false;
+            QTest::newRow((trace.first + "-uploader").constData()) << trace.second << true;
+        }
+    }
+
+    void benchmarkUpload()
+    {
+        if (!m_hasContext)
+            QSKIP("No OpenGL context available");
+
+        QFETCH(DirtyTrace, trace);
+        QFETCH(bool, merged);
+
+        QImage image(windowSize, QImage::Format_RGBA8888);
+        image.fill(Qt::darkCyan);
+
+        QOpenGLFunctions *funcs = m_context.functions();
+        GLuint texture = 0;
+        funcs->glGenTextures(1, &texture);
+        funcs->glBindTexture(GL_TEXTURE_2D, texture);
+        funcs->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width(), image.height(), 0,
+                            GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+        OpenGLTextureUploader uploader;
+
+        QBENCHMARK {
+            Q_FOREACH (const QRegion &frame, trace) {
+                if (merged) {
+                    uploader.upload(image, frame);
+                } else {
+                    // What the backing store used to do
+                    Q_FOREACH (const QRect &rect, frame.rects()) {
+                        const QImage copy = image.copy(rect);
+                        funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                                               GL_RGBA, GL_UNSIGNED_BYTE, copy.constBits());
+                    }
+                }
+            }
+            funcs->glFinish();
+        }
+
+        uploader.destroy();
+        funcs->glDeleteTextures(1, &texture);
+    }
+
+private:
+    QOffscreenSurface m_surface;
+    QOpenGLContext m_context;
+    bool m_hasContext;
+};
+
+QTEST_MAIN(TestTextureUpload)
+
+#include "tst_textureupload.moc"
@@ -0,0 +1,274 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QSemaphore>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QThread>
+#include <QtGui/QWindow>
+#include <QtTest/QtTest>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+#include <GreenIsland/QtWaylandCompositor/QWaylandOutput>
+#include <GreenIsland/QtWaylandCompositor/QWaylandSurface>
+#include <GreenIsland/QtWaylandCompositor/QWaylandView>
+
+#include <GreenIsland/Server/IdleInhibitManager>
+#include <GreenIsland/Server/IdleManager>
+
+#include <wayland-client.h>
+
+#include <string.h>
+
+using namespace GreenIsland::Server;
+
+static const QByteArray s_socketName = QByteArrayLiteral("greenisland-test-idle-0");
+
+/*
+ * Maps a small surface and inhibits idle on it, then keeps the
+ * connection until it's told to quit.
+ */
+class InhibitingClient : public QThread
+{
+public:
+    InhibitingClient()
+        : QThread()
+        , compositor(Q_NULLPTR)
+        , shm(Q_NULLPTR)
+        , inhibitManager(Q_NULLPTR)
+    {
+    }
+
+    QSemaphore ready;
+    QSemaphore quit;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        wl_display *display = wl_display_connect(s_socketName.constData());
+        if (!display)
+            return;
+
+        static const wl_registry_listener registryListener = {
+            &InhibitingClient::global,
+            &InhibitingClient::globalRemove
+        };
+        wl_registry *registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registryListener, this);
+        wl_display_roundtrip(display);
+
+        if (compositor && shm && inhibitManager) {
+            const int width = 4, height = 4, stride = width * 4;
+            QTemporaryFile file;
+            file.open();
+            file.resize(stride * height);
+
+            wl_surface *surface = wl_compositor_create_surface(compositor);
+            wl_shm_pool *pool = wl_shm_create_pool(shm, file.handle(), stride * height);
+            wl_buffer *buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride,
+                                                          WL_SHM_FORMAT_ARGB8888);
+            wl_surface_attach(surface, buffer, 0, 0);
+            wl_surface_commit(surface);
+
+            // zwp_idle_inhibit_manager_v1.create_inhibitor
+            const wl_interface *inhibitorInterface = IdleInhibitManager::interface()->methods[1].types[0];
+            wl_proxy_marshal_constructor(inhibitManager, 1, inhibitorInterface, Q_NULLPTR, surface);
+            wl_display_roundtrip(display);
+        }
+
+        ready.release();
+        quit.acquire();
+
+        wl_display_disconnect(display);
+    }
+
+private:
+    wl_compositor *compositor;
+    wl_shm *shm;
+    wl_proxy *inhibitManager;
+
+    static void global(void *data, wl_registry *registry, uint32_t name,
+                       const char *interface, uint32_t version)
+    {
+        Q_UNUSED(version);
+
+        InhibitingClient *self = static_cast<InhibitingClient *>(data);
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor *>(
+                        wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+            self->shm = static_cast<wl_shm *>(
+                        wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        else if (IdleInhibitManager::interfaceName() == interface)
+            self->inhibitManager = static_cast<wl_proxy *>(
+                        wl_registry_bind(registry, name, IdleInhibitManager::interface(), 1));
+    }
+
+    static void globalRemove(void *, wl_registry *, uint32_t)
+    {
+    }
+};
+
+class TestIdleManager : public QObject
+{
+    Q_OBJECT
+public:
+    TestIdleManager(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void idleAfterTimeout()
+    {
+        IdleManager manager;
+        QSignalSpy idleStartedSpy(&manager, SIGNAL(idleStarted()));
+
+        manager.setTimeout(100);
+        QVERIFY(!manager.isIdle());
+        QVERIFY(idleStartedSpy.wait(2000));
+        QVERIFY(manager.isIdle());
+        QCOMPARE(idleStartedSpy.count(), 1);
+    }
+
+    void activityPostponesIdle()
+    {
+        IdleManager manager;
+        QSignalSpy idleStartedSpy(&manager, SIGNAL(idleStarted()));
+
+        manager.setTimeout(300);
+        for (int i = 0; i < 6; i++) {
+            QTest::qWait(100);
+            manager.simulateUserActivity();
+        }
+        QCOMPARE(idleStartedSpy.count(), 0);
+        QVERIFY(!manager.isIdle());
+
+        QVERIFY(idleStartedSpy.wait(2000));
+    }
+
+    void activityResumes()
+    {
+        IdleManager manager;
+        QSignalSpy idleStartedSpy(&manager, SIGNAL(idleStarted()));
+        QSignalSpy resumedSpy(&manager, SIGNAL(resumed()));
+
+        manager.setTimeout(100);
+        QVERIFY(idleStartedSpy.wait(2000));
+
+        manager.simulateUserActivity();
+        QCOMPARE(resumedSpy.count(), 1);
+        QVERIFY(!manager.isIdle());
+
+        // The timeout starts over after resuming
+        QVERIFY(idleStartedSpy.wait(2000));
+        QCOMPARE(idleStartedSpy.count(), 2);
+    }
+
+    void inputResumes()
+    {
+        IdleManager manager;
+        QSignalSpy idleStartedSpy(&manager, SIGNAL(idleStarted()));
+        QSignalSpy resumedSpy(&manager, SIGNAL(resumed()));
+
+        manager.setTimeout(100);
+        QVERIFY(idleStartedSpy.wait(2000));
+
+        // Events for windows count, other objects are ignored
+        QKeyEvent press(QEvent::KeyPress, Qt::Key_A, Qt::NoModifier);
+        QObject object;
+        QCoreApplication::sendEvent(&object, &press);
+        QCOMPARE(resumedSpy.count(), 0);
+
+        QWindow window;
+        QCoreApplication::sendEvent(&window, &press);
+        QCOMPARE(resumedSpy.count(), 1);
+        QVERIFY(!manager.isIdle());
+    }
+
+    void disablingResumes()
+    {
+        IdleManager manager;
+        QSignalSpy idleStartedSpy(&manager, SIGNAL(idleStarted()));
+        QSignalSpy resumedSpy(&manager, SIGNAL(resumed()));
+
+        manager.setTimeout(100);
+        QVERIFY(idleStartedSpy.wait(2000));
+
+        manager.setTimeout(0);
+        QCOMPARE(resumedSpy.count(), 1);
+        QVERIFY(!manager.isIdle());
+
+        QTest::qWait(300);
+        QCOMPARE(idleStartedSpy.count(), 1);
+    }
+
+    void inhibitedByVisibleSurface()
+    {
+        QWaylandCompositor compositor;
+        compositor.setSocketName(s_socketName);
+        new IdleInhibitManager(&compositor);
+        QSignalSpy surfaceCreatedSpy(&compositor, SIGNAL(surfaceCreated(QWaylandSurface*)));
+        compositor.create();
+
+        InhibitingClient client;
+        client.start();
+        QTRY_VERIFY(client.ready.tryAcquire());
+        QCOMPARE(surfaceCreatedSpy.count(), 1);
+        QWaylandSurface *surface = surfaceCreatedSpy.first().first().value<QWaylandSurface *>();
+        QTRY_VERIFY(surface->isMapped());
+
+        IdleManager manager;
+        manager.setCompositor(&compositor);
+        QSignalSpy idleStartedSpy(&manager, SIGNAL(idleStarted()));
+
+        // Nothing shows the surface yet
+        manager.setTimeout(100);
+        QVERIFY(idleStartedSpy.wait(2000));
+        manager.simulateUserActivity();
+
+        QWaylandOutput output(&compositor, Q_NULLPTR);
+        QWaylandView view;
+        view.setSurface(surface);
+        view.setOutput(&output);
+
+        QTest::qWait(500);
+        QCOMPARE(idleStartedSpy.count(), 1);
+
+        // Hidden surfaces don't keep the outputs on
+        surface->setVisibility(QWindow::Hidden);
+        QVERIFY(idleStartedSpy.wait(2000));
+        QCOMPARE(idleStartedSpy.count(), 2);
+
+        view.setSurface(Q_NULLPTR);
+        client.quit.release();
+        QVERIFY(client.wait(5000));
+    }
+};
+
+QTEST_MAIN(TestIdleManager)
+
+#include "tst_idlemanager.moc"
@@ -0,0 +1,201 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <GreenIsland/server/private/screenbackend_p.h>
+
+using namespace GreenIsland;
+using namespace GreenIsland::Server;
+
+typedef Platform::EglFSFunctions EglFSFunctions;
+
+static bool fuzzyEqual(const QVector3D &a, const QVector3D &b)
+{
+    return qAbs(a.x() - b.x()) < 0.001f && qAbs(a.y() - b.y()) < 0.001f &&
+            qAbs(a.z() - b.z()) < 0.001f;
+}
+
+static EglFSFunctions::ColorPipeline pipeline(int stages)
+{
+    EglFSFunctions::ColorPipeline pipeline;
+    pipeline.stages = stages;
+    pipeline.degammaSize = stages & EglFSFunctions::DegammaStage ? 33 : 0;
+    pipeline.gammaSize = stages & EglFSFunctions::GammaStage ? 256 : 0;
+    return pipeline;
+}
+
+class TestScreenColor : public QObject
+{
+    Q_OBJECT
+public:
+    TestScreenColor(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void whitePointReference()
+    {
+        QVERIFY(fuzzyEqual(ScreenPrivate::whitePoint(6500), QVector3D(1, 1, 1)));
+    }
+
+    void whitePointWarm()
+    {
+        // Lower temperatures keep red and take blue away first
+        QVector3D previous = ScreenPrivate::whitePoint(6500);
+        for (int kelvin = 6000; kelvin >= 1000; kelvin -= 500) {
+            const QVector3D gain = ScreenPrivate::whitePoint(kelvin);
+            QCOMPARE(gain.x(), 1.0f);
+            QVERIFY(gain.z() <= gain.y());
+            QVERIFY(gain.y() <= previous.y());
+            QVERIFY(gain.z() <= previous.z());
+            previous = gain;
+        }
+    }
+
+    void whitePointCold()
+    {
+        const QVector3D gain = ScreenPrivate::whitePoint(10000);
+        QCOMPARE(gain.z(), 1.0f);
+        QVERIFY(gain.x() < 1.0f);
+    }
+
+    void whitePointClamped()
+    {
+        QVERIFY(fuzzyEqual(ScreenPrivate::whitePoint(100), ScreenPrivate::whitePoint(1000)));
+        QVERIFY(fuzzyEqual(ScreenPrivate::whitePoint(100000), ScreenPrivate::whitePoint(40000)));
+    }
+
+    void interpolateEnds()
+    {
+        ScreenColorState from;
+        ScreenColorState to;
+        to.whitePoint = QVector3D(1, 0.5f, 0.25f);
+        to.ramp.fill(0.5);
+
+        QCOMPARE(ScreenColorState::interpolate(from, to, -1).whitePoint, from.whitePoint);
+        QCOMPARE(ScreenColorState::interpolate(from, to, 0).ramp, from.ramp);
+        QCOMPARE(ScreenColorState::interpolate(from, to, 1).ramp, to.ramp);
+        QCOMPARE(ScreenColorState::interpolate(from, to, 2).whitePoint, to.whitePoint);
+    }
+
+    void interpolateHalfway()
+    {
+        ScreenColorState from;
+        ScreenColorState to;
+        to.whitePoint = QVector3D(1, 0.5f, 0);
+        to.ramp.fill(1.0);
+        to.matrix(0, 1) = 1;
+
+        const ScreenColorState state = ScreenColorState::interpolate(from, to, 0.5);
+        QVERIFY(fuzzyEqual(state.whitePoint, QVector3D(1, 0.75f, 0.5f)));
+        QCOMPARE(state.ramp.size(), from.ramp.size());
+        for (int i = 0; i < state.ramp.size(); i++)
+            QVERIFY(qAbs(state.ramp.at(i) - (from.ramp.at(i) + 1) / 2) < 1e-9);
+        QCOMPARE(state.matrix(0, 0), 1.0f);
+        QCOMPARE(state.matrix(0, 1), 0.5f);
+        QCOMPARE(state.matrix(1, 0), 0.0f);
+    }
+
+    void identityNeedsNoCorrection()
+    {
+        ScreenPrivate d;
+
+        const int all = EglFSFunctions::DegammaStage | EglFSFunctions::ColorTransformStage |
+                EglFSFunctions::GammaStage;
+        const EglFSFunctions::ColorCorrection correction = d.colorCorrection(pipeline(all));
+        QVERIFY(correction.degammaLut.isEmpty());
+        QVERIFY(correction.colorTransform.isEmpty());
+        QVERIFY(correction.gammaLut.isEmpty());
+    }
+
+    void whitePointInGammaLut()
+    {
+        ScreenPrivate d;
+        d.m_colorTo.whitePoint = ScreenPrivate::whitePoint(3000);
+        d.m_colorProgress = 1.0;
+
+        const EglFSFunctions::ColorCorrection correction =
+                d.colorCorrection(pipeline(EglFSFunctions::GammaStage));
+        QVERIFY(correction.degammaLut.isEmpty());
+        QVERIFY(correction.colorTransform.isEmpty());
+        QCOMPARE(correction.gammaLut.size(), 256 * 3);
+
+        // Black stays black, full white is tinted
+        QCOMPARE(correction.gammaLut.at(0), quint16(0));
+        QCOMPARE(correction.gammaLut.at(255 * 3), quint16(0xffff));
+        QVERIFY(correction.gammaLut.at(255 * 3 + 2) < correction.gammaLut.at(255 * 3 + 1));
+        QCOMPARE(correction.gammaLut.at(255 * 3 + 2),
+                 quint16(qRound(qreal(d.m_colorTo.whitePoint.z()) * 0xffff)));
+    }
+
+    void matrixOnLinearLight()
+    {
+        ScreenPrivate d;
+        d.m_colorTo.matrix(0, 1) = 0.5f;
+        d.m_colorProgress = 1.0;
+
+        const int all = EglFSFunctions::DegammaStage | EglFSFunctions::ColorTransformStage |
+                EglFSFunctions::GammaStage;
+        const EglFSFunctions::ColorCorrection correction = d.colorCorrection(pipeline(all));
+
+        QCOMPARE(correction.colorTransform.size(), 9);
+        QCOMPARE(correction.colorTransform.at(0), qreal(1));
+        QCOMPARE(correction.colorTransform.at(1), qreal(0.5));
+        QCOMPARE(correction.colorTransform.at(3), qreal(0));
+
+        // Degamma decodes sRGB, gamma encodes it again
+        QCOMPARE(correction.degammaLut.size(), 33 * 3);
+        QCOMPARE(correction.degammaLut.at(0), quint16(0));
+        QCOMPARE(correction.degammaLut.at(16 * 3), quint16(qRound(0.21404114 * 0xffff)));
+        QCOMPARE(correction.degammaLut.at(32 * 3), quint16(0xffff));
+
+        QCOMPARE(correction.gammaLut.size(), 256 * 3);
+        QVERIFY(qAbs(int(correction.gammaLut.at(55 * 3)) - qRound(0.5 * 0xffff)) < 256);
+    }
+
+    void matrixWithoutTransformStage()
+    {
+        ScreenPrivate d;
+        d.m_colorTo.matrix(0, 1) = 0.5f;
+        d.m_colorProgress = 1.0;
+
+        const int stages = EglFSFunctions::DegammaStage | EglFSFunctions::GammaStage;
+        const EglFSFunctions::ColorCorrection correction = d.colorCorrection(pipeline(stages));
+        QVERIFY(correction.colorTransform.isEmpty());
+        QVERIFY(correction.degammaLut.isEmpty());
+
+        // Without linear light the gamma ramp is left as is
+        QCOMPARE(correction.gammaLut.size(), 256 * 3);
+        QCOMPARE(correction.gammaLut.at(128 * 3), quint16(qRound(128.0 / 255 * 0xffff)));
+    }
+};
+
+QTEST_MAIN(TestScreenColor)
+
+#include "tst_screencolor.moc"
@@ -0,0 +1,186 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QTemporaryFile>
+#include <QtTest/QtTest>
+
+#include <GreenIsland/server/private/screenmanager_p.h>
+
+using namespace GreenIsland::Server;
+
+static const char configuration[] =
+        "{\n"
+        "    \"outputs\": [\n"
+        "        {\n"
+        "            \"name\": \"Screen0\",\n"
+        "            \"primary\": true,\n"
+        "            \"scale\": 2,\n"
+        "            \"position\": { \"x\": 0, \"y\": 0 },\n"
+        "            \"mode\": { \"size\": { \"width\": 1920, \"height\": 1080 }, \"refreshRate\": 60000 }\n"
+        "        },\n"
+        "        {\n"
+        "            \"name\": \"Screen1\",\n"
+        "            \"position\": { \"x\": 960, \"y\": 0 },\n"
+        "            \"mode\": { \"size\": { \"width\": 1024, \"height\": 768 }, \"refreshRate\": 60000 }\n"
+        "        }\n"
+        "    ]\n"
+        "}\n";
+
+class TestScreenManager : public QObject
+{
+    Q_OBJECT
+public:
+    TestScreenManager(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+        , m_manager(Q_NULLPTR)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_file.open());
+        m_file.write(configuration);
+        m_file.flush();
+
+        qApp->setProperty("__greenisland_screen_backend", QStringLiteral("fake"));
+        qApp->setProperty("__greenisland_screen_configuration", m_file.fileName());
+
+        m_manager = new ScreenManager(this);
+        m_manager->create();
+
+        QCOMPARE(screens().size(), 2);
+        QCOMPARE(m_manager->primaryScreen(), screens().at(0));
+    }
+
+    void confirmationIsOptIn()
+    {
+        // Nothing is reverted behind the back of the client
+        QCOMPARE(m_manager->confirmationTimeout(), 0);
+        QVERIFY(!m_manager->isConfirmationPending());
+    }
+
+    void testState()
+    {
+        ScreenPrivate *screen = Screen::get(screens().at(1));
+        ScreenState state = screen->state();
+        QVERIFY(screen->testState(state));
+
+        state.modeId = screen->m_modes.size();
+        QVERIFY(!screen->testState(state));
+
+        state = screen->state();
+        state.scaleFactor = 0;
+        QVERIFY(!screen->testState(state));
+    }
+
+    void layoutUsesScaleFactor()
+    {
+        // The first screen is 960 logical pixels wide at scale 2
+        QHash<Screen *, ScreenState> states;
+        states.insert(screens().at(1), Screen::get(screens().at(1))->state());
+        QVERIFY(managerPrivate()->testLayout(states));
+
+        states[screens().at(1)].position = QPoint(959, 0);
+        QVERIFY(!managerPrivate()->testLayout(states));
+
+        ScreenState state = Screen::get(screens().at(0))->state();
+        state.scaleFactor = 1;
+        states.clear();
+        states.insert(screens().at(0), state);
+        QVERIFY(!managerPrivate()->testLayout(states));
+    }
+
+    void layoutAllowsClones()
+    {
+        // Give the second screen the mode of the first one
+        ScreenPrivate *screen = Screen::get(screens().at(1));
+        QList<Screen::Mode> modes = screen->m_modes;
+        modes.append({QSize(1920, 1080), 60});
+        screen->setModes(modes);
+
+        // The same exact geometry means mirroring
+        ScreenState state = screen->state();
+        state.modeId = 1;
+        state.position = QPoint(0, 0);
+        state.scaleFactor = 2;
+
+        QHash<Screen *, ScreenState> states;
+        states.insert(screens().at(1), state);
+        QVERIFY(managerPrivate()->testLayout(states));
+
+        // Only with the same scale
+        states[screens().at(1)].scaleFactor = 1;
+        QVERIFY(!managerPrivate()->testLayout(states));
+
+        modes.removeLast();
+        screen->setModes(modes);
+    }
+
+    void applyStates()
+    {
+        Screen *screen = screens().at(1);
+        QSignalSpy positionSpy(screen, SIGNAL(positionChanged()));
+        QSignalSpy scaleSpy(screen, SIGNAL(scaleFactorChanged()));
+        QSignalSpy transformSpy(screen, SIGNAL(transformChanged()));
+
+        ScreenState state = Screen::get(screen)->state();
+        state.position = QPoint(0, 540);
+        state.scaleFactor = 2;
+        state.transform = QWaylandOutput::Transform90;
+
+        QHash<Screen *, ScreenState> states;
+        states.insert(screen, state);
+        QVERIFY(managerPrivate()->testLayout(states));
+        managerPrivate()->applyStates(states);
+
+        QCOMPARE(screen->position(), QPoint(0, 540));
+        QCOMPARE(screen->scaleFactor(), 2);
+        QCOMPARE(screen->transform(), QWaylandOutput::Transform90);
+        QCOMPARE(positionSpy.count(), 1);
+        QCOMPARE(scaleSpy.count(), 1);
+        QCOMPARE(transformSpy.count(), 1);
+    }
+
+private:
+    QTemporaryFile m_file;
+    ScreenManager *m_manager;
+
+    QList<Screen *> screens() const
+    {
+        return managerPrivate()->backend->screens();
+    }
+
+    ScreenManagerPrivate *managerPrivate() const
+    {
+        return static_cast<ScreenManagerPrivate *>(QObjectPrivate::get(m_manager));
+    }
+};
+
+QTEST_MAIN(TestScreenManager)
+
+#include "tst_screenmanager.moc"
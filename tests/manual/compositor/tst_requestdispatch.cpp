@@ -0,0 +1,235 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPL$
+ *
+ * This file may be used under the terms of the GNU Lesser General Public
+ * License version 2.1 or later as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPLv21 included in the packaging of
+ * this file.  Please review the following information to ensure the
+ * GNU Lesser General Public License version 2.1 requirements will be
+ * met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ *
+ * Alternatively, this file may be used under the terms of the GNU General
+ * Public License version 2.0 or later as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPLv2 included in the
+ * packaging of this file.  Please review the following information to ensure
+ * the GNU General Public License version 2.0 requirements will be
+ * met: http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+#include <GreenIsland/QtWaylandCompositor/QWaylandCompositor>
+#include <GreenIsland/QtWaylandCompositor/QWaylandXdgShell>
+#include <GreenIsland/QtWaylandCompositor/private/qwayland-server-wayland.h>
+
+#include <wayland-client.h>
+
+#include "wayland-xdg-shell-client-protocol.h"
+
+#include <string.h>
+
+static const QByteArray s_socketName = QByteArrayLiteral("greenisland-test-requestdispatch-0");
+static const int s_requests = 20000;
+static const int clientCount = 8;
+
+struct FakeResource
+{
+    int id;
+};
+
+typedef QtWaylandServer::ResourceMap<FakeResource> FlatMap;
+typedef QMultiMap<struct ::wl_client *, FakeResource *> TreeMap;
+
+// Client pointers are only used as keys, they are never dereferenced
+static struct ::wl_client *fakeClient(int i)
+{
+    return reinterpret_cast<struct ::wl_client *>(quintptr(0x1000 + i * 0x100));
+}
+
+// Sends a burst of xdg_surface.set_title requests, a string argument
+// that chatty clients update all the time, and waits for the compositor
+// to dispatch them
+class TitleClient : public QThread
+{
+public:
+    TitleClient(bool changing)
+        : QThread()
+        , totalNsecs(-1)
+        , compositor(Q_NULLPTR)
+        , shell(Q_NULLPTR)
+        , m_changing(changing)
+    {
+    }
+
+    qint64 totalNsecs;
+    wl_compositor *compositor;
+    xdg_shell *shell;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        wl_display *display = wl_display_connect(s_socketName.constData());
+        if (!display)
+            return;
+
+        wl_registry *registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &s_registryListener, this);
+        wl_display_roundtrip(display);
+
+        if (compositor && shell) {
+            xdg_shell_use_unstable_version(shell, XDG_SHELL_VERSION_CURRENT);
+            wl_surface *surface = wl_compositor_create_surface(compositor);
+            xdg_surface *xdgSurface = xdg_shell_get_xdg_surface(shell, surface);
+            wl_display_roundtrip(display);
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < s_requests; i++)
+                xdg_surface_set_title(xdgSurface, m_changing && (i & 1) ? "Terminal - ~/src" : "Terminal - ~");
+            if (wl_display_roundtrip(display) >= 0)
+                totalNsecs = timer.nsecsElapsed();
+
+            xdg_surface_destroy(xdgSurface);
+            wl_surface_destroy(surface);
+            xdg_shell_destroy(shell);
+            wl_compositor_destroy(compositor);
+        }
+
+        wl_registry_destroy(registry);
+        wl_display_disconnect(display);
+    }
+
+private:
+    bool m_changing;
+
+    static void handleGlobal(void *data, wl_registry *registry, uint32_t name,
+                             const char *interface, uint32_t version)
+    {
+        Q_UNUSED(version);
+
+        TitleClient *self = static_cast<TitleClient *>(data);
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor *>(
+                        wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        else if (strcmp(interface, xdg_shell_interface.name) == 0)
+            self->shell = static_cast<xdg_shell *>(
+                        wl_registry_bind(registry, name, &xdg_shell_interface, 1));
+    }
+
+    static void handleGlobalRemove(void *data, wl_registry *registry, uint32_t name)
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(registry);
+        Q_UNUSED(name);
+    }
+
+    static const wl_registry_listener s_registryListener;
+};
+
+const wl_registry_listener TitleClient::s_registryListener = {
+    TitleClient::handleGlobal,
+    TitleClient::handleGlobalRemove
+};
+
+class TestRequestDispatch : public QObject
+{
+    Q_OBJECT
+public:
+    TestRequestDispatch(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+        for (int i = 0; i < clientCount; i++)
+            m_resources[i].id = i;
+    }
+
+private:
+    FakeResource m_resources[clientCount];
+
+private Q_SLOTS:
+    void benchmarkDispatch_data()
+    {
+        QTest::addColumn<bool>("changing");
+
+        QTest::newRow("same title") << false;
+        QTest::newRow("changing title") << true;
+    }
+
+    void benchmarkDispatch()
+    {
+        QFETCH(bool, changing);
+
+        QWaylandCompositor compositor;
+        compositor.setSocketName(s_socketName);
+        compositor.create();
+
+        QWaylandXdgShell shell(&compositor);
+
+        TitleClient client(changing);
+        QSignalSpy finishedSpy(&client, &QThread::finished);
+        client.start();
+        QVERIFY(finishedSpy.wait(60000));
+        QVERIFY(client.totalNsecs >= 0);
+
+        // Average time the compositor takes to dispatch one request,
+        // build with and without ZERO_ALLOCATION to compare
+        QTest::setBenchmarkResult(client.totalNsecs / 1000000.0 / s_requests,
+                                  QTest::WalltimeMilliseconds);
+    }
+
+    void benchmarkFlatLookup()
+    {
+        FlatMap map;
+        for (int i = 0; i < clientCount; i++)
+            map.insert(fakeClient(i), &m_resources[i]);
+
+        int sum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < clientCount; i++)
+                sum += map.value(fakeClient(i))->id;
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void benchmarkTreeLookup()
+    {
+        TreeMap map;
+        for (int i = 0; i < clientCount; i++)
+            map.insert(fakeClient(i), &m_resources[i]);
+
+        int sum = 0;
+        QBENCHMARK {
+            // The old resourceMap() accessor returned a copy
+            const TreeMap copy = map;
+            for (int i = 0; i < clientCount; i++)
+                sum += copy.value(fakeClient(i))->id;
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void benchmarkStringArgument()
+    {
+        const char *mimeType = "text/plain;charset=utf-8";
+
+        int length = 0;
+        QBENCHMARK {
+            // What the generated code did for every string argument
+            length += QString::fromUtf8(mimeType).size();
+        }
+        QVERIFY(length > 0);
+    }
+};
+
+QTEST_MAIN(TestRequestDispatch)
+
+#include "tst_requestdispatch.moc"
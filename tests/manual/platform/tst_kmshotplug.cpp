@@ -0,0 +1,146 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:GPL2+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+/*
+ * Output hotplug check for the KMS device integration, it needs a
+ * vkms device configured through configfs with at least two
+ * connectors, all of them connected:
+ *
+ *   modprobe vkms
+ *   # create /sys/kernel/config/vkms/test with two connectors
+ *   # and enable it
+ *
+ * Run it from a VT with a logind session, passing the status
+ * attribute of the connector to unplug:
+ *
+ *   QT_QPA_PLATFORM=greenisland GREENISLAND_QPA_INTEGRATION=kms \
+ *       ./tst_kmshotplug /sys/kernel/config/vkms/test/connectors/connector1/status
+ *
+ * The connector is unplugged and plugged back: the test fails unless
+ * the screen goes away and comes back, while the window on the
+ * other screen keeps rendering.
+ */
+
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLWindow>
+#include <QtGui/QScreen>
+
+class FrameWindow : public QOpenGLWindow
+{
+public:
+    FrameWindow(QScreen *screen)
+        : QOpenGLWindow()
+        , frames(0)
+    {
+        setScreen(screen);
+        connect(this, &QOpenGLWindow::frameSwapped, this, [this] {
+            frames++;
+            update();
+        });
+    }
+
+    int frames;
+
+protected:
+    void paintGL() Q_DECL_OVERRIDE
+    {
+        const float level = (frames % 2) ? 1.0f : 0.0f;
+        context()->functions()->glClearColor(level, 0.0f, 0.0f, 1.0f);
+        context()->functions()->glClear(GL_COLOR_BUFFER_BIT);
+    }
+};
+
+static bool writeStatus(const QString &fileName, bool connected)
+{
+    // vkms connector status: 1 is connected, 2 is disconnected
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning("Cannot open %s", qPrintable(fileName));
+        return false;
+    }
+    return file.write(connected ? "1\n" : "2\n") > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    if (argc < 2) {
+        qWarning("Usage: %s <vkms connector status file>", argv[0]);
+        return 2;
+    }
+    const QString statusFileName = QString::fromLocal8Bit(argv[1]);
+
+    if (app.screens().size() < 2) {
+        qWarning("At least two screens are needed, found %d", app.screens().size());
+        return 2;
+    }
+
+    FrameWindow window(app.primaryScreen());
+    window.showFullScreen();
+
+    const int initialScreens = app.screens().size();
+    int removed = 0;
+    int added = 0;
+    int framesAtUnplug = 0;
+
+    QObject::connect(&app, &QGuiApplication::screenRemoved, [&](QScreen *screen) {
+        qDebug() << "Screen removed:" << screen->name();
+        removed++;
+        framesAtUnplug = window.frames;
+        QTimer::singleShot(1000, [&] {
+            writeStatus(statusFileName, true);
+        });
+    });
+    QObject::connect(&app, &QGuiApplication::screenAdded, [&](QScreen *screen) {
+        qDebug() << "Screen added:" << screen->name();
+        added++;
+        QTimer::singleShot(1000, [&] {
+            const bool rendering = window.frames > framesAtUnplug;
+            qDebug("Removed: %d, added: %d, frames while unplugged: %d",
+                   removed, added, window.frames - framesAtUnplug);
+            QGuiApplication::exit(removed == 1 && added == 1 && rendering &&
+                                  app.screens().size() == initialScreens ? 0 : 1);
+        });
+    });
+
+    // Give up when hotplug events never arrive
+    QTimer::singleShot(10000, [&] {
+        qWarning("Timeout waiting for hotplug events");
+        QGuiApplication::exit(1);
+    });
+
+    QTimer::singleShot(1000, [&] {
+        if (!writeStatus(statusFileName, false))
+            QGuiApplication::exit(2);
+    });
+
+    return app.exec();
+}
@@ -0,0 +1,136 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:GPL2+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+/*
+ * Output rotation check for the KMS device integration, it needs a
+ * driver that exposes the rotation property on primary planes,
+ * such as vkms:
+ *
+ *   modprobe vkms
+ *
+ * Configure the output rotated by 90 degrees:
+ *
+ *   {
+ *     "kms": {
+ *       "outputs": [ { "name": "Virtual1", "transform": "90" } ]
+ *     }
+ *   }
+ *
+ * Run it from a VT with a logind session:
+ *
+ *   QT_QPA_PLATFORM=greenisland GREENISLAND_QPA_INTEGRATION=kms \
+ *       GREENISLAND_QPA_CONFIG=rotation.json ./tst_kmsrotation
+ *
+ * The test fails unless the screen is rotated by the plane, hence
+ * with a transposed size, and frames keep reaching the screen.
+ */
+
+#include <QtCore/QDebug>
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLWindow>
+#include <QtGui/QScreen>
+
+#include <GreenIsland/Platform/EglFSScreen>
+
+using namespace GreenIsland::Platform;
+
+class FrameWindow : public QOpenGLWindow
+{
+public:
+    FrameWindow(QScreen *screen)
+        : QOpenGLWindow()
+        , frames(0)
+    {
+        setScreen(screen);
+        connect(this, &QOpenGLWindow::frameSwapped, this, [this] {
+            frames++;
+            update();
+        });
+    }
+
+    int frames;
+
+protected:
+    void paintGL() Q_DECL_OVERRIDE
+    {
+        // Top half red and bottom half blue, to check by eye
+        // that the scene is upright on the rotated panel
+        QOpenGLFunctions *f = context()->functions();
+        f->glEnable(GL_SCISSOR_TEST);
+        f->glScissor(0, 0, width(), height() / 2);
+        f->glClearColor(0.0f, 0.0f, 1.0f, 1.0f);
+        f->glClear(GL_COLOR_BUFFER_BIT);
+        f->glScissor(0, height() / 2, width(), height() - height() / 2);
+        f->glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+        f->glClear(GL_COLOR_BUFFER_BIT);
+        f->glDisable(GL_SCISSOR_TEST);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    if (QGuiApplication::platformName() != QLatin1String("greenisland")) {
+        qWarning("The greenisland QPA plugin is needed");
+        return 2;
+    }
+
+    QScreen *screen = app.primaryScreen();
+    EglFSScreen *eglfsScreen = static_cast<EglFSScreen *>(screen->handle());
+    if (eglfsScreen->transform() != EglFSScreen::Transform90) {
+        qWarning("Screen %s is not rotated, check the configuration and "
+                 "whether the driver supports plane rotation",
+                 qPrintable(screen->name()));
+        return 2;
+    }
+
+    const QSize modeSize = eglfsScreen->modes().at(eglfsScreen->currentMode()).size;
+    if (screen->geometry().size() != modeSize.transposed()) {
+        qWarning() << "Screen size" << screen->geometry().size()
+                   << "doesn't match the rotated mode" << modeSize;
+        return 1;
+    }
+
+    // Touch positions must survive the round trip through the scan out
+    const QPointF corner(0.25, 0.75);
+    if (eglfsScreen->mapFromScanout(eglfsScreen->mapToScanout(corner)) != corner) {
+        qWarning("Scan out mapping is not reversible");
+        return 1;
+    }
+
+    FrameWindow window(screen);
+    window.showFullScreen();
+
+    QTimer::singleShot(3000, [&] {
+        qDebug("Frames: %d", window.frames);
+        QGuiApplication::exit(window.frames > 60 ? 0 : 1);
+    });
+
+    return app.exec();
+}
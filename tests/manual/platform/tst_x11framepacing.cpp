@@ -0,0 +1,146 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:GPL2+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+/*
+ * Frame pacing check for the X11 device integration, run it under
+ * Xvfb or Xephyr:
+ *
+ *   Xvfb :99 &
+ *   DISPLAY=:99 QT_QPA_PLATFORM=greenisland GREENISLAND_QPA_INTEGRATION=x11 \
+ *       ./tst_x11framepacing [frames]
+ *
+ * Every frame is expected to land on its own vblank: the test fails
+ * when more than 5% of the frames skipped a vblank or landed on the
+ * same one as the previous frame.
+ */
+
+#include <QtCore/QDebug>
+#include <QtCore/QtMath>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLWindow>
+
+#include <GreenIsland/Platform/EglFSFunctions>
+
+using namespace GreenIsland::Platform;
+
+class PacingWindow : public QOpenGLWindow
+{
+public:
+    PacingWindow(int frames)
+        : QOpenGLWindow()
+        , m_frames(frames)
+        , m_missed(0)
+        , m_repeated(0)
+    {
+        connect(this, &QOpenGLWindow::frameSwapped,
+                this, &PacingWindow::frameSwapped);
+    }
+
+    int result() const
+    {
+        return (m_missed + m_repeated) * 20 > m_intervals.size() ? 1 : 0;
+    }
+
+protected:
+    void paintGL() Q_DECL_OVERRIDE
+    {
+        // Alternate colors so that tearing and skipped frames are
+        // visible when running on Xephyr
+        const float level = (m_intervals.size() % 2) ? 1.0f : 0.0f;
+        context()->functions()->glClearColor(level, level, level, 1.0f);
+        context()->functions()->glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+private:
+    int m_frames;
+    int m_missed;
+    int m_repeated;
+    EglFSFunctions::Presentation m_last;
+    QVector<qreal> m_intervals;
+
+    void frameSwapped()
+    {
+        if (!QGuiApplication::platformFunction(EglFSFunctions::lastPresentationIdentifier())) {
+            qWarning("Presentation timing is not available, is the x11 integration in use?");
+            QGuiApplication::exit(2);
+            return;
+        }
+
+        // Nothing was presented yet after the first swap
+        EglFSFunctions::Presentation presentation;
+        if (!EglFSFunctions::lastPresentation(this, &presentation)) {
+            update();
+            return;
+        }
+
+        // The notification of this frame may not be there yet,
+        // the comparison is always with the previous one
+        if (m_last.msc > 0) {
+            if (presentation.msc == m_last.msc)
+                m_repeated++;
+            else if (presentation.msc > m_last.msc + 1)
+                m_missed += presentation.msc - m_last.msc - 1;
+            if (presentation.msc > m_last.msc)
+                m_intervals.append((presentation.ust - m_last.ust) / 1000.0);
+        }
+        m_last = presentation;
+
+        if (m_intervals.size() < m_frames) {
+            update();
+            return;
+        }
+
+        qreal mean = 0;
+        Q_FOREACH (qreal interval, m_intervals)
+            mean += interval;
+        mean /= m_intervals.size();
+
+        qreal variance = 0;
+        Q_FOREACH (qreal interval, m_intervals)
+            variance += (interval - mean) * (interval - mean);
+        variance /= m_intervals.size();
+
+        qDebug("Frames: %d, missed vblanks: %d, repeated vblanks: %d",
+               m_intervals.size(), m_missed, m_repeated);
+        qDebug("Interval: %.3f ms mean, %.3f ms deviation, refresh %.3f ms",
+               mean, qSqrt(variance), presentation.refreshNsec / 1000000.0);
+
+        QGuiApplication::exit(result());
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    const int frames = argc > 1 ? QByteArray(argv[1]).toInt() : 300;
+
+    PacingWindow window(frames > 0 ? frames : 300);
+    window.showFullScreen();
+
+    return app.exec();
+}
@@ -0,0 +1,159 @@
+/****************************************************************************
+ * This file is part of Hawaii.
+ *
+ * Copyright (C) 2016 Pier Luigi Fiorini
+ *
+ * Author(s):
+ *    Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:GPL2+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+/*
+ * Benchmark for BlurItem, a panel and a popup are blurred behind
+ * on a busy backdrop and the frame time is measured with:
+ *
+ *   - static: nothing changes, the cached blur is drawn as is
+ *   - damage: a small item moves behind the panel
+ *   - full: the same, but the cache is thrown away every frame
+ *
+ * Swap interval is 0 and frames are requested continuously, run
+ * it with software rendering to check it's usable on llvmpipe:
+ *
+ *   LIBGL_ALWAYS_SOFTWARE=1 ./tst_blurbenchmark
+ *
+ * The test fails unless partial updates are faster than full ones.
+ */
+
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QSurfaceFormat>
+#include <QtQml/QQmlApplicationEngine>
+#include <QtQuick/QQuickWindow>
+
+#include <GreenIsland/Server/BlurItem>
+
+using namespace GreenIsland::Server;
+
+static const char *scene =
+        "import QtQuick 2.5\n"
+        "import QtQuick.Window 2.2\n"
+        "import GreenIsland.Test 1.0\n"
+        "Window {\n"
+        "    property alias blur: blur\n"
+        "    property alias mover: mover\n"
+        "    width: 1280; height: 800; visible: true\n"
+        "    Item {\n"
+        "        id: backdrop\n"
+        "        anchors.fill: parent\n"
+        "        Rectangle {\n"
+        "            anchors.fill: parent\n"
+        "            gradient: Gradient {\n"
+        "                GradientStop { position: 0; color: \"steelblue\" }\n"
+        "                GradientStop { position: 1; color: \"darkorange\" }\n"
+        "            }\n"
+        "        }\n"
+        "        Grid {\n"
+        "            anchors.centerIn: parent\n"
+        "            columns: 16; spacing: 16\n"
+        "            Repeater {\n"
+        "                model: 128\n"
+        "                Rectangle { width: 48; height: 48; color: Qt.hsla(index / 128, 0.6, 0.5, 1) }\n"
+        "            }\n"
+        "        }\n"
+        "        Rectangle { id: mover; y: 8; width: 64; height: 24; color: \"white\" }\n"
+        "    }\n"
+        "    BlurItem {\n"
+        "        id: blur\n"
+        "        anchors.fill: parent\n"
+        "        source: backdrop\n"
+        "        windows: [panel, popup]\n"
+        "    }\n"
+        "    Rectangle { id: panel; width: parent.width; height: 40; color: \"#80000000\" }\n"
+        "    Rectangle { id: popup; x: 40; y: 60; width: 400; height: 300; color: \"#80ffffff\" }\n"
+        "}\n";
+
+struct Phase
+{
+    const char *name;
+    bool move;
+    bool invalidate;
+};
+
+static const Phase phases[] = {
+    { "static", false, false },
+    { "damage", true, false },
+    { "full", true, true }
+};
+static const int phaseCount = sizeof(phases) / sizeof(Phase);
+
+int main(int argc, char *argv[])
+{
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(0);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QGuiApplication app(argc, argv);
+
+    qmlRegisterType<BlurItem>("GreenIsland.Test", 1, 0, "BlurItem");
+
+    QQmlApplicationEngine engine;
+    engine.loadData(scene);
+
+    QQuickWindow *window = qobject_cast<QQuickWindow *>(engine.rootObjects().value(0));
+    if (!window) {
+        qWarning("Failed to load the scene");
+        return 2;
+    }
+
+    BlurItem *blur = qobject_cast<BlurItem *>(window->property("blur").value<QObject *>());
+    QQuickItem *mover = qobject_cast<QQuickItem *>(window->property("mover").value<QObject *>());
+
+    int phase = 0;
+    int frames = 0;
+    qreal frameTimes[phaseCount];
+    QElapsedTimer timer;
+    timer.start();
+
+    // Frames are swapped on the render thread
+    QObject::connect(window, &QQuickWindow::frameSwapped, blur, [&] {
+        frames++;
+
+        if (timer.elapsed() >= 3000) {
+            frameTimes[phase] = qreal(timer.elapsed()) / frames;
+            qDebug("%s: %.2f ms per frame", phases[phase].name, frameTimes[phase]);
+
+            if (++phase == phaseCount) {
+                QGuiApplication::exit(frameTimes[1] < frameTimes[2] ? 0 : 1);
+                return;
+            }
+
+            frames = 0;
+            timer.restart();
+        }
+
+        if (phases[phase].move)
+            mover->setX((int(mover->x()) + 4) % window->width());
+        if (phases[phase].invalidate)
+            blur->invalidate();
+        window->update();
+    }, Qt::QueuedConnection);
+
+    return app.exec();
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# Measures clipboard throughput between X11 and Wayland clients.
+#
+# Run it from a terminal inside a Green Island session with XWayland
+# enabled, both DISPLAY and WAYLAND_DISPLAY must be set.  Requires
+# xclip and wl-clipboard.
+#
+# Usage: selection-benchmark.sh [size in MiB, defaults to 100]
+
+set -e
+
+size=${1:-100}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+for tool in xclip wl-copy wl-paste; do
+    command -v $tool >/dev/null || { echo "$tool not found" >&2; exit 1; }
+done
+
+head -c $((size * 1024 * 1024)) /dev/urandom | base64 -w 0 > "$tmp/data"
+bytes=$(stat -c %s "$tmp/data")
+
+elapsed() {
+    start=$(date +%s.%N)
+    "$@"
+    end=$(date +%s.%N)
+    echo "$end - $start" | bc
+}
+
+check() {
+    if cmp -s "$tmp/data" "$1"; then
+        echo "$2: $bytes bytes in $3 s ($(echo "$bytes / $3 / 1048576" | bc) MiB/s)"
+    else
+        echo "$2: data mismatch" >&2
+        exit 1
+    fi
+}
+
+# X11 owner, Wayland reader
+xclip -selection clipboard -t UTF8_STRING -i "$tmp/data"
+sleep 1
+t=$(elapsed sh -c "wl-paste -n -t 'text/plain;charset=utf-8' > '$tmp/x2w'")
+check "$tmp/x2w" "X11 -> Wayland" $t
+
+# Wayland owner, X11 reader
+wl-copy -t 'text/plain;charset=utf-8' < "$tmp/data"
+sleep 1
+t=$(elapsed sh -c "xclip -selection clipboard -t UTF8_STRING -o > '$tmp/w2x'")
+check "$tmp/w2x" "Wayland -> X11" $t
+
+# Peak compositor memory should not grow with the transfer size
+pid=$(pidof greenisland 2>/dev/null | cut -d ' ' -f 1)
+if [ -n "$pid" ]; then
+    grep VmHWM /proc/$pid/status
+fi
@@ -53,6 +53,10 @@ bool isServerSide()
     return option == ServerHeader || option == ServerCode;
 }
 
+// Generate server code that passes request arguments to the handlers
+// as received from libwayland and keeps resources in a flat map
+bool zeroAllocation = false;
+
 QByteArray protocolName;
 
 bool parseOption(const char *str, Option *option)
@@ -215,7 +219,7 @@ QByteArray waylandToCType(const QByteArray &waylandType, const QByteArray &inter
 QByteArray waylandToQtType(const QByteArray &waylandType, const QByteArray &interface, bool cStyleArray)
 {
     if (waylandType == "string")
-        return "const QString &";
+        return cStyleArray && zeroAllocation && isServerSide() ? "const char *" : "const QString &";
     else if (waylandType == "array")
         return cStyleArray ? "wl_array *" : "const QByteArray &";
     else
@@ -328,6 +332,132 @@ QByteArray stripInterfaceName(const QByteArray &name, const QByteArray &prefix)
     return name;
 }
 
+/*
+ * Flat client to resource map used in zero allocation mode. Entries are
+ * kept in insertion order in inline storage, up to Prealloc of them are
+ * looked up with a linear scan which doesn't allocate and beats hashing
+ * for that few entries. Larger maps, like globals bound by every client,
+ * also index the latest resource of each client in a hash. The interface
+ * mirrors the QMultiMap API used by compositors.
+ */
+void printResourceMap()
+{
+    printf("#ifndef QT_WAYLAND_SERVER_RESOURCE_MAP\n");
+    printf("#define QT_WAYLAND_SERVER_RESOURCE_MAP\n");
+    printf("    template <typename T, int Prealloc = 4>\n");
+    printf("    class ResourceMap\n");
+    printf("    {\n");
+    printf("    public:\n");
+    printf("        struct Entry\n");
+    printf("        {\n");
+    printf("            struct ::wl_client *client;\n");
+    printf("            T *resource;\n");
+    printf("        };\n");
+    printf("\n");
+    printf("        class const_iterator\n");
+    printf("        {\n");
+    printf("        public:\n");
+    printf("            const_iterator() : m_entry(0) {}\n");
+    printf("            explicit const_iterator(const Entry *entry) : m_entry(entry) {}\n");
+    printf("\n");
+    printf("            T *operator*() const { return m_entry->resource; }\n");
+    printf("            struct ::wl_client *key() const { return m_entry->client; }\n");
+    printf("            T *value() const { return m_entry->resource; }\n");
+    printf("\n");
+    printf("            const_iterator &operator++() { ++m_entry; return *this; }\n");
+    printf("            const_iterator operator++(int) { const_iterator it = *this; ++m_entry; return it; }\n");
+    printf("            bool operator==(const const_iterator &other) const { return m_entry == other.m_entry; }\n");
+    printf("            bool operator!=(const const_iterator &other) const { return m_entry != other.m_entry; }\n");
+    printf("\n");
+    printf("        private:\n");
+    printf("            const Entry *m_entry;\n");
+    printf("        };\n");
+    printf("        typedef const_iterator iterator;\n");
+    printf("\n");
+    printf("        void insert(struct ::wl_client *client, T *resource)\n");
+    printf("        {\n");
+    printf("            Entry entry = { client, resource };\n");
+    printf("            m_entries.append(entry);\n");
+    printf("            if (m_entries.size() == Prealloc + 1) {\n");
+    printf("                for (int i = 0; i < m_entries.size(); ++i)\n");
+    printf("                    m_index.insert(m_entries.at(i).client, m_entries.at(i).resource);\n");
+    printf("            } else if (m_entries.size() > Prealloc) {\n");
+    printf("                m_index.insert(client, resource);\n");
+    printf("            }\n");
+    printf("        }\n");
+    printf("\n");
+    printf("        void remove(struct ::wl_client *client, T *resource)\n");
+    printf("        {\n");
+    printf("            for (int i = 0; i < m_entries.size(); ++i) {\n");
+    printf("                if (m_entries.at(i).client == client && m_entries.at(i).resource == resource) {\n");
+    printf("                    m_entries.remove(i);\n");
+    printf("                    if (m_entries.size() <= Prealloc) {\n");
+    printf("                        m_index.clear();\n");
+    printf("                    } else if (m_index.value(client) == resource) {\n");
+    printf("                        T *latest = scan(client);\n");
+    printf("                        if (latest)\n");
+    printf("                            m_index.insert(client, latest);\n");
+    printf("                        else\n");
+    printf("                            m_index.remove(client);\n");
+    printf("                    }\n");
+    printf("                    return;\n");
+    printf("                }\n");
+    printf("            }\n");
+    printf("        }\n");
+    printf("\n");
+    printf("        T *value(struct ::wl_client *client, T *defaultValue = 0) const\n");
+    printf("        {\n");
+    printf("            // Like QMultiMap, the most recently inserted resource wins\n");
+    printf("            T *resource = m_entries.size() > Prealloc ? m_index.value(client) : scan(client);\n");
+    printf("            return resource ? resource : defaultValue;\n");
+    printf("        }\n");
+    printf("\n");
+    printf("        bool contains(struct ::wl_client *client) const { return value(client) != 0; }\n");
+    printf("\n");
+    printf("        QList<T *> values() const\n");
+    printf("        {\n");
+    printf("            QList<T *> result;\n");
+    printf("            result.reserve(m_entries.size());\n");
+    printf("            for (int i = 0; i < m_entries.size(); ++i)\n");
+    printf("                result.append(m_entries.at(i).resource);\n");
+    printf("            return result;\n");
+    printf("        }\n");
+    printf("\n");
+    printf("        QList<T *> values(struct ::wl_client *client) const\n");
+    printf("        {\n");
+    printf("            QList<T *> result;\n");
+    printf("            for (int i = m_entries.size() - 1; i >= 0; --i) {\n");
+    printf("                if (m_entries.at(i).client == client)\n");
+    printf("                    result.append(m_entries.at(i).resource);\n");
+    printf("            }\n");
+    printf("            return result;\n");
+    printf("        }\n");
+    printf("\n");
+    printf("        int size() const { return m_entries.size(); }\n");
+    printf("        bool isEmpty() const { return m_entries.isEmpty(); }\n");
+    printf("\n");
+    printf("        const_iterator begin() const { return const_iterator(m_entries.constData()); }\n");
+    printf("        const_iterator end() const { return const_iterator(m_entries.constData() + m_entries.size()); }\n");
+    printf("        const_iterator constBegin() const { return begin(); }\n");
+    printf("        const_iterator constEnd() const { return end(); }\n");
+    printf("\n");
+    printf("    private:\n");
+    printf("        T *scan(struct ::wl_client *client) const\n");
+    printf("        {\n");
+    printf("            for (int i = m_entries.size() - 1; i >= 0; --i) {\n");
+    printf("                if (m_entries.at(i).client == client)\n");
+    printf("                    return m_entries.at(i).resource;\n");
+    printf("            }\n");
+    printf("            return 0;\n");
+    printf("        }\n");
+    printf("\n");
+    printf("        QVarLengthArray<Entry, Prealloc> m_entries;\n");
+    printf("        QHash<struct ::wl_client *, T *> m_index;\n");
+    printf("    };\n");
+    printf("#endif\n");
+    printf("\n");
+}
+
 bool ignoreInterface(const QByteArray &name)
 {
     return name == "wl_display"
@@ -381,6 +511,10 @@ void process(QXmlStreamReader &xml, const QByteArray &headerPath, const QByteArr
         printf("#include <QByteArray>\n");
         printf("#include <QMultiMap>\n");
         printf("#include <QString>\n");
+        if (zeroAllocation) {
+            printf("#include <QHash>\n");
+            printf("#include <QVarLengthArray>\n");
+        }
 
         printf("\n");
         printf("#ifndef WAYLAND_VERSION_CHECK\n");
@@ -407,6 +541,13 @@ void process(QXmlStreamReader &xml, const QByteArray &headerPath, const QByteArr
         printf("\n");
         printf("namespace QtWaylandServer {\n");
 
+        if (zeroAllocation)
+            printResourceMap();
+
+        const QByteArray resourceMapType = zeroAllocation
+                ? QByteArray("ResourceMap<Resource>")
+                : QByteArray("QMultiMap<struct ::wl_client*, Resource*>");
+
         for (int j = 0; j < interfaces.size(); ++j) {
             const WaylandInterface &interface = interfaces.at(j);
 
@@ -453,8 +594,12 @@ void process(QXmlStreamReader &xml, const QByteArray &headerPath, const QByteArr
             printf("        Resource *resource() { return m_resource; }\n");
             printf("        const Resource *resource() const { return m_resource; }\n");
             printf("\n");
-            printf("        QMultiMap<struct ::wl_client*, Resource*> resourceMap() { return m_resource_map; }\n");
-            printf("        const QMultiMap<struct ::wl_client*, Resource*> resourceMap() const { return m_resource_map; }\n");
+            if (zeroAllocation) {
+                printf("        const %s &resourceMap() const { return m_resource_map; }\n", resourceMapType.constData());
+            } else {
+                printf("        %s resourceMap() { return m_resource_map; }\n", resourceMapType.constData());
+                printf("        const %s resourceMap() const { return m_resource_map; }\n", resourceMapType.constData());
+            }
             printf("\n");
             printf("        bool isGlobal() const { return m_global != 0; }\n");
             printf("        bool isResource() const { return m_resource != 0; }\n");
@@ -521,7 +666,7 @@ void process(QXmlStreamReader &xml, const QByteArray &headerPath, const QByteArr
             }
 
             printf("\n");
-            printf("        QMultiMap<struct ::wl_client*, Resource*> m_resource_map;\n");
+            printf("        %s m_resource_map;\n", resourceMapType.constData());
             printf("        Resource *m_resource;\n");
             printf("        struct ::wl_global *m_global;\n");
             printf("        uint32_t m_globalVersion;\n");
@@ -1140,8 +1285,19 @@ void process(QXmlStreamReader &xml, const QByteArray &headerPath, const QByteArr
 
 int main(int argc, char **argv)
 {
+    // Options can be anywhere on the command line, remove them
+    // before looking at the positional arguments
+    int count = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--zero-allocation") == 0)
+            zeroAllocation = true;
+        else
+            argv[count++] = argv[i];
+    }
+    argc = count;
+
     if (argc <= 2 || !parseOption(argv[1], &option)) {
-        fprintf(stderr, "Usage: %s [client-header|server-header|client-code|server-code] specfile [header-path] [prefix]\n", argv[0]);
+        fprintf(stderr, "Usage: %s [client-header|server-header|client-code|server-code] [--zero-allocation] specfile [header-path] [prefix]\n", argv[0]);
         return 1;
     }
 